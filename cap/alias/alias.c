@@ -31,14 +31,11 @@ parse_opts(CapAlCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, shortopts, longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, shortopts, longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -49,23 +46,23 @@ parse_opts(CapAlCmd *self) {
         case 'g': self->opts.is_global = true; break;
         case 'd': self->opts.is_desc = true; break;
         case '?':
-        default: PadErr_Die("unknown option"); break;
+        default: CapOut_Err(self->config, "unknown option"); return NULL; break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return NULL;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
 
     return self;
 }
 
 static int
 usage(const CapAlCmd *self) {
-    fprintf(stdout, "Usage:\n"
+    CapOut_Printf(self->config, "Usage:\n"
         "\n"
         "    cap alias [name] [options]\n"
         "\n"
@@ -76,7 +73,7 @@ usage(const CapAlCmd *self) {
         "    -d, --description show description of alias.\n"
         "\n"
     );
-    fflush(stdout);
+    CapOut_Flush(self->config);
     return 0;
 }
 
@@ -112,7 +109,7 @@ CapAlCmd_New(const CapConfig *config, int argc, char **argv) {
     self->desc_colors[2] = PAD_TERM__BRIGHT;
 
     if (!parse_opts(self)) {
-        PadErr_Die("failed to parse options");
+        CapAlCmd_Del(self);
         return NULL;
     }
 
@@ -124,14 +121,14 @@ load_alias_list_by_opts(CapAlCmd* self) {
     if (self->opts.is_global) {
         if (!CapAliasMgr_LoadAliasList(self->almgr, CAP_SCOPE__GLOBAL)) {
             if (CapAliasMgr_HasErr(self->almgr)) {
-                PadErr_Err(CapAliasMgr_GetErrDetail(self->almgr));
+                CapOut_Err(self->config, "%s", CapAliasMgr_GetErrDetail(self->almgr));
             }
             return NULL;
         }
     } else {
         if (!CapAliasMgr_LoadAliasList(self->almgr, CAP_SCOPE__LOCAL)) {
             if (CapAliasMgr_HasErr(self->almgr)) {
-                PadErr_Err(CapAliasMgr_GetErrDetail(self->almgr));
+                CapOut_Err(self->config, "%s", CapAliasMgr_GetErrDetail(self->almgr));
             }
             return NULL;
         }
@@ -164,7 +161,7 @@ print_key_val_desc(
     const char *desc
 ) {
     if (!print_color) {
-        printf("%-*s    %-*s    %s\n",
+        CapOut_Printf(self->config, "%-*s    %-*s    %s\n",
             keymaxlen, key, valmaxlen, val, desc);
         return;
     }
@@ -207,7 +204,7 @@ print_key_val(
     const char *val
 ) {
     if (!print_color) {
-        printf("%-*s    %s\n", keymaxlen, key, val);
+        CapOut_Printf(self->config, "%-*s    %s\n", keymaxlen, key, val);
         return;
     }
 
@@ -221,32 +218,25 @@ print_key_val(
 static int
 show_list(CapAlCmd *self) {
     const CapAliasInfo *alinfo = CapAliasMgr_GetcAliasInfo(self->almgr);
-    const PadDict *key_val_map = CapAliasInfo_GetcKeyValueMap(alinfo);
     int keymaxlen = 0;
     int valmaxlen = 0;
 
 #undef max
 #define max(a, b) (a > b ? a : b);
 
-    for (int i = 0; i < PadDict_Len(key_val_map); ++i) {
-        const PadDictItem *item = PadDict_GetcIndex(key_val_map, i);
-        if (!item) {
-            continue;
-        }
-        keymaxlen = max(strlen(item->key), keymaxlen);
-        valmaxlen = max(strlen(item->value), valmaxlen);
+    for (int i = 0; i < CapAliasInfo_Len(alinfo); ++i) {
+        keymaxlen = max(strlen(CapAliasInfo_GetcKeyAt(alinfo, i)), keymaxlen);
+        valmaxlen = max(strlen(CapAliasInfo_GetcValueAt(alinfo, i)), valmaxlen);
     }
 
+    // colors are written to terminal only. sink of caller gets plain text
     FILE *fout = stdout;
-    bool print_color = isatty(PadFile_GetNum(fout));
-
-    for (int i = 0; i < PadDict_Len(key_val_map); ++i) {
-        const PadDictItem *kv_item = PadDict_GetcIndex(key_val_map, i);
-        if (!kv_item) {
-            continue;
-        }
+    bool print_color = !self->config->out_sink && isatty(PadFile_GetNum(fout));
 
-        const char *desc = CapAliasInfo_GetcDesc(alinfo, kv_item->key);
+    for (int i = 0; i < CapAliasInfo_Len(alinfo); ++i) {
+        const char *key = CapAliasInfo_GetcKeyAt(alinfo, i);
+        const char *value = CapAliasInfo_GetcValueAt(alinfo, i);
+        const char *desc = CapAliasInfo_GetcDescAt(alinfo, i);
         if (self->opts.is_desc && desc) {
             char disp_desc[128] = {0};
             Pad_TrimFirstLine(disp_desc, sizeof disp_desc, desc);
@@ -257,8 +247,8 @@ show_list(CapAlCmd *self) {
                 print_color,
                 keymaxlen,
                 valmaxlen,
-                kv_item->key,
-                kv_item->value,
+                key,
+                value,
                 disp_desc
             );
         } else {
@@ -267,12 +257,12 @@ show_list(CapAlCmd *self) {
                 fout,
                 print_color,
                 keymaxlen,
-                kv_item->key,
-                kv_item->value
+                key,
+                value
             );
         }
     }
-    fflush(stdout);
+    CapOut_Flush(self->config);
 
     return 0;
 }
@@ -282,12 +272,12 @@ show_alias_value(CapAlCmd *self) {
     const char *key = self->argv[self->optind];
     const char *value = getc_value(self, key);
     if (!value) {
-        PadErr_Err("not found alias \"%s\"", key);
+        CapOut_Err(self->config, "not found alias \"%s\"", key);
         return 1;
     }
 
-    puts(value);
-    fflush(stdout);
+    CapOut_Printf(self->config, "%s\n", value);
+    CapOut_Flush(self->config);
     
     return 0;
 }
@@ -301,8 +291,8 @@ CapAlCmd_ShowDescOfAlias(CapAlCmd *self) {
         return 0;
     }
 
-    puts(desc);
-    fflush(stdout);
+    CapOut_Printf(self->config, "%s\n", desc);
+    CapOut_Flush(self->config);
 
     return 0;
 }
@@ -14,6 +14,8 @@
 #include <cap/core/config.h>
 #include <cap/core/alias_manager.h>
 #include <cap/core/alias_info.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 struct CapAlCmd;
 typedef struct CapAlCmd CapAlCmd;
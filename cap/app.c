@@ -13,6 +13,7 @@
 enum {
     MAX_RECURSION_LIMIT = 8,
     NOT_FOUND = -1,
+    MAX_PHASES = 32,
 };
 
 /**
@@ -21,6 +22,15 @@ enum {
 struct CapAppOpts {
     bool is_help;
     bool is_version;
+    bool is_trace_startup;
+};
+
+/**
+ * phase of startup for --trace-startup
+ */
+struct CapAppPhase {
+    const char *name;
+    double msec;
 };
 
 /**
@@ -32,13 +42,68 @@ typedef struct {
     int cmd_argc;
     char **cmd_argv;
     CapConfig *config;
+    CapWarm *warm;  // warm state of daemon (reference). config is of it. NULL if not in child of daemon
     struct CapAppOpts opts;
     PadErrStack *errstack;
+    bool is_inited;  // config and environment were initialized. alias recursion re-enters CapApp_Init
+    struct timespec phase_start;  // start time of current phase of startup
+    struct CapAppPhase phases[MAX_PHASES];  // elapsed times of phases of startup
+    int32_t nphases;
 } CapApp;
 
 static int
 CapApp_Run(CapApp *self, int argc, char *argv[]);
 
+static int
+CapApp_ExecInDaemon(void *arg, int argc, char *argv[]);
+
+static bool
+CapApp_FilterInDaemon(void *arg, int argc, char *argv[]);
+
+/**
+ * end current phase of startup and start next phase
+ *
+ * @param[in] self
+ * @param[in] *name name of ended phase
+ */
+static void
+CapApp_EndPhase(CapApp *self, const char *name) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (self->nphases < MAX_PHASES) {
+        self->phases[self->nphases++] = (struct CapAppPhase) {
+            .name = name,
+            .msec = (now.tv_sec - self->phase_start.tv_sec) * 1e3 +
+                    (now.tv_nsec - self->phase_start.tv_nsec) / 1e6,
+        };
+    }
+
+    self->phase_start = now;
+}
+
+/**
+ * show elapsed times of phases of startup
+ * if --trace-startup option is specified
+ *
+ * @param[in] self
+ */
+static void
+CapApp_ShowStartupTrace(const CapApp *self) {
+    if (!self->opts.is_trace_startup) {
+        return;
+    }
+
+    double total = 0.0;
+    for (int32_t i = 0; i < self->nphases; ++i) {
+        const struct CapAppPhase *phase = &self->phases[i];
+        CapOut_ErrPrintf(self->config, "startup: %-8s %9.3f ms\n", phase->name, phase->msec);
+        total += phase->msec;
+    }
+    CapOut_ErrPrintf(self->config, "startup: %-8s %9.3f ms (state %s)\n",
+        "total", total, self->config->is_deployed ? "hit" : "miss");
+}
+
 /**
  * parse options
  *
@@ -51,18 +116,18 @@ CapApp_ParseOpts(CapApp *self) {
     static struct option longopts[] = {
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'V'},
+        {"trace-startup", no_argument, 0, 'T'},
         {0},
     };
 
     // init status
     self->opts = (struct CapAppOpts){0};
-    optind = 0;
-    opterr = 0;
+    CapGetopt opt = {0};
 
     // parse options
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hV", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hV", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -70,6 +135,7 @@ CapApp_ParseOpts(CapApp *self) {
         switch (cur) {
         case 'h': self->opts.is_help = true; break;
         case 'V': self->opts.is_version = true; break;
+        case 'T': self->opts.is_trace_startup = true; break;
         case '?':
         default:
             Pad_PushErr("invalid option");
@@ -77,7 +143,7 @@ CapApp_ParseOpts(CapApp *self) {
         }
     }
 
-    if (self->argc < optind) {
+    if (self->argc < opt.optind) {
         return false;
     }
 
@@ -92,7 +158,9 @@ CapApp_ParseOpts(CapApp *self) {
 static void
 CapApp_Del(CapApp *self) {
     if (self) {
-        CapConfig_Del(self->config);
+        if (!self->warm) {
+            CapConfig_Del(self->config);
+        }
         Pad_FreeArgv(self->argc, self->argv);
         Pad_FreeArgv(self->cmd_argc, self->cmd_argv);
         PadErrStack_Del(self->errstack);
@@ -229,21 +297,21 @@ CapApp_ParseArgs(CapApp *self, int argc, char *argv[]) {
 /**
  * construct module
  *
- * @param[in] argc
- * @param[in] argv
+ * @param[in] *warm warm state of daemon (reference) or NULL. its config is used instead of new config
  *
  * @return success to pointer to dynamic allocate memory to CapApp
  * @return failed to NULL
  */
 static CapApp *
-CapApp_New(void) {
+CapApp_New(CapWarm *warm) {
     CapApp *self = PadMem_Calloc(1, sizeof(*self));
     if (self == NULL) {
         return NULL;
     }
 
     self->errstack = PadErrStack_New();
-    self->config = CapConfig_New();
+    self->warm = warm;
+    self->config = warm ? CapWarm_GetConfig(warm) : CapConfig_New();
 
     return self;
 }
@@ -266,6 +334,7 @@ CapApp_Usage(CapApp *app) {
         "\n"
         "    -h, --help       show usage\n"
         "    -V, --version    show version\n"
+        "    --trace-startup  show elapsed time of each phase of startup\n"
         "\n"
         "The commands are:\n"
         "\n"
@@ -294,6 +363,8 @@ CapApp_Usage(CapApp *app) {
         "    insert     insert code at label\n"
         "    clone      clone git repository\n"
         "    replace    replace text of file\n"
+        "    hash       remember programs in PATH\n"
+        "    daemon     keep warm process to run commands\n"
     ;
     static const char *examples[] = {
         "    $ cap home\n"
@@ -316,7 +387,7 @@ CapApp_Usage(CapApp *app) {
     srand(time(NULL));
     example = examples[Pad_RandRange(0, exmlen-1)];
 
-    fprintf(stderr,
+    CapOut_ErrPrintf(app->config,
         "%s\n"
         "Examples:\n\n"
         "%s\n"
@@ -331,24 +402,20 @@ CapApp_Usage(CapApp *app) {
  */
 static void
 CapApp_Version(CapApp *self) {
-    fflush(stdout);
-    fflush(stderr);
-    printf("%s\n", CAP__VERSION);
-    fflush(stdout);
-    exit(0);
+    CapOut_Printf(self->config, "%s\n", CAP__VERSION);
+    CapOut_Flush(self->config);
 }
 
 /**
  * check if the argument is the command name of Cap
  *
- * @param[in] self
  * @param[in] cmdname command name
  *
  * @return If the cmdname is the command name of Cap to true
  * @return If the cmdname not is the command name of Cap to false
  */
 static bool
-CapApp_IsCapCmdName(const CapApp *self, const char *cmdname) {
+CapApp_IsCapCmdName(const char *cmdname) {
     static const char *capcmdnames[] = {
         "home",
         "cd",
@@ -376,6 +443,8 @@ CapApp_IsCapCmdName(const CapApp *self, const char *cmdname) {
         "insert",
         "clone",
         "replace",
+        "hash",
+        "daemon",
         NULL,
     };
 
@@ -466,6 +535,16 @@ CapApp_ExecCmdByName(CapApp *self, const char *name) {
         routine(CapCloneCmd);
     } else if (PadCStr_Eq(name, "replace")) {
         routine(CapReplaceCmd);
+    } else if (PadCStr_Eq(name, "hash")) {
+        routine(CapHashCmd);
+    } else if (PadCStr_Eq(name, "daemon")) {
+        CapDaemonCmd *cmd = CapDaemonCmd_New(self->config, self->cmd_argc, self->cmd_argv);
+        if (!cmd) {
+            return 1;
+        }
+        CapDaemonCmd_SetFuncs(cmd, CapApp_ExecInDaemon, CapApp_FilterInDaemon);
+        result = CapDaemonCmd_Run(cmd);
+        CapDaemonCmd_Del(cmd);
     } else {
         Pad_PushErr("invalid command name \"%s\"", name);
         result = 1;
@@ -475,32 +554,77 @@ CapApp_ExecCmdByName(CapApp *self, const char *name) {
 }
 
 /**
- * execute alias by alias name
+ * find alias value by alias name in alias tables of warm state
+ * find first from local scope. not found to find from global scope
+ *
+ * @param[in]  *warm  pointer to CapWarm
+ * @param[out] *dst   destination of alias value
+ * @param[in]  dstsz  size of destination
+ * @param[in]  *name  alias name
+ *
+ * @return found to true else false
+ */
+static bool
+CapApp_FindWarmAliasValue(CapWarm *warm, char *dst, uint32_t dstsz, const char *name) {
+    const int scopes[] = {CAP_SCOPE__LOCAL, CAP_SCOPE__GLOBAL};
+
+    for (int i = 0; i < 2; ++i) {
+        const CapAliasInfo *alinfo = CapWarm_RefreshAliases(warm, scopes[i]);
+        const char *value = CapAliasInfo_GetcValue(alinfo, name);
+        if (value) {
+            snprintf(dst, dstsz, "%s", value);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * find alias value by alias name
+ * find first from local scope. not found to find from global scope
  *
  * @param[in]  self
- * @param[in]  name alias name
+ * @param[out] *dst   destination of alias value
+ * @param[in]  dstsz  size of destination
+ * @param[in]  *name  alias name
  *
- * @return success to 0
- * @return failed to not 0
+ * @return found to true else false
  */
-static int
-CapApp_ExecAliasByName(CapApp *self, bool *found, const char *name) {
+static bool
+CapApp_FindAliasValue(CapApp *self, char *dst, uint32_t dstsz, const char *name) {
+    if (self->warm) {
+        return CapApp_FindWarmAliasValue(self->warm, dst, dstsz, name);
+    }
+
     CapAliasMgr *almgr = CapAliasMgr_New(self->config);
+    if (!almgr) {
+        return false;
+    }
 
-    // find alias value by name
-    // find first from local scope
-    // not found to find from global scope
-    char val[1024];
-    if (CapAliasMgr_FindAliasValue(almgr, val, sizeof val, name, CAP_SCOPE__LOCAL) == NULL) {
+    bool found = true;
+    if (CapAliasMgr_FindAliasValue(almgr, dst, dstsz, name, CAP_SCOPE__LOCAL) == NULL) {
         CapAliasMgr_ClearError(almgr);
-        if (CapAliasMgr_FindAliasValue(almgr, val, sizeof val, name, CAP_SCOPE__GLOBAL) == NULL) {
-            *found = false;
-            return 1;
+        if (CapAliasMgr_FindAliasValue(almgr, dst, dstsz, name, CAP_SCOPE__GLOBAL) == NULL) {
+            found = false;
         }
     }
+
     CapAliasMgr_Del(almgr);
-    *found = true;
+    return found;
+}
 
+/**
+ * execute alias by alias value
+ *
+ * @param[in]  self
+ * @param[in]  val  alias value
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+static int
+CapApp_ExecAliasValue(CapApp *self, const char *val) {
     // create cap's command line with alias value
     PadStr *cmdline = PadStr_New();
 
@@ -527,6 +651,8 @@ CapApp_ExecAliasByName(CapApp *self, bool *found, const char *name) {
     // re-parse application's arguments
     Pad_FreeArgv(self->argc, self->argv);
     Pad_FreeArgv(self->cmd_argc, self->cmd_argv);
+    self->argc = self->cmd_argc = 0;
+    self->argv = self->cmd_argv = NULL;
 
     // increment recursion count for safety
     self->config->recursion_count++;
@@ -543,8 +669,117 @@ CapApp_ExecAliasByName(CapApp *self, bool *found, const char *name) {
     return result;
 }
 
+/**
+ * add resource files of aliases to dependencies of entry
+ * the entry is uncacheable if the resource file is not cacheable
+ *
+ * @param[in] self
+ * @param[in] *entry pointer to CapCmdCacheEntry
+ */
+static void
+CapApp_AddAliasDeps(CapApp *self, CapCmdCacheEntry *entry) {
+    const char *orgs[] = {self->config->cd_path, self->config->home_path};
+    const int scopes[] = {CAP_SCOPE__LOCAL, CAP_SCOPE__GLOBAL};
+
+    CapAliasMgr *almgr = CapAliasMgr_New(self->config);
+    if (!almgr) {
+        entry->is_uncacheable = true;
+        return;
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        // the resource file can be symlink of Cap
+        char path[PAD_FILE__NPATH];
+        snprintf(path, sizeof path, "%s/.caprc", orgs[i]);
+        CapCmdCacheEntry_AddDep(entry, path);
+
+        if (CapAliasMgr_SolveResourcePath(almgr, path, sizeof path, scopes[i])) {
+            CapCmdCacheEntry_AddDep(entry, path);
+            if (!CapAliasCache_IsCacheablePath(path)) {
+                entry->is_uncacheable = true;
+            }
+        } else {
+            CapAliasMgr_ClearError(almgr);
+        }
+    }
+
+    CapAliasMgr_Del(almgr);
+}
+
+/**
+ * resolve command name to source of command
+ * the dependencies of resolution are stored in entry
+ *
+ * @param[in] self
+ * @param[in] *entry   pointer to CapCmdCacheEntry
+ * @param[in] *cmdname command name
+ *
+ * @return success to true
+ * @return failed to false
+ */
+static bool
+CapApp_ResolveCmdName(CapApp *self, CapCmdCacheEntry *entry, const char *cmdname) {
+    // stamp dependencies before read them
+    CapApp_AddAliasDeps(self, entry);
+
+    char val[1024];
+    if (CapApp_FindAliasValue(self, val, sizeof val, cmdname)) {
+        return CapCmdCacheEntry_SetResult(entry, CAP_CMD_CACHE__ALIAS, val) != NULL;
+    }
+
+    // snippets are added to or removed from the directory
+    CapCmdCacheEntry_AddDep(entry, self->config->codes_dir_path);
+
+    bool found = false;
+    if (Cap_FindSnippet(self->config, &found, cmdname) != 0) {
+        return false;
+    }
+    if (found) {
+        return CapCmdCacheEntry_SetResult(entry, CAP_CMD_CACHE__SNIPPET, NULL) != NULL;
+    }
+
+    char cap_fpath[PAD_FILE__NPATH];
+    if (Cap_FindProg(self->config, entry, cap_fpath, sizeof cap_fpath, cmdname)) {
+        return CapCmdCacheEntry_SetResult(entry, CAP_CMD_CACHE__PROG, cap_fpath) != NULL;
+    }
+
+    return CapCmdCacheEntry_SetResult(entry, CAP_CMD_CACHE__RUN, NULL) != NULL;
+}
+
+/**
+ * execute command by result of resolution
+ *
+ * @param[in] self
+ * @param[in] kind    kind of resolution
+ * @param[in] *value  value of resolution
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+static int
+CapApp_ExecResolved(CapApp *self, CapCmdCacheKind kind, const char *value) {
+    const char *cmdname = self->cmd_argv[0];
+
+    switch (kind) {
+    case CAP_CMD_CACHE__ALIAS:
+        return CapApp_ExecAliasValue(self, value);
+    case CAP_CMD_CACHE__SNIPPET:
+        return Cap_ExecSnippetFile(self->config, self->cmd_argc, self->cmd_argv, cmdname);
+    case CAP_CMD_CACHE__PROG:
+        return Cap_ExecProgPath(self->config, self->cmd_argc, self->cmd_argv, value);
+    default:
+        break;
+    }
+
+    PadCStrAry *new_argv = Pad_PushFrontArgv(self->cmd_argc, self->cmd_argv, "run");
+    int argc = PadCStrAry_Len(new_argv);
+    char **argv = PadCStrAry_EscDel(new_argv);
+    return Cap_ExecRun(self->config, argc, argv);
+}
+
 /**
  * run module by cmdname of first argument of command arguments
+ * the resolution of command name is cached at config->var_cmds_path
  * 
  * @param[in] *self 
  * 
@@ -558,56 +793,126 @@ CapApp_RunCmdName(CapApp *self) {
         return 1; // impossible
     }
 
-    if (CapApp_IsCapCmdName(self, cmdname)) {
+    if (CapApp_IsCapCmdName(cmdname)) {
+        CapApp_EndPhase(self, "resolve");
         return CapApp_ExecCmdByName(self, cmdname);
     }
 
-    bool found = false;
-    int result = CapApp_ExecAliasByName(self, &found, cmdname);
-    if (found) {
-        return result;
+    CapCmdCache *cache = CapCmdCache_New();
+    if (!cache) {
+        Pad_PushErr("failed to create command cache");
+        return 1;
     }
+    CapCmdCache_Load(cache, self->config->var_cmds_path);
 
-    found = false;
-    result = Cap_ExecSnippet(self->config, &found, self->cmd_argc, self->cmd_argv, cmdname);
-    if (found) {
-        return result;
+    CapCmdCacheKind kind = CAP_CMD_CACHE__NONE;
+    char *value = NULL;
+
+    const CapCmdCacheEntry *hit = CapCmdCache_Find(cache, self->config, cmdname);
+    if (hit) {
+        kind = hit->kind;
+        value = PadCStr_Dup(hit->value);
+    } else {
+        CapCmdCacheEntry entry;
+        if (!CapCmdCacheEntry_Init(&entry, self->config, cmdname)) {
+            CapCmdCache_Del(cache);
+            Pad_PushErr("failed to initialize entry of command cache");
+            return 1;
+        }
+
+        if (!CapApp_ResolveCmdName(self, &entry, cmdname)) {
+            CapCmdCacheEntry_Fini(&entry);
+            CapCmdCache_Del(cache);
+            return 1;
+        }
+
+        kind = entry.kind;
+        value = PadCStr_Dup(entry.value);
+        if (CapCmdCache_Set(cache, &entry)) {
+            // failure of save is not error. next time resolves again
+            CapCmdCache_Save(cache, self->config->var_cmds_path);
+        }
+        CapCmdCacheEntry_Fini(&entry);
     }
 
-    found = false;
-    result = Cap_ExecProg(self->config, &found, self->cmd_argc, self->cmd_argv, cmdname);
-    if (found) {
-        return result;
+    CapCmdCache_Del(cache);
+    if (!value) {
+        Pad_PushErr("failed to copy value of command cache");
+        return 1;
     }
 
-    PadCStrAry *new_argv = Pad_PushFrontArgv(self->cmd_argc, self->cmd_argv, "run");
-    int argc = PadCStrAry_Len(new_argv);
-    char **argv = PadCStrAry_EscDel(new_argv);
-    return Cap_ExecRun(self->config, argc, argv);
+    CapApp_EndPhase(self, "resolve");
+
+    int result = CapApp_ExecResolved(self, kind, value);
+    free(value);
+    return result;
+}
+
+/**
+ * save state file after deploy of environment
+ * failure of save is not error. next time deploys again
+ *
+ * @param[in] self
+ */
+static void
+CapApp_SaveState(const CapApp *self) {
+    CapState *state = PadMem_Malloc(sizeof(*state));
+    if (!state) {
+        return;
+    }
+
+    if (CapState_Make(state, self->config)) {
+        CapState_Save(state, self->config->var_state_path);
+    }
+
+    free(state);
 }
 
 static bool
 CapApp_Init(CapApp *self, int argc, char *argv[]) {
-    if (!CapConfig_Init(self->config)) {
-        PadErrStack *es = CapConfig_GetErrStack(self->config);
-        PadErrStack_ExtendBackOther(self->errstack, es);
-        Pad_PushErr("failed to configuration");
-        return false;
+    // config and environment are initialized once per process
+    // alias recursion re-enters here with new arguments only
+    bool is_first = !self->is_inited;
+    self->is_inited = true;
+
+    if (is_first) {
+        clock_gettime(CLOCK_MONOTONIC, &self->phase_start);
+        // warm config of daemon has solved paths. variables are read again
+        bool is_ok = self->warm ?
+            CapWarm_Refresh(self->warm) != NULL :
+            CapConfig_Init(self->config) != NULL;
+        if (!is_ok) {
+            PadErrStack *es = CapConfig_GetErrStack(self->config);
+            PadErrStack_ExtendBackOther(self->errstack, es);
+            Pad_PushErr("failed to configuration");
+            return false;
+        }
+        CapApp_EndPhase(self, "config");
     }
 
     if (!CapApp_ParseArgs(self, argc, argv)) {
         Pad_PushErr("failed to parse arguments");
         return false;
     }
+    CapApp_EndPhase(self, "args");
 
+    // arguments of alias value have not options of application
+    bool is_trace_startup = self->opts.is_trace_startup;
     if (!CapApp_ParseOpts(self)) {
         Pad_PushErr("failed to parse options");
         return false;
     }
+    self->opts.is_trace_startup |= is_trace_startup;
+    CapApp_EndPhase(self, "opts");
 
-    if (!CapApp_DeployEnv(self)) {
-        Pad_PushErr("failed to deploy environment at file system");
-        return false;
+    // the valid state file is sentinel of deployed environment
+    if (is_first && !self->config->is_deployed) {
+        if (!CapApp_DeployEnv(self)) {
+            Pad_PushErr("failed to deploy environment at file system");
+            return false;
+        }
+        CapApp_SaveState(self);
+        CapApp_EndPhase(self, "deploy");
     }
 
     return true;
@@ -633,6 +938,7 @@ CapApp_Run(CapApp *self, int argc, char *argv[]) {
 
     if (self->opts.is_version) {
         CapApp_Version(self);
+        return 0;
     }
 
     if (self->cmd_argc == 0) {
@@ -650,37 +956,286 @@ CapApp_Run(CapApp *self, int argc, char *argv[]) {
 static void
 CapApp_Trace(const CapApp *self) {
     if (PadErrStack_Len(self->errstack)) {
-        fflush(stdout);
-        PadErrStack_TraceSimple(self->errstack, stderr);
-        fflush(stderr);        
+        CapOut_TraceErrStack(self->config, self->errstack);
     }
 }
 
 /**
- * main routine
+ * show counters of resolution cache of symbolic links
+ * if CAP_SYMLINK_CACHE_STATS environment variable is "1"
  *
+ * @param[in] self
+ */
+static void
+CapApp_ShowSymlinkCacheStats(const CapApp *self) {
+    const char *show = getenv("CAP_SYMLINK_CACHE_STATS");
+    if (!show || show[0] != '1') {
+        return;
+    }
+
+    CapSymlinkCacheStats stats = CapSymlink_GetCacheStats();
+    CapOut_ErrPrintf(self->config,
+        "symlink cache: hits %llu, misses %llu, stales %llu, entries %u\n",
+        (unsigned long long) stats.hits,
+        (unsigned long long) stats.misses,
+        (unsigned long long) stats.stales,
+        stats.len
+    );
+}
+
+/**
+ * run application and show traces of it
+ *
+ * @param[in] self
  * @param[in] argc
  * @param[in] argv
  *
  * @return success to 0
  * @return failed to not 0
  */
-int
-main(int argc, char *argv[]) {
-    // set locale for unicode object (char32_t, char16_t)
-    setlocale(LC_CTYPE, "");
+static int
+CapApp_RunAndShow(CapApp *self, int argc, char *argv[]) {
+    int result = CapApp_Run(self, argc, argv);
+    if (result != 0) {
+        CapApp_Trace(self);
+    }
+
+    CapApp_ShowStartupTrace(self);
+    CapApp_ShowSymlinkCacheStats(self);
+
+    return result;
+}
 
-    CapApp *app = CapApp_New();
+int
+CapApp_Main(int argc, char *argv[]) {
+    CapApp *app = CapApp_New(NULL);
     if (!app) {
-        PadErr_Die("failed to start application");
+        PadErr_Err("failed to start application");
+        return 1;
     }
 
-    int result = CapApp_Run(app, argc, argv);
-    if (result != 0) {
-        CapApp_Trace(app);
+    int result = CapApp_RunAndShow(app, argc, argv);
+    CapApp_Del(app);
+
+    return result;
+}
+
+/**
+ * run application in child process of daemon
+ * config, alias tables, snippet index and kits of warm state are used
+ *
+ * @param[in] *arg pointer to CapWarm
+ * @param[in] argc
+ * @param[in] argv
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+static int
+CapApp_ExecInDaemon(void *arg, int argc, char *argv[]) {
+    CapApp *app = CapApp_New(arg);
+    if (!app) {
+        PadErr_Err("failed to start application");
+        return 1;
     }
 
+    int result = CapApp_RunAndShow(app, argc, argv);
     CapApp_Del(app);
 
     return result;
 }
+
+/**
+ * check command name can be forwarded to daemon
+ * only built-in commands that do not read terminal are forwarded
+ * run, exec, edit and sh start interactive programs and they need terminal of client
+ *
+ * @param[in] *cmdname command name
+ *
+ * @return forwardable to true else false
+ */
+static bool
+CapApp_IsForwardableCmdName(const char *cmdname) {
+    static const char *names[] = {
+        "home",
+        "cd",
+        "pwd",
+        "ls",
+        "cat",
+        "alias",
+        "mkdir",
+        "rm",
+        "mv",
+        "cp",
+        "touch",
+        "snippet",
+        "link",
+        "make",
+        "cook",
+        "find",
+        "bake",
+        "insert",
+        "replace",
+        "hash",
+        NULL,
+    };
+
+    for (const char **p = names; *p; ++p) {
+        if (PadCStr_Eq(cmdname, *p)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * find command name in arguments of cap
+ * options of application are skipped
+ *
+ * @param[in] argc
+ * @param[in] argv
+ *
+ * @return found to pointer to command name else NULL
+ */
+static const char *
+CapApp_FindCmdName(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] != '-') {
+            return argv[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * check request in child process of daemon
+ * name of other than built-in command is accepted if it is alias of forwardable command
+ * aliases are expanded by alias tables of warm state
+ * snippets, programs and run are refused because they can start interactive programs
+ *
+ * @param[in] *arg pointer to CapWarm
+ * @param[in] argc
+ * @param[in] argv
+ *
+ * @return accept to true else false
+ */
+static bool
+CapApp_FilterInDaemon(void *arg, int argc, char *argv[]) {
+    CapWarm *warm = arg;
+    const char *cmdname = CapApp_FindCmdName(argc, argv);
+    if (!cmdname) {
+        return false;
+    }
+    if (CapApp_IsForwardableCmdName(cmdname)) {
+        return true;
+    }
+    if (CapApp_IsCapCmdName(cmdname) || !CapWarm_Refresh(warm)) {
+        return false;
+    }
+
+    char name[1024];
+    snprintf(name, sizeof name, "%s", cmdname);
+
+    // alias value can be alias
+    for (int i = 0; i < MAX_RECURSION_LIMIT; ++i) {
+        char val[1024];
+        if (!CapApp_FindWarmAliasValue(warm, val, sizeof val, name)) {
+            return false;
+        }
+
+        // same arguments as CapApp_ExecAliasValue
+        PadStr *cmdline = PadStr_New();
+        PadStr_App(cmdline, "cap ");
+        PadStr_App(cmdline, val);
+        PadCL *cl = PadCL_New();
+        PadCL_ParseStrOpts(cl, PadStr_Getc(cmdline), 0);
+        PadStr_Del(cmdline);
+
+        int cl_argc = PadCL_Len(cl);
+        char **cl_argv = PadCL_EscDel(cl);
+        const char *next = CapApp_FindCmdName(cl_argc, cl_argv);
+        bool is_end = !next || CapApp_IsCapCmdName(next);
+        bool is_forwardable = next && CapApp_IsForwardableCmdName(next);
+        if (next) {
+            snprintf(name, sizeof name, "%s", next);
+        }
+        Pad_FreeArgv(cl_argc, cl_argv);
+
+        if (is_end) {
+            return is_forwardable;
+        }
+    }
+
+    return false;
+}
+
+bool
+CapApp_IsForwardable(int argc, char *argv[]) {
+    const char *env = getenv("CAP_DAEMON");
+    if (env && PadCStr_Eq(env, "0")) {
+        return false;
+    }
+
+    const char *cmdname = CapApp_FindCmdName(argc, argv);
+    if (!cmdname) {
+        return false;  // usage only
+    }
+    if (CapApp_IsForwardableCmdName(cmdname)) {
+        return true;
+    }
+
+    // other names can be aliases. the daemon refuses them if they are not aliases of forwardable commands
+    return !CapApp_IsCapCmdName(cmdname);
+}
+
+/**
+ * show error of CapApp_Exec before configuration of application is ready
+ *
+ * @param[in] *err sink of error output. if NULL then stderr
+ * @param[in] *msg message
+ */
+static void
+CapApp_ExecErr(CapSink *err, const char *msg) {
+    if (!err) {
+        PadErr_Err(msg);
+        return;
+    }
+    // same format as PadErr_Err
+    char head = toupper((unsigned char) msg[0]);
+    CapSink_Write(err, "Error: ", 7);
+    CapSink_Write(err, &head, 1);
+    CapSink_Write(err, msg + 1, strlen(msg + 1));
+    CapSink_Write(err, ".\n", 2);
+}
+
+int
+CapApp_Exec(const CapConfig *config, int argc, char *argv[], CapSink *out, CapSink *err) {
+    int result = 1;
+    CapApp *app = CapApp_New(NULL);
+    if (!app || !app->config || !app->errstack) {
+        CapApp_ExecErr(err, "failed to start application");
+        goto done;
+    }
+
+    if (config) {
+        // values of caller are used instead of file system
+        if (!CapConfig_CopyValues(app->config, config)) {
+            CapApp_ExecErr(err, "failed to copy configuration");
+            goto done;
+        }
+        app->config->recursion_count = 0;
+        app->is_inited = true;
+        clock_gettime(CLOCK_MONOTONIC, &app->phase_start);
+    }
+
+    // commands write to sinks of caller instead of stdout and stderr
+    app->config->out_sink = out;
+    app->config->err_sink = err;
+
+    result = CapApp_RunAndShow(app, argc, argv);
+
+done:
+    CapApp_Del(app);
+    return result;
+}
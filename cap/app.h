@@ -1,10 +1,14 @@
 #pragma once
 
+#define _DEFAULT_SOURCE 1 /* cap: app: clock_gettime */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <getopt.h>
 #include <locale.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <pad/lib/string.h>
 #include <pad/lib/term.h>
@@ -20,8 +24,14 @@
 
 #include <cap/core/constant.h>
 #include <cap/core/config.h>
+#include <cap/core/state.h>
 #include <cap/core/util.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
+#include <cap/core/sink.h>
 #include <cap/core/alias_manager.h>
+#include <cap/core/symlink.h>
+#include <cap/core/warm.h>
 
 #include <cap/home/home.h>
 #include <cap/cd/cd.h>
@@ -48,3 +58,51 @@
 #include <cap/insert/insert.h>
 #include <cap/clone/clone.h>
 #include <cap/replace/replace.h>
+#include <cap/hash/hash.h>
+#include <cap/daemon/daemon.h>
+
+/**
+ * run application in this process
+ * the configuration is initialized from user's file system
+ *
+ * @param[in] argc number of arguments
+ * @param[in] argv arguments of cap (argv[0] is "cap")
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+int
+CapApp_Main(int argc, char *argv[]);
+
+/**
+ * check arguments of cap can be forwarded to daemon
+ * built-in commands that do not read terminal are forwarded
+ * names of other than built-in commands are forwarded as candidates of aliases
+ * the daemon refuses them if they are not aliases of forwardable commands
+ * if CAP_DAEMON environment variable is "0" then nothing is forwarded
+ *
+ * @param[in] argc number of arguments
+ * @param[in] argv arguments of cap (argv[0] is "cap")
+ *
+ * @return forwardable to true else false
+ */
+bool
+CapApp_IsForwardable(int argc, char *argv[]);
+
+/**
+ * execute arguments of cap in this process for embedding
+ * reentrant. threads can execute at the same time with own sinks
+ * output of commands is written to sinks instead of stdout and stderr
+ * programs started by run, edit and sh inherit stdout and stderr of the process
+ *
+ * @param[in] *config reference to CapConfig. if NULL then initialized from user's file system
+ * @param[in] argc    number of arguments
+ * @param[in] argv    arguments of cap (argv[0] is "cap")
+ * @param[in] *out    reference to sink of output. if NULL then stdout
+ * @param[in] *err    reference to sink of error output. if NULL then stderr
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+int
+CapApp_Exec(const CapConfig *config, int argc, char *argv[], CapSink *out, CapSink *err);
@@ -44,15 +44,80 @@ error:
     return NULL;
 }
 
+static bool
+is_tree_opt(const char *arg) {
+    return arg && (PadCStr_Eq(arg, "-r") || PadCStr_Eq(arg, "--recursive"));
+}
+
+/**
+ * bake files under directory
+ *
+ *     bake -r [-j N] directory [arguments for templates]
+ *
+ * @param[in] *self
+ *
+ * @return success to 0, else other
+ */
+static int
+bake_tree(CapBakeCmd *self) {
+    static struct option longopts[] = {
+        {"recursive", no_argument, 0, 'r'},
+        {"jobs", required_argument, 0, 'j'},
+        {0},
+    };
+
+    CapBakeTreeOpts opts = {0};
+
+    CapGetopt opt = {0};
+
+    for (;;) {
+        int optsindex;
+        // arguments after directory are arguments for templates
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "+rj:", longopts, &optsindex);
+        if (cur == -1) {
+            break;
+        }
+
+        switch (cur) {
+        case 'r': break;
+        case 'j': opts.njobs = atoi(opt.optarg); break;
+        case '?':
+        default:
+            Pad_PushErr("invalid option for recursive bake");
+            return 1;
+        }
+    }
+
+    if (self->argc <= opt.optind) {
+        Pad_PushErr("need directory for recursive bake");
+        return 1;
+    }
+
+    const char *cap_path = self->argv[opt.optind];
+    char path[PAD_FILE__NPATH];
+    if (!Cap_SolveCmdlineArgPath(self->config, path, sizeof path, cap_path)) {
+        Pad_PushErr("failed to solve cap path");
+        return 1;
+    }
+    if (!PadFile_IsDir(path)) {
+        Pad_PushErr("\"%s\" is not a directory", cap_path);
+        return 1;
+    }
+
+    opts.argc = self->argc - opt.optind - 1;
+    opts.argv = self->argv + opt.optind + 1;
+
+    return CapBakeTree_Run(self->config, self->errstack, path, &opts);
+}
+
 static int
 bake(CapBakeCmd *self) {
     FILE *fin = NULL;
-    FILE *fout = NULL;
+    CapSink *sink = NULL;
     const char *cap_path = NULL;
     char path[PAD_FILE__NPATH];
     char *make_path = NULL;
     char *src = NULL;
-    char *compiled = NULL;
     bool use_stdin = false;
     int make_argc = 0;
     char **make_argv = NULL;
@@ -89,58 +154,50 @@ bake(CapBakeCmd *self) {
     fclose(fin);
     fin = NULL;
 
-    compiled = Cap_MakeArgv(
+    // baked file is replaced after all of output is written
+    sink = use_stdin ? CapOut_NewSink(self->config) : CapSink_NewAtomicFile(path);
+    if (sink == NULL) {
+        Pad_PushErr("failed to open file %s for write", (use_stdin ? "stdout" : path));
+        goto error;
+    }
+
+    if (!Cap_MakeArgvToSink(
         self->config,
         self->errstack,
         make_path,
         src,
         make_argc,
-        make_argv
-    );
-    if (compiled == NULL) {
+        make_argv,
+        sink
+    )) {
         Pad_PushErr("failed to compile");
         goto error;        
     }
 
-    if (use_stdin) {
-        printf("%s", compiled);
-        free(src);
-        free(compiled);
-        return 0;
-    }
-
-    // bake
-    fout = fopen(path, "wb");
-    if (fout == NULL) {
-        Pad_PushErr("failed to open file %s for write", path);
-        goto error;
-    }
-
-    if (fwrite(compiled, sizeof(char), strlen(compiled), fout) == 0) {
-        Pad_PushErr("failed to write data at %s", cap_path);
+    if (!CapSink_Close(sink)) {
+        Pad_PushErr("failed to write data at %s", (use_stdin ? "stdout" : cap_path));
         goto error;
     }
 
     free(src);
-    free(compiled);
-    if (fout) {
-        fclose(fout);
-    }
+    CapSink_Del(sink);
     return 0;
 error:
     free(src);
-    free(compiled);
-    if (fout) {
-        fclose(fout);
-    }
+    CapSink_Del(sink);
     return 1;
 }
 
 int
 CapBakeCmd_Run(CapBakeCmd *self) {
-    int result = bake(self);
+    int result = 0;
+    if (self->argc >= 2 && is_tree_opt(self->argv[1])) {
+        result = bake_tree(self);
+    } else {
+        result = bake(self);
+    }
     if (PadErrStack_Len(self->errstack)) {
-        PadErrStack_TraceSimple(self->errstack, stderr);
+        CapOut_TraceErrStack(self->config, self->errstack);
         return result;
     }
     return result;
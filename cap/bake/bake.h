@@ -10,7 +10,10 @@
 
 #include <cap/core/config.h>
 #include <cap/core/constant.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 #include <cap/make/make.h>
+#include <cap/bake/tree.h>
 
 /**
  * structure and type of command
@@ -0,0 +1,356 @@
+#include <cap/bake/tree.h>
+
+/**
+ * numbers
+ */
+enum {
+    MAX_JOBS = 256,
+};
+
+/**
+ * job of one file
+ */
+typedef struct {
+    char *path;  // path of file
+    const char *relpath;  // relative path from root in path
+    const CapBakeEntry *old;  // entry of last bake or NULL
+    CapBakeEntry entry;  // entry of this bake
+    bool has_entry;  // if true then entry is recorded
+    bool is_fresh;  // if true then old entry is kept
+    bool is_ok;
+    PadErrStack *errstack;
+} Job;
+
+/**
+ * queue of jobs shared by workers
+ */
+typedef struct {
+    const CapConfig *config;
+    const CapBakeTreeOpts *opts;
+    CapKitPool *kit_pool;  // kits are reused by workers
+    uint64_t args_hash;
+    Job *jobs;
+    int32_t len;
+    int32_t capa;
+    int32_t next;  // index of next job for workers
+    pthread_mutex_t mutex;
+} Queue;
+
+static void
+queue_fini(Queue *q) {
+    for (int32_t i = 0; i < q->len; ++i) {
+        Job *job = &q->jobs[i];
+        free(job->path);
+        CapBakeEntry_Fini(&job->entry);
+        PadErrStack_Del(job->errstack);
+    }
+    free(q->jobs);
+}
+
+static bool
+push_job(Queue *q, const char *path, size_t rootlen) {
+    if (q->len >= q->capa) {
+        int32_t capa = q->capa ? q->capa * 2 : 64;
+        Job *jobs = PadMem_Realloc(q->jobs, sizeof(*jobs) * capa);
+        if (!jobs) {
+            return false;
+        }
+        q->jobs = jobs;
+        q->capa = capa;
+    }
+
+    Job *job = &q->jobs[q->len];
+    *job = (Job) {0};
+    job->path = PadCStr_Dup(path);
+    job->errstack = PadErrStack_New();
+    if (!job->path || !job->errstack) {
+        free(job->path);
+        PadErrStack_Del(job->errstack);
+        return false;
+    }
+    job->relpath = job->path + rootlen;
+    q->len++;
+
+    return true;
+}
+
+/**
+ * Stat file without following symlink of file system
+ * Symlink is failed because the target can be out of tree or make cycle
+ */
+static bool
+stat_nofollow(const char *path, struct stat *st) {
+#ifdef CAP__WINDOWS
+    return stat(path, st) == 0;
+#else
+    return lstat(path, st) == 0 && !S_ISLNK(st->st_mode);
+#endif
+}
+
+/**
+ * collect regular files under directory
+ * hidden files and Cap's symbolic links are ignored. symlinks of file system are not followed
+ */
+static bool
+collect_files(Queue *q, PadErrStack *errstack, const char *dirpath, size_t rootlen) {
+    PadDir *dir = PadDir_Open(dirpath);
+    if (!dir) {
+        PadErrStack_Add(errstack, "failed to open directory \"%s\"", dirpath);
+        return false;
+    }
+
+    bool ok = true;
+    for (PadDirNode *node; ok && (node = PadDir_Read(dir)); PadDirNode_Del(node)) {
+        const char *name = PadDirNode_Name(node);
+        if (name[0] == '.') {
+            continue;  // hidden, current, parent and manifest
+        }
+
+        char path[PAD_FILE__NPATH];
+        if (snprintf(path, sizeof path, "%s%c%s", dirpath, PAD_FILE__SEP, name) >= (int) sizeof path) {
+            PadErrStack_Add(errstack, "too long path under \"%s\"", dirpath);
+            ok = false;
+            continue;
+        }
+
+        struct stat st;
+        if (!stat_nofollow(path, &st)) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            ok = collect_files(q, errstack, path, rootlen);
+        } else if (S_ISREG(st.st_mode) && !CapSymlink_IsLinkFile(q->config, path)) {
+            if (!push_job(q, path, rootlen)) {
+                PadErrStack_Add(errstack, "failed to allocate memory");
+                ok = false;
+            }
+        }
+    }
+
+    PadDir_Close(dir);
+    return ok;
+}
+
+static bool
+has_blocks(const char *src) {
+    return strstr(src, "{@") || strstr(src, "{:");
+}
+
+static bool
+replace_file(const CapKit *kit, const char *path) {
+    CapSink *sink = CapSink_NewAtomicFile(path);
+    if (!sink) {
+        return false;
+    }
+
+    bool ok = CapKit_WriteStdoutBuf(kit, sink) && CapSink_Close(sink);
+    CapSink_Del(sink);
+    return ok;
+}
+
+static char **
+make_argv(const Queue *q, const Job *job) {
+    char **argv = PadMem_Calloc(q->opts->argc + 2, sizeof(char *));
+    if (!argv) {
+        return NULL;
+    }
+
+    argv[0] = job->path;
+    for (int i = 0; i < q->opts->argc; ++i) {
+        argv[i + 1] = q->opts->argv[i];
+    }
+
+    return argv;
+}
+
+static bool
+bake_job(const Queue *q, Job *job) {
+    char *src = PadFile_ReadCopyFromPath(job->path);
+    if (!src) {
+        PadErrStack_Add(job->errstack, "failed to read from \"%s\"", job->path);
+        return false;
+    }
+
+    uint64_t src_hash = CapBake_HashStr(src);
+    if (CapBakeEntry_IsFresh(job->old, src_hash, q->args_hash)) {
+        job->is_fresh = true;
+        free(src);
+        return true;  // not changed since last bake
+    }
+    if (!has_blocks(src)) {
+        free(src);
+        return true;  // not eligible
+    }
+
+    bool ok = false;
+    bool is_compiled = false;
+    char **argv = make_argv(q, job);
+    CapKit *kit = CapKitPool_Get(q->kit_pool);
+    if (!argv || !kit) {
+        PadErrStack_Add(job->errstack, "failed to allocate memory");
+        goto done;
+    }
+
+    if (!CapKit_CompileFromStrArgs(kit, job->path, src, q->opts->argc + 1, argv)) {
+        PadErrStack_ExtendBackOther(job->errstack, CapKit_GetcErrStack(kit));
+        PadErrStack_Add(job->errstack, "failed to compile from \"%s\"", job->path);
+        goto done;
+    }
+    is_compiled = true;
+
+    // file is replaced by rename of temporary file. mode of file is kept
+    const char *out = CapKit_GetcStdoutBuf(kit);
+    if (strcmp(out, src) && !replace_file(kit, job->path)) {
+        PadErrStack_Add(job->errstack, "failed to write to \"%s\"", job->path);
+        goto done;
+    }
+
+    job->entry = (CapBakeEntry) {
+        .path = PadCStr_Dup(job->relpath),
+        .src_hash = src_hash,
+        .args_hash = q->args_hash,
+        .out_hash = CapBake_HashStr(out),
+    };
+    // not recorded entry is baked at next time
+    job->has_entry = job->entry.path &&
+                     CapBakeEntry_SetDeps(&job->entry, CapKit_GetcDeps(kit));
+    ok = true;
+
+done:
+    CapKitPool_Put(q->kit_pool, kit, is_compiled);
+    free(argv);
+    free(src);
+    return ok;
+}
+
+static void *
+worker_main(void *arg) {
+    Queue *q = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&q->mutex);
+        int32_t i = q->next < q->len ? q->next++ : -1;
+        pthread_mutex_unlock(&q->mutex);
+        if (i < 0) {
+            break;
+        }
+
+        Job *job = &q->jobs[i];
+        job->is_ok = bake_job(q, job);
+    }
+
+    return NULL;
+}
+
+static int32_t
+count_workers(const CapBakeTreeOpts *opts, int32_t njobs) {
+    int32_t n = opts->njobs;
+    if (n <= 0) {
+#ifdef CAP__WINDOWS
+        n = 1;
+#else
+        n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    }
+    if (n <= 0) {
+        n = 1;
+    }
+    if (n > njobs) {
+        n = njobs;
+    }
+    if (n > MAX_JOBS) {
+        n = MAX_JOBS;
+    }
+    return n;
+}
+
+int
+CapBakeTree_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const char *dirpath,
+    const CapBakeTreeOpts *opts
+) {
+    if (!config || !errstack || !dirpath || !opts) {
+        return 1;
+    }
+
+    char manifest_path[PAD_FILE__NPATH];
+    snprintf(manifest_path, sizeof manifest_path, "%s%c%s", dirpath, PAD_FILE__SEP, CAP_BAKE_TREE__MANIFEST_NAME);
+
+    CapBakeManifest *old = CapBakeManifest_New();
+    CapBakeManifest *cur = CapBakeManifest_New();
+    if (!old || !cur) {
+        PadErrStack_Add(errstack, "failed to create manifest");
+        CapBakeManifest_Del(old);
+        CapBakeManifest_Del(cur);
+        return 1;
+    }
+    CapBakeManifest_Load(old, manifest_path);
+
+    Queue q = {
+        .config = config,
+        .opts = opts,
+        .args_hash = CapBake_HashArgs(opts->argc, opts->argv),
+    };
+    pthread_mutex_init(&q.mutex, NULL);
+
+    int result = 1;
+    if (!collect_files(&q, errstack, dirpath, strlen(dirpath) + 1)) {
+        goto done;
+    }
+    for (int32_t i = 0; i < q.len; ++i) {
+        q.jobs[i].old = CapBakeManifest_Find(old, q.jobs[i].relpath);
+    }
+
+    int32_t nworkers = count_workers(opts, q.len);
+    q.kit_pool = CapKitPool_New(config, nworkers);
+    if (!q.kit_pool) {
+        PadErrStack_Add(errstack, "failed to create pool of kits");
+        goto done;
+    }
+
+    pthread_t threads[MAX_JOBS];
+    int32_t nthreads = 0;
+    for (; nthreads < nworkers - 1; ++nthreads) {
+        if (pthread_create(&threads[nthreads], NULL, worker_main, &q) != 0) {
+            break;
+        }
+    }
+    // this thread is worker too
+    worker_main(&q);
+    for (int32_t i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int32_t nfails = 0;
+    for (int32_t i = 0; i < q.len; ++i) {
+        Job *job = &q.jobs[i];
+        if (!job->is_ok) {
+            CapOut_TraceErrStack(config, job->errstack);
+            nfails++;
+        } else if (job->has_entry) {
+            CapBakeManifest_Add(cur, &job->entry);
+        } else if (job->is_fresh) {
+            CapBakeManifest_Add(cur, job->old);
+        }
+    }
+
+    // failure of save is not error. next time bakes again
+    CapBakeManifest_Save(cur, manifest_path);
+
+    if (nfails) {
+        PadErrStack_Add(errstack, "failed to bake %d files", nfails);
+        goto done;
+    }
+
+    result = 0;
+done:
+    queue_fini(&q);
+    CapKitPool_Del(q.kit_pool);
+    pthread_mutex_destroy(&q.mutex);
+    CapBakeManifest_Del(old);
+    CapBakeManifest_Del(cur);
+    return result;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#define _DEFAULT_SOURCE 1 /* cap: bake/tree: lstat */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/cstring_array.h>
+#include <pad/core/error_stack.h>
+
+#include <cap/core/config.h>
+#include <cap/core/symlink.h>
+#include <cap/core/bake_manifest.h>
+#include <cap/core/output.h>
+#include <cap/lang/kit.h>
+#include <cap/lang/kit_pool.h>
+
+/**
+ * file name of manifest at root directory
+ */
+#define CAP_BAKE_TREE__MANIFEST_NAME ".capbake"
+
+/**
+ * options of bake of tree
+ */
+typedef struct {
+    int32_t njobs;  // number of workers. if 0 then number of processors
+    int argc;  // number of arguments for templates
+    char **argv;  // arguments for templates
+} CapBakeTreeOpts;
+
+/**
+ * bake files under directory at same time
+ * files with blocks of template ("{@" or "{:") are eligible
+ * files whose content, arguments and imported modules are not changed
+ * since last bake are skipped by manifest
+ * files whose result is same as content are not rewritten
+ *
+ * @param[in]  *config   pointer to CapConfig (read-only)
+ * @param[out] *errstack pointer to PadErrStack
+ * @param[in]  *dirpath  path of root directory
+ * @param[in]  *opts     pointer to CapBakeTreeOpts
+ *
+ * @return success to 0, else other
+ */
+int
+CapBakeTree_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const char *dirpath,
+    const CapBakeTreeOpts *opts
+);
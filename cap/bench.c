@@ -0,0 +1,568 @@
+/**
+ * Cap
+ *
+ * License: MIT
+ *  Author: narupo
+ *   Since: 2016
+ *
+ * Micro benchmarks
+ *
+ *      $ make bench
+ *      $ ./build/bench [module] [method] [-n number-of-loops]
+ */
+#include <cap/bench.h>
+
+enum {
+    BENCH_DEF_NLOOP = 100000,
+};
+
+/**
+ * Structure of options
+ */
+struct Opts {
+    bool ishelp;
+    int32_t nloop;
+    int argc;
+    int optind;
+    char **argv;
+};
+
+/**
+ * Structure of benchmark
+ *
+ * bench runs target nloop times and returns checksum of results.
+ * checksum is printed for keep results from optimization
+ */
+struct benchcase {
+    const char *name;
+    uint64_t (*bench)(int32_t nloop);
+    int32_t nloop;  // default number of loops or 0
+};
+
+struct benchmodule {
+    const char *name;
+    const struct benchcase *benches;
+};
+
+/********
+* utils *
+********/
+
+/**
+ * Show error message and exit from process.
+ *
+ * @param string fmt message format.
+ * @param ...    ... format arguments.
+ */
+static void
+die(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+
+    fflush(stdout);
+    fprintf(stderr, "die: ");
+    vfprintf(stderr, fmt, args);
+    if (errno != 0) {
+        fprintf(stderr, ". %s.", strerror(errno));
+    }
+    fprintf(stderr, "\n");
+
+    va_end(args);
+    fflush(stderr);
+    exit(EXIT_FAILURE);
+}
+
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t
+checksum(const char *s) {
+    uint64_t h = 0;
+    for (; *s; ++s) {
+        h = h * 31 + (unsigned char) *s;
+    }
+    return h;
+}
+
+/**********
+* symlink *
+**********/
+
+static const char *normpath_inputs[] = {
+    "/path/to/dir",
+    "/path/to/dir/",
+    "path/../to/../dir",
+    "/home/user/projects/cap/../pad/build/../src/lang/../../include/pad/lib/file.h",
+    "./a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p/q/r/s/t/u/v/w/x/y/z",
+    "//double//slashes///and/trailing/////",
+    NULL,
+};
+
+/**
+ * Reference implementation (CapSymlink_NormPath before single pass normalizer)
+ */
+static char *
+normpath_ref(char *dst, uint32_t dstsz, const char *drtpath) {
+    char **toks = PadCStr_SplitIgnoreEmpty(drtpath, PAD_FILE__SEP);
+    PadCStrAry *srctoks = PadCStrAry_New();
+    for (char **toksp = toks; *toksp; ++toksp) {
+        PadCStrAry_Move(srctoks, *toksp);
+    }
+    Pad_SafeFree(toks);
+
+    PadCStrAry *dsttoks = PadCStrAry_New();
+    for (int32_t i = 0; i < PadCStrAry_Len(srctoks); ++i) {
+        const char *tok = PadCStrAry_Getc(srctoks, i);
+        if (PadCStr_Eq(tok, "..")) {
+            char *el = PadCStrAry_PopMove(dsttoks);
+            Pad_SafeFree(el);
+        } else {
+            PadCStrAry_PushBack(dsttoks, tok);
+        }
+    }
+
+    dst[0] = '\0';
+    if (drtpath[0] == PAD_FILE__SEP) {
+        PadCStr_AppFmt(dst, dstsz, "%c", PAD_FILE__SEP);
+    }
+    for (int32_t i = 0; i < PadCStrAry_Len(dsttoks)-1; ++i) {
+        PadCStr_App(dst, dstsz, PadCStrAry_Getc(dsttoks, i));
+        PadCStr_AppFmt(dst, dstsz, "%c", PAD_FILE__SEP);
+    }
+    if (PadCStrAry_Len(dsttoks)) {
+        PadCStr_App(dst, dstsz, PadCStrAry_Getc(dsttoks, PadCStrAry_Len(dsttoks)-1));
+    }
+
+    PadCStrAry_Del(srctoks);
+    PadCStrAry_Del(dsttoks);
+    return dst;
+}
+
+static uint64_t
+bench_CapSymlink_NormPath_ref(int32_t nloop) {
+    char path[PAD_FILE__NPATH];
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        for (const char **p = normpath_inputs; *p; ++p) {
+            normpath_ref(path, sizeof path, *p);
+            sum += checksum(path);
+        }
+    }
+
+    return sum;
+}
+
+static uint64_t
+bench_CapSymlink_NormPath(int32_t nloop) {
+    CapConfig config = {0};
+    char path[PAD_FILE__NPATH];
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        for (const char **p = normpath_inputs; *p; ++p) {
+            CapSymlink_NormPath(&config, path, sizeof path, *p);
+            sum += checksum(path);
+        }
+    }
+
+    return sum;
+}
+
+static const struct benchcase
+symlink_benches[] = {
+    {"CapSymlink_NormPath_ref", bench_CapSymlink_NormPath_ref},
+    {"CapSymlink_NormPath", bench_CapSymlink_NormPath},
+    {0},
+};
+
+/*************
+* alias info *
+*************/
+
+/**
+ * Set naliases aliases and find all of them
+ */
+static uint64_t
+bench_alias_info(int32_t naliases, int32_t nloop) {
+    char key[32];
+    char val[32];
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        CapAliasInfo *alinfo = CapAliasInfo_New();
+        for (int32_t j = 0; j < naliases; ++j) {
+            snprintf(key, sizeof key, "alias%d", j);
+            snprintf(val, sizeof val, "cap ls dir%d", j);
+            CapAliasInfo_SetValue(alinfo, key, val);
+        }
+        for (int32_t j = 0; j < naliases; ++j) {
+            snprintf(key, sizeof key, "alias%d", j);
+            sum += strlen(CapAliasInfo_GetcValue(alinfo, key));
+        }
+        CapAliasInfo *copied = CapAliasInfo_DeepCopy(alinfo);
+        sum += CapAliasInfo_Len(copied);
+        CapAliasInfo_Del(copied);
+        CapAliasInfo_Del(alinfo);
+    }
+
+    return sum;
+}
+
+/**
+ * Same as bench_alias_info with PadDict (CapAliasInfo before hash table)
+ */
+static uint64_t
+bench_alias_info_ref(int32_t naliases, int32_t nloop) {
+    char key[32];
+    char val[32];
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        PadDict *dict = PadDict_New(32);
+        for (int32_t j = 0; j < naliases; ++j) {
+            snprintf(key, sizeof key, "alias%d", j);
+            snprintf(val, sizeof val, "cap ls dir%d", j);
+            PadDict_Set(dict, key, val);
+        }
+        for (int32_t j = 0; j < naliases; ++j) {
+            snprintf(key, sizeof key, "alias%d", j);
+            sum += strlen(PadDict_Getc(dict, key)->value);
+        }
+        PadDict *copied = PadDict_DeepCopy(dict);
+        sum += PadDict_Len(copied);
+        PadDict_Del(copied);
+        PadDict_Del(dict);
+    }
+
+    return sum;
+}
+
+static uint64_t bench_alias_info_ref_100(int32_t nloop) { return bench_alias_info_ref(100, nloop); }
+static uint64_t bench_alias_info_ref_10k(int32_t nloop) { return bench_alias_info_ref(10000, nloop); }
+static uint64_t bench_alias_info_ref_100k(int32_t nloop) { return bench_alias_info_ref(100000, nloop); }
+static uint64_t bench_alias_info_100(int32_t nloop) { return bench_alias_info(100, nloop); }
+static uint64_t bench_alias_info_10k(int32_t nloop) { return bench_alias_info(10000, nloop); }
+static uint64_t bench_alias_info_100k(int32_t nloop) { return bench_alias_info(100000, nloop); }
+
+static const struct benchcase
+alias_info_benches[] = {
+    {"PadDict_100", bench_alias_info_ref_100, 1000},
+    {"CapAliasInfo_100", bench_alias_info_100, 1000},
+    {"PadDict_10k", bench_alias_info_ref_10k, 2},
+    {"CapAliasInfo_10k", bench_alias_info_10k, 20},
+    {"PadDict_100k", bench_alias_info_ref_100k, 1},
+    {"CapAliasInfo_100k", bench_alias_info_100k, 2},
+    {0},
+};
+
+/*****
+* rc *
+*****/
+
+/**
+ * Make source of resource file that has naliases aliases and PATH
+ *
+ * @return pointer to source (dynamic allocate memory)
+ */
+static char *
+make_rc_src(int32_t naliases) {
+    size_t size = 64 + (size_t) naliases * 64;
+    char *src = PadMem_Malloc(size);
+    if (!src) {
+        die("failed to allocate memory");
+    }
+
+    size_t len = 0;
+    len += snprintf(src + len, size - len, "{@\n    PATH = \"bin\"\n");
+    for (int32_t i = 0; i < naliases; ++i) {
+        len += snprintf(src + len, size - len,
+            "    alias.set(\"a%d\", \"cap ls dir%d\", \"desc %d\")\n", i, i, i);
+    }
+    snprintf(src + len, size - len, "@}\n");
+
+    return src;
+}
+
+static uint64_t
+checksum_alinfo(const CapAliasInfo *alinfo) {
+    int32_t len = CapAliasInfo_Len(alinfo);
+    if (!len) {
+        return 0;
+    }
+    return len + checksum(CapAliasInfo_GetcValueAt(alinfo, len-1));
+}
+
+static uint64_t
+bench_rc_scanner(int32_t naliases, int32_t nloop) {
+    char *src = make_rc_src(naliases);
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        CapAliasInfo *alinfo = CapAliasInfo_New();
+        CapRcScanResult result;
+        if (!CapRcScanner_Scan(&result, alinfo, src)) {
+            die("failed to scan");
+        }
+        sum += checksum_alinfo(alinfo) + checksum(result.path);
+        CapAliasInfo_Del(alinfo);
+    }
+
+    Pad_SafeFree(src);
+    return sum;
+}
+
+/**
+ * Same as CapAliasMgr_LoadPath before scanner
+ */
+static uint64_t
+bench_rc_kit(int32_t naliases, int32_t nloop) {
+    CapConfig *config = CapConfig_New();
+    if (!config) {
+        die("failed to create config");
+    }
+    char *src = make_rc_src(naliases);
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        CapKit *kit = CapKit_New(config);
+        if (!kit || !CapKit_CompileFromStrArgs(kit, "bench.caprc", src, 0, NULL)) {
+            die("failed to compile");
+        }
+        const PadCtx *ctx = CapKit_GetRefCtx(kit);
+        sum += checksum_alinfo(CapBltAliasMod_GetAliasInfo(ctx));
+        CapKit_Del(kit);
+    }
+
+    Pad_SafeFree(src);
+    CapConfig_Del(config);
+    return sum;
+}
+
+static uint64_t bench_rc_scanner_10(int32_t nloop) { return bench_rc_scanner(10, nloop); }
+static uint64_t bench_rc_scanner_100(int32_t nloop) { return bench_rc_scanner(100, nloop); }
+static uint64_t bench_rc_scanner_1000(int32_t nloop) { return bench_rc_scanner(1000, nloop); }
+static uint64_t bench_rc_scanner_5000(int32_t nloop) { return bench_rc_scanner(5000, nloop); }
+static uint64_t bench_rc_kit_10(int32_t nloop) { return bench_rc_kit(10, nloop); }
+static uint64_t bench_rc_kit_100(int32_t nloop) { return bench_rc_kit(100, nloop); }
+static uint64_t bench_rc_kit_1000(int32_t nloop) { return bench_rc_kit(1000, nloop); }
+static uint64_t bench_rc_kit_5000(int32_t nloop) { return bench_rc_kit(5000, nloop); }
+
+static const struct benchcase
+rc_benches[] = {
+    {"CapRcScanner_Scan_10", bench_rc_scanner_10, 10000},
+    {"CapKit_Compile_10", bench_rc_kit_10, 1000},
+    {"CapRcScanner_Scan_100", bench_rc_scanner_100, 1000},
+    {"CapKit_Compile_100", bench_rc_kit_100, 100},
+    {"CapRcScanner_Scan_1000", bench_rc_scanner_1000, 100},
+    {"CapKit_Compile_1000", bench_rc_kit_1000, 10},
+    {"CapRcScanner_Scan_5000", bench_rc_scanner_5000, 20},
+    {"CapKit_Compile_5000", bench_rc_kit_5000, 2},
+    {0},
+};
+
+/******
+* kit *
+******/
+
+static const char KIT_SRC[] = "{@ n = 1 + 2 @}{: n :}\n";
+
+static uint64_t
+bench_kit_new(int32_t nloop) {
+    CapConfig *config = CapConfig_New();
+    if (!config) {
+        die("failed to create config");
+    }
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        CapKit *kit = CapKit_New(config);
+        if (!kit || !CapKit_CompileFromStrArgs(kit, "bench.cap", KIT_SRC, 0, NULL)) {
+            die("failed to compile");
+        }
+        sum += checksum(CapKit_GetcStdoutBuf(kit));
+        CapKit_Del(kit);
+    }
+
+    printf("%-40s %10d kits created\n", "CapKit_New", nloop);
+    CapConfig_Del(config);
+    return sum;
+}
+
+/**
+ * Same as bench_kit_new by pool of kits
+ */
+static uint64_t
+bench_kit_pool(int32_t nloop) {
+    CapConfig *config = CapConfig_New();
+    CapKitPool *pool = CapKitPool_New(config, 1);
+    if (!config || !pool) {
+        die("failed to create pool");
+    }
+    uint64_t sum = 0;
+
+    for (int32_t i = 0; i < nloop; ++i) {
+        CapKit *kit = CapKitPool_Get(pool);
+        if (!kit || !CapKit_CompileFromStrArgs(kit, "bench.cap", KIT_SRC, 0, NULL)) {
+            die("failed to compile");
+        }
+        sum += checksum(CapKit_GetcStdoutBuf(kit));
+        CapKitPool_Put(pool, kit, true);
+    }
+
+    CapKitPoolStats stats = CapKitPool_GetStats(pool);
+    printf("%-40s %10lld kits created %10lld reused\n", "CapKitPool",
+        (long long) stats.nnews,
+        (long long) stats.nreuses
+    );
+    CapKitPool_Del(pool);
+    CapConfig_Del(config);
+    return sum;
+}
+
+static const struct benchcase
+kit_benches[] = {
+    {"CapKit_New", bench_kit_new, 1000},
+    {"CapKitPool", bench_kit_pool, 1000},
+    {0},
+};
+
+/*******
+* main *
+*******/
+
+static const struct benchmodule
+bench_modules[] = {
+    {"symlink", symlink_benches},
+    {"alias_info", alias_info_benches},
+    {"rc", rc_benches},
+    {"kit", kit_benches},
+    {0},
+};
+
+static void
+usage(void) {
+    fprintf(stderr,
+        "Usage:\n"
+        "\n"
+        "    bench [options] [module] [method]\n"
+        "\n"
+        "The options are:\n"
+        "\n"
+        "    -h, --help     show usage\n"
+        "    -n, --nloop    number of loops (default to %d or default of benchmark)\n"
+        "\n",
+        BENCH_DEF_NLOOP
+    );
+}
+
+static int
+parseopts(struct Opts *opts, int argc, char *argv[]) {
+    *opts = (struct Opts) {0};
+    optind = 0;
+    opterr = 0;
+
+    static struct option longopts[] = {
+        {"help", no_argument, 0, 'h'},
+        {"nloop", required_argument, 0, 'n'},
+        {0},
+    };
+
+    for (;;) {
+        int optsindex;
+        int cur = getopt_long(argc, argv, "hn:", longopts, &optsindex);
+        if (cur == -1) {
+            break;
+        }
+
+        switch (cur) {
+        case 0: /* Long option only */ break;
+        case 'h': opts->ishelp = true; break;
+        case 'n': opts->nloop = atoi(optarg); break;
+        case '?':
+        default: die("unknown option"); break;
+        }
+    }
+
+    if (argc < optind || opts->nloop < 0) {
+        die("failed to parse option");
+    }
+
+    opts->argc = argc;
+    opts->optind = optind;
+    opts->argv = argv;
+
+    return 0;
+}
+
+static void
+runbench(const struct benchcase *b, int32_t nloop) {
+    if (!nloop) {
+        nloop = b->nloop ? b->nloop : BENCH_DEF_NLOOP;
+    }
+
+    double start = now();
+    uint64_t sum = b->bench(nloop);
+    double end = now();
+
+    printf("%-40s %10d loops %10.3lfms %10.1lfns/loop (%llx)\n",
+        b->name,
+        nloop,
+        (end - start) * 1e3,
+        (end - start) * 1e9 / nloop,
+        (unsigned long long) sum
+    );
+}
+
+static int32_t
+run(const struct Opts *opts) {
+    const char *modname = NULL;
+    const char *methname = NULL;
+    int32_t nbench = 0;
+
+    if (opts->argc - opts->optind >= 1) {
+        modname = opts->argv[opts->optind];
+    }
+    if (opts->argc - opts->optind >= 2) {
+        methname = opts->argv[opts->optind+1];
+    }
+
+    for (const struct benchmodule *m = bench_modules; m->name; ++m) {
+        if (modname && strcmp(modname, m->name)) {
+            continue;
+        }
+
+        printf("\n* module '%s'\n", m->name);
+        for (const struct benchcase *b = m->benches; b->name; ++b) {
+            if (methname && strcmp(methname, b->name)) {
+                continue;
+            }
+            runbench(b, opts->nloop);
+            ++nbench;
+        }
+    }
+
+    return nbench;
+}
+
+int
+main(int argc, char *argv[]) {
+    struct Opts opts;
+    if (parseopts(&opts, argc, argv) != 0) {
+        die("failed to parse options");
+    }
+
+    if (opts.ishelp) {
+        usage();
+        return 0;
+    }
+
+    int32_t nbench = run(&opts);
+    fprintf(stderr, "\nRun %d benchmarks.\n", nbench);
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/**
+ * Cap
+ *
+ * License: MIT
+ *  Author: narupo
+ *   Since: 2016
+ */
+#pragma once
+
+#define _DEFAULT_SOURCE 1 /* cap: bench: clock_gettime */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <time.h>
+
+#include <pad/lib/cstring_array.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/file.h>
+#include <pad/lib/memory.h>
+#include <pad/lib/dict.h>
+
+#include <cap/core/config.h>
+#include <cap/core/symlink.h>
+#include <cap/core/alias_info.h>
+#include <cap/core/rc_scanner.h>
+#include <cap/lang/kit.h>
+#include <cap/lang/kit_pool.h>
+#include <cap/lang/builtin/modules/alias.h>
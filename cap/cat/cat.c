@@ -7,6 +7,7 @@ struct Opts {
     bool is_help;
     bool is_tab;
     bool is_make;
+    bool is_cache;
     int indent;
     int tabspaces;
 };
@@ -22,6 +23,7 @@ struct CapCatCmd {
     struct Opts opts;
     int optind;
     bool is_debug;
+    CapKitPool *kit_pool;  // kits of make option. construct at first make
 };
 
 /**
@@ -43,6 +45,7 @@ parse_opts(CapCatCmd *self) {
         {"tabspaces", required_argument, 0, 'T'},
         {"tab", no_argument, 0, 't'},
         {"make", no_argument, 0, 'm'},
+        {"cache", no_argument, 0, 'c'},
         {0},
     };
 
@@ -50,15 +53,15 @@ parse_opts(CapCatCmd *self) {
         .is_help = false,
         .is_tab = false,
         .is_make = false,
+        .is_cache = false,
         .indent = 0,
         .tabspaces = 4,
     };
-    opterr = 0;
-    optind = 0;
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hi:T:tm", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hi:T:tm", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -66,23 +69,24 @@ parse_opts(CapCatCmd *self) {
         switch (cur) {
         case 0: /* Long option only */ break;
         case 'h': self->opts.is_help = true; break;
-        case 'i': self->opts.indent = atoi(optarg); break;
-        case 'T': self->opts.tabspaces = atoi(optarg); break;
+        case 'i': self->opts.indent = atoi(opt.optarg); break;
+        case 'T': self->opts.tabspaces = atoi(opt.optarg); break;
         case 't': self->opts.is_tab = true; break;
         case 'm': self->opts.is_make = true; break;
+        case 'c': self->opts.is_cache = true; break;
         case '?':
         default:
-            PadErr_Die("unsupported option");
+            CapOut_Err(self->config, "unsupported option");
             return NULL;
             break;
         }
     }
 
-    if (self->argc < optind) {
+    if (self->argc < opt.optind) {
         return NULL;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
 
     return self;
 }
@@ -98,6 +102,7 @@ CapCatCmd_Del(CapCatCmd *self) {
         return;
     }
     PadErrStack_Del(self->errstack);
+    CapKitPool_Del(self->kit_pool);
     Pad_SafeFree(self);
 }
 
@@ -125,7 +130,7 @@ CapCatCmd_New(const CapConfig *config, int argc, char **argv) {
     }
 
     if (!parse_opts(self)) {
-        PadErr_Err("failed to parse options");
+        CapOut_Err(self->config, "failed to parse options");
         goto error;
     }
 
@@ -192,7 +197,7 @@ set_indent(CapCatCmd *self, char *buf, size_t bufsize) {
  */
 static int
 usage(const CapCatCmd *self) {
-    fprintf(stderr,
+    CapOut_ErrPrintf(self->config,
         "Usage:\n"
         "\n"
         "    cap cat [options] [files]\n"
@@ -204,6 +209,7 @@ usage(const CapCatCmd *self) {
         "    -T, --tabspaces  number of tab spaces.\n"
         "    -t, --tab        tab indent mode.\n"
         "    -m, --make       with make.\n"
+        "    --cache          with cache of make.\n"
         "\n"
         "Examples:\n"
         "\n"
@@ -238,24 +244,56 @@ read_stream(CapCatCmd *self, FILE *fin) {
 }
 
 /**
- * Write buffer at stream
+ * Write buffer at output of command
  *
  * @param[in] *self pointer to CapCatCmd
- * @param[in] *fout pointer to FILE of destination
  * @param[in] *buf pointer to buffer
  *
  * @return success to true, failed to false
  */
 static bool
-write_stream(CapCatCmd *self, const char *fname, FILE *fout, const PadStr *buf) {
+write_stream(CapCatCmd *self, const char *fname, const PadStr *buf) {
     bool ret = true;
     CapKit *kit = NULL;
+    bool is_compiled = false;
     PadStr *out = NULL;
+    char *cached = NULL;
     const char *p = PadStr_Getc(buf);
     int m = 0;
 
-    if (self->opts.is_make) {
-        CapKit *kit = CapKit_New(self->config);
+    char cache_path[PAD_FILE__NPATH];
+    CapRenderCacheKey cache_key;
+    bool is_cacheable = self->opts.is_make &&
+                        self->opts.is_cache &&
+                        CapRenderCache_IsCacheable(p);
+    if (is_cacheable) {
+        CapRenderCacheKey_Init(&cache_key, self->config, fname, p, 0, NULL);
+        if (CapRenderCache_Find(cache_path, sizeof cache_path, self->config->render_cache_dir_path, &cache_key)) {
+            // hit. the kit is not needed
+            if (!self->opts.indent) {
+                CapOut_Flush(self->config);
+                bool is_sent = self->config->out_sink ?
+                    CapRenderCache_SendFileToSink(cache_path, self->config->out_sink, false) :
+                    CapRenderCache_SendFile(cache_path, STDOUT_FILENO, false);
+                if (!is_sent) {
+                    Pad_PushErr("failed to write cache");
+                    ret = false;
+                }
+                goto error;
+            }
+            cached = PadFile_ReadCopyFromPath(cache_path);
+        }
+    }
+
+    if (cached) {
+        p = cached;
+        is_cacheable = false;
+    } else if (self->opts.is_make) {
+        // files are made by one kit
+        if (!self->kit_pool) {
+            self->kit_pool = CapKitPool_New(self->config, 1);
+        }
+        kit = CapKitPool_Get(self->kit_pool);
         if (kit == NULL) {
             Pad_PushErr("failed to create kit");
             goto error;
@@ -273,8 +311,13 @@ write_stream(CapCatCmd *self, const char *fname, FILE *fout, const PadStr *buf)
             Pad_PushErr("failed to compile");
             goto error;
         }
+        is_compiled = true;
 
         p = CapKit_GetcStdoutBuf(kit);
+        if (is_cacheable) {
+            // failure of write is not error
+            CapRenderCache_Write(self->config->render_cache_dir_path, &cache_key, p, CapKit_GetcDeps(kit));
+        }
     }
 
     // set indent
@@ -308,12 +351,13 @@ write_stream(CapCatCmd *self, const char *fname, FILE *fout, const PadStr *buf)
         }
     }
 
-    printf("%s", PadStr_Getc(out));
-    fflush(fout);
+    CapOut_Printf(self->config, "%s", PadStr_Getc(out));
+    CapOut_Flush(self->config);
 
 error:
-    CapKit_Del(kit);
+    CapKitPool_Put(self->kit_pool, kit, is_compiled);
     PadStr_Del(out);
+    free(cached);
     return ret;
 }
 
@@ -362,7 +406,7 @@ CapCatCmd_Run(CapCatCmd *self) {
 
     if (self->argc - self->optind + 1 < 2) {
         PadStr *stdinbuf = read_stream(self, stdin);
-        write_stream(self, NULL, stdout, stdinbuf);
+        write_stream(self, NULL, stdinbuf);
         PadStr_Del(stdinbuf);
         return 0;
     }
@@ -373,7 +417,7 @@ CapCatCmd_Run(CapCatCmd *self) {
 
         if (PadCStr_Eq(name, "-")) {
             PadStr *stdinbuf = read_stream(self, stdin);
-            write_stream(self, NULL, stdout, stdinbuf);
+            write_stream(self, NULL, stdinbuf);
             PadStr_Del(stdinbuf);
             continue;
         }
@@ -381,26 +425,25 @@ CapCatCmd_Run(CapCatCmd *self) {
         char path[PAD_FILE__NPATH];
         if (!make_path(self, path, sizeof path, name)) {
             ++ret;
-            PadErr_Err("failed to make path by \"%s\"", name);
+            CapOut_Err(self->config, "failed to make path by \"%s\"", name);
             continue;
         }
 
         PadStr *filebuf = read_file(self, path);
         if (!filebuf) {
             ++ret;
-            PadErr_Err("failed to read file from \"%s\"", path);
+            CapOut_Err(self->config, "failed to read file from \"%s\"", path);
             continue;
         }
 
-        write_stream(self, path, stdout, filebuf);
+        write_stream(self, path, filebuf);
         PadStr_Del(filebuf);
     }
 
-    fflush(stdout);
+    CapOut_Flush(self->config);
 
     if (PadErrStack_Len(self->errstack)) {
-        PadErrStack_TraceSimple(self->errstack, stderr);
-        fflush(stderr);
+        CapOut_TraceErrStack(self->config, self->errstack);
     }
 
     return ret;
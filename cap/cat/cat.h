@@ -13,7 +13,11 @@
 #include <cap/core/constant.h>
 #include <cap/core/config.h>
 #include <cap/core/symlink.h>
+#include <cap/core/render_cache.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 #include <cap/lang/kit.h>
+#include <cap/lang/kit_pool.h>
 
 struct CapCatCmd;
 typedef struct CapCatCmd CapCatCmd;
@@ -40,28 +40,28 @@ static bool
 cd(CapCdCmd *self, const char *drtpath) {
     char normpath[PAD_FILE__NPATH];
     if (!CapSymlink_NormPath(self->config, normpath, sizeof normpath, drtpath)) {
-        PadErr_Err("failed to normalize path");
+        CapOut_Err(self->config, "failed to normalize path");
         return false;
     }
 
     char realpath[PAD_FILE__NPATH];
     if (!CapSymlink_FollowPath(self->config, realpath, sizeof realpath, normpath)) {
-        PadErr_Err("failed to follow path");
+        CapOut_Err(self->config, "failed to follow path");
         return false;
     }
 
     if (Cap_IsOutOfHome(self->config->home_path, realpath)) {
-        PadErr_Err("\"%s\" is out of home", normpath);
+        CapOut_Err(self->config, "\"%s\" is out of home", normpath);
         return false;
     }
 
     if (!PadFile_IsDir(realpath)) {
-        PadErr_Err("\"%s\" is not a directory", normpath);
+        CapOut_Err(self->config, "\"%s\" is not a directory", normpath);
         return false;
     }
 
     if (!PadFile_WriteLine(normpath, self->config->var_cd_path)) {
-        PadErr_Err("invalid var cd path");
+        CapOut_Err(self->config, "invalid var cd path");
         return false;
     }
 
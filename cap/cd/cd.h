@@ -13,6 +13,7 @@
 #include <cap/core/config.h>
 #include <cap/core/util.h>
 #include <cap/core/symlink.h>
+#include <cap/core/output.h>
 
 struct CapCdCmd;
 typedef struct CapCdCmd CapCdCmd;
@@ -25,9 +25,7 @@ struct CapCloneCmd {
  */
 static int
 usage(CapCloneCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap clone [url|path] [dst-cap-path] [options]...\n"
         "\n"
@@ -36,7 +34,6 @@ usage(CapCloneCmd *self) {
         "    -h, --help    Show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -59,14 +56,11 @@ parse_opts(CapCloneCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hf:", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hf:", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -74,21 +68,21 @@ parse_opts(CapCloneCmd *self) {
         switch (cur) {
         case 0: /* long option only */ break;
         case 'h': self->opts.is_help = true; break;
-        case 'f': printf("%s\n", optarg); break;
+        case 'f': CapOut_Printf(self->config, "%s\n", opt.optarg); break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -147,18 +141,18 @@ CapCloneCmd_Run(CapCloneCmd *self) {
         return usage(self);
     }
 
-    const char *src_path = self->argv[optind];
+    const char *src_path = self->argv[self->optind];
     char repo_name[PAD_FILE__NPATH];
     get_repo_name(repo_name, sizeof repo_name, src_path);
 
-    const char *dst_cap_path = self->argv[optind + 1];
+    const char *dst_cap_path = self->argv[self->optind + 1];
     char dst_path[PAD_FILE__NPATH];
     if (dst_cap_path == NULL) {
         dst_cap_path = repo_name;
     }
 
     if (!Cap_SolveCmdlineArgPath(self->config, dst_path, sizeof dst_path, dst_cap_path)) {
-        fprintf(stderr, "failed to solve path\n");
+        CapOut_ErrPrintf(self->config, "failed to solve path\n");
         return 1;
     }
 
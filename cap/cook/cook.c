@@ -45,7 +45,7 @@ CapCookCmd_Run(CapCookCmd *self) {
         false  // look me!
     );
     if (result != 0) {
-        PadErrStack_TraceSimple(self->errstack, stderr);
+        CapOut_TraceErrStack(self->config, self->errstack);
     }
 
     return result;
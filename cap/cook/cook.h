@@ -9,6 +9,7 @@
 #include <cap/core/constant.h>
 #include <cap/core/util.h>
 #include <cap/core/config.h>
+#include <cap/core/output.h>
 #include <cap/make/make.h>
 
 /**
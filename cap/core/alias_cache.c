@@ -0,0 +1,314 @@
+#include <cap/core/alias_cache.h>
+
+/**
+ * Numbers
+ */
+enum {
+    MAGIC_SIZE = 8,
+    MAX_CACHE_SIZE = 1024 * 1024 * 4,
+};
+
+static const char CACHE_MAGIC[MAGIC_SIZE] = "CAPALC1";
+static const uint32_t NO_DESC = 0xFFFFFFFF;
+
+/**
+ * Sequence number of temporary file in process. threads of process have same pid
+ */
+static pthread_mutex_t tmp_seq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static long tmp_seq;
+
+/**
+ * Words in source that make result of source not determined by content
+ */
+static const char *UNCACHEABLE_WORDS[] = {
+    "import",  // depends on other files
+    "exec",  // depends on result of commands
+    "opts",  // depends on arguments
+    "file",  // depends on file system
+    NULL,
+};
+
+CapAliasCacheKey *
+CapAliasCacheKey_Init(CapAliasCacheKey *key, const struct stat *st, const char *src) {
+    *key = (CapAliasCacheKey) {
+        .mtime = st->st_mtime,
+        .size = st->st_size,
+        .hash = CapRecord_HashStr(src),
+    };
+    return key;
+}
+
+bool
+CapAliasCache_IsCacheable(const char *src) {
+    for (const char **w = UNCACHEABLE_WORDS; *w; ++w) {
+        if (CapRecord_HasWord(src, *w)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+CapAliasCache_IsCacheablePath(const char *path) {
+    if (!PadFile_IsExists(path)) {
+        return true;
+    }
+
+    char *src = PadFile_ReadCopyFromPath(path);
+    bool ok = src && CapAliasCache_IsCacheable(src);
+    free(src);
+    return ok;
+}
+
+char *
+CapAliasCache_MakePath(char *dst, uint32_t dstsz, const char *dirpath, const char *rcpath) {
+    int n = snprintf(dst, dstsz, "%s%c%016llx",
+        dirpath,
+        PAD_FILE__SEP,
+        (unsigned long long) CapRecord_HashStr(rcpath)
+    );
+    if (n < 0 || (uint32_t) n >= dstsz) {
+        return NULL;
+    }
+    return dst;
+}
+
+/*********
+* reader *
+*********/
+
+typedef struct {
+    const char *p;
+    const char *end;
+} Reader;
+
+static bool
+read_bytes(Reader *r, void *dst, size_t n) {
+    if ((size_t) (r->end - r->p) < n) {
+        return false;
+    }
+    memcpy(dst, r->p, n);
+    r->p += n;
+    return true;
+}
+
+/**
+ * Read length-prefixed string to buffer
+ */
+static bool
+read_str(Reader *r, char *dst, uint32_t dstsz) {
+    uint32_t len;
+    if (!read_bytes(r, &len, sizeof len)) {
+        return false;
+    }
+    if (len >= dstsz || (size_t) (r->end - r->p) < len) {
+        return false;
+    }
+    memcpy(dst, r->p, len);
+    dst[len] = '\0';
+    r->p += len;
+    return true;
+}
+
+/**
+ * Read length-prefixed string to dynamic allocated buffer
+ * The length is bounded by rest of cache (MAX_CACHE_SIZE)
+ * If length is NO_DESC then *dst is NULL
+ */
+static bool
+read_str_dup(Reader *r, char **dst) {
+    *dst = NULL;
+    uint32_t len;
+    if (!read_bytes(r, &len, sizeof len)) {
+        return false;
+    }
+    if (len == NO_DESC) {
+        return true;
+    }
+    if ((size_t) (r->end - r->p) < len) {
+        return false;
+    }
+
+    *dst = PadMem_Malloc(len + 1);
+    if (!*dst) {
+        return false;
+    }
+    memcpy(*dst, r->p, len);
+    (*dst)[len] = '\0';
+    r->p += len;
+    return true;
+}
+
+static char *
+read_file(const char *path, size_t *len) {
+    FILE *fin = fopen(path, "rb");
+    if (!fin) {
+        return NULL;
+    }
+
+    char *buf = NULL;
+    if (fseek(fin, 0, SEEK_END) != 0) {
+        goto fail;
+    }
+    long size = ftell(fin);
+    if (size < 0 || size > MAX_CACHE_SIZE || fseek(fin, 0, SEEK_SET) != 0) {
+        goto fail;
+    }
+
+    buf = PadMem_Malloc(size + 1);
+    if (!buf || fread(buf, 1, size, fin) != (size_t) size) {
+        goto fail;
+    }
+
+    fclose(fin);
+    *len = size;
+    return buf;
+fail:
+    Pad_SafeFree(buf);
+    fclose(fin);
+    return NULL;
+}
+
+CapAliasInfo *
+CapAliasCache_Read(const char *cachepath, const char *rcpath, const CapAliasCacheKey *key) {
+    if (!cachepath || !rcpath || !key) {
+        return NULL;
+    }
+
+    size_t len = 0;
+    char *buf = read_file(cachepath, &len);
+    if (!buf) {
+        return NULL;
+    }
+
+    Reader r = { .p = buf, .end = buf + len };
+    CapAliasInfo *alinfo = NULL;
+    char magic[MAGIC_SIZE];
+    CapAliasCacheKey saved;
+    char path[PAD_FILE__NPATH];
+    uint32_t nitems;
+
+    if (!read_bytes(&r, magic, sizeof magic) ||
+        memcmp(magic, CACHE_MAGIC, sizeof magic) ||
+        !read_bytes(&r, &saved.mtime, sizeof saved.mtime) ||
+        !read_bytes(&r, &saved.size, sizeof saved.size) ||
+        !read_bytes(&r, &saved.hash, sizeof saved.hash) ||
+        !read_str(&r, path, sizeof path) ||
+        !read_bytes(&r, &nitems, sizeof nitems)) {
+        goto fail;
+    }
+
+    if (saved.mtime != key->mtime ||
+        saved.size != key->size ||
+        saved.hash != key->hash ||
+        strcmp(path, rcpath)) {
+        // resource file was changed
+        goto fail;
+    }
+
+    alinfo = CapAliasInfo_New();
+    if (!alinfo) {
+        goto fail;
+    }
+
+    for (uint32_t i = 0; i < nitems; ++i) {
+        // strings of alias info have any length
+        char *k = NULL;
+        char *v = NULL;
+        char *d = NULL;
+        bool ok = read_str_dup(&r, &k) && k &&
+                  read_str_dup(&r, &v) && v &&
+                  read_str_dup(&r, &d) &&
+                  CapAliasInfo_SetValue(alinfo, k, v) &&
+                  (!d || CapAliasInfo_SetDesc(alinfo, k, d));
+        free(k);
+        free(v);
+        free(d);
+        if (!ok) {
+            goto fail;
+        }
+    }
+
+    Pad_SafeFree(buf);
+    return alinfo;
+fail:
+    CapAliasInfo_Del(alinfo);
+    Pad_SafeFree(buf);
+    return NULL;
+}
+
+/*********
+* writer *
+*********/
+
+static bool
+write_str(FILE *fout, const char *s) {
+    if (!s) {
+        return fwrite(&NO_DESC, sizeof NO_DESC, 1, fout) == 1;
+    }
+
+    uint32_t len = strlen(s);
+    return fwrite(&len, sizeof len, 1, fout) == 1 &&
+           fwrite(s, 1, len, fout) == len;
+}
+
+static bool
+write_all(FILE *fout, const char *rcpath, const CapAliasCacheKey *key, const CapAliasInfo *alinfo) {
+    uint32_t nitems = CapAliasInfo_Len(alinfo);
+
+    if (fwrite(CACHE_MAGIC, sizeof CACHE_MAGIC, 1, fout) != 1 ||
+        fwrite(&key->mtime, sizeof key->mtime, 1, fout) != 1 ||
+        fwrite(&key->size, sizeof key->size, 1, fout) != 1 ||
+        fwrite(&key->hash, sizeof key->hash, 1, fout) != 1 ||
+        !write_str(fout, rcpath) ||
+        fwrite(&nitems, sizeof nitems, 1, fout) != 1) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < nitems; ++i) {
+        if (!write_str(fout, CapAliasInfo_GetcKeyAt(alinfo, i)) ||
+            !write_str(fout, CapAliasInfo_GetcValueAt(alinfo, i)) ||
+            !write_str(fout, CapAliasInfo_GetcDescAt(alinfo, i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+CapAliasCache_Write(
+    const char *cachepath,
+    const char *rcpath,
+    const CapAliasCacheKey *key,
+    const CapAliasInfo *alinfo
+) {
+    if (!cachepath || !rcpath || !key || !alinfo) {
+        return false;
+    }
+
+    // other processes and threads may write same cache at same time
+    pthread_mutex_lock(&tmp_seq_mutex);
+    long seq = tmp_seq++;
+    pthread_mutex_unlock(&tmp_seq_mutex);
+
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.%ld.%ld.tmp", cachepath, (long) getpid(), seq);
+
+    FILE *fout = fopen(tmppath, "wb");
+    if (!fout) {
+        return false;
+    }
+
+    bool ok = write_all(fout, rcpath, key, alinfo);
+    if (fclose(fout) != 0) {
+        ok = false;
+    }
+
+    if (!ok || PadFile_Rename(tmppath, cachepath) != 0) {
+        PadFile_Remove(tmppath);
+        return false;
+    }
+
+    return true;
+}
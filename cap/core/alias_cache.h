@@ -0,0 +1,123 @@
+/**
+ * Cache of alias tables of resource files (.caprc)
+ *
+ * .caprc を評価して得られたエイリアスをバイナリ形式で ~/.cap/var/alias_cache に保存する
+ * キャッシュは .caprc のパス、mtime、サイズ、内容のハッシュで検証される
+ * 一致すればインタプリタを起動せずにエイリアスを読み込める
+ *
+ * The format of file is native byte order (the cache is not portable):
+ *
+ *      "CAPALC1\0"
+ *      int64 mtime, int64 size, uint64 hash
+ *      uint32 length of path, path
+ *      uint32 number of aliases
+ *      uint32 length of key, key, uint32 length of value, value,
+ *      uint32 length of description or 0xFFFFFFFF if not exists, description
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/dict.h>
+
+#include <cap/core/alias_info.h>
+#include <cap/core/record.h>
+
+/**
+ * Key of cache of resource file
+ */
+typedef struct {
+    int64_t mtime;
+    int64_t size;
+    uint64_t hash;  // hash of content
+} CapAliasCacheKey;
+
+/**
+ * Make key of resource file
+ *
+ * @param[out] *key pointer to destination
+ * @param[in]  *st  pointer to result of stat of resource file
+ * @param[in]  *src content of resource file
+ *
+ * @return pointer to key
+ */
+CapAliasCacheKey *
+CapAliasCacheKey_Init(CapAliasCacheKey *key, const struct stat *st, const char *src);
+
+/**
+ * Check aliases of source can be cached
+ * The source that depends on other files or arguments or commands is not cacheable
+ * because the result is not determined by content
+ *
+ * @param[in] *src content of resource file
+ *
+ * @return cacheable to true else false
+ */
+bool
+CapAliasCache_IsCacheable(const char *src);
+
+/**
+ * Check aliases of resource file can be cached
+ * The creation of not exists file is detected by stamp of dependency
+ *
+ * @param[in] *path path of resource file
+ *
+ * @return cacheable or not exists to true else false
+ */
+bool
+CapAliasCache_IsCacheablePath(const char *path);
+
+/**
+ * Make path of cache file of resource file
+ *
+ * @param[out] *dst     pointer to destination
+ * @param[in]  dstsz    number of size of destination
+ * @param[in]  *dirpath path of cache directory
+ * @param[in]  *rcpath  path of resource file
+ *
+ * @return success to pointer to dst else NULL
+ */
+char *
+CapAliasCache_MakePath(char *dst, uint32_t dstsz, const char *dirpath, const char *rcpath);
+
+/**
+ * Read aliases from cache file
+ *
+ * @param[in] *cachepath path of cache file
+ * @param[in] *rcpath    path of resource file
+ * @param[in] *key       key of resource file
+ *
+ * @return hit to pointer to CapAliasInfo (dynamic allocate memory)
+ * @return miss or broken to NULL
+ */
+CapAliasInfo *
+CapAliasCache_Read(const char *cachepath, const char *rcpath, const CapAliasCacheKey *key);
+
+/**
+ * Write aliases at cache file
+ * The file is replaced by rename(2) after write to temporary file
+ *
+ * @param[in] *cachepath path of cache file
+ * @param[in] *rcpath    path of resource file
+ * @param[in] *key       key of resource file
+ * @param[in] *alinfo    aliases of resource file
+ *
+ * @return success to true else false
+ */
+bool
+CapAliasCache_Write(
+    const char *cachepath,
+    const char *rcpath,
+    const CapAliasCacheKey *key,
+    const CapAliasInfo *alinfo
+);
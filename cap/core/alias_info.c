@@ -1,40 +1,92 @@
 #include <cap/core/alias_info.h>
 
+/**
+ * Numbers
+ */
+enum {
+    INIT_NSLOTS = 64,  // must be power of 2
+    INIT_ARENA_SIZE = 1024,
+};
+
+#define NO_STR UINT32_MAX
+#define EMPTY_SLOT -1
+
+/**
+ * Entry of alias. strings are offsets in arena
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t key;
+    uint32_t value;  // NO_STR if not set
+    uint32_t desc;  // NO_STR if not set
+} Entry;
+
 struct CapAliasInfo {
-    PadDict *key_val_map;
-    PadDict *key_desc_map;
+    Entry *entries;  // all keys
+    int32_t nentries;
+    int32_t entries_capa;
+    int32_t *order;  // indexes of entries that have value in insertion order
+    int32_t norder;
+    int32_t order_capa;
+    int32_t *slots;  // indexes of entries or EMPTY_SLOT
+    uint32_t nslots;
+    char *arena;
+    uint32_t arena_len;
+    uint32_t arena_capa;
 };
 
+static const char *
+getc_str(const CapAliasInfo *self, uint32_t offset) {
+    if (offset == NO_STR) {
+        return NULL;
+    }
+    return self->arena + offset;
+}
+
 void
 CapAliasInfo_Del(CapAliasInfo *self) {
     if (!self) {
         return;
     }
 
-    PadDict_Del(self->key_val_map);
-    PadDict_Del(self->key_desc_map);
+    free(self->entries);
+    free(self->order);
+    free(self->slots);
+    free(self->arena);
     free(self);
 }
 
-CapAliasInfo *
-CapAliasInfo_New(void) {
+static CapAliasInfo *
+alloc_info(int32_t entries_capa, uint32_t nslots, uint32_t arena_capa) {
     CapAliasInfo *self = PadMem_Calloc(1, sizeof(*self));
     if (!self) {
         return NULL;
     }
 
-    self->key_val_map = PadDict_New(32);
-    if (!self->key_val_map) {
+    self->entries_capa = entries_capa;
+    self->order_capa = entries_capa;
+    self->nslots = nslots;
+    self->arena_capa = arena_capa;
+    self->entries = PadMem_Calloc(self->entries_capa, sizeof(*self->entries));
+    self->order = PadMem_Calloc(self->order_capa, sizeof(*self->order));
+    self->slots = PadMem_Calloc(self->nslots, sizeof(*self->slots));
+    self->arena = PadMem_Calloc(self->arena_capa, sizeof(*self->arena));
+    if (!self->entries || !self->order || !self->slots || !self->arena) {
         CapAliasInfo_Del(self);
         return NULL;
     }
 
-    self->key_desc_map = PadDict_New(32);
-    if (!self->key_desc_map) {
-        CapAliasInfo_Del(self);
+    return self;
+}
+
+CapAliasInfo *
+CapAliasInfo_New(void) {
+    CapAliasInfo *self = alloc_info(INIT_NSLOTS / 2, INIT_NSLOTS, INIT_ARENA_SIZE);
+    if (!self) {
         return NULL;
     }
 
+    CapAliasInfo_Clear(self);
     return self;
 }
 
@@ -44,86 +96,265 @@ CapAliasInfo_DeepCopy(const CapAliasInfo *other) {
         return NULL;
     }
 
-    CapAliasInfo *self = PadMem_Calloc(1, sizeof(*self));
+    CapAliasInfo *self = alloc_info(other->entries_capa, other->nslots, other->arena_capa);
     if (!self) {
         return NULL;
     }
 
-    self->key_val_map = PadDict_DeepCopy(other->key_val_map);
-    if (!self->key_val_map) {
-        CapAliasInfo_Del(self);
-        return NULL;
-    }
-
-    self->key_desc_map = PadDict_DeepCopy(other->key_desc_map);
-    if (!self->key_desc_map) {
-        CapAliasInfo_Del(self);
-        return NULL;
-    }
+    // all members are offsets. copy memory blocks
+    memcpy(self->entries, other->entries, sizeof(*self->entries) * other->nentries);
+    memcpy(self->order, other->order, sizeof(*self->order) * other->norder);
+    memcpy(self->slots, other->slots, sizeof(*self->slots) * other->nslots);
+    memcpy(self->arena, other->arena, other->arena_len);
+    self->nentries = other->nentries;
+    self->norder = other->norder;
+    self->arena_len = other->arena_len;
 
     return self;
 }
 
 CapAliasInfo *
 CapAliasInfo_ShallowCopy(const CapAliasInfo *other) {
-    if (!other) {
-        return NULL;
+    // strings are not owned by entries
+    return CapAliasInfo_DeepCopy(other);
+}
+
+/**
+ * find index of slot of key
+ *
+ * @return index of slot of key or index of empty slot
+ */
+static uint32_t
+find_slot(const CapAliasInfo *self, const char *key, uint32_t hash) {
+    uint32_t mask = self->nslots - 1;
+    for (uint32_t i = hash & mask; ; i = (i + 1) & mask) {
+        int32_t ei = self->slots[i];
+        if (ei == EMPTY_SLOT) {
+            return i;
+        }
+        const Entry *e = &self->entries[ei];
+        if (e->hash == hash && !strcmp(self->arena + e->key, key)) {
+            return i;
+        }
     }
+}
 
-    CapAliasInfo *self = PadMem_Calloc(1, sizeof(*self));
-    if (!self) {
+static const Entry *
+find_entry(const CapAliasInfo *self, const char *key) {
+    if (!self || !key) {
         return NULL;
     }
 
-    self->key_val_map = PadDict_ShallowCopy(other->key_val_map);
-    if (!self->key_val_map) {
-        CapAliasInfo_Del(self);
+    uint32_t si = find_slot(self, key, CapRecord_HashStr32(key));
+    int32_t ei = self->slots[si];
+    if (ei == EMPTY_SLOT) {
         return NULL;
     }
 
-    self->key_desc_map = PadDict_ShallowCopy(other->key_desc_map);
-    if (!self->key_desc_map) {
-        CapAliasInfo_Del(self);
-        return NULL;
+    return &self->entries[ei];
+}
+
+static bool
+grow_slots(CapAliasInfo *self) {
+    uint32_t nslots = self->nslots * 2;
+    int32_t *slots = PadMem_Calloc(nslots, sizeof(*slots));
+    if (!slots) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < nslots; ++i) {
+        slots[i] = EMPTY_SLOT;
+    }
+    for (int32_t ei = 0; ei < self->nentries; ++ei) {
+        uint32_t mask = nslots - 1;
+        uint32_t i = self->entries[ei].hash & mask;
+        for (; slots[i] != EMPTY_SLOT; i = (i + 1) & mask) {
+        }
+        slots[i] = ei;
+    }
+
+    free(self->slots);
+    self->slots = slots;
+    self->nslots = nslots;
+    return true;
+}
+
+static bool
+grow_array(void **array, int32_t *capa, size_t elemsize) {
+    int32_t newcapa = *capa * 2;
+    void *p = PadMem_Realloc(*array, elemsize * newcapa);
+    if (!p) {
+        return false;
+    }
+
+    *array = p;
+    *capa = newcapa;
+    return true;
+}
+
+/**
+ * append string to arena
+ * str can be pointer in arena
+ *
+ * @return success to offset of string else NO_STR
+ */
+static uint32_t
+append_str(CapAliasInfo *self, const char *str) {
+    size_t len = strlen(str) + 1;
+    if ((size_t) self->arena_len + len >= NO_STR) {
+        return NO_STR;
+    }
+
+    if (self->arena_len + len > self->arena_capa) {
+        bool in_arena = str >= self->arena && str < self->arena + self->arena_len;
+        size_t str_offset = str - self->arena;
+        uint32_t capa = self->arena_capa;
+        for (; self->arena_len + len > capa; capa *= 2) {
+        }
+        char *arena = PadMem_Realloc(self->arena, capa);
+        if (!arena) {
+            return NO_STR;
+        }
+        self->arena = arena;
+        self->arena_capa = capa;
+        if (in_arena) {
+            str = self->arena + str_offset;
+        }
+    }
+
+    uint32_t offset = self->arena_len;
+    memmove(self->arena + offset, str, len);
+    self->arena_len += len;
+    return offset;
+}
+
+/**
+ * set string to member of entry
+ * if new string fits in old string then old string is overwritten
+ */
+static bool
+set_str(CapAliasInfo *self, int32_t ei, size_t member, const char *str) {
+    uint32_t *dst = (uint32_t *) ((char *) &self->entries[ei] + member);
+    if (*dst != NO_STR) {
+        char *old = self->arena + *dst;
+        size_t len = strlen(str);
+        if (len <= strlen(old)) {
+            memmove(old, str, len + 1);
+            return true;
+        }
+    }
+
+    uint32_t offset = append_str(self, str);
+    if (offset == NO_STR) {
+        return false;
     }
 
-    return self;  
+    // entries are not moved by append_str
+    dst = (uint32_t *) ((char *) &self->entries[ei] + member);
+    *dst = offset;
+    return true;
+}
+
+/**
+ * find or create entry of key
+ *
+ * @return success to index of entry else -1
+ */
+static int32_t
+upsert_entry(CapAliasInfo *self, const char *key) {
+    uint32_t hash = CapRecord_HashStr32(key);
+    uint32_t si = find_slot(self, key, hash);
+    if (self->slots[si] != EMPTY_SLOT) {
+        return self->slots[si];
+    }
+
+    // keep load factor under 0.5
+    if ((uint32_t) (self->nentries + 1) * 2 > self->nslots) {
+        if (!grow_slots(self)) {
+            return -1;
+        }
+        si = find_slot(self, key, hash);
+    }
+    if (self->nentries >= self->entries_capa &&
+        !grow_array((void **) &self->entries, &self->entries_capa, sizeof(*self->entries))) {
+        return -1;
+    }
+
+    uint32_t koffset = append_str(self, key);
+    if (koffset == NO_STR) {
+        return -1;
+    }
+
+    int32_t ei = self->nentries++;
+    self->entries[ei] = (Entry) {
+        .hash = hash,
+        .key = koffset,
+        .value = NO_STR,
+        .desc = NO_STR,
+    };
+    self->slots[si] = ei;
+    return ei;
 }
 
 const char *
 CapAliasInfo_GetcValue(const CapAliasInfo *self, const char *key) {
-   const PadDictItem *item = PadDict_Getc(self->key_val_map, key);
-   if (!item) {
-       return NULL;
-   }
+    const Entry *e = find_entry(self, key);
+    if (!e) {
+        return NULL;
+    }
 
-   return item->value;
+    return getc_str(self, e->value);
 }
 
 const char *
 CapAliasInfo_GetcDesc(const CapAliasInfo *self, const char *key) {
-   const PadDictItem *item = PadDict_Getc(self->key_desc_map, key);
-   if (!item) {
-       return NULL;
-   }
+    const Entry *e = find_entry(self, key);
+    if (!e) {
+        return NULL;
+    }
 
-   return item->value;
+    return getc_str(self, e->desc);
 }
 
 CapAliasInfo *
 CapAliasInfo_SetValue(CapAliasInfo *self, const char *key, const char *value) {
-    PadDict *result = PadDict_Set(self->key_val_map, key, value);
-    if (!result) {
+    if (!self || !key || !value) {
+        return NULL;
+    }
+
+    int32_t ei = upsert_entry(self, key);
+    if (ei < 0) {
+        return NULL;
+    }
+
+    bool is_new = self->entries[ei].value == NO_STR;
+    if (is_new && self->norder >= self->order_capa &&
+        !grow_array((void **) &self->order, &self->order_capa, sizeof(*self->order))) {
+        return NULL;
+    }
+
+    if (!set_str(self, ei, offsetof(Entry, value), value)) {
         return NULL;
     }
+    if (is_new) {
+        self->order[self->norder++] = ei;
+    }
 
     return self;
 }
 
 CapAliasInfo *
 CapAliasInfo_SetDesc(CapAliasInfo *self, const char *key, const char *desc) {
-    PadDict *result = PadDict_Set(self->key_desc_map, key, desc);
-    if (!result) {
+    if (!self || !key || !desc) {
+        return NULL;
+    }
+
+    int32_t ei = upsert_entry(self, key);
+    if (ei < 0) {
+        return NULL;
+    }
+
+    if (!set_str(self, ei, offsetof(Entry, desc), desc)) {
         return NULL;
     }
 
@@ -132,16 +363,70 @@ CapAliasInfo_SetDesc(CapAliasInfo *self, const char *key, const char *desc) {
 
 void
 CapAliasInfo_Clear(CapAliasInfo *self) {
-    PadDict_Clear(self->key_val_map);
-    PadDict_Clear(self->key_desc_map);
+    if (!self) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < self->nslots; ++i) {
+        self->slots[i] = EMPTY_SLOT;
+    }
+    self->nentries = 0;
+    self->norder = 0;
+    self->arena_len = 0;
+}
+
+CapAliasInfo *
+CapAliasInfo_Merge(CapAliasInfo *self, const CapAliasInfo *other) {
+    if (!self || !other) {
+        return NULL;
+    }
+
+    // values at first for keep insertion order of values
+    for (int32_t i = 0; i < other->norder; ++i) {
+        const Entry *e = &other->entries[other->order[i]];
+        if (!CapAliasInfo_SetValue(self, other->arena + e->key, other->arena + e->value)) {
+            return NULL;
+        }
+    }
+
+    for (int32_t i = 0; i < other->nentries; ++i) {
+        const Entry *e = &other->entries[i];
+        if (e->desc != NO_STR &&
+            !CapAliasInfo_SetDesc(self, other->arena + e->key, other->arena + e->desc)) {
+            return NULL;
+        }
+    }
+
+    return self;
+}
+
+int32_t
+CapAliasInfo_Len(const CapAliasInfo *self) {
+    return self ? self->norder : 0;
+}
+
+static const Entry *
+entry_at(const CapAliasInfo *self, int32_t index) {
+    if (!self || index < 0 || index >= self->norder) {
+        return NULL;
+    }
+    return &self->entries[self->order[index]];
 }
 
-const PadDict *
-CapAliasInfo_GetcKeyValueMap(const CapAliasInfo *self) {
-    return self->key_val_map;
+const char *
+CapAliasInfo_GetcKeyAt(const CapAliasInfo *self, int32_t index) {
+    const Entry *e = entry_at(self, index);
+    return e ? getc_str(self, e->key) : NULL;
 }
 
-const PadDict *
-CapAliasInfo_GetcKeyDescMap(const CapAliasInfo *self) {
-    return self->key_desc_map;
+const char *
+CapAliasInfo_GetcValueAt(const CapAliasInfo *self, int32_t index) {
+    const Entry *e = entry_at(self, index);
+    return e ? getc_str(self, e->value) : NULL;
+}
+
+const char *
+CapAliasInfo_GetcDescAt(const CapAliasInfo *self, int32_t index) {
+    const Entry *e = entry_at(self, index);
+    return e ? getc_str(self, e->desc) : NULL;
 }
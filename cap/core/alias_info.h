@@ -1,10 +1,21 @@
 /* alias_info modules is for alias manage in context module 
-   alias_info module has key and value, and key and description value */
+   alias_info module has key and value, and key and description value
+
+   aliases are stored in open addressing hash table and strings are
+   stored in one arena. iteration by index is in insertion order */
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <pad/lib/dict.h>
 #include <pad/lib/memory.h>
 
+#include <cap/core/record.h>
+
 struct CapAliasInfo;
 typedef struct CapAliasInfo CapAliasInfo;
 
@@ -89,21 +100,59 @@ void
 CapAliasInfo_Clear(CapAliasInfo *self);
 
 /**
- * get key and value map (dict) from alinfo
+ * set all values and descriptions of other
  *
- * @param[in] *self pointer to CapAliasInfo dynamic allocate memory
+ * @param[in] *self  pointer to CapAliasInfo
+ * @param[in] *other pointer to CapAliasInfo
  *
- * @return pointer to PadDict dynamic allocate memory
+ * @return success to pointer to self
+ * @return failed to NULL
  */
-const PadDict *
-CapAliasInfo_GetcKeyValueMap(const CapAliasInfo *self);
+CapAliasInfo *
+CapAliasInfo_Merge(CapAliasInfo *self, const CapAliasInfo *other);
 
 /**
- * get key and description value map (dict) from alinfo
+ * get number of aliases
  *
  * @param[in] *self pointer to CapAliasInfo dynamic allocate memory
  *
- * @return pointer to PadDict dynamic allocate memory
+ * @return number of aliases
+ */
+int32_t
+CapAliasInfo_Len(const CapAliasInfo *self);
+
+/**
+ * get key of alias by index (insertion order)
+ *
+ * @param[in] *self  pointer to CapAliasInfo dynamic allocate memory
+ * @param[in] index  index of alias
+ *
+ * @return found to pointer to string of key
+ * @return out of range to pointer to NULL
+ */
+const char *
+CapAliasInfo_GetcKeyAt(const CapAliasInfo *self, int32_t index);
+
+/**
+ * get value of alias by index (insertion order)
+ *
+ * @param[in] *self  pointer to CapAliasInfo dynamic allocate memory
+ * @param[in] index  index of alias
+ *
+ * @return found to pointer to string of value
+ * @return out of range to pointer to NULL
+ */
+const char *
+CapAliasInfo_GetcValueAt(const CapAliasInfo *self, int32_t index);
+
+/**
+ * get description value of alias by index (insertion order)
+ *
+ * @param[in] *self  pointer to CapAliasInfo dynamic allocate memory
+ * @param[in] index  index of alias
+ *
+ * @return found to pointer to string of description value
+ * @return out of range or not has description to pointer to NULL
  */
-const PadDict *
-CapAliasInfo_GetcKeyDescMap(const CapAliasInfo *self);
+const char *
+CapAliasInfo_GetcDescAt(const CapAliasInfo *self, int32_t index);
@@ -12,17 +12,35 @@ enum {
  */
 struct CapAliasMgr {
     const CapConfig *config;
-    CapKit *kit;
+    CapKit *kit;  // created at first interpretation of resource file
+    CapKitPool *kit_pool;  // kit is borrowed from this if not NULL
+    bool is_kit_ok;  // false if compile of borrowed kit was failed
+    CapAliasInfo *alinfo;  // aliases of loaded resource files
     char error_detail[ERR_DETAIL_SIZE];
 };
 
+/**
+ * Put back borrowed kit to pool
+ */
+static void
+put_kit(CapAliasMgr *self) {
+    if (!self->kit_pool || !self->kit) {
+        return;
+    }
+
+    CapKitPool_Put(self->kit_pool, self->kit, self->is_kit_ok);
+    self->kit = NULL;
+}
+
 void
 CapAliasMgr_Del(CapAliasMgr *self) {
     if (!self) {
         return;
     }
 
+    put_kit(self);
     CapKit_Del(self->kit);
+    CapAliasInfo_Del(self->alinfo);
     Pad_SafeFree(self);
 }
 
@@ -34,8 +52,8 @@ CapAliasMgr_New(const CapConfig *config) {
     }
 
     self->config = config;
-    self->kit = CapKit_New(config);
-    if (self->kit == NULL) {
+    self->alinfo = CapAliasInfo_New();
+    if (self->alinfo == NULL) {
         goto error;
     }
 
@@ -45,6 +63,17 @@ error:
     return NULL;
 }
 
+CapAliasMgr *
+CapAliasMgr_NewWithKitPool(const CapConfig *config, CapKitPool *kit_pool) {
+    CapAliasMgr *self = CapAliasMgr_New(config);
+    if (!self) {
+        return NULL;
+    }
+
+    self->kit_pool = kit_pool;
+    return self;
+}
+
 static void
 set_err(CapAliasMgr *self, const char *fmt, ...) {
     va_list ap;
@@ -77,14 +106,33 @@ create_resource_path(CapAliasMgr *self, char *dst, size_t dstsz, int scope) {
     return dst;
 }
 
-CapAliasMgr *
-CapAliasMgr_LoadPath(CapAliasMgr *self, const char *path) {
-    char *src = PadFile_ReadCopyFromPath(path);
-    if (!src) {
-        set_err(self, "failed to read content from file \"%s\"", path);
-        return NULL;
+/**
+ * Interpret resource file and merge aliases
+ *
+ * @param[in]  *self    pointer to CapAliasMgr
+ * @param[in]  *path    path of resource file
+ * @param[in]  *src     content of resource file
+ * @param[out] **alinfo aliases of source (reference of context) or NULL if source has not aliases
+ *
+ * @return success to true, failed to false
+ */
+static bool
+interpret(CapAliasMgr *self, const char *path, const char *src, const CapAliasInfo **alinfo) {
+    if (!self->kit) {
+        self->kit = self->kit_pool ?
+            CapKitPool_Get(self->kit_pool) :
+            CapKit_New(self->config);
+        if (!self->kit) {
+            set_err(self, "failed to create kit");
+            return false;
+        }
+        self->is_kit_ok = true;
     }
 
+    // aliases of previous source are remained in context
+    const PadCtx *ref_ctx = CapKit_GetRefCtx(self->kit);
+    CapBltAliasMod_ClearAliasInfo(ref_ctx);
+
     if (!CapKit_CompileFromStrArgs(
         self->kit,
         path,
@@ -92,10 +140,92 @@ CapAliasMgr_LoadPath(CapAliasMgr *self, const char *path) {
         0,
         NULL
     )) {
+        self->is_kit_ok = false;
         set_err(self, "failed to compile");
+        return false;
+    }
+
+    *alinfo = CapBltAliasMod_GetAliasInfo(ref_ctx);
+    if (*alinfo && !CapAliasInfo_Merge(self->alinfo, *alinfo)) {
+        set_err(self, "failed to merge aliases");
+        return false;
+    }
+
+    return true;
+}
+
+CapAliasMgr *
+CapAliasMgr_LoadPath(CapAliasMgr *self, const char *path) {
+    char *src = PadFile_ReadCopyFromPath(path);
+    if (!src) {
+        set_err(self, "failed to read content from file \"%s\"", path);
+        return NULL;
+    }
+
+    char cachepath[PAD_FILE__NPATH];
+    CapAliasCacheKey key;
+    struct stat st;
+    bool is_cacheable = CapAliasCache_IsCacheable(src) &&
+        stat(path, &st) == 0 &&
+        CapAliasCache_MakePath(cachepath, sizeof cachepath, self->config->alias_cache_dir_path, path);
+
+    if (is_cacheable) {
+        CapAliasCacheKey_Init(&key, &st, src);
+        CapAliasInfo *cached = CapAliasCache_Read(cachepath, path, &key);
+        if (cached) {
+            // hit. the interpreter is not needed
+            CapAliasInfo *result = CapAliasInfo_Merge(self->alinfo, cached);
+            CapAliasInfo_Del(cached);
+            if (!result) {
+                set_err(self, "failed to merge aliases");
+                goto error;
+            }
+            Pad_SafeFree(src);
+            return self;
+        }
+    }
+
+    // most resource files are declarative. read them without the interpreter
+    CapAliasInfo *scanned = CapAliasInfo_New();
+    if (!scanned) {
+        set_err(self, "failed to create alias info");
         goto error;
     }
 
+    const CapAliasInfo *alinfo = NULL;
+    CapRcScanResult result;
+    if (CapRcScanner_Scan(&result, scanned, src)) {
+        if (!CapAliasInfo_Merge(self->alinfo, scanned)) {
+            CapAliasInfo_Del(scanned);
+            set_err(self, "failed to merge aliases");
+            goto error;
+        }
+        alinfo = scanned;
+    } else if (!interpret(self, path, src, &alinfo)) {
+        CapAliasInfo_Del(scanned);
+        goto error;
+    }
+
+    if (is_cacheable) {
+        const char *dirpath = self->config->alias_cache_dir_path;
+        if (!PadFile_IsExists(dirpath)) {
+            PadFile_MkdirQ(dirpath);
+        }
+
+        CapAliasInfo *empty = NULL;
+        if (!alinfo) {
+            // source has not aliases
+            alinfo = empty = CapAliasInfo_New();
+        }
+        if (alinfo) {
+            // failure of write is not error
+            CapAliasCache_Write(cachepath, path, &key, alinfo);
+        }
+        CapAliasInfo_Del(empty);
+    }
+
+    CapAliasInfo_Del(scanned);
+
     Pad_SafeFree(src);
     return self;
 error:
@@ -103,6 +233,11 @@ error:
     return NULL;
 }
 
+char *
+CapAliasMgr_SolveResourcePath(CapAliasMgr *self, char *dst, uint32_t dstsz, int scope) {
+    return create_resource_path(self, dst, dstsz, scope);
+}
+
 CapAliasMgr *
 CapAliasMgr_LoadAliasList(CapAliasMgr *self, int scope) {
     char path[PAD_FILE__NPATH];
@@ -124,14 +259,8 @@ CapAliasMgr_FindAliasValue(CapAliasMgr *self, char *dst, uint32_t dstsz, const c
         return NULL;
     }
 
-    const PadCtx *ref_ctx = CapKit_GetRefCtx(self->kit);
-    const CapAliasInfo *alinfo = CapBltAliasMod_GetAliasInfo(ref_ctx);
-    if (alinfo == NULL) {
-        return NULL;
-    } 
-
     // find alias value by key
-    const char *value = CapAliasInfo_GetcValue(alinfo, key);
+    const char *value = CapAliasInfo_GetcValue(self->alinfo, key);
     if (value == NULL) {
         return NULL;
     }
@@ -147,7 +276,12 @@ CapAliasMgr_HasErr(const CapAliasMgr *self) {
 
 void
 CapAliasMgr_Clear(CapAliasMgr *self) {
-    CapKit_Clear(self->kit);
+    if (self->kit_pool) {
+        put_kit(self);
+    } else {
+        CapKit_Clear(self->kit);
+    }
+    CapAliasInfo_Clear(self->alinfo);
     CapAliasMgr_ClearError(self);
 }
 
@@ -163,8 +297,7 @@ CapAliasMgr_GetErrDetail(const CapAliasMgr *self) {
 
 const CapAliasInfo *
 CapAliasMgr_GetcAliasInfo(const CapAliasMgr *self) {
-    const PadCtx *ref_ctx = CapKit_GetRefCtx(self->kit);
-    return CapBltAliasMod_GetAliasInfo(ref_ctx);
+    return self->alinfo;
 }
 
 const PadCtx *
@@ -18,6 +18,9 @@
 #include <cap/core/util.h>
 #include <cap/core/symlink.h>
 #include <cap/core/alias_info.h>
+#include <cap/core/alias_cache.h>
+#include <cap/core/rc_scanner.h>
+#include <cap/lang/kit_pool.h>
 
 struct CapAliasMgr;
 typedef struct CapAliasMgr CapAliasMgr;
@@ -41,6 +44,19 @@ CapAliasMgr_Del(CapAliasMgr *self);
 CapAliasMgr *
 CapAliasMgr_New(const CapConfig *config);
 
+/**
+ * Construct module that borrows kit from pool for interpretation
+ * The kit is put back to pool by CapAliasMgr_Clear or CapAliasMgr_Del
+ *
+ * @param[in] config    read-only pointer to CapConfig
+ * @param[in] kit_pool  pointer to CapKitPool (reference). pool must live longer than module
+ *
+ * @return success to pointer to dynamic allocate memory of CapAliasMgr
+ * @return failed to pointer to NULL
+ */
+CapAliasMgr *
+CapAliasMgr_NewWithKitPool(const CapConfig *config, CapKitPool *kit_pool);
+
 /**
  * Find alias value by key and scope
  *
@@ -68,8 +84,30 @@ CapAliasMgr_FindAliasValue(CapAliasMgr *self, char *dst, uint32_t dstsz, const c
 CapAliasMgr *
 CapAliasMgr_LoadAliasList(CapAliasMgr *self, int scope);
 
+/**
+ * Solve path of resource file by scope
+ * Cap's symbolic links in path are followed
+ *
+ * @param[in]  self  pointer to CapAliasMgr
+ * @param[out] dst   pointer to destination
+ * @param[in]  dstsz number of size of destination
+ * @param[in]  scope number of scope of environment
+ *
+ * @return success to pointer to dst
+ * @return failed to NULL
+ */
+char *
+CapAliasMgr_SolveResourcePath(CapAliasMgr *self, char *dst, uint32_t dstsz, int scope);
+
 /**
  * Load alias list by path
+ * Aliases are merged to aliases of loaded resource files
+ *
+ * The aliases of resource file are saved at cache (config->alias_cache_dir_path)
+ * and the resource file is not interpreted while the file is not changed.
+ * Declarative resource file is read by scanner without the interpreter.
+ * @see cap/core/alias_cache.h
+ * @see cap/core/rc_scanner.h
  *
  * @param[in] self pointer to CapAliasMgr
  * @param[in] path path on file system
@@ -122,7 +160,7 @@ CapAliasMgr_GetErrDetail(const CapAliasMgr *self);
  *
  * @param[in] self pointer to dynamic allocate memory of CapAliasMgr
  *
- * @return pointer to PadCtx
+ * @return pointer to PadCtx or NULL if resource files were not interpreted
  */
 const PadCtx *
 CapAliasMgr_GetcCtx(const CapAliasMgr *self);
@@ -0,0 +1,83 @@
+#include <cap/core/alias_table.h>
+
+/**
+ * Structure of table
+ */
+struct CapAliasTable {
+    int scope;
+    CapAliasMgr *almgr;
+    bool is_moved;  // scope was moved by cd or home
+    char rcpath[PAD_FILE__NPATH];  // path of resource file of scope
+    CapSymlinkStamp stamp;  // stamp of resource file at load
+};
+
+void
+CapAliasTable_Del(CapAliasTable *self) {
+    if (!self) {
+        return;
+    }
+
+    CapAliasMgr_Del(self->almgr);
+    Pad_SafeFree(self);
+}
+
+CapAliasTable *
+CapAliasTable_New(const CapConfig *config, CapKitPool *kit_pool, int scope) {
+    CapAliasTable *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->scope = scope;
+    self->is_moved = true;
+    self->almgr = kit_pool ?
+        CapAliasMgr_NewWithKitPool(config, kit_pool) :
+        CapAliasMgr_New(config);
+    if (!self->almgr) {
+        CapAliasTable_Del(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void
+CapAliasTable_Move(CapAliasTable *self) {
+    self->is_moved = true;
+}
+
+const CapAliasInfo *
+CapAliasTable_Refresh(CapAliasTable *self) {
+    bool is_reload = false;
+    if (self->is_moved) {
+        self->is_moved = false;
+        char rcpath[PAD_FILE__NPATH];
+        if (!CapAliasMgr_SolveResourcePath(self->almgr, rcpath, sizeof rcpath, self->scope)) {
+            CapAliasMgr_ClearError(self->almgr);
+            rcpath[0] = '\0';
+        }
+        // scope can be moved to directory of same resource file
+        is_reload = !PadCStr_Eq(rcpath, self->rcpath);
+        strcpy(self->rcpath, rcpath);
+    }
+
+    CapSymlinkStamp stamp = {0};
+    if (self->rcpath[0]) {
+        CapSymlinkStamp_Load(&stamp, self->rcpath);
+    }
+    if (!is_reload && CapSymlinkStamp_Eq(&stamp, &self->stamp)) {
+        return CapAliasMgr_GetcAliasInfo(self->almgr);
+    }
+
+    // change in same second of racy file is not detected by mtime. reload it at next time
+    self->stamp = stamp;
+    if (stamp.exists && CapRecord_IsRacy(stamp.mtime)) {
+        self->stamp.mtime = -1;
+    }
+    CapAliasMgr_Clear(self->almgr);
+    if (stamp.exists && !CapAliasMgr_LoadPath(self->almgr, self->rcpath)) {
+        CapAliasMgr_Clear(self->almgr);
+    }
+
+    return CapAliasMgr_GetcAliasInfo(self->almgr);
+}
@@ -0,0 +1,71 @@
+/**
+ * Alias table of scope
+ *
+ * スコープ（ローカルまたはグローバル）のリソースファイルのエイリアスをプロセス内に保持する
+ * テーブルはリソースファイルのパスとスタンプが変わったときだけ読み直す
+ * cd や home でスコープが移動したときは CapAliasTable_Move を呼ぶ。移動先が同じリソースファイルなら読み直さない
+ * 直近に変更されたリソースファイルは同じ秒の次の変更を mtime で検出できないので、次の参照で読み直す
+ * cap sh のセッションとデーモンの子プロセスがテーブルを使う
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/constant.h>
+#include <cap/core/config.h>
+#include <cap/core/alias_info.h>
+#include <cap/core/alias_manager.h>
+#include <cap/core/symlink_cache.h>
+#include <cap/core/record.h>
+#include <cap/lang/kit_pool.h>
+
+struct CapAliasTable;
+typedef struct CapAliasTable CapAliasTable;
+
+/**
+ * Destruct table
+ *
+ * @param[in] *self pointer to CapAliasTable
+ */
+void
+CapAliasTable_Del(CapAliasTable *self);
+
+/**
+ * Construct table of scope
+ * Resource file is loaded at first refresh
+ *
+ * @param[in] *config   read-only pointer to CapConfig. values of cd and home are read at move
+ * @param[in] *kit_pool pointer to CapKitPool (reference) for interpretation or NULL
+ * @param[in] scope     number of scope (@see constant.h)
+ *
+ * @return success to pointer to CapAliasTable (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapAliasTable *
+CapAliasTable_New(const CapConfig *config, CapKitPool *kit_pool, int scope);
+
+/**
+ * Mark scope as moved. Path of resource file is solved again at next refresh
+ *
+ * @param[in] *self pointer to CapAliasTable
+ */
+void
+CapAliasTable_Move(CapAliasTable *self);
+
+/**
+ * Reload table if path or stamp of resource file was changed
+ * If load was failed then table is empty until resource file is changed
+ *
+ * @param[in] *self pointer to CapAliasTable
+ *
+ * @return pointer to aliases of table
+ */
+const CapAliasInfo *
+CapAliasTable_Refresh(CapAliasTable *self);
@@ -0,0 +1,374 @@
+#include <cap/core/bake_manifest.h>
+
+/**
+ * Numbers
+ */
+enum {
+    INIT_CAPA = 16,
+    READ_SIZE = 1024 * 16,
+};
+
+static const char MANIFEST_SIGNATURE[] = "cap bake manifest 1";
+
+struct CapBakeManifest {
+    CapBakeEntry *entries;
+    int32_t len;
+    int32_t capa;
+};
+
+uint64_t
+CapBake_HashStr(const char *s) {
+    return CapRecord_HashStr(s);
+}
+
+uint64_t
+CapBake_HashBytes(const void *p, size_t len) {
+    return CapRecord_Hash(CAP_RECORD__HASH_INIT, p, len);
+}
+
+uint64_t
+CapBake_HashArgs(int argc, char *argv[]) {
+    uint64_t h = CAP_RECORD__HASH_INIT;
+    for (int i = 0; i < argc && argv[i]; ++i) {
+        h = CapRecord_Hash(h, argv[i], strlen(argv[i]) + 1);
+    }
+    return h;
+}
+
+bool
+CapBake_HashFile(uint64_t *hash, const char *path) {
+    FILE *fin = fopen(path, "rb");
+    if (!fin) {
+        return false;
+    }
+
+    uint64_t h = CAP_RECORD__HASH_INIT;
+    unsigned char buf[READ_SIZE];
+    for (size_t n; (n = fread(buf, 1, sizeof buf, fin)) > 0; ) {
+        h = CapRecord_Hash(h, buf, n);
+    }
+
+    bool ok = !ferror(fin);
+    fclose(fin);
+    if (ok) {
+        *hash = h;
+    }
+    return ok;
+}
+
+void
+CapBakeEntry_Fini(CapBakeEntry *self) {
+    if (!self) {
+        return;
+    }
+
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        free(self->deps[i].path);
+    }
+    free(self->deps);
+    free(self->path);
+    *self = (CapBakeEntry) {0};
+}
+
+static bool
+push_dep(CapBakeEntry *self, const char *path, uint64_t hash) {
+    CapBakeDep *deps = PadMem_Realloc(self->deps, sizeof(*deps) * (self->ndeps + 1));
+    if (!deps) {
+        return false;
+    }
+    self->deps = deps;
+
+    char *copy = PadCStr_Dup(path);
+    if (!copy) {
+        return false;
+    }
+
+    self->deps[self->ndeps++] = (CapBakeDep) {
+        .path = copy,
+        .hash = hash,
+    };
+    return true;
+}
+
+CapBakeEntry *
+CapBakeEntry_SetDeps(CapBakeEntry *self, const PadCStrAry *deps) {
+    if (!self || !deps) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < PadCStrAry_Len(deps); ++i) {
+        const char *path = PadCStrAry_Getc(deps, i);
+        uint64_t hash;
+        if (!CapBake_HashFile(&hash, path)) {
+            return NULL;
+        }
+        if (!push_dep(self, path, hash)) {
+            return NULL;
+        }
+    }
+
+    return self;
+}
+
+bool
+CapBakeEntry_IsFresh(const CapBakeEntry *self, uint64_t content_hash, uint64_t args_hash) {
+    if (!self ||
+        self->out_hash != content_hash ||
+        self->args_hash != args_hash) {
+        return false;
+    }
+
+    return CapBakeEntry_IsDepsFresh(self);
+}
+
+bool
+CapBakeEntry_IsDepsFresh(const CapBakeEntry *self) {
+    if (!self) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        uint64_t hash;
+        if (!CapBake_HashFile(&hash, self->deps[i].path) ||
+            hash != self->deps[i].hash) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void
+clear(CapBakeManifest *self) {
+    for (int32_t i = 0; i < self->len; ++i) {
+        CapBakeEntry_Fini(&self->entries[i]);
+    }
+    self->len = 0;
+}
+
+void
+CapBakeManifest_Del(CapBakeManifest *self) {
+    if (!self) {
+        return;
+    }
+
+    clear(self);
+    free(self->entries);
+    free(self);
+}
+
+CapBakeManifest *
+CapBakeManifest_New(void) {
+    CapBakeManifest *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->entries = PadMem_Calloc(INIT_CAPA, sizeof(*self->entries));
+    if (!self->entries) {
+        free(self);
+        return NULL;
+    }
+    self->capa = INIT_CAPA;
+
+    return self;
+}
+
+static CapBakeEntry *
+push_entry(CapBakeManifest *self) {
+    if (self->len >= self->capa) {
+        int32_t capa = self->capa * 2;
+        CapBakeEntry *entries = PadMem_Realloc(self->entries, sizeof(*entries) * capa);
+        if (!entries) {
+            return NULL;
+        }
+        self->entries = entries;
+        self->capa = capa;
+    }
+
+    CapBakeEntry *entry = &self->entries[self->len++];
+    *entry = (CapBakeEntry) {0};
+    return entry;
+}
+
+static int
+cmp_entry(const void *a, const void *b) {
+    const CapBakeEntry *x = a;
+    const CapBakeEntry *y = b;
+    return strcmp(x->path, y->path);
+}
+
+static void
+sort_entries(CapBakeManifest *self) {
+    qsort(self->entries, self->len, sizeof(*self->entries), cmp_entry);
+}
+
+static bool
+load_line(CapBakeManifest *self, char *line) {
+    char *fields[5];
+    int n = CapRecord_SplitFields(line, fields, 5);
+
+    if (n == 5 && PadCStr_Eq(fields[0], "file")) {
+        CapBakeEntry *entry = push_entry(self);
+        if (!entry) {
+            return false;
+        }
+        entry->src_hash = strtoull(fields[1], NULL, 16);
+        entry->args_hash = strtoull(fields[2], NULL, 16);
+        entry->out_hash = strtoull(fields[3], NULL, 16);
+        entry->path = PadCStr_Dup(fields[4]);
+        return entry->path != NULL;
+    } else if (n == 3 && PadCStr_Eq(fields[0], "dep")) {
+        if (!self->len) {
+            return false;
+        }
+        CapBakeEntry *entry = &self->entries[self->len - 1];
+        return push_dep(entry, fields[2], strtoull(fields[1], NULL, 16));
+    }
+
+    return false;
+}
+
+CapBakeManifest *
+CapBakeManifest_Load(CapBakeManifest *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    clear(self);
+
+    FILE *fin = fopen(path, "r");
+    if (!fin) {
+        return NULL;
+    }
+
+    char line[PAD_FILE__NPATH + 256];
+    bool is_valid = false;
+
+    if (PadFile_GetLine(line, sizeof line, fin) == EOF ||
+        strcmp(line, MANIFEST_SIGNATURE)) {
+        goto done;
+    }
+
+    for (;;) {
+        if (PadFile_GetLine(line, sizeof line, fin) == EOF) {
+            break;
+        }
+        if (!load_line(self, line)) {
+            // broken
+            goto done;
+        }
+    }
+
+    is_valid = true;
+
+done:
+    fclose(fin);
+    if (!is_valid) {
+        clear(self);
+        return NULL;
+    }
+
+    sort_entries(self);
+    return self;
+}
+
+CapBakeManifest *
+CapBakeManifest_Save(CapBakeManifest *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    sort_entries(self);
+
+    // other processes may save same manifest at same time
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.%ld.tmp", path, (long) getpid());
+
+    FILE *fout = fopen(tmppath, "w");
+    if (!fout) {
+        return NULL;
+    }
+
+    fprintf(fout, "%s\n", MANIFEST_SIGNATURE);
+    for (int32_t i = 0; i < self->len; ++i) {
+        const CapBakeEntry *e = &self->entries[i];
+        if (!CapRecord_IsField(e->path)) {
+            continue;  // can't record. the file is baked every time
+        }
+
+        fprintf(fout, "file\t%016llx\t%016llx\t%016llx\t%s\n",
+            (unsigned long long) e->src_hash,
+            (unsigned long long) e->args_hash,
+            (unsigned long long) e->out_hash,
+            e->path
+        );
+        for (int32_t j = 0; j < e->ndeps; ++j) {
+            if (!CapRecord_IsField(e->deps[j].path)) {
+                continue;
+            }
+            fprintf(fout, "dep\t%016llx\t%s\n",
+                (unsigned long long) e->deps[j].hash,
+                e->deps[j].path
+            );
+        }
+    }
+
+    if (fclose(fout) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    if (PadFile_Rename(tmppath, path) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    return self;
+}
+
+const CapBakeEntry *
+CapBakeManifest_Find(const CapBakeManifest *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    CapBakeEntry key = {.path = (char *) path};
+    return bsearch(&key, self->entries, self->len, sizeof(*self->entries), cmp_entry);
+}
+
+CapBakeManifest *
+CapBakeManifest_Add(CapBakeManifest *self, const CapBakeEntry *entry) {
+    if (!self || !entry || !entry->path) {
+        return NULL;
+    }
+
+    CapBakeEntry *dst = push_entry(self);
+    if (!dst) {
+        return NULL;
+    }
+
+    dst->src_hash = entry->src_hash;
+    dst->args_hash = entry->args_hash;
+    dst->out_hash = entry->out_hash;
+    dst->path = PadCStr_Dup(entry->path);
+    if (!dst->path) {
+        self->len--;
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < entry->ndeps; ++i) {
+        if (!push_dep(dst, entry->deps[i].path, entry->deps[i].hash)) {
+            CapBakeEntry_Fini(dst);
+            self->len--;
+            return NULL;
+        }
+    }
+
+    return self;
+}
+
+int32_t
+CapBakeManifest_Len(const CapBakeManifest *self) {
+    return self ? self->len : 0;
+}
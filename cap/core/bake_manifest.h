@@ -0,0 +1,217 @@
+/**
+ * Manifest of baked files
+ *
+ * cap bake -r はディレクトリ以下のファイルを焼いた結果をディレクトリ直下の .capbake に記録する
+ * エントリはファイルごとに、焼く前の内容のハッシュ、引数のハッシュ、焼いた結果のハッシュと
+ * インポートしたモジュールのパスとハッシュを持つ
+ * ファイルの内容が焼いた結果と同じで、引数とモジュールが変わっていなければ、そのファイルは焼かない
+ * ハッシュは内容の FNV-1a（64 bit）
+ * cap make --incremental も出力の隣のスタンプファイルに同じ形式で記録する
+ * レンダリング結果のキャッシュ（render_cache.h）もエントリごとに同じ形式で記録する
+ *
+ * The format of file is text:
+ *
+ *      cap bake manifest 1
+ *      file <TAB> src hash <TAB> args hash <TAB> out hash <TAB> relative/path
+ *      dep <TAB> hash <TAB> /path/of/module
+ *
+ * dep lines belong to previous file line
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/cstring_array.h>
+
+#include <cap/core/record.h>
+
+/**
+ * Dependency of entry
+ */
+typedef struct {
+    char *path;  // path of imported module
+    uint64_t hash;  // hash of content of module
+} CapBakeDep;
+
+/**
+ * Entry of baked file
+ */
+typedef struct {
+    char *path;  // relative path from root directory
+    uint64_t src_hash;  // hash of content before bake
+    uint64_t args_hash;  // hash of arguments of template
+    uint64_t out_hash;  // hash of content after bake
+    CapBakeDep *deps;
+    int32_t ndeps;
+} CapBakeEntry;
+
+struct CapBakeManifest;
+typedef struct CapBakeManifest CapBakeManifest;
+
+/**
+ * Hash bytes of string by FNV-1a
+ *
+ * @param[in] *s string
+ *
+ * @return hash
+ */
+uint64_t
+CapBake_HashStr(const char *s);
+
+/**
+ * Hash bytes by FNV-1a
+ *
+ * @param[in] *p  bytes
+ * @param[in] len number of bytes
+ *
+ * @return hash
+ */
+uint64_t
+CapBake_HashBytes(const void *p, size_t len);
+
+/**
+ * Hash arguments of template
+ * Each argument is terminated by null character for hash
+ *
+ * @param[in] argc  number of arguments
+ * @param[in] *argv arguments
+ *
+ * @return hash
+ */
+uint64_t
+CapBake_HashArgs(int argc, char *argv[]);
+
+/**
+ * Hash content of file
+ *
+ * @param[out] *hash hash of content
+ * @param[in]  *path path of file
+ *
+ * @return success to true, failed to false
+ */
+bool
+CapBake_HashFile(uint64_t *hash, const char *path);
+
+/**
+ * Destruct entry (not free entry)
+ *
+ * @param[in] *self pointer to CapBakeEntry
+ */
+void
+CapBakeEntry_Fini(CapBakeEntry *self);
+
+/**
+ * Set dependencies of entry by imported modules
+ * Modules that can't be read are not recorded then entry is always stale
+ *
+ * @param[in] *self pointer to CapBakeEntry
+ * @param[in] *deps paths of modules
+ *
+ * @return success to pointer to self, failed to NULL
+ */
+CapBakeEntry *
+CapBakeEntry_SetDeps(CapBakeEntry *self, const PadCStrAry *deps);
+
+/**
+ * Check if baked file of entry needs not bake
+ *
+ * @param[in] *self         pointer to CapBakeEntry
+ * @param[in] content_hash  hash of current content of file
+ * @param[in] args_hash     hash of current arguments
+ *
+ * @return fresh to true, else false
+ */
+bool
+CapBakeEntry_IsFresh(const CapBakeEntry *self, uint64_t content_hash, uint64_t args_hash);
+
+/**
+ * Check if imported modules of entry are not changed
+ *
+ * @param[in] *self pointer to CapBakeEntry
+ *
+ * @return not changed to true, else false
+ */
+bool
+CapBakeEntry_IsDepsFresh(const CapBakeEntry *self);
+
+/**
+ * Destruct manifest
+ *
+ * @param[in] *self pointer to CapBakeManifest
+ */
+void
+CapBakeManifest_Del(CapBakeManifest *self);
+
+/**
+ * Construct empty manifest
+ *
+ * @return success to pointer to CapBakeManifest, failed to NULL
+ */
+CapBakeManifest *
+CapBakeManifest_New(void);
+
+/**
+ * Load manifest from file
+ * If file is not exists or invalid then manifest is empty
+ *
+ * @param[in] *self pointer to CapBakeManifest
+ * @param[in] *path path of manifest
+ *
+ * @return loaded to pointer to self, else NULL
+ */
+CapBakeManifest *
+CapBakeManifest_Load(CapBakeManifest *self, const char *path);
+
+/**
+ * Save manifest to file
+ * Manifest is written to temporary file and renamed
+ *
+ * @param[in] *self pointer to CapBakeManifest
+ * @param[in] *path path of manifest
+ *
+ * @return success to pointer to self, failed to NULL
+ */
+CapBakeManifest *
+CapBakeManifest_Save(CapBakeManifest *self, const char *path);
+
+/**
+ * Find entry by relative path in loaded manifest
+ * Entries added by CapBakeManifest_Add are found after save and load
+ * Threads can find at same time while manifest is not changed
+ *
+ * @param[in] *self pointer to CapBakeManifest
+ * @param[in] *path relative path
+ *
+ * @return found to pointer to CapBakeEntry (read-only), else NULL
+ */
+const CapBakeEntry *
+CapBakeManifest_Find(const CapBakeManifest *self, const char *path);
+
+/**
+ * Add deep copy of entry
+ *
+ * @param[in] *self  pointer to CapBakeManifest
+ * @param[in] *entry pointer to CapBakeEntry
+ *
+ * @return success to pointer to self, failed to NULL
+ */
+CapBakeManifest *
+CapBakeManifest_Add(CapBakeManifest *self, const CapBakeEntry *entry);
+
+/**
+ * Get number of entries
+ *
+ * @param[in] *self pointer to CapBakeManifest
+ *
+ * @return number of entries
+ */
+int32_t
+CapBakeManifest_Len(const CapBakeManifest *self);
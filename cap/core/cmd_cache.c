@@ -0,0 +1,388 @@
+#include <cap/core/cmd_cache.h>
+
+/**
+ * Numbers
+ */
+enum {
+    LINE_SIZE = PAD_FILE__NPATH * 4 + 256,
+};
+
+/**
+ * Structure of cache
+ */
+struct CapCmdCache {
+    CapCmdCacheEntry entries[CAP_CMD_CACHE__MAX_ENTRIES];  // older first
+    int32_t len;
+};
+
+static const char CACHE_SIGNATURE[] = "cap cmd cache 2";
+
+/********
+* entry *
+********/
+
+CapCmdCacheEntry *
+CapCmdCacheEntry_Init(CapCmdCacheEntry *entry, const CapConfig *config, const char *name) {
+    *entry = (CapCmdCacheEntry) {0};
+    entry->scope = config->scope;
+    entry->name = PadCStr_Dup(name);
+    entry->cd_path = PadCStr_Dup(config->cd_path);
+    entry->home_path = PadCStr_Dup(config->home_path);
+    entry->value = PadCStr_Dup("");
+    if (!entry->name || !entry->cd_path || !entry->home_path || !entry->value) {
+        CapCmdCacheEntry_Fini(entry);
+        return NULL;
+    }
+
+    entry->is_uncacheable = !CapRecord_IsField(name);
+    return entry;
+}
+
+void
+CapCmdCacheEntry_Fini(CapCmdCacheEntry *entry) {
+    if (!entry) {
+        return;
+    }
+
+    Pad_SafeFree(entry->name);
+    Pad_SafeFree(entry->cd_path);
+    Pad_SafeFree(entry->home_path);
+    Pad_SafeFree(entry->value);
+    for (int32_t i = 0; i < entry->ndeps; ++i) {
+        Pad_SafeFree(entry->deps[i].path);
+    }
+    *entry = (CapCmdCacheEntry) {0};
+}
+
+static CapCmdCacheEntry *
+add_dep(CapCmdCacheEntry *entry, const char *path, const CapSymlinkStamp *stamp) {
+    if (entry->ndeps >= CAP_CMD_CACHE__MAX_DEPS || !CapRecord_IsField(path)) {
+        entry->is_uncacheable = true;
+        return NULL;
+    }
+
+    char *p = PadCStr_Dup(path);
+    if (!p) {
+        entry->is_uncacheable = true;
+        return NULL;
+    }
+
+    entry->deps[entry->ndeps++] = (CapCmdCacheDep) {
+        .path = p,
+        .stamp = *stamp,
+    };
+    return entry;
+}
+
+CapCmdCacheEntry *
+CapCmdCacheEntry_AddStampedDep(CapCmdCacheEntry *entry, const char *path, const CapSymlinkStamp *stamp) {
+    if (!entry || !path || !stamp) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < entry->ndeps; ++i) {
+        if (PadCStr_Eq(entry->deps[i].path, path)) {
+            return entry;
+        }
+    }
+
+    if (stamp->exists && CapRecord_IsRacy(stamp->mtime)) {
+        entry->is_uncacheable = true;
+        return NULL;
+    }
+
+    return add_dep(entry, path, stamp);
+}
+
+CapCmdCacheEntry *
+CapCmdCacheEntry_AddDep(CapCmdCacheEntry *entry, const char *path) {
+    if (!entry || !path) {
+        return NULL;
+    }
+
+    CapSymlinkStamp stamp;
+    CapSymlinkStamp_Load(&stamp, path);
+    return CapCmdCacheEntry_AddStampedDep(entry, path, &stamp);
+}
+
+CapCmdCacheEntry *
+CapCmdCacheEntry_SetResult(CapCmdCacheEntry *entry, CapCmdCacheKind kind, const char *value) {
+    if (!entry) {
+        return NULL;
+    }
+
+    char *v = PadCStr_Dup(value ? value : "");
+    if (!v) {
+        entry->is_uncacheable = true;
+        return NULL;
+    }
+
+    Pad_SafeFree(entry->value);
+    entry->value = v;
+    entry->kind = kind;
+    if (!CapRecord_IsField(v)) {
+        entry->is_uncacheable = true;
+    }
+
+    return entry;
+}
+
+static bool
+is_same_key(const CapCmdCacheEntry *entry, int scope, const char *cd, const char *home, const char *name) {
+    return entry->scope == scope &&
+           PadCStr_Eq(entry->name, name) &&
+           PadCStr_Eq(entry->cd_path, cd) &&
+           PadCStr_Eq(entry->home_path, home);
+}
+
+static bool
+is_fresh_entry(const CapCmdCacheEntry *entry) {
+    for (int32_t i = 0; i < entry->ndeps; ++i) {
+        const CapCmdCacheDep *dep = &entry->deps[i];
+        CapSymlinkStamp stamp;
+        CapSymlinkStamp_Load(&stamp, dep->path);
+        if (!CapSymlinkStamp_Eq(&stamp, &dep->stamp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/********
+* cache *
+********/
+
+static void
+clear_entries(CapCmdCache *self) {
+    for (int32_t i = 0; i < self->len; ++i) {
+        CapCmdCacheEntry_Fini(&self->entries[i]);
+    }
+    self->len = 0;
+}
+
+void
+CapCmdCache_Del(CapCmdCache *self) {
+    if (!self) {
+        return;
+    }
+
+    clear_entries(self);
+    Pad_SafeFree(self);
+}
+
+CapCmdCache *
+CapCmdCache_New(void) {
+    CapCmdCache *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    return self;
+}
+
+static bool
+load_entry(CapCmdCache *self, FILE *fin, char *line) {
+    char *fields[8];
+    if (CapRecord_SplitFields(line, fields, 8) != 8 ||
+        !PadCStr_Eq(fields[0], "entry") ||
+        self->len >= CAP_CMD_CACHE__MAX_ENTRIES) {
+        return false;
+    }
+
+    CapCmdCacheEntry *entry = &self->entries[self->len];
+    *entry = (CapCmdCacheEntry) {
+        .kind = atoi(fields[1]),
+        .scope = atoi(fields[2]),
+        .name = PadCStr_Dup(fields[3]),
+        .cd_path = PadCStr_Dup(fields[4]),
+        .home_path = PadCStr_Dup(fields[5]),
+        .value = PadCStr_Dup(fields[6]),
+    };
+    ++self->len;  // finalized by clear_entries if failed
+
+    int32_t ndeps = atoi(fields[7]);
+    if (!entry->name || !entry->cd_path || !entry->home_path || !entry->value ||
+        entry->kind <= CAP_CMD_CACHE__NONE || entry->kind > CAP_CMD_CACHE__RUN ||
+        ndeps < 0 || ndeps > CAP_CMD_CACHE__MAX_DEPS) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < ndeps; ++i) {
+        if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF) {
+            return false;
+        }
+
+        char *dfields[9];
+        if (CapRecord_SplitFields(line, dfields, 9) != 9 || !PadCStr_Eq(dfields[0], "dep")) {
+            return false;
+        }
+
+        CapSymlinkStamp stamp;
+        CapSymlinkStamp_Read(&stamp, dfields + 1);
+        if (!add_dep(entry, dfields[8], &stamp)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CapCmdCache *
+CapCmdCache_Load(CapCmdCache *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    clear_entries(self);
+
+    FILE *fin = fopen(path, "r");
+    if (!fin) {
+        return NULL;
+    }
+
+    char *line = PadMem_Malloc(LINE_SIZE);
+    bool is_valid = false;
+    if (!line) {
+        goto done;
+    }
+
+    if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF ||
+        strcmp(line, CACHE_SIGNATURE)) {
+        goto done;
+    }
+
+    for (;;) {
+        if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF) {
+            break;
+        }
+        if (!load_entry(self, fin, line)) {
+            // broken
+            goto done;
+        }
+    }
+
+    is_valid = true;
+
+done:
+    Pad_SafeFree(line);
+    fclose(fin);
+    if (!is_valid) {
+        clear_entries(self);
+        return NULL;
+    }
+    return self;
+}
+
+CapCmdCache *
+CapCmdCache_Save(CapCmdCache *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    // other processes may save same cache at same time
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.%ld.tmp", path, (long) getpid());
+
+    FILE *fout = fopen(tmppath, "w");
+    if (!fout) {
+        return NULL;
+    }
+
+    fprintf(fout, "%s\n", CACHE_SIGNATURE);
+    for (int32_t i = 0; i < self->len; ++i) {
+        const CapCmdCacheEntry *e = &self->entries[i];
+        fprintf(fout, "entry\t%d\t%d\t%s\t%s\t%s\t%s\t%d\n",
+            e->kind, e->scope, e->name, e->cd_path, e->home_path, e->value, e->ndeps);
+        for (int32_t j = 0; j < e->ndeps; ++j) {
+            const CapCmdCacheDep *d = &e->deps[j];
+            fprintf(fout, "dep");
+            CapSymlinkStamp_Write(&d->stamp, fout);
+            fprintf(fout, "\t%s\n", d->path);
+        }
+    }
+
+    if (fclose(fout) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    if (PadFile_Rename(tmppath, path) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    return self;
+}
+
+static int32_t
+find_index(const CapCmdCache *self, int scope, const char *cd, const char *home, const char *name) {
+    for (int32_t i = 0; i < self->len; ++i) {
+        if (is_same_key(&self->entries[i], scope, cd, home, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const CapCmdCacheEntry *
+CapCmdCache_Find(const CapCmdCache *self, const CapConfig *config, const char *name) {
+    if (!self || !config || !name) {
+        return NULL;
+    }
+
+    int32_t i = find_index(self, config->scope, config->cd_path, config->home_path, name);
+    if (i < 0) {
+        return NULL;
+    }
+
+    const CapCmdCacheEntry *entry = &self->entries[i];
+    if (!is_fresh_entry(entry)) {
+        return NULL;
+    }
+
+    return entry;
+}
+
+static void
+remove_at(CapCmdCache *self, int32_t index) {
+    CapCmdCacheEntry_Fini(&self->entries[index]);
+    memmove(
+        &self->entries[index],
+        &self->entries[index+1],
+        sizeof(self->entries[0]) * (self->len - index - 1)
+    );
+    --self->len;
+}
+
+CapCmdCache *
+CapCmdCache_Set(CapCmdCache *self, CapCmdCacheEntry *move_entry) {
+    if (!self || !move_entry) {
+        return NULL;
+    }
+    if (move_entry->is_uncacheable || move_entry->kind == CAP_CMD_CACHE__NONE) {
+        return NULL;
+    }
+
+    int32_t i = find_index(
+        self,
+        move_entry->scope,
+        move_entry->cd_path,
+        move_entry->home_path,
+        move_entry->name
+    );
+    if (i >= 0) {
+        remove_at(self, i);
+    } else if (self->len >= CAP_CMD_CACHE__MAX_ENTRIES) {
+        remove_at(self, 0);
+    }
+
+    // newest is last
+    self->entries[self->len++] = *move_entry;
+    *move_entry = (CapCmdCacheEntry) {0};
+    return self;
+}
+
+int32_t
+CapCmdCache_Len(const CapCmdCache *self) {
+    return self ? self->len : 0;
+}
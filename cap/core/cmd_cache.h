@@ -0,0 +1,223 @@
+/**
+ * Resolution cache of command names
+ *
+ * cap コマンドの名前がビルトインでない場合、エイリアス、スニペット、PATH のプログラム、run の順で解決される
+ * このキャッシュは名前がどのソースに解決されたかを ~/.cap/var/cmds に保存する
+ * どのソースにも見つからなかった名前（run に渡される）もネガティブエントリとして保存する
+ *
+ * エントリは解決時に調べたファイルとディレクトリ（.caprc、スニペットのディレクトリ、PATH のディレクトリ）の
+ * スタンプを持ち、参照時にいずれかのスタンプが変わっていればそのエントリは無効になる
+ *
+ * The format of file is text:
+ *
+ *      cap cmd cache 2
+ *      entry <TAB> kind <TAB> scope <TAB> name <TAB> cd <TAB> home <TAB> value <TAB> number of deps
+ *      dep <TAB> exists <TAB> dev <TAB> ino <TAB> mtime <TAB> mtime_nsec <TAB> size <TAB> mode <TAB> path
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/config.h>
+#include <cap/core/symlink_cache.h>
+#include <cap/core/record.h>
+
+/**
+ * Numbers
+ */
+enum {
+    CAP_CMD_CACHE__MAX_DEPS = 32,
+    CAP_CMD_CACHE__MAX_ENTRIES = 128,
+};
+
+/**
+ * Kinds of resolution
+ */
+typedef enum {
+    CAP_CMD_CACHE__NONE = 0,
+    CAP_CMD_CACHE__ALIAS,  // value is value of alias
+    CAP_CMD_CACHE__SNIPPET,  // name is file name of snippet
+    CAP_CMD_CACHE__PROG,  // value is Cap's path of program
+    CAP_CMD_CACHE__RUN,  // not found in sources. name is passed to run
+} CapCmdCacheKind;
+
+/**
+ * Dependency of entry
+ */
+typedef struct {
+    char *path;
+    CapSymlinkStamp stamp;
+} CapCmdCacheDep;
+
+/**
+ * Entry of cache
+ */
+typedef struct {
+    CapCmdCacheKind kind;
+    int scope;
+    char *name;
+    char *cd_path;
+    char *home_path;
+    char *value;
+    bool is_uncacheable;  // dependencies are too many or racy
+    int32_t ndeps;
+    CapCmdCacheDep deps[CAP_CMD_CACHE__MAX_DEPS];
+} CapCmdCacheEntry;
+
+struct CapCmdCache;
+typedef struct CapCmdCache CapCmdCache;
+
+/**
+ * Initialize entry by key
+ *
+ * @param[out] *entry  pointer to CapCmdCacheEntry
+ * @param[in]  *config pointer to CapConfig (scope, cd_path and home_path are used)
+ * @param[in]  *name   command name
+ *
+ * @return success to pointer to entry
+ * @return failed to NULL
+ */
+CapCmdCacheEntry *
+CapCmdCacheEntry_Init(CapCmdCacheEntry *entry, const CapConfig *config, const char *name);
+
+/**
+ * Finalize entry
+ *
+ * @param[in] *entry pointer to CapCmdCacheEntry
+ */
+void
+CapCmdCacheEntry_Fini(CapCmdCacheEntry *entry);
+
+/**
+ * Add dependency to entry
+ * The stamp of path is loaded at this time. Call this before read of path
+ * If path was already added then does nothing
+ * If path was modified in last few seconds then the entry is not cacheable
+ * because next modification in same second is not detected by mtime
+ *
+ * @param[in] *entry pointer to CapCmdCacheEntry
+ * @param[in] *path  path of file or directory
+ *
+ * @return success to pointer to entry
+ * @return failed to NULL (the entry is not cacheable)
+ */
+CapCmdCacheEntry *
+CapCmdCacheEntry_AddDep(CapCmdCacheEntry *entry, const char *path);
+
+/**
+ * Add dependency with stamp to entry
+ * Use this if the stamp was loaded before read of path by other cache
+ *
+ * @param[in] *entry pointer to CapCmdCacheEntry
+ * @param[in] *path  path of file or directory
+ * @param[in] *stamp stamp of path
+ *
+ * @return success to pointer to entry
+ * @return failed to NULL (the entry is not cacheable)
+ */
+CapCmdCacheEntry *
+CapCmdCacheEntry_AddStampedDep(CapCmdCacheEntry *entry, const char *path, const CapSymlinkStamp *stamp);
+
+/**
+ * Set result of resolution
+ *
+ * @param[in] *entry pointer to CapCmdCacheEntry
+ * @param[in] kind   kind of resolution
+ * @param[in] *value value of kind or NULL
+ *
+ * @return success to pointer to entry
+ * @return failed to NULL
+ */
+CapCmdCacheEntry *
+CapCmdCacheEntry_SetResult(CapCmdCacheEntry *entry, CapCmdCacheKind kind, const char *value);
+
+/**
+ * Destruct cache
+ *
+ * @param[in] *self pointer to CapCmdCache
+ */
+void
+CapCmdCache_Del(CapCmdCache *self);
+
+/**
+ * Construct cache
+ *
+ * @return success to pointer to CapCmdCache (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapCmdCache *
+CapCmdCache_New(void);
+
+/**
+ * Load entries from file
+ * Current entries are cleared
+ *
+ * @param[in] *self pointer to CapCmdCache
+ * @param[in] *path path of cache file
+ *
+ * @return success to pointer to self
+ * @return not exists or broken to NULL
+ */
+CapCmdCache *
+CapCmdCache_Load(CapCmdCache *self, const char *path);
+
+/**
+ * Save entries at file
+ * The file is replaced by rename(2) after write to temporary file
+ *
+ * @param[in] *self pointer to CapCmdCache
+ * @param[in] *path path of cache file
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapCmdCache *
+CapCmdCache_Save(CapCmdCache *self, const char *path);
+
+/**
+ * Find valid entry by key
+ * The stamps of dependencies of entry are compared with file system
+ *
+ * @param[in] *self   pointer to CapCmdCache
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *name   command name
+ *
+ * @return found and valid to pointer to entry
+ * @return not found or invalid to NULL
+ */
+const CapCmdCacheEntry *
+CapCmdCache_Find(const CapCmdCache *self, const CapConfig *config, const char *name);
+
+/**
+ * Save entry
+ * If the entry is not cacheable then does nothing and returns NULL
+ * The oldest entry is removed if cache is full
+ *
+ * @param[in] *self        pointer to CapCmdCache
+ * @param[in] *move_entry  pointer to CapCmdCacheEntry. the members are moved to cache
+ *
+ * @return success to pointer to self
+ * @return failed or not cacheable to NULL
+ */
+CapCmdCache *
+CapCmdCache_Set(CapCmdCache *self, CapCmdCacheEntry *move_entry);
+
+/**
+ * Get number of entries
+ *
+ * @param[in] *self pointer to CapCmdCache
+ *
+ * @return number of entries
+ */
+int32_t
+CapCmdCache_Len(const CapCmdCache *self);
@@ -1,4 +1,5 @@
 #include <cap/core/config.h>
+#include <cap/core/state.h>
 
 void
 CapConfig_Del(CapConfig *self) {
@@ -50,6 +51,27 @@ if_not_exists_to_mkdir(CapConfig *self, const char *dirpath) {
 char *
 Pad_PopTailSlash(char *path);
 
+CapConfig *
+CapConfig_CopyValues(CapConfig *self, const CapConfig *other) {
+    if (!self || !other) {
+        return NULL;
+    }
+
+    PadConfig *pad_config = self->pad_config;
+    PadErrStack *errstack = self->errstack;
+    *self = *other;
+    self->pad_config = pad_config;
+    self->errstack = errstack;
+    self->warm = NULL;
+
+    if (!PadConfig_Init(self->pad_config)) {
+        Pad_PushErr("failed to init pad-config");
+        return NULL;
+    }
+
+    return self;
+}
+
 PadErrStack *
 CapConfig_GetErrStack(CapConfig *self) {
     return self->errstack;
@@ -64,28 +86,10 @@ CapConfig_Init(CapConfig *self) {
 
     self->scope = CAP_SCOPE__LOCAL;
     self->recursion_count = 0;
+    self->is_deployed = false;
 
     strcpy(self->line_encoding, "lf");
 
-    // init environment
-    
-    if (!if_not_exists_to_mkdir(self, "~/.cap")) {
-        Pad_PushErr("failed to create ~/.cap");
-        return NULL;
-    }
-    if (!if_not_exists_to_mkdir(self, "~/.cap/var")) {
-        Pad_PushErr("failed to create ~/.cap/var");
-        return NULL;
-    }
-    if (!if_not_exists_to_mkdir(self, "~/.cap/codes")) {
-        Pad_PushErr("failed to create ~/.cap/codes");
-        return NULL;
-    }
-    if (!if_not_exists_to_mkdir(self, "~/.cap/stdlib")) {
-        Pad_PushErr("failed to create ~/.cap/stdlib");
-        return NULL;
-    }
-
     // solve path
 
     if (!PadFile_Solve(self->var_cd_path, sizeof self->var_cd_path, "~/.cap/var/cd")) {
@@ -100,6 +104,30 @@ CapConfig_Init(CapConfig *self) {
         Pad_PushErr("failed to create path of editor of variable");
         return NULL;
     }
+    if (!PadFile_Solve(self->var_links_path, sizeof self->var_links_path, "~/.cap/var/links")) {
+        Pad_PushErr("failed to create path of links of variable");
+        return NULL;
+    }
+    if (!PadFile_Solve(self->var_cmds_path, sizeof self->var_cmds_path, "~/.cap/var/cmds")) {
+        Pad_PushErr("failed to create path of commands of variable");
+        return NULL;
+    }
+    if (!PadFile_Solve(self->var_snippets_path, sizeof self->var_snippets_path, "~/.cap/var/snippets")) {
+        Pad_PushErr("failed to create path of snippets of variable");
+        return NULL;
+    }
+    if (!PadFile_Solve(self->var_hash_path, sizeof self->var_hash_path, "~/.cap/var/hash")) {
+        Pad_PushErr("failed to create path of hash of variable");
+        return NULL;
+    }
+    if (!PadFile_Solve(self->var_state_path, sizeof self->var_state_path, "~/.cap/var/state")) {
+        Pad_PushErr("failed to create path of state of variable");
+        return NULL;
+    }
+    if (!PadFile_Solve(self->var_daemon_path, sizeof self->var_daemon_path, "~/.cap/var/daemon.sock")) {
+        Pad_PushErr("failed to create path of socket of daemon");
+        return NULL;
+    }
     if (!PadFile_Solve(self->codes_dir_path, sizeof self->codes_dir_path, "~/.cap/codes")) {
         Pad_PushErr("failed to solve path for snippet codes directory path");
         return NULL;
@@ -108,9 +136,66 @@ CapConfig_Init(CapConfig *self) {
         Pad_PushErr("failed to solve path for standard libraries directory");
         return NULL;
     }
+    if (!PadFile_Solve(self->alias_cache_dir_path, sizeof self->alias_cache_dir_path, "~/.cap/var/alias_cache")) {
+        Pad_PushErr("failed to solve path for alias cache directory");
+        return NULL;
+    }
+    if (!PadFile_Solve(self->render_cache_dir_path, sizeof self->render_cache_dir_path, "~/.cap/cache")) {
+        Pad_PushErr("failed to solve path for render cache directory");
+        return NULL;
+    }
+
+    return CapConfig_ReadVars(self);
+}
+
+CapConfig *
+CapConfig_ReadVars(CapConfig *self) {
+    // read values from state file
+    // the state file is valid while the environment and variables are not changed
+
+    CapState *state = PadMem_Malloc(sizeof(*state));
+    if (!state) {
+        Pad_PushErr("failed to allocate memory for state");
+        return NULL;
+    }
+
+    self->is_deployed = CapState_Load(state, self->var_state_path) != NULL;
+    if (self->is_deployed) {
+        strcpy(self->cd_path, state->cd_path);
+        strcpy(self->home_path, state->home_path);
+        strcpy(self->editor, state->editor);
+    }
+    Pad_SafeFree(state);
+
+    if (self->is_deployed) {
+        Pad_PopTailSlash(self->cd_path);
+        Pad_PopTailSlash(self->home_path);
+        return self;
+    }
+
+    // init environment
+    
+    if (!if_not_exists_to_mkdir(self, "~/.cap")) {
+        Pad_PushErr("failed to create ~/.cap");
+        return NULL;
+    }
+    if (!if_not_exists_to_mkdir(self, "~/.cap/var")) {
+        Pad_PushErr("failed to create ~/.cap/var");
+        return NULL;
+    }
+    if (!if_not_exists_to_mkdir(self, "~/.cap/codes")) {
+        Pad_PushErr("failed to create ~/.cap/codes");
+        return NULL;
+    }
+    if (!if_not_exists_to_mkdir(self, "~/.cap/stdlib")) {
+        Pad_PushErr("failed to create ~/.cap/stdlib");
+        return NULL;
+    }
 
-    // read path from variables
+    // read path from variables. values of previous read are not remained
 
+    self->cd_path[0] = '\0';
+    self->editor[0] = '\0';
     if (!PadFile_ReadLine(self->cd_path, sizeof self->cd_path, self->var_cd_path)) {
         // nothing todo
     }
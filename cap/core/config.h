@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdbool.h>
+
 #include <pad/lib/memory.h>
 #include <pad/lib/file.h>
 #include <pad/lib/path.h>
@@ -8,21 +10,36 @@
 #include <pad/core/util.h>
 
 #include <cap/core/constant.h>
+#include <cap/core/sink.h>
+
+struct CapWarm;
 
 typedef struct CapConfig {
     PadConfig *pad_config;
     PadErrStack *errstack;  // error stack for error handling
     int scope;  // @see constant.h for CAP_SCOPE_*
     int recursion_count;  // count of recursion of call to app
+    bool is_deployed;  // environment was verified by state file and values were read from it
     char line_encoding[32+1];  // line encoding "cr" | "crlf" | "lf"
     char var_cd_path[PAD_FILE__NPATH];  // path of variable of cd on file system
     char var_home_path[PAD_FILE__NPATH];  // path of variable of home on file system
     char var_editor_path[PAD_FILE__NPATH];  // path of variable of editor on file system
+    char var_links_path[PAD_FILE__NPATH];  // path of index of Cap's symbolic links on file system
+    char var_cmds_path[PAD_FILE__NPATH];  // path of resolution cache of command names on file system
+    char var_snippets_path[PAD_FILE__NPATH];  // path of index of snippet codes on file system
+    char var_hash_path[PAD_FILE__NPATH];  // path of hash of programs in PATH on file system
+    char var_state_path[PAD_FILE__NPATH];  // path of state file of startup on file system
+    char var_daemon_path[PAD_FILE__NPATH];  // path of socket of daemon on file system
     char cd_path[PAD_FILE__NPATH];  // value of cd
     char home_path[PAD_FILE__NPATH];  // value of home
     char editor[PAD_FILE__NPATH];  // value of editor
     char codes_dir_path[PAD_FILE__NPATH];  // snippet codes directory path
     char std_lib_dir_path[PAD_FILE__NPATH];  // standard libraries directory path
+    char alias_cache_dir_path[PAD_FILE__NPATH];  // cache directory path of aliases of resource files
+    char render_cache_dir_path[PAD_FILE__NPATH];  // cache directory path of results of render
+    CapSink *out_sink;  // output of commands (reference). NULL is stdout
+    CapSink *err_sink;  // error output of commands (reference). NULL is stderr
+    struct CapWarm *warm;  // state prepared by daemon (reference). NULL if not in child of daemon
 } CapConfig;
 
 /**
@@ -43,6 +60,7 @@ CapConfig_New(void);
 
 /**
  * initialize CapConfig
+ * If state file is valid then values are read from it and checks of directories are skipped
  * 
  * @param[in] *self 
  * 
@@ -51,6 +69,32 @@ CapConfig_New(void);
 CapConfig *
 CapConfig_Init(CapConfig *self);
 
+/**
+ * read values of variables (cd, home and editor) again
+ * paths of variables must be solved by CapConfig_Init before
+ * 
+ * @param[in] *self 
+ * 
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapConfig *
+CapConfig_ReadVars(CapConfig *self);
+
+/**
+ * copy values of other to self
+ * pad's config and error stack of self are kept
+ * warm state of daemon is not copied because it is bound to other
+ * 
+ * @param[in] *self 
+ * @param[in] *other 
+ * 
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapConfig *
+CapConfig_CopyValues(CapConfig *self, const CapConfig *other);
+
 /**
  * get config's error stack
  * 
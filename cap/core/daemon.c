@@ -0,0 +1,681 @@
+#include <cap/core/daemon.h>
+
+extern char **environ;
+
+#ifdef CAP__WINDOWS
+
+int
+CapDaemon_Serve(
+    const char *sockpath,
+    CapDaemonExecFunc exec,
+    CapDaemonFilterFunc filter,
+    void *arg
+) {
+    PadErr_Err("daemon is not supported on this platform");
+    return 1;
+}
+
+bool
+CapDaemon_Forward(int *result, const char *sockpath, int argc, char *argv[]) {
+    return false;
+}
+
+bool
+CapDaemon_Stop(const char *sockpath) {
+    return false;
+}
+
+#else
+
+/**
+ * Numbers
+ */
+enum {
+    MAGIC = 0x43415044,  // "CAPD"
+    NFDS = 3,  // stdin, stdout and stderr
+    MAX_PAYLOAD = 1 << 20,
+    MAX_STRINGS = 1 << 16,
+    RECV_TIMEOUT_SECONDS = 5,
+    BACKLOG = 64,
+};
+
+/**
+ * Header of request
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t argc;
+    uint32_t envc;
+    uint32_t umask;
+    uint32_t size;  // size of payload
+} Header;
+
+/**
+ * Received request
+ */
+typedef struct {
+    Header header;
+    int fds[NFDS];
+    int nfds;
+    char *payload;
+    char *cwd;  // in payload
+    char **argv;  // argc + 1. strings are in payload
+    char **envp;  // envc + 1. strings are in payload
+} Request;
+
+/**
+ * Buffer of control message of file descriptors
+ */
+typedef union {
+    char buf[CMSG_SPACE(sizeof(int) * NFDS)];
+    struct cmsghdr align;
+} Control;
+
+static bool
+write_all(int fd, const void *buf, size_t size) {
+    const char *p = buf;
+    while (size) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool
+read_all(int fd, void *buf, size_t size) {
+    char *p = buf;
+    while (size) {
+        ssize_t n = read(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (n == 0) {
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool
+make_addr(struct sockaddr_un *addr, const char *sockpath) {
+    *addr = (struct sockaddr_un) {0};
+    addr->sun_family = AF_UNIX;
+    if (strlen(sockpath) >= sizeof addr->sun_path) {
+        return false;
+    }
+    strcpy(addr->sun_path, sockpath);
+    return true;
+}
+
+/**
+ * Connect to daemon
+ *
+ * @return success to file descriptor of socket
+ * @return daemon is not running to -1
+ */
+static int
+connect_to(const char *sockpath) {
+    struct sockaddr_un addr;
+    if (!make_addr(&addr, sockpath)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (connect(fd, (struct sockaddr *) &addr, sizeof addr) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool
+send_header(int fd, const Header *header, const int fds[], int nfds) {
+    struct iovec iov = {
+        .iov_base = (void *) header,
+        .iov_len = sizeof(*header),
+    };
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+    };
+
+    Control control = {0};
+    if (nfds) {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    }
+
+    ssize_t n;
+    do {
+        n = sendmsg(fd, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return false;
+    }
+
+    // file descriptors were sent with first byte
+    return write_all(fd, (const char *) header + n, sizeof(*header) - n);
+}
+
+static void
+close_fds(Request *req) {
+    for (int i = 0; i < req->nfds; ++i) {
+        close(req->fds[i]);
+    }
+    req->nfds = 0;
+}
+
+static void
+free_request(Request *req) {
+    close_fds(req);
+    Pad_SafeFree(req->payload);
+    Pad_SafeFree(req->argv);
+    Pad_SafeFree(req->envp);
+}
+
+static bool
+recv_header(int fd, Request *req) {
+    struct iovec iov = {
+        .iov_base = &req->header,
+        .iov_len = sizeof(req->header),
+    };
+    Control control = {0};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof control.buf,
+    };
+
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        int nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (int i = 0; i < nfds; ++i) {
+            int rfd;
+            memcpy(&rfd, CMSG_DATA(cmsg) + sizeof(int) * i, sizeof(int));
+            if (req->nfds < NFDS) {
+                req->fds[req->nfds++] = rfd;
+            } else {
+                close(rfd);
+            }
+        }
+    }
+
+    if (msg.msg_flags & MSG_CTRUNC) {
+        return false;
+    }
+
+    return read_all(fd, (char *) &req->header + n, sizeof(req->header) - n);
+}
+
+/**
+ * Split payload to cwd, argv and envp
+ */
+static bool
+split_payload(Request *req) {
+    const Header *h = &req->header;
+    req->argv = PadMem_Calloc(h->argc + 1, sizeof(char *));
+    req->envp = PadMem_Calloc(h->envc + 1, sizeof(char *));
+    if (!req->argv || !req->envp) {
+        return false;
+    }
+
+    char *p = req->payload;
+    char *end = req->payload + h->size;
+    uint32_t nstrings = 1 + h->argc + h->envc;
+    for (uint32_t i = 0; i < nstrings; ++i) {
+        char *nul = memchr(p, '\0', end - p);
+        if (!nul) {
+            return false;
+        }
+
+        if (i == 0) {
+            req->cwd = p;
+        } else if (i <= h->argc) {
+            req->argv[i - 1] = p;
+        } else {
+            req->envp[i - 1 - h->argc] = p;
+        }
+        p = nul + 1;
+    }
+
+    return p == end;
+}
+
+static bool
+recv_request(int fd, Request *req) {
+    *req = (Request) {0};
+
+    if (!recv_header(fd, req)) {
+        return false;
+    }
+
+    const Header *h = &req->header;
+    if (h->magic != MAGIC ||
+        h->size > MAX_PAYLOAD ||
+        h->argc + (uint64_t) h->envc > MAX_STRINGS) {
+        return false;
+    }
+    if (h->argc == 0) {
+        // stop request
+        return true;
+    }
+    if (req->nfds != NFDS || h->size == 0) {
+        return false;
+    }
+
+    req->payload = PadMem_Malloc(h->size);
+    if (!req->payload || !read_all(fd, req->payload, h->size)) {
+        return false;
+    }
+
+    return split_payload(req);
+}
+
+/**
+ * Handlers of requests
+ */
+typedef struct {
+    CapDaemonExecFunc exec;
+    CapDaemonFilterFunc filter;
+    void *arg;
+} Handler;
+
+/**
+ * Execute request in child process of daemon
+ * The child forks command process and sends exit status of it to client
+ * Then exit, PadErr_Die and signals in command are reported to client
+ * This function does not return
+ */
+static void
+run_child(int conn, Request *req, const Handler *handler) {
+    // environment of client for filter and command
+    // if failed then pid is not sent and client executes command by itself
+    if (chdir(req->cwd) != 0) {
+        _exit(1);
+    }
+    umask(req->header.umask);
+    environ = req->envp;
+    // locale of client. categories are same as main
+    setlocale(LC_CTYPE, "");
+
+    if (handler->filter && !handler->filter(handler->arg, req->header.argc, req->argv)) {
+        _exit(1);
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        // client executes command by itself
+        _exit(1);
+    } else if (pid == 0) {
+        close(conn);
+        for (int i = 0; i < NFDS; ++i) {
+            dup2(req->fds[i], i);
+        }
+        for (int i = 0; i < NFDS; ++i) {
+            if (req->fds[i] >= NFDS) {
+                close(req->fds[i]);
+            }
+        }
+        exit(handler->exec(handler->arg, req->header.argc, req->argv));
+    }
+
+    close_fds(req);
+
+    int32_t cpid = pid;
+    if (!write_all(conn, &cpid, sizeof cpid)) {
+        kill(pid, SIGTERM);
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+
+    int32_t code = 1;
+    if (WIFEXITED(status)) {
+        code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        code = 128 + WTERMSIG(status);
+    }
+
+    write_all(conn, &code, sizeof code);
+    _exit(0);
+}
+
+/**
+ * Stop daemon of parent process and wait exit of it
+ * Then send acknowledgement to client
+ * This function does not return
+ */
+static void
+stop_parent(int conn) {
+    pid_t ppid = getppid();
+    if (kill(ppid, SIGTERM) != 0) {
+        _exit(1);
+    }
+
+    // this process is adopted by other process after exit of daemon
+    for (int i = 0; i < RECV_TIMEOUT_SECONDS * 100 && getppid() == ppid; ++i) {
+        usleep(10 * 1000);
+    }
+
+    int32_t zero = 0;
+    write_all(conn, &zero, sizeof zero);
+    _exit(0);
+}
+
+/**
+ * Serve connection in child process of daemon
+ * The request is received in child so that slow client does not block other clients
+ * This function does not return
+ */
+static void
+serve_conn(int conn, const Handler *handler) {
+    // restore dispositions of daemon for commands
+    signal(SIGCHLD, SIG_DFL);
+    signal(SIGPIPE, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    // child of client that does not send request does not remain
+    struct timeval tv = {.tv_sec = RECV_TIMEOUT_SECONDS};
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+
+    Request req;
+    if (!recv_request(conn, &req)) {
+        // pid is not sent. client executes command by itself
+        _exit(1);
+    }
+
+    if (req.header.argc == 0) {
+        stop_parent(conn);
+    }
+
+    run_child(conn, &req, handler);
+}
+
+static volatile sig_atomic_t is_stopping;
+static int listen_fd = -1;
+
+/**
+ * Stop accept loop of daemon
+ * Listening socket is shut down, so accept after check of flag fails too
+ */
+static void
+stop_serve(int sig) {
+    (void) sig;
+    is_stopping = 1;
+    shutdown(listen_fd, SHUT_RDWR);
+}
+
+int
+CapDaemon_Serve(
+    const char *sockpath,
+    CapDaemonExecFunc exec,
+    CapDaemonFilterFunc filter,
+    void *arg
+) {
+    if (!sockpath || !exec) {
+        return 1;
+    }
+
+    const Handler handler = {
+        .exec = exec,
+        .filter = filter,
+        .arg = arg,
+    };
+
+    struct sockaddr_un addr;
+    if (!make_addr(&addr, sockpath)) {
+        PadErr_Err("too long path of socket %s", sockpath);
+        return 1;
+    }
+
+    int fd = connect_to(sockpath);
+    if (fd >= 0) {
+        close(fd);
+        PadErr_Err("daemon is already running at %s", sockpath);
+        return 1;
+    }
+    unlink(sockpath);  // stale socket of dead daemon
+
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) {
+        PadErr_Err("failed to create socket");
+        return 1;
+    }
+
+    // only owner can connect
+    mode_t mask = umask(0177);
+    int ret = bind(lfd, (struct sockaddr *) &addr, sizeof addr);
+    umask(mask);
+    if (ret != 0 || listen(lfd, BACKLOG) != 0) {
+        PadErr_Err("failed to listen at %s", sockpath);
+        close(lfd);
+        return 1;
+    }
+
+    // children are reaped automatically
+    signal(SIGCHLD, SIG_IGN);
+    signal(SIGPIPE, SIG_IGN);
+
+    // stop request and SIGTERM interrupt accept. accept is not restarted
+    is_stopping = 0;
+    listen_fd = lfd;
+    struct sigaction act = {0};
+    struct sigaction oldact;
+    act.sa_handler = stop_serve;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGTERM, &act, &oldact);
+
+    int result = 0;
+    while (!is_stopping) {
+        int conn = accept(lfd, NULL, NULL);
+        if (conn < 0) {
+            if (is_stopping) {
+                break;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            PadErr_Err("failed to accept connection");
+            result = 1;
+            break;
+        }
+
+        fflush(NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(lfd);
+            serve_conn(conn, &handler);
+        }
+
+        // if failed to fork then client executes command by itself
+        close(conn);
+    }
+
+    sigaction(SIGTERM, &oldact, NULL);
+    listen_fd = -1;
+    close(lfd);
+    unlink(sockpath);
+    return result;
+}
+
+/*********
+* client *
+*********/
+
+static volatile sig_atomic_t forward_pid;
+
+static void
+forward_signal(int sig) {
+    if (forward_pid > 0) {
+        kill(forward_pid, sig);
+    }
+}
+
+static char *
+make_payload(uint32_t *size, int argc, char *argv[], uint32_t *envc) {
+    char cwd[PAD_FILE__NPATH];
+    if (!getcwd(cwd, sizeof cwd)) {
+        return NULL;
+    }
+
+    size_t sz = strlen(cwd) + 1;
+    for (int i = 0; i < argc; ++i) {
+        sz += strlen(argv[i]) + 1;
+    }
+    uint32_t n = 0;
+    for (char **e = environ; e && *e; ++e, ++n) {
+        sz += strlen(*e) + 1;
+    }
+    if (sz > MAX_PAYLOAD || argc + (uint64_t) n > MAX_STRINGS) {
+        return NULL;
+    }
+
+    char *payload = PadMem_Malloc(sz);
+    if (!payload) {
+        return NULL;
+    }
+
+    char *p = payload;
+    p = stpcpy(p, cwd) + 1;
+    for (int i = 0; i < argc; ++i) {
+        p = stpcpy(p, argv[i]) + 1;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        p = stpcpy(p, environ[i]) + 1;
+    }
+
+    *size = sz;
+    *envc = n;
+    return payload;
+}
+
+bool
+CapDaemon_Forward(int *result, const char *sockpath, int argc, char *argv[]) {
+    if (!result || !sockpath || argc <= 0 || !argv) {
+        return false;
+    }
+
+    int fd = connect_to(sockpath);
+    if (fd < 0) {
+        return false;
+    }
+
+    uint32_t size = 0;
+    uint32_t envc = 0;
+    char *payload = make_payload(&size, argc, argv, &envc);
+    if (!payload) {
+        close(fd);
+        return false;
+    }
+
+    mode_t mask = umask(0);
+    umask(mask);
+
+    Header header = {
+        .magic = MAGIC,
+        .argc = argc,
+        .envc = envc,
+        .umask = mask,
+        .size = size,
+    };
+    const int fds[NFDS] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+    // flush before daemon writes at same file descriptors
+    fflush(stdout);
+    fflush(stderr);
+
+    int32_t pid = 0;
+    bool is_sent = send_header(fd, &header, fds, NFDS) &&
+                   write_all(fd, payload, size) &&
+                   read_all(fd, &pid, sizeof pid);
+    free(payload);
+    if (!is_sent || pid <= 0) {
+        // command was not started. execute by itself
+        close(fd);
+        return false;
+    }
+
+    // signals of terminal are sent to this process. pass them to command
+    static const int sigs[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+    enum { NSIGS = sizeof sigs / sizeof sigs[0] };
+    struct sigaction olds[NSIGS];
+    struct sigaction act = {0};
+    act.sa_handler = forward_signal;
+    sigemptyset(&act.sa_mask);
+
+    forward_pid = pid;
+    for (int i = 0; i < NSIGS; ++i) {
+        sigaction(sigs[i], &act, &olds[i]);
+    }
+
+    int32_t code = 1;
+    if (!read_all(fd, &code, sizeof code)) {
+        PadErr_Err("lost connection to daemon");
+        code = 1;
+    }
+
+    for (int i = 0; i < NSIGS; ++i) {
+        sigaction(sigs[i], &olds[i], NULL);
+    }
+    forward_pid = 0;
+
+    close(fd);
+    *result = code;
+    return true;
+}
+
+bool
+CapDaemon_Stop(const char *sockpath) {
+    if (!sockpath) {
+        return false;
+    }
+
+    int fd = connect_to(sockpath);
+    if (fd < 0) {
+        return false;
+    }
+
+    Header header = {
+        .magic = MAGIC,
+    };
+    int32_t ack;
+    bool is_stopped = send_header(fd, &header, NULL, 0) &&
+                      read_all(fd, &ack, sizeof ack);
+    close(fd);
+    return is_stopped;
+}
+
+#endif
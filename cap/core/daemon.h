@@ -0,0 +1,127 @@
+/**
+ * Daemon of cap over Unix domain socket
+ *
+ * cap daemon は常駐してユーザーごとのソケット（~/.cap/var/daemon.sock）で要求を待つ
+ * 通常の cap はソケットがあれば argv、カレントディレクトリ、環境変数、umask と標準入出力のファイルディスクリプタ（SCM_RIGHTS）をデーモンに送る
+ * デーモンは接続ごとに fork して、子プロセスで要求を受け取る。遅いクライアントが他のクライアントを待たせることはない
+ * 子プロセスはカレントディレクトリ、環境変数とロケールを置き換え、フィルタが要求を受け付けたらコマンドのプロセスを fork する
+ * コマンドのプロセスはファイルディスクリプタを置き換えてからコマンドを実行する
+ * フィルタが断った要求には pid を返さない。クライアントは自身のプロセスでコマンドを実行する
+ * exec、libpad の動的リンクと初期化はデーモンの起動時の 1 回だけになる
+ * デーモンが accept の前に作った状態（arg）は fork でコピーオンライトで子プロセスに引き継がれる
+ * 子プロセスで実行するので、コマンドの中の exit や PadErr_Die でデーモンが終了することはない
+ * デーモンがなければ cap は従来どおり自身のプロセスでコマンドを実行する
+ *
+ * Request (client to daemon):
+ *
+ *      header (with SCM_RIGHTS of stdin, stdout and stderr)
+ *      cwd \0 argv[0] \0 ... argv[argc-1] \0 env[0] \0 ... env[envc-1] \0
+ *
+ * Reply (daemon to client):
+ *
+ *      pid of child (int32_t)
+ *      exit code of command (int32_t)
+ *
+ * A request of argc 0 stops the daemon. The acknowledgement is sent after exit of daemon
+ * SIGTERM stops the daemon too
+ */
+#pragma once
+
+#define _DEFAULT_SOURCE 1 /* cap: core/daemon: CMSG_SPACE */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <locale.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/error.h>
+
+#include <cap/core/constant.h>
+
+#ifndef CAP__WINDOWS
+# include <sys/socket.h>
+# include <sys/un.h>
+# include <sys/wait.h>
+# include <sys/time.h>
+#endif
+
+/**
+ * Function of execution of command in child process of daemon
+ *
+ * @param[in] *arg   argument of CapDaemon_Serve
+ * @param[in] argc   number of arguments
+ * @param[in] *argv  arguments of cap (argv[0] is "cap")
+ *
+ * @return exit code of command
+ */
+typedef int (*CapDaemonExecFunc)(void *arg, int argc, char *argv[]);
+
+/**
+ * Function of check of request in child process of daemon
+ * Current directory and environment variables are of client
+ *
+ * @param[in] *arg   argument of CapDaemon_Serve
+ * @param[in] argc   number of arguments
+ * @param[in] *argv  arguments of cap (argv[0] is "cap")
+ *
+ * @return accept to true
+ * @return refuse to false. the client executes command by itself
+ */
+typedef bool (*CapDaemonFilterFunc)(void *arg, int argc, char *argv[]);
+
+/**
+ * Listen at socket and serve requests until stop request
+ * Each request is executed by exec in child process
+ *
+ * @param[in] *sockpath path of socket
+ * @param[in] exec      function of execution of command
+ * @param[in] filter    function of check of request or NULL for accept all
+ * @param[in] *arg      argument of exec and filter (reference). children inherit it by fork
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+int
+CapDaemon_Serve(
+    const char *sockpath,
+    CapDaemonExecFunc exec,
+    CapDaemonFilterFunc filter,
+    void *arg
+);
+
+/**
+ * Forward arguments to daemon and wait exit of command
+ * Stdin, stdout and stderr of current process are passed to daemon
+ *
+ * @param[out] *result   exit code of command
+ * @param[in]  *sockpath path of socket
+ * @param[in]  argc      number of arguments
+ * @param[in]  *argv     arguments of cap
+ *
+ * @return forwarded to true
+ * @return daemon is not running, daemon refused request or failed to send request to false
+ */
+bool
+CapDaemon_Forward(int *result, const char *sockpath, int argc, char *argv[]);
+
+/**
+ * Stop daemon
+ *
+ * @param[in] *sockpath path of socket
+ *
+ * @return stopped to true
+ * @return daemon is not running to false
+ */
+bool
+CapDaemon_Stop(const char *sockpath);
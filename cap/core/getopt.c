@@ -0,0 +1,235 @@
+#include <cap/core/getopt.h>
+
+static bool
+is_nonopt(char *argv[], int index) {
+    return argv[index][0] != '-' || argv[index][1] == '\0';
+}
+
+static void
+reverse(char *argv[], int begin, int end) {
+    for (--end; begin < end; ++begin, --end) {
+        char *tmp = argv[begin];
+        argv[begin] = argv[end];
+        argv[end] = tmp;
+    }
+}
+
+/**
+ * Move skipped non-options [first_nonopt, last_nonopt) after options [last_nonopt, optind)
+ */
+static void
+exchange(CapGetopt *self, char *argv[]) {
+    reverse(argv, self->first_nonopt, self->last_nonopt);
+    reverse(argv, self->last_nonopt, self->optind);
+    reverse(argv, self->first_nonopt, self->optind);
+
+    self->first_nonopt += self->optind - self->last_nonopt;
+    self->last_nonopt = self->optind;
+}
+
+/**
+ * Move to next element of argv that has options
+ *
+ * @return found to true, end of options to false
+ */
+static bool
+next_elem(CapGetopt *self, int argc, char *argv[], bool is_permute) {
+    if (self->last_nonopt > self->optind) {
+        self->last_nonopt = self->optind;
+    }
+    if (self->first_nonopt > self->optind) {
+        self->first_nonopt = self->optind;
+    }
+
+    if (is_permute) {
+        if (self->first_nonopt != self->last_nonopt && self->last_nonopt != self->optind) {
+            exchange(self, argv);
+        } else if (self->last_nonopt != self->optind) {
+            self->first_nonopt = self->optind;
+        }
+
+        while (self->optind < argc && is_nonopt(argv, self->optind)) {
+            self->optind++;
+        }
+        self->last_nonopt = self->optind;
+    }
+
+    // "--" ends options. it is moved before non-options
+    if (self->optind != argc && strcmp(argv[self->optind], "--") == 0) {
+        self->optind++;
+        if (self->first_nonopt != self->last_nonopt && self->last_nonopt != self->optind) {
+            exchange(self, argv);
+        } else if (self->first_nonopt == self->last_nonopt) {
+            self->first_nonopt = self->optind;
+        }
+        self->last_nonopt = argc;
+        self->optind = argc;
+    }
+
+    if (self->optind == argc) {
+        // rest of arguments are skipped non-options
+        if (self->first_nonopt != self->last_nonopt) {
+            self->optind = self->first_nonopt;
+        }
+        return false;
+    }
+
+    if (is_nonopt(argv, self->optind)) {
+        // first non-option ends options in order
+        return false;
+    }
+
+    return true;
+}
+
+static int
+parse_long(
+    CapGetopt *self,
+    int argc,
+    char *argv[],
+    const struct option *longopts,
+    int *longindex,
+    char missing
+) {
+    const char *name = self->nextchar;
+    const char *eq = strchr(name, '=');
+    size_t namelen = eq ? (size_t) (eq - name) : strlen(name);
+
+    const struct option *found = NULL;
+    int found_index = -1;
+    bool is_ambiguous = false;
+
+    for (int i = 0; longopts[i].name; ++i) {
+        const struct option *o = &longopts[i];
+        if (strncmp(o->name, name, namelen) != 0) {
+            continue;
+        }
+        if (strlen(o->name) == namelen) {
+            // exact match
+            found = o;
+            found_index = i;
+            is_ambiguous = false;
+            break;
+        }
+        if (!found) {
+            found = o;
+            found_index = i;
+        } else if (found->has_arg != o->has_arg || found->flag != o->flag || found->val != o->val) {
+            is_ambiguous = true;
+        }
+    }
+
+    self->nextchar = NULL;
+    self->optind++;
+
+    if (is_ambiguous || !found) {
+        self->optopt = 0;
+        return '?';
+    }
+
+    if (eq) {
+        if (found->has_arg == no_argument) {
+            self->optopt = found->val;
+            return '?';
+        }
+        self->optarg = (char *) eq + 1;
+    } else if (found->has_arg == required_argument) {
+        if (self->optind >= argc) {
+            self->optopt = found->val;
+            return missing;
+        }
+        self->optarg = argv[self->optind++];
+    }
+
+    if (longindex) {
+        *longindex = found_index;
+    }
+    if (found->flag) {
+        *found->flag = found->val;
+        return 0;
+    }
+
+    return found->val;
+}
+
+int
+CapGetopt_Long(
+    CapGetopt *self,
+    int argc,
+    char *argv[],
+    const char *shortopts,
+    const struct option *longopts,
+    int *longindex
+) {
+    if (!self || !argv || !shortopts) {
+        return -1;
+    }
+
+    self->optarg = NULL;
+    if (self->optind == 0) {
+        // start of parse. argv[0] is name of program
+        *self = (CapGetopt) {
+            .optind = 1,
+            .first_nonopt = 1,
+            .last_nonopt = 1,
+        };
+    }
+
+    bool is_permute = true;
+    if (shortopts[0] == '+') {
+        is_permute = false;
+        shortopts++;
+    }
+    char missing = '?';
+    if (shortopts[0] == ':') {
+        missing = ':';
+    }
+
+    if (!self->nextchar || *self->nextchar == '\0') {
+        if (!next_elem(self, argc, argv, is_permute)) {
+            self->nextchar = NULL;
+            return -1;
+        }
+
+        const char *elem = argv[self->optind];
+        if (longopts && elem[1] == '-') {
+            self->nextchar = argv[self->optind] + 2;
+            return parse_long(self, argc, argv, longopts, longindex, missing);
+        }
+        self->nextchar = argv[self->optind] + 1;
+    }
+
+    char c = *self->nextchar++;
+    const char *spec = strchr(shortopts, c);
+    if (*self->nextchar == '\0') {
+        self->optind++;
+    }
+
+    if (!spec || c == ':') {
+        self->optopt = (unsigned char) c;
+        return '?';
+    }
+
+    if (spec[1] != ':') {
+        return (unsigned char) c;
+    }
+
+    if (spec[2] == ':') {
+        // optional argument is only in same element
+        if (*self->nextchar != '\0') {
+            self->optarg = self->nextchar;
+            self->optind++;
+        }
+    } else if (*self->nextchar != '\0') {
+        self->optarg = self->nextchar;
+        self->optind++;
+    } else if (self->optind >= argc) {
+        self->optopt = (unsigned char) c;
+        c = missing;
+    } else {
+        self->optarg = argv[self->optind++];
+    }
+    self->nextchar = NULL;
+
+    return (unsigned char) c;
+}
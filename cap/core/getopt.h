@@ -0,0 +1,51 @@
+/**
+ * Reentrant parser of options
+ * getopt_long と同じ規則でオプションを解析するが、状態をプロセス全体の変数ではなく CapGetopt に持つ
+ * 同時に複数のスレッドで別々の引数を解析できる
+ * GNU の getopt_long と同じく非オプション引数は argv の後ろに並べ替えられる
+ * shortopts が '+' で始まる場合は最初の非オプション引数で解析を終える
+ * エラーメッセージは表示しない（opterr = 0 と同じ）
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+
+/**
+ * State of parse. Zero value starts parse
+ */
+typedef struct {
+    int optind;  // index of next element of argv. rest of arguments after parse
+    int optopt;  // character of unknown option or option that lacks argument
+    char *optarg;  // argument of option or NULL
+    char *nextchar;  // next character in element of grouped short options
+    int first_nonopt;  // range of skipped non-options
+    int last_nonopt;
+} CapGetopt;
+
+/**
+ * Parse next option like getopt_long(3)
+ *
+ * @param[in] *self      pointer to CapGetopt
+ * @param[in] argc       number of arguments
+ * @param[in] *argv[]    arguments. non-options are permuted to end
+ * @param[in] *shortopts string of short options
+ * @param[in] *longopts  array of long options terminated by zero element or NULL
+ * @param[out] *longindex index of found long option or NULL
+ *
+ * @return character of option, 0 for long option that sets flag,
+ *         '?' for unknown option, ':' for lacking argument if shortopts begins with ':' (after '+'),
+ *         -1 for end of options
+ */
+int
+CapGetopt_Long(
+    CapGetopt *self,
+    int argc,
+    char *argv[],
+    const char *shortopts,
+    const struct option *longopts,
+    int *longindex
+);
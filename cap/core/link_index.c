@@ -0,0 +1,480 @@
+#include <cap/core/link_index.h>
+
+/**
+ * Numbers
+ */
+enum {
+    INIT_CAPA = 16,
+    NBUCKETS = 1024,
+};
+
+/**
+ * Hash table of entries keyed by device and inode
+ */
+typedef struct {
+    CapLinkIndexEntry *entries;
+    int32_t len;
+    int32_t capa;
+    int32_t buckets[NBUCKETS];  // head index of entries or -1
+} Table;
+
+/**
+ * Structure of index
+ */
+struct CapLinkIndex {
+    char home[PAD_FILE__NPATH];
+    int64_t built;  // time of start of build or 0 if unknown
+    Table links;
+    Table dirs;
+};
+
+static const char INDEX_SIGNATURE[] = "cap link index 1";
+
+static uint32_t
+hash_stat(uint64_t dev, uint64_t ino) {
+    uint64_t h = (dev * 1099511628211ULL) ^ ino;
+    h ^= h >> 29;
+    return (uint32_t) (h % NBUCKETS);
+}
+
+/********
+* table *
+********/
+
+static void
+table_rehash(Table *self) {
+    for (int32_t i = 0; i < NBUCKETS; ++i) {
+        self->buckets[i] = -1;
+    }
+    for (int32_t i = 0; i < self->len; ++i) {
+        CapLinkIndexEntry *e = &self->entries[i];
+        uint32_t h = hash_stat(e->dev, e->ino);
+        e->next = self->buckets[h];
+        self->buckets[h] = i;
+    }
+}
+
+static void
+table_clear(Table *self) {
+    for (int32_t i = 0; i < self->len; ++i) {
+        Pad_SafeFree(self->entries[i].path);
+        Pad_SafeFree(self->entries[i].cappath);
+    }
+    self->len = 0;
+    table_rehash(self);
+}
+
+static void
+table_fini(Table *self) {
+    table_clear(self);
+    Pad_SafeFree(self->entries);
+}
+
+static bool
+table_init(Table *self) {
+    self->capa = INIT_CAPA;
+    self->entries = PadMem_Calloc(self->capa, sizeof(*self->entries));
+    if (!self->entries) {
+        return false;
+    }
+    table_clear(self);
+    return true;
+}
+
+static CapLinkIndexEntry *
+table_find(const Table *self, uint64_t dev, uint64_t ino) {
+    for (int32_t i = self->buckets[hash_stat(dev, ino)]; i >= 0; i = self->entries[i].next) {
+        CapLinkIndexEntry *e = &self->entries[i];
+        if (e->dev == dev && e->ino == ino) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static bool
+table_set(
+    Table *self,
+    uint64_t dev,
+    uint64_t ino,
+    int64_t mtime,
+    int64_t size,
+    const char *path,
+    const char *cappath
+) {
+    char *p = PadCStr_Dup(path);
+    char *cp = cappath ? PadCStr_Dup(cappath) : NULL;
+    if (!p || (cappath && !cp)) {
+        Pad_SafeFree(p);
+        Pad_SafeFree(cp);
+        return false;
+    }
+
+    CapLinkIndexEntry *e = table_find(self, dev, ino);
+    if (e) {
+        // overwrite
+        Pad_SafeFree(e->path);
+        Pad_SafeFree(e->cappath);
+        e->path = p;
+        e->cappath = cp;
+        e->mtime = mtime;
+        e->size = size;
+        return true;
+    }
+
+    if (self->len >= self->capa) {
+        int32_t capa = self->capa * 2;
+        CapLinkIndexEntry *entries = PadMem_Realloc(self->entries, sizeof(*entries) * capa);
+        if (!entries) {
+            Pad_SafeFree(p);
+            Pad_SafeFree(cp);
+            return false;
+        }
+        self->entries = entries;
+        self->capa = capa;
+    }
+
+    uint32_t h = hash_stat(dev, ino);
+    self->entries[self->len] = (CapLinkIndexEntry) {
+        .dev = dev,
+        .ino = ino,
+        .mtime = mtime,
+        .size = size,
+        .path = p,
+        .cappath = cp,
+        .next = self->buckets[h],
+    };
+    self->buckets[h] = self->len++;
+    return true;
+}
+
+static bool
+table_remove(Table *self, uint64_t dev, uint64_t ino) {
+    CapLinkIndexEntry *e = table_find(self, dev, ino);
+    if (!e) {
+        return false;
+    }
+
+    Pad_SafeFree(e->path);
+    Pad_SafeFree(e->cappath);
+    *e = self->entries[--self->len];
+    table_rehash(self);
+    return true;
+}
+
+static bool
+is_same_stamp(const CapLinkIndexEntry *e, const struct stat *st) {
+    return e->mtime == st->st_mtime && e->size == st->st_size;
+}
+
+/**
+ * Check file was changed before build of index
+ * ctime is changed by write, rename and link. change in last few seconds of build may not be scanned
+ * ctime on Windows is time of creation
+ */
+static bool
+is_changed_before_build(const CapLinkIndex *self, const struct stat *st) {
+#ifdef CAP__WINDOWS
+    (void) self;
+    (void) st;
+    return false;
+#else
+    return self->built > 0 && st->st_ctime < self->built - CAP_RECORD__RACY_SECONDS;
+#endif
+}
+
+/**************
+* link index *
+**************/
+
+void
+CapLinkIndex_Del(CapLinkIndex *self) {
+    if (!self) {
+        return;
+    }
+
+    table_fini(&self->links);
+    table_fini(&self->dirs);
+    Pad_SafeFree(self);
+}
+
+CapLinkIndex *
+CapLinkIndex_New(void) {
+    CapLinkIndex *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    if (!table_init(&self->links) ||
+        !table_init(&self->dirs)) {
+        CapLinkIndex_Del(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+static bool
+load_line(CapLinkIndex *self, char *line) {
+    char *fields[7];
+    int n = CapRecord_SplitFields(line, fields, 7);
+
+    if (n == 2 && PadCStr_Eq(fields[0], "home")) {
+        snprintf(self->home, sizeof self->home, "%s", fields[1]);
+        return true;
+    }
+    if (n == 2 && PadCStr_Eq(fields[0], "built")) {
+        self->built = strtoll(fields[1], NULL, 10);
+        return true;
+    }
+
+    Table *table = NULL;
+    const char *cappath = NULL;
+    if (n == 6 && PadCStr_Eq(fields[0], "dir")) {
+        table = &self->dirs;
+    } else if (n == 7 && PadCStr_Eq(fields[0], "link")) {
+        table = &self->links;
+        cappath = fields[6];
+    } else {
+        return false;
+    }
+
+    return table_set(
+        table,
+        strtoull(fields[1], NULL, 10),
+        strtoull(fields[2], NULL, 10),
+        strtoll(fields[3], NULL, 10),
+        strtoll(fields[4], NULL, 10),
+        fields[5],
+        cappath
+    );
+}
+
+CapLinkIndex *
+CapLinkIndex_Load(CapLinkIndex *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    CapLinkIndex_Reset(self, "");
+    self->built = 0;  // index of old version has not time of build
+
+    FILE *fin = fopen(path, "r");
+    if (!fin) {
+        return NULL;
+    }
+
+    char line[PAD_FILE__NPATH * 2 + 256];
+    bool is_valid = false;
+
+    if (PadFile_GetLine(line, sizeof line, fin) == EOF ||
+        strcmp(line, INDEX_SIGNATURE)) {
+        goto done;
+    }
+
+    for (;;) {
+        if (PadFile_GetLine(line, sizeof line, fin) == EOF) {
+            break;
+        }
+        if (!load_line(self, line)) {
+            // broken
+            goto done;
+        }
+    }
+
+    is_valid = self->home[0] != '\0';
+
+done:
+    fclose(fin);
+    if (!is_valid) {
+        CapLinkIndex_Reset(self, "");
+        return NULL;
+    }
+    return self;
+}
+
+static void
+save_table(const Table *table, const char *kind, FILE *fout) {
+    for (int32_t i = 0; i < table->len; ++i) {
+        const CapLinkIndexEntry *e = &table->entries[i];
+        fprintf(fout, "%s\t%llu\t%llu\t%lld\t%lld\t%s",
+            kind,
+            (unsigned long long) e->dev,
+            (unsigned long long) e->ino,
+            (long long) e->mtime,
+            (long long) e->size,
+            e->path
+        );
+        if (e->cappath) {
+            fprintf(fout, "\t%s", e->cappath);
+        }
+        fputc('\n', fout);
+    }
+}
+
+CapLinkIndex *
+CapLinkIndex_Save(CapLinkIndex *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.tmp", path);
+
+    FILE *fout = fopen(tmppath, "w");
+    if (!fout) {
+        return NULL;
+    }
+
+    fprintf(fout, "%s\n", INDEX_SIGNATURE);
+    fprintf(fout, "home\t%s\n", self->home);
+    fprintf(fout, "built\t%lld\n", (long long) self->built);
+    save_table(&self->dirs, "dir", fout);
+    save_table(&self->links, "link", fout);
+
+    if (fclose(fout) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    if (PadFile_Rename(tmppath, path) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    return self;
+}
+
+CapLinkIndex *
+CapLinkIndex_Reset(CapLinkIndex *self, const char *home) {
+    if (!self || !home) {
+        return NULL;
+    }
+
+    table_clear(&self->links);
+    table_clear(&self->dirs);
+    snprintf(self->home, sizeof self->home, "%s", home);
+    self->built = time(NULL);
+    return self;
+}
+
+const char *
+CapLinkIndex_GetcHome(const CapLinkIndex *self) {
+    return self->home;
+}
+
+bool
+CapLinkIndex_IsCovered(const CapLinkIndex *self, const char *path) {
+    if (!self || !path || !self->home[0]) {
+        return false;
+    }
+
+    size_t homelen = strlen(self->home);
+    if (strncmp(path, self->home, homelen)) {
+        return false;
+    }
+
+    // "/home/foo" is not covered by "/home/fo"
+    char ch = path[homelen];
+    return ch == '\0' || ch == PAD_FILE__SEP || self->home[homelen-1] == PAD_FILE__SEP;
+}
+
+CapLinkIndex *
+CapLinkIndex_Set(CapLinkIndex *self, const char *path, const char *cappath, const struct stat *st) {
+    if (!self || !path || !cappath || !st) {
+        return NULL;
+    }
+
+    if (!table_set(&self->links, st->st_dev, st->st_ino, st->st_mtime, st->st_size, path, cappath)) {
+        return NULL;
+    }
+
+    return self;
+}
+
+CapLinkIndex *
+CapLinkIndex_SetDir(CapLinkIndex *self, const char *path, const struct stat *st) {
+    if (!self || !path || !st) {
+        return NULL;
+    }
+
+    if (!table_set(&self->dirs, st->st_dev, st->st_ino, st->st_mtime, st->st_size, path, NULL)) {
+        return NULL;
+    }
+
+    return self;
+}
+
+bool
+CapLinkIndex_IsFreshDir(const CapLinkIndex *self, const struct stat *st) {
+    if (!self || !st) {
+        return false;
+    }
+
+    const CapLinkIndexEntry *e = table_find(&self->dirs, st->st_dev, st->st_ino);
+    return e && is_same_stamp(e, st);
+}
+
+bool
+CapLinkIndex_Remove(CapLinkIndex *self, const struct stat *st) {
+    if (!self || !st) {
+        return false;
+    }
+
+    return table_remove(&self->links, st->st_dev, st->st_ino);
+}
+
+const CapLinkIndexEntry *
+CapLinkIndex_FindByStat(const CapLinkIndex *self, const struct stat *st) {
+    if (!self || !st) {
+        return NULL;
+    }
+
+    return table_find(&self->links, st->st_dev, st->st_ino);
+}
+
+CapLinkIndexResult
+CapLinkIndex_Lookup(
+    const CapLinkIndex *self,
+    const struct stat *st,
+    const struct stat *dirst,
+    const char **cappath
+) {
+    if (!self || !st) {
+        return CAP_LINK_INDEX__UNKNOWN;
+    }
+
+    const CapLinkIndexEntry *e = table_find(&self->links, st->st_dev, st->st_ino);
+    if (e) {
+        if (!is_same_stamp(e, st)) {
+            // link file was changed or inode was reused
+            return CAP_LINK_INDEX__UNKNOWN;
+        }
+        if (cappath) {
+            *cappath = e->cappath;
+        }
+        return CAP_LINK_INDEX__LINK;
+    }
+
+    const CapLinkIndexEntry *dir = dirst ? table_find(&self->dirs, dirst->st_dev, dirst->st_ino) : NULL;
+    if (!dir) {
+        // directory was not scanned
+        return CAP_LINK_INDEX__UNKNOWN;
+    }
+    if (is_changed_before_build(self, st)) {
+        // file was scanned and not changed after that
+        return CAP_LINK_INDEX__NOT_LINK;
+    }
+    if (st->st_size < CAP_LINK_INDEX__MIN_LINK_SIZE && is_same_stamp(dir, dirst)) {
+        // file is not created after indexing and too small for link
+        return CAP_LINK_INDEX__NOT_LINK;
+    }
+
+    // file may be overwritten in place by link or created after indexing
+    return CAP_LINK_INDEX__UNKNOWN;
+}
+
+int32_t
+CapLinkIndex_Len(const CapLinkIndex *self) {
+    return self ? self->links.len : 0;
+}
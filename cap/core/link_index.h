@@ -0,0 +1,240 @@
+/**
+ * Index of Cap's symbolic links
+ *
+ * cap link が作成したリンクファイルを ~/.cap/var/links に記録する
+ * エントリはリンクファイルのデバイスと inode をキーに持ち、リンク先の Cap のパスを値に持つ
+ * 参照時にはリンクファイルの mtime とサイズを比較してエントリを検証する
+ *
+ * インデックスはホーム以下のディレクトリのスタンプと作成を始めた時刻も持つ
+ * 走査したディレクトリにあり、インデックスにないファイルは
+ * ctime が作成時刻より前（数秒の余裕を持つ）ならリンクではないと判断できる
+ * 書き込み、リネームとハードリンクは ctime を更新するので、その後に変更されたファイルは読んで確かめる
+ * ディレクトリがインデックス作成時から変更されていなければ
+ * リンクのヘッダより小さいファイルもリンクではないと判断できる
+ *
+ * The format of file is text:
+ *
+ *      cap link index 1
+ *      home <TAB> /path/of/home
+ *      built <TAB> time of start of build
+ *      dir <TAB> dev <TAB> ino <TAB> mtime <TAB> size <TAB> /path/of/dir
+ *      link <TAB> dev <TAB> ino <TAB> mtime <TAB> size <TAB> /path/of/link <TAB> /cap/path
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/constant.h>
+#include <cap/core/record.h>
+
+/**
+ * Minimum size of link file (length of "cap symlink:")
+ */
+#define CAP_LINK_INDEX__MIN_LINK_SIZE 12
+
+/**
+ * Results of CapLinkIndex_Lookup
+ */
+typedef enum {
+    CAP_LINK_INDEX__UNKNOWN = 0,  // directory or file was changed after indexing. read the file
+    CAP_LINK_INDEX__LINK,  // file is link
+    CAP_LINK_INDEX__NOT_LINK,  // file is not link
+} CapLinkIndexResult;
+
+/**
+ * Entry of index
+ */
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtime;
+    int64_t size;
+    char *path;  // path of link file or directory on file system
+    char *cappath;  // path of target in Cap's environment (NULL if directory)
+    int32_t next;  // next index of entry in bucket or -1
+} CapLinkIndexEntry;
+
+struct CapLinkIndex;
+typedef struct CapLinkIndex CapLinkIndex;
+
+/**
+ * Destruct index
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ */
+void
+CapLinkIndex_Del(CapLinkIndex *self);
+
+/**
+ * Construct index
+ *
+ * @return success to pointer to CapLinkIndex (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapLinkIndex *
+CapLinkIndex_New(void);
+
+/**
+ * Load entries from file
+ * Current entries are cleared
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *path path of index file
+ *
+ * @return success to pointer to self
+ * @return not exists or broken to NULL
+ */
+CapLinkIndex *
+CapLinkIndex_Load(CapLinkIndex *self, const char *path);
+
+/**
+ * Save entries at file
+ * The file is replaced by rename(2) after write to temporary file
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *path path of index file
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapLinkIndex *
+CapLinkIndex_Save(CapLinkIndex *self, const char *path);
+
+/**
+ * Clear entries and set home of index
+ * Only links under home are recorded in index
+ * The time of build is set to current time. call this before scan
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *home path of home
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapLinkIndex *
+CapLinkIndex_Reset(CapLinkIndex *self, const char *home);
+
+/**
+ * Get home of index
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ *
+ * @return pointer to path of home
+ */
+const char *
+CapLinkIndex_GetcHome(const CapLinkIndex *self);
+
+/**
+ * Check path is under home of index
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *path path on file system
+ *
+ * @return covered to true else false
+ */
+bool
+CapLinkIndex_IsCovered(const CapLinkIndex *self, const char *path);
+
+/**
+ * Save link
+ *
+ * @param[in] *self    pointer to CapLinkIndex
+ * @param[in] *path    path of link file
+ * @param[in] *cappath path of target in Cap's environment
+ * @param[in] *st      pointer to result of stat of link file
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapLinkIndex *
+CapLinkIndex_Set(CapLinkIndex *self, const char *path, const char *cappath, const struct stat *st);
+
+/**
+ * Save stamp of directory
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *path path of directory
+ * @param[in] *st   pointer to result of stat of directory
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapLinkIndex *
+CapLinkIndex_SetDir(CapLinkIndex *self, const char *path, const struct stat *st);
+
+/**
+ * Check directory is not changed after indexing
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *st   pointer to result of stat of directory
+ *
+ * @return not changed to true else false
+ */
+bool
+CapLinkIndex_IsFreshDir(const CapLinkIndex *self, const struct stat *st);
+
+/**
+ * Remove link by device and inode
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *st   pointer to result of stat of link file
+ *
+ * @return removed to true else false
+ */
+bool
+CapLinkIndex_Remove(CapLinkIndex *self, const struct stat *st);
+
+/**
+ * Find link by device and inode
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ * @param[in] *st   pointer to result of stat of file
+ *
+ * @return found to pointer to CapLinkIndexEntry
+ * @return not found to NULL
+ */
+const CapLinkIndexEntry *
+CapLinkIndex_FindByStat(const CapLinkIndex *self, const struct stat *st);
+
+/**
+ * Check file is link without read of file
+ * The entry is valid only if mtime and size of file are same as entry
+ * The file not found in index is not link if parent directory was scanned and
+ * ctime of file is before build of index, or parent directory is fresh
+ * and size of file is less than CAP_LINK_INDEX__MIN_LINK_SIZE
+ *
+ * @param[in]  *self     pointer to CapLinkIndex
+ * @param[in]  *st       pointer to result of stat of file
+ * @param[in]  *dirst    pointer to result of stat of parent directory or NULL
+ * @param[out] **cappath if file is link then pointer to path of target
+ *
+ * @return CapLinkIndexResult
+ */
+CapLinkIndexResult
+CapLinkIndex_Lookup(
+    const CapLinkIndex *self,
+    const struct stat *st,
+    const struct stat *dirst,
+    const char **cappath
+);
+
+/**
+ * Get number of links
+ *
+ * @param[in] *self pointer to CapLinkIndex
+ *
+ * @return number of links
+ */
+int32_t
+CapLinkIndex_Len(const CapLinkIndex *self);
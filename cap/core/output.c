@@ -0,0 +1,262 @@
+#include <cap/core/output.h>
+
+/**
+ * Format string to dynamic allocate memory
+ */
+static char *
+vformat(const char *fmt, va_list ap) {
+    va_list ap2;
+    va_copy(ap2, ap);
+    int len = vsnprintf(NULL, 0, fmt, ap2);
+    va_end(ap2);
+    if (len < 0) {
+        return NULL;
+    }
+
+    char *s = PadMem_Malloc(len + 1);
+    if (!s) {
+        return NULL;
+    }
+    vsnprintf(s, len + 1, fmt, ap);
+    return s;
+}
+
+static CapSink *
+out_sink(const CapConfig *config) {
+    return config ? config->out_sink : NULL;
+}
+
+static CapSink *
+err_sink(const CapConfig *config) {
+    return config ? config->err_sink : NULL;
+}
+
+bool
+CapOut_Write(const CapConfig *config, const char *data, size_t len) {
+    CapSink *sink = out_sink(config);
+    if (sink) {
+        return CapSink_Write(sink, data, len);
+    }
+    return fwrite(data, 1, len, stdout) == len;
+}
+
+bool
+CapOut_Printf(const CapConfig *config, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+
+    CapSink *sink = out_sink(config);
+    if (!sink) {
+        bool ok = vprintf(fmt, ap) >= 0;
+        va_end(ap);
+        return ok;
+    }
+
+    char *s = vformat(fmt, ap);
+    va_end(ap);
+    bool ok = s && CapSink_Write(sink, s, strlen(s));
+    free(s);
+    return ok;
+}
+
+void
+CapOut_Flush(const CapConfig *config) {
+    if (!out_sink(config)) {
+        fflush(stdout);
+    }
+}
+
+bool
+CapOut_ErrPrintf(const CapConfig *config, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+
+    CapSink *sink = err_sink(config);
+    if (!sink) {
+        fflush(stdout);
+        bool ok = vfprintf(stderr, fmt, ap) >= 0;
+        va_end(ap);
+        fflush(stderr);
+        return ok;
+    }
+
+    char *s = vformat(fmt, ap);
+    va_end(ap);
+    bool ok = s && CapSink_Write(sink, s, strlen(s));
+    free(s);
+    return ok;
+}
+
+/**
+ * Escape '%' of message for format of Pad's error functions
+ */
+static char *
+escape_percent(const char *msg) {
+    size_t n = 0;
+    for (const char *p = msg; *p; ++p) {
+        n += *p == '%' ? 2 : 1;
+    }
+
+    char *s = PadMem_Malloc(n + 1);
+    if (!s) {
+        return NULL;
+    }
+
+    char *d = s;
+    for (const char *p = msg; *p; ++p) {
+        *d++ = *p;
+        if (*p == '%') {
+            *d++ = '%';
+        }
+    }
+    *d = '\0';
+    return s;
+}
+
+/**
+ * Show message to error sink in format of Pad's error functions
+ * "<label>: <Message>. <error of errno>."
+ */
+static void
+write_msg(CapSink *sink, const char *label, const char *msg, int errnum) {
+    size_t len = strlen(msg);
+    char head[2] = {0};
+    if (len && isalpha((unsigned char) msg[0])) {
+        head[0] = toupper((unsigned char) msg[0]);
+        msg++;
+        len--;
+    }
+
+    CapSink_Write(sink, label, strlen(label));
+    CapSink_Write(sink, head, strlen(head));
+    CapSink_Write(sink, msg, len);
+    if (!len || msg[len-1] != '.') {
+        CapSink_Write(sink, ".", 1);
+    }
+    if (errnum != 0) {
+        const char *what = strerror(errnum);
+        CapSink_Write(sink, " ", 1);
+        CapSink_Write(sink, what, strlen(what));
+        CapSink_Write(sink, ".", 1);
+    }
+    CapSink_Write(sink, "\n", 1);
+}
+
+/**
+ * Show error or warning message
+ *
+ * @param[in] is_err error to true, warning to false
+ */
+static void
+show_msg(const CapConfig *config, bool is_err, const char *fmt, va_list ap) {
+    int errnum = errno;
+    char *msg = vformat(fmt, ap);
+    if (!msg) {
+        return;
+    }
+
+    CapSink *sink = err_sink(config);
+    if (sink) {
+        write_msg(sink, is_err ? "Error: " : "Warn: ", msg, errnum);
+        free(msg);
+        return;
+    }
+
+    // formatted message is passed as format. Pad's functions decorate it
+    char *esc = escape_percent(msg);
+    free(msg);
+    if (!esc) {
+        return;
+    }
+    errno = errnum;
+    if (is_err) {
+        PadErr_Err(esc);
+    } else {
+        PadErr_Warn(esc);
+    }
+    free(esc);
+}
+
+void
+CapOut_Err(const CapConfig *config, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    show_msg(config, true, fmt, ap);
+    va_end(ap);
+}
+
+void
+CapOut_Warn(const CapConfig *config, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    show_msg(config, false, fmt, ap);
+    va_end(ap);
+}
+
+/**
+ * Show error stack to error output
+ * Pad writes trace to FILE. it is written to temporary file and copied to error sink
+ */
+static void
+trace(const CapConfig *config, const PadErrStack *errstack, bool is_simple) {
+    if (!errstack) {
+        return;
+    }
+
+    CapSink *sink = err_sink(config);
+    if (!sink) {
+        fflush(stdout);
+        if (is_simple) {
+            PadErrStack_TraceSimple(errstack, stderr);
+        } else {
+            PadErrStack_Trace(errstack, stderr);
+        }
+        fflush(stderr);
+        return;
+    }
+
+    FILE *tmp = tmpfile();
+    if (!tmp) {
+        return;
+    }
+
+    if (is_simple) {
+        PadErrStack_TraceSimple(errstack, tmp);
+    } else {
+        PadErrStack_Trace(errstack, tmp);
+    }
+
+    rewind(tmp);
+    char buf[BUFSIZ];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof buf, tmp)) > 0) {
+        if (!CapSink_Write(sink, buf, n)) {
+            break;
+        }
+    }
+    fclose(tmp);
+}
+
+void
+CapOut_TraceErrStack(const CapConfig *config, const PadErrStack *errstack) {
+    trace(config, errstack, true);
+}
+
+void
+CapOut_TraceErrStackFull(const CapConfig *config, const PadErrStack *errstack) {
+    trace(config, errstack, false);
+}
+
+static bool
+write_out_sink(void *arg, const char *data, size_t len) {
+    return CapSink_Write(arg, data, len);
+}
+
+CapSink *
+CapOut_NewSink(const CapConfig *config) {
+    CapSink *sink = out_sink(config);
+    if (sink) {
+        return CapSink_NewFunc(write_out_sink, sink);
+    }
+    return CapSink_NewFile(stdout);
+}
@@ -0,0 +1,115 @@
+/**
+ * Output of commands
+ * コマンドの出力とエラー出力を CapConfig の書き込み先（out_sink と err_sink）に書き込む
+ * 書き込み先が NULL の場合はプロセスの stdout と stderr に書き込む
+ * CapApp_Exec は呼び出し元の書き込み先を設定するので、ライブラリはファイルディスクリプタ 1 と 2 に書き込まない
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/error.h>
+#include <pad/core/error_stack.h>
+
+#include <cap/core/config.h>
+#include <cap/core/sink.h>
+
+/**
+ * Write bytes to output
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *data   bytes
+ * @param[in] len     number of bytes
+ *
+ * @return success to true, failed to false
+ */
+bool
+CapOut_Write(const CapConfig *config, const char *data, size_t len);
+
+/**
+ * Write formatted string to output
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *fmt    format
+ * @param[in] ...     arguments of format
+ *
+ * @return success to true, failed to false
+ */
+bool
+CapOut_Printf(const CapConfig *config, const char *fmt, ...);
+
+/**
+ * Flush output. stdout is flushed if output is not set
+ *
+ * @param[in] *config pointer to CapConfig
+ */
+void
+CapOut_Flush(const CapConfig *config);
+
+/**
+ * Write formatted string to error output as is
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *fmt    format
+ * @param[in] ...     arguments of format
+ *
+ * @return success to true, failed to false
+ */
+bool
+CapOut_ErrPrintf(const CapConfig *config, const char *fmt, ...);
+
+/**
+ * Show error message to error output like PadErr_Err
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *fmt    format
+ * @param[in] ...     arguments of format
+ */
+void
+CapOut_Err(const CapConfig *config, const char *fmt, ...);
+
+/**
+ * Show warning message to error output like PadErr_Warn
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *fmt    format
+ * @param[in] ...     arguments of format
+ */
+void
+CapOut_Warn(const CapConfig *config, const char *fmt, ...);
+
+/**
+ * Show errors of error stack to error output like PadErrStack_TraceSimple
+ *
+ * @param[in] *config   pointer to CapConfig
+ * @param[in] *errstack pointer to PadErrStack
+ */
+void
+CapOut_TraceErrStack(const CapConfig *config, const PadErrStack *errstack);
+
+/**
+ * Show errors of error stack with places to error output like PadErrStack_Trace
+ *
+ * @param[in] *config   pointer to CapConfig
+ * @param[in] *errstack pointer to PadErrStack
+ */
+void
+CapOut_TraceErrStackFull(const CapConfig *config, const PadErrStack *errstack);
+
+/**
+ * Construct sink that writes to output
+ * Close of the sink does not close output
+ *
+ * @param[in] *config pointer to CapConfig
+ *
+ * @return success to pointer to CapSink, failed to NULL
+ */
+CapSink *
+CapOut_NewSink(const CapConfig *config);
@@ -0,0 +1,435 @@
+#include <cap/core/prog_hash.h>
+
+/**
+ * Numbers
+ */
+enum {
+    LINE_SIZE = PAD_FILE__NPATH * 3 + 256,
+    INIT_CAPA = 16,
+};
+
+/**
+ * Program in hash
+ */
+typedef struct {
+    char *name;
+    char *cap_path;
+    int32_t order;  // order of addition. the first one is used in same names
+} Item;
+
+/**
+ * Structure of hash
+ */
+struct CapProgHash {
+    int scope;
+    char cd_path[PAD_FILE__NPATH];
+    char home_path[PAD_FILE__NPATH];
+    CapProgHashDep *deps;
+    int32_t ndeps;
+    int32_t deps_capa;
+    Item *items;
+    int32_t nitems;
+    int32_t items_capa;
+    bool is_sorted;  // items are sorted by name and unique
+    bool is_racy;  // dependencies were modified in last few seconds
+    bool is_uncacheable;  // resource file wrote output. saved as mark without programs
+};
+
+static const char HASH_SIGNATURE[] = "cap prog hash 2";
+
+static void
+clear(CapProgHash *self) {
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        Pad_SafeFree(self->deps[i].path);
+    }
+    for (int32_t i = 0; i < self->nitems; ++i) {
+        Pad_SafeFree(self->items[i].name);
+        Pad_SafeFree(self->items[i].cap_path);
+    }
+    self->ndeps = 0;
+    self->nitems = 0;
+    self->is_sorted = true;
+    self->is_racy = false;
+    self->is_uncacheable = false;
+}
+
+void
+CapProgHash_Del(CapProgHash *self) {
+    if (!self) {
+        return;
+    }
+
+    clear(self);
+    Pad_SafeFree(self->deps);
+    Pad_SafeFree(self->items);
+    Pad_SafeFree(self);
+}
+
+CapProgHash *
+CapProgHash_New(void) {
+    CapProgHash *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->is_sorted = true;
+    return self;
+}
+
+CapProgHash *
+CapProgHash_Reset(CapProgHash *self, const CapConfig *config) {
+    if (!self || !config) {
+        return NULL;
+    }
+
+    clear(self);
+    self->scope = config->scope;
+    snprintf(self->cd_path, sizeof self->cd_path, "%s", config->cd_path);
+    snprintf(self->home_path, sizeof self->home_path, "%s", config->home_path);
+    return self;
+}
+
+static bool
+grow(void **array, int32_t *capa, int32_t len, size_t elemsize) {
+    if (len < *capa) {
+        return true;
+    }
+
+    int32_t newcapa = *capa ? *capa * 2 : INIT_CAPA;
+    void *p = PadMem_Realloc(*array, elemsize * newcapa);
+    if (!p) {
+        return false;
+    }
+
+    *array = p;
+    *capa = newcapa;
+    return true;
+}
+
+static CapProgHash *
+add_dep(CapProgHash *self, const char *path, const CapSymlinkStamp *stamp) {
+    if (!grow((void **) &self->deps, &self->deps_capa, self->ndeps, sizeof(*self->deps))) {
+        return NULL;
+    }
+
+    char *p = PadCStr_Dup(path);
+    if (!p) {
+        return NULL;
+    }
+
+    self->deps[self->ndeps++] = (CapProgHashDep) {
+        .path = p,
+        .stamp = *stamp,
+    };
+    return self;
+}
+
+CapProgHash *
+CapProgHash_AddDep(CapProgHash *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        if (PadCStr_Eq(self->deps[i].path, path)) {
+            return self;
+        }
+    }
+
+    CapSymlinkStamp stamp;
+    CapSymlinkStamp_Load(&stamp, path);
+    if (stamp.exists && CapRecord_IsRacy(stamp.mtime)) {
+        self->is_racy = true;
+    }
+
+    return add_dep(self, path, &stamp);
+}
+
+void
+CapProgHash_SetUncacheable(CapProgHash *self) {
+    if (self) {
+        self->is_uncacheable = true;
+    }
+}
+
+bool
+CapProgHash_IsUncacheable(const CapProgHash *self) {
+    return !self || self->is_racy || self->is_uncacheable;
+}
+
+CapProgHash *
+CapProgHash_Add(CapProgHash *self, const char *name, const char *cap_path) {
+    if (!self || !name || !cap_path) {
+        return NULL;
+    }
+
+    if (!grow((void **) &self->items, &self->items_capa, self->nitems, sizeof(*self->items))) {
+        return NULL;
+    }
+
+    Item item = {
+        .name = PadCStr_Dup(name),
+        .cap_path = PadCStr_Dup(cap_path),
+        .order = self->nitems,
+    };
+    if (!item.name || !item.cap_path) {
+        Pad_SafeFree(item.name);
+        Pad_SafeFree(item.cap_path);
+        return NULL;
+    }
+
+    self->items[self->nitems++] = item;
+    self->is_sorted = false;
+    return self;
+}
+
+static int
+compare_items(const void *lhs, const void *rhs) {
+    const Item *a = lhs;
+    const Item *b = rhs;
+    int cmp = strcmp(a->name, b->name);
+    if (cmp) {
+        return cmp;
+    }
+    return a->order - b->order;
+}
+
+/**
+ * Sort items by name and remove later items of same names
+ */
+static void
+sort_items(CapProgHash *self) {
+    if (self->is_sorted) {
+        return;
+    }
+
+    qsort(self->items, self->nitems, sizeof(*self->items), compare_items);
+
+    int32_t n = 0;
+    for (int32_t i = 0; i < self->nitems; ++i) {
+        Item *item = &self->items[i];
+        if (n && !strcmp(self->items[n-1].name, item->name)) {
+            Pad_SafeFree(item->name);
+            Pad_SafeFree(item->cap_path);
+            continue;
+        }
+        item->order = n;
+        self->items[n++] = *item;
+    }
+
+    self->nitems = n;
+    self->is_sorted = true;
+}
+
+static bool
+load_lines(CapProgHash *self, FILE *fin, char *line, const CapConfig *config) {
+    if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF ||
+        strcmp(line, HASH_SIGNATURE)) {
+        return false;
+    }
+
+    char *fields[9];
+    if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF ||
+        CapRecord_SplitFields(line, fields, 4) != 4 ||
+        !PadCStr_Eq(fields[0], "key") ||
+        atoi(fields[1]) != config->scope ||
+        !PadCStr_Eq(fields[2], config->cd_path) ||
+        !PadCStr_Eq(fields[3], config->home_path)) {
+        return false;
+    }
+
+    if (!CapProgHash_Reset(self, config)) {
+        return false;
+    }
+
+    for (;;) {
+        if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF) {
+            break;
+        }
+
+        int n = CapRecord_SplitFields(line, fields, 9);
+        if (n == 9 && PadCStr_Eq(fields[0], "dep")) {
+            CapSymlinkStamp stamp;
+            CapSymlinkStamp_Read(&stamp, fields + 1);
+
+            // validate before read of programs
+            CapSymlinkStamp cur;
+            CapSymlinkStamp_Load(&cur, fields[8]);
+            if (!CapSymlinkStamp_Eq(&stamp, &cur)) {
+                return false;
+            }
+            if (!add_dep(self, fields[8], &stamp)) {
+                return false;
+            }
+        } else if (n == 1 && PadCStr_Eq(fields[0], "uncacheable")) {
+            self->is_uncacheable = true;
+        } else if (n == 3 && PadCStr_Eq(fields[0], "prog")) {
+            if (!CapProgHash_Add(self, fields[1], fields[2])) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    // saved in sorted order
+    sort_items(self);
+    return true;
+}
+
+CapProgHash *
+CapProgHash_Load(CapProgHash *self, const char *path, const CapConfig *config) {
+    if (!self || !path || !config) {
+        return NULL;
+    }
+
+    FILE *fin = fopen(path, "r");
+    if (!fin) {
+        return NULL;
+    }
+
+    char *line = PadMem_Malloc(LINE_SIZE);
+    bool is_valid = line && load_lines(self, fin, line, config);
+    Pad_SafeFree(line);
+    fclose(fin);
+
+    if (!is_valid) {
+        CapProgHash_Reset(self, config);
+        return NULL;
+    }
+
+    return self;
+}
+
+static bool
+is_savable(const CapProgHash *self) {
+    if (self->is_racy ||
+        !CapRecord_IsField(self->cd_path) ||
+        !CapRecord_IsField(self->home_path)) {
+        return false;
+    }
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        if (!CapRecord_IsField(self->deps[i].path)) {
+            return false;
+        }
+    }
+    for (int32_t i = 0; i < self->nitems; ++i) {
+        if (!CapRecord_IsField(self->items[i].name) || !CapRecord_IsField(self->items[i].cap_path)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CapProgHash *
+CapProgHash_Save(CapProgHash *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    sort_items(self);
+    if (!is_savable(self)) {
+        return NULL;
+    }
+
+    // other processes may save same hash at same time
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.%ld.tmp", path, (long) getpid());
+
+    FILE *fout = fopen(tmppath, "w");
+    if (!fout) {
+        return NULL;
+    }
+
+    fprintf(fout, "%s\n", HASH_SIGNATURE);
+    fprintf(fout, "key\t%d\t%s\t%s\n", self->scope, self->cd_path, self->home_path);
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        const CapProgHashDep *d = &self->deps[i];
+        fprintf(fout, "dep");
+        CapSymlinkStamp_Write(&d->stamp, fout);
+        fprintf(fout, "\t%s\n", d->path);
+    }
+    if (self->is_uncacheable) {
+        // mark is valid until dependencies are changed. programs are not used
+        fprintf(fout, "uncacheable\n");
+    }
+    for (int32_t i = 0; !self->is_uncacheable && i < self->nitems; ++i) {
+        fprintf(fout, "prog\t%s\t%s\n", self->items[i].name, self->items[i].cap_path);
+    }
+
+    if (fclose(fout) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    if (PadFile_Rename(tmppath, path) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    return self;
+}
+
+const char *
+CapProgHash_Find(CapProgHash *self, const char *name) {
+    if (!self || !name) {
+        return NULL;
+    }
+
+    sort_items(self);
+
+    int32_t lo = 0;
+    int32_t hi = self->nitems;
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(self->items[mid].name, name);
+        if (cmp == 0) {
+            return self->items[mid].cap_path;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return NULL;
+}
+
+int32_t
+CapProgHash_Len(CapProgHash *self) {
+    if (!self) {
+        return 0;
+    }
+
+    sort_items(self);
+    return self->nitems;
+}
+
+const char *
+CapProgHash_GetcNameAt(CapProgHash *self, int32_t index) {
+    if (index < 0 || index >= CapProgHash_Len(self)) {
+        return NULL;
+    }
+    return self->items[index].name;
+}
+
+const char *
+CapProgHash_GetcPathAt(CapProgHash *self, int32_t index) {
+    if (index < 0 || index >= CapProgHash_Len(self)) {
+        return NULL;
+    }
+    return self->items[index].cap_path;
+}
+
+int32_t
+CapProgHash_DepsLen(const CapProgHash *self) {
+    return self ? self->ndeps : 0;
+}
+
+const CapProgHashDep *
+CapProgHash_GetcDepAt(const CapProgHash *self, int32_t index) {
+    if (!self || index < 0 || index >= self->ndeps) {
+        return NULL;
+    }
+    return &self->deps[index];
+}
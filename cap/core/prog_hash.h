@@ -0,0 +1,218 @@
+/**
+ * Hash of programs in PATH of resource files
+ *
+ * シェルの hash のように、PATH のディレクトリにあるプログラム名と Cap のパスの対応を ~/.cap/var/hash に保存する
+ * プログラムの実行のたびに .caprc を評価して PATH のディレクトリを順に調べる代わりに、このハッシュを参照する
+ * 同じ名前のプログラムが複数のディレクトリにある場合は、先に調べられるディレクトリのものが優先される
+ *
+ * ハッシュは .caprc（ローカルとグローバル）と PATH のディレクトリのスタンプを持つ
+ * いずれかのスタンプが変わっていればハッシュは無効になり、作り直される
+ * ハッシュのキーはスコープ、cd と home で、キーが変わった場合も作り直される
+ * .caprc が出力を書く場合はプログラムを保存せず uncacheable の印だけを保存する
+ * 印のあるハッシュは使われず、Cap_FindProg は PATH のディレクトリを順に調べる
+ *
+ * The format of file is text:
+ *
+ *      cap prog hash 2
+ *      key <TAB> scope <TAB> cd <TAB> home
+ *      dep <TAB> exists <TAB> dev <TAB> ino <TAB> mtime <TAB> mtime_nsec <TAB> size <TAB> mode <TAB> path
+ *      uncacheable
+ *      prog <TAB> name <TAB> cap path
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/config.h>
+#include <cap/core/symlink_cache.h>
+#include <cap/core/record.h>
+
+/**
+ * Dependency of hash
+ */
+typedef struct {
+    char *path;
+    CapSymlinkStamp stamp;
+} CapProgHashDep;
+
+struct CapProgHash;
+typedef struct CapProgHash CapProgHash;
+
+/**
+ * Destruct hash
+ *
+ * @param[in] *self pointer to CapProgHash
+ */
+void
+CapProgHash_Del(CapProgHash *self);
+
+/**
+ * Construct hash
+ *
+ * @return success to pointer to CapProgHash (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapProgHash *
+CapProgHash_New(void);
+
+/**
+ * Clear hash and set key
+ *
+ * @param[in] *self   pointer to CapProgHash
+ * @param[in] *config pointer to CapConfig (scope, cd_path and home_path are used)
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapProgHash *
+CapProgHash_Reset(CapProgHash *self, const CapConfig *config);
+
+/**
+ * Load hash from file
+ * The hash is valid if key is same and stamps of dependencies are not changed
+ *
+ * @param[in] *self   pointer to CapProgHash
+ * @param[in] *path   path of hash file
+ * @param[in] *config pointer to CapConfig
+ *
+ * @return valid to pointer to self
+ * @return not exists, broken or stale to NULL
+ */
+CapProgHash *
+CapProgHash_Load(CapProgHash *self, const char *path, const CapConfig *config);
+
+/**
+ * Save hash at file
+ * If the hash is not cacheable then does nothing and returns NULL
+ *
+ * @param[in] *self pointer to CapProgHash
+ * @param[in] *path path of hash file
+ *
+ * @return success to pointer to self
+ * @return failed or not cacheable to NULL
+ */
+CapProgHash *
+CapProgHash_Save(CapProgHash *self, const char *path);
+
+/**
+ * Add dependency to hash
+ * The stamp of path is loaded at this time. Call this before read of path
+ * If path was modified in last few seconds then the hash is not cacheable
+ * If path was already added then does nothing
+ *
+ * @param[in] *self pointer to CapProgHash
+ * @param[in] *path path of file or directory
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapProgHash *
+CapProgHash_AddDep(CapProgHash *self, const char *path);
+
+/**
+ * Mark hash as not cacheable
+ * The mark is saved with dependencies instead of programs
+ *
+ * @param[in] *self pointer to CapProgHash
+ */
+void
+CapProgHash_SetUncacheable(CapProgHash *self);
+
+/**
+ * Check hash is not cacheable
+ * The hash of racy dependencies or of mark is not cacheable
+ *
+ * @param[in] *self pointer to CapProgHash
+ *
+ * @return not cacheable to true else false
+ */
+bool
+CapProgHash_IsUncacheable(const CapProgHash *self);
+
+/**
+ * Add program
+ * If the name was already added then the program is ignored
+ *
+ * @param[in] *self     pointer to CapProgHash
+ * @param[in] *name     name of program
+ * @param[in] *cap_path Cap's path of program
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapProgHash *
+CapProgHash_Add(CapProgHash *self, const char *name, const char *cap_path);
+
+/**
+ * Find program by name
+ *
+ * @param[in] *self pointer to CapProgHash
+ * @param[in] *name name of program
+ *
+ * @return found to Cap's path of program else NULL
+ */
+const char *
+CapProgHash_Find(CapProgHash *self, const char *name);
+
+/**
+ * Get number of programs
+ *
+ * @param[in] *self pointer to CapProgHash
+ *
+ * @return number of programs
+ */
+int32_t
+CapProgHash_Len(CapProgHash *self);
+
+/**
+ * Get name of program at index. programs are sorted by name
+ *
+ * @param[in] *self  pointer to CapProgHash
+ * @param[in] index  index of program
+ *
+ * @return found to pointer to name else NULL
+ */
+const char *
+CapProgHash_GetcNameAt(CapProgHash *self, int32_t index);
+
+/**
+ * Get Cap's path of program at index
+ *
+ * @param[in] *self  pointer to CapProgHash
+ * @param[in] index  index of program
+ *
+ * @return found to pointer to Cap's path else NULL
+ */
+const char *
+CapProgHash_GetcPathAt(CapProgHash *self, int32_t index);
+
+/**
+ * Get number of dependencies
+ *
+ * @param[in] *self pointer to CapProgHash
+ *
+ * @return number of dependencies
+ */
+int32_t
+CapProgHash_DepsLen(const CapProgHash *self);
+
+/**
+ * Get dependency at index
+ *
+ * @param[in] *self  pointer to CapProgHash
+ * @param[in] index  index of dependency
+ *
+ * @return found to pointer to dependency else NULL
+ */
+const CapProgHashDep *
+CapProgHash_GetcDepAt(const CapProgHash *self, int32_t index);
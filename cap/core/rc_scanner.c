@@ -0,0 +1,209 @@
+#include <cap/core/rc_scanner.h>
+
+/**
+ * Structure of scanner
+ */
+typedef struct {
+    const char *p;
+    CapRcScanResult *result;
+    CapAliasInfo *alinfo;
+    uint32_t outlen;
+} Scanner;
+
+static bool
+is_match(const Scanner *s, const char *word) {
+    return !strncmp(s->p, word, strlen(word));
+}
+
+static void
+skip_blanks(Scanner *s) {
+    for (; *s->p == ' ' || *s->p == '\t' || *s->p == '\r'; ++s->p) {
+    }
+}
+
+static bool
+read_char(Scanner *s, char c) {
+    skip_blanks(s);
+    if (*s->p != c) {
+        return false;
+    }
+    ++s->p;
+    return true;
+}
+
+static bool
+read_string(Scanner *s, char *dst, uint32_t dstsz) {
+    if (!read_char(s, '"')) {
+        return false;
+    }
+
+    uint32_t len = 0;
+    for (; *s->p != '"'; ++s->p) {
+        if (*s->p == '\0' || *s->p == '\\' || *s->p == '\n') {
+            // not supported. the interpreter will read it
+            return false;
+        }
+        if (len >= dstsz-1) {
+            return false;
+        }
+        dst[len++] = *s->p;
+    }
+
+    ++s->p;
+    dst[len] = '\0';
+    return true;
+}
+
+static bool
+read_alias_set(Scanner *s) {
+    char key[PAD_DICT_ITEM__KEY_SIZE];
+    char val[PAD_DICT_ITEM__VALUE_SIZE];
+    char desc[PAD_DICT_ITEM__VALUE_SIZE];
+    bool has_desc = false;
+
+    s->p += strlen("alias.set");
+    if (!read_char(s, '(') ||
+        !read_string(s, key, sizeof key) ||
+        !read_char(s, ',') ||
+        !read_string(s, val, sizeof val)) {
+        return false;
+    }
+
+    if (read_char(s, ',')) {
+        if (!read_string(s, desc, sizeof desc)) {
+            return false;
+        }
+        has_desc = true;
+    }
+
+    if (!read_char(s, ')')) {
+        return false;
+    }
+
+    if (!s->alinfo) {
+        return true;
+    }
+    if (!CapAliasInfo_SetValue(s->alinfo, key, val)) {
+        return false;
+    }
+    if (has_desc && !CapAliasInfo_SetDesc(s->alinfo, key, desc)) {
+        return false;
+    }
+
+    return true;
+}
+
+static bool
+read_path_assign(Scanner *s) {
+    s->p += strlen("PATH");
+    if (!read_char(s, '=') || *s->p == '=') {
+        return false;
+    }
+
+    CapRcScanResult *r = s->result;
+    if (!read_string(s, r->path, sizeof r->path)) {
+        return false;
+    }
+
+    r->has_path = true;
+    return true;
+}
+
+static bool
+read_statement(Scanner *s) {
+    bool ok = false;
+    if (is_match(s, "alias.set")) {
+        ok = read_alias_set(s);
+    } else if (is_match(s, "PATH")) {
+        ok = read_path_assign(s);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    // one statement per line
+    skip_blanks(s);
+    return *s->p == '\n' || is_match(s, "@}");
+}
+
+static bool
+read_code_block(Scanner *s) {
+    s->p += strlen("{@");
+
+    for (;;) {
+        skip_blanks(s);
+        if (*s->p == '\n') {
+            ++s->p;
+        } else if (is_match(s, "@}")) {
+            s->p += strlen("@}");
+            return true;
+        } else if (*s->p == '\0') {
+            return false;
+        } else if (!read_statement(s)) {
+            return false;
+        }
+    }
+}
+
+static bool
+read_text(Scanner *s) {
+    CapRcScanResult *r = s->result;
+
+    for (; *s->p && !is_match(s, "{@"); ++s->p) {
+        char c = *s->p;
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            // text and {: :} blocks
+            return false;
+        }
+        if (s->outlen >= sizeof(r->stdout_buf) - 1) {
+            return false;
+        }
+        r->stdout_buf[s->outlen++] = c;
+    }
+
+    r->stdout_buf[s->outlen] = '\0';
+    return true;
+}
+
+bool
+CapRcScanner_Scan(CapRcScanResult *result, CapAliasInfo *alinfo, const char *src) {
+    if (!result || !src) {
+        return false;
+    }
+
+    *result = (CapRcScanResult) {0};
+    Scanner s = {
+        .p = src,
+        .result = result,
+        .alinfo = alinfo,
+    };
+
+    for (;;) {
+        if (!read_text(&s)) {
+            return false;
+        }
+        if (*s.p == '\0') {
+            break;
+        }
+        if (!read_code_block(&s)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const char *
+CapRcScanResult_PopNewlineOfStdoutBuf(CapRcScanResult *result) {
+    char *buf = result->stdout_buf;
+    size_t len = strlen(buf);
+
+    if (len && buf[len-1] == '\n') {
+        buf[--len] = '\0';
+    }
+    if (len && buf[len-1] == '\r') {
+        buf[--len] = '\0';
+    }
+
+    return buf;
+}
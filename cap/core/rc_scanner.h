@@ -0,0 +1,66 @@
+/**
+ * Scanner of declarative resource files (.caprc)
+ *
+ * 多くの .caprc は alias.set の呼び出しと PATH への代入しか持たない
+ * このスキャナはそのようなソースを Pad の言語処理系を起動せずに読み込む
+ * 以下の文法以外の構文を見つけたら失敗し、呼び出し側は CapKit で評価する
+ *
+ *      source     := ( blank | code-block )*
+ *      code-block := "{@" ( statement? "\n" )* statement? "@}"
+ *      statement  := "alias.set(" string "," string ( "," string )? ")"
+ *                  | "PATH" "=" string
+ *      string     := '"' characters without '"', '\\' and newline '"'
+ *
+ * blank は空白、タブ、改行のみ。コメントやエスケープシーケンスは扱わない
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <pad/lib/file.h>
+#include <pad/lib/dict.h>
+
+#include <cap/core/alias_info.h>
+
+/**
+ * Numbers
+ */
+enum {
+    CAP_RC_SCANNER__STDOUT_SIZE = 256,
+};
+
+/**
+ * Result of scan
+ */
+typedef struct {
+    bool has_path;  // PATH was assigned
+    char path[PAD_FILE__NPATH];  // value of PATH
+    char stdout_buf[CAP_RC_SCANNER__STDOUT_SIZE];  // text outside of code blocks
+} CapRcScanResult;
+
+/**
+ * Scan source of resource file
+ * If source has constructs out of grammar then returns false and result is undefined
+ * In that case, aliases may be partially stored in alinfo
+ *
+ * @param[out] *result pointer to destination
+ * @param[out] *alinfo pointer to destination of aliases (can be NULL)
+ * @param[in]  *src    source of resource file
+ *
+ * @return scanned to true else false
+ */
+bool
+CapRcScanner_Scan(CapRcScanResult *result, CapAliasInfo *alinfo, const char *src);
+
+/**
+ * Get standard output of source like PadCtx_PopNewlineOfStdoutBuf
+ * The last newline is removed from stdout_buf
+ *
+ * @param[in] *result pointer to CapRcScanResult
+ *
+ * @return pointer to string
+ */
+const char *
+CapRcScanResult_PopNewlineOfStdoutBuf(CapRcScanResult *result);
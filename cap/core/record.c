@@ -0,0 +1,76 @@
+#include <cap/core/record.h>
+
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+static const uint32_t FNV32_OFFSET = 2166136261u;
+static const uint32_t FNV32_PRIME = 16777619u;
+
+int
+CapRecord_SplitFields(char *line, char *fields[], int nfields) {
+    int n = 0;
+    for (char *p = line; n < nfields; ) {
+        fields[n++] = p;
+        char *tab = strchr(p, '\t');
+        if (!tab) {
+            break;
+        }
+        *tab = '\0';
+        p = tab + 1;
+    }
+    return n;
+}
+
+bool
+CapRecord_IsField(const char *s) {
+    return s && !strpbrk(s, "\t\r\n");
+}
+
+bool
+CapRecord_IsRacy(int64_t mtime) {
+    return mtime >= (int64_t) time(NULL) - CAP_RECORD__RACY_SECONDS;
+}
+
+static bool
+is_ident_char(char c) {
+    return isalnum((unsigned char) c) || c == '_';
+}
+
+bool
+CapRecord_HasWord(const char *src, const char *word) {
+    size_t len = strlen(word);
+    if (!len) {
+        return false;
+    }
+
+    for (const char *p = src; (p = strstr(p, word)); p += len) {
+        if ((p == src || !is_ident_char(p[-1])) && !is_ident_char(p[len])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t
+CapRecord_Hash(uint64_t h, const void *p, size_t len) {
+    const unsigned char *s = p;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= s[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+uint64_t
+CapRecord_HashStr(const char *s) {
+    return CapRecord_Hash(CAP_RECORD__HASH_INIT, s, strlen(s));
+}
+
+uint32_t
+CapRecord_HashStr32(const char *s) {
+    uint32_t h = FNV32_OFFSET;
+    for (const unsigned char *p = (const unsigned char *) s; *p; ++p) {
+        h ^= *p;
+        h *= FNV32_PRIME;
+    }
+    return h;
+}
@@ -0,0 +1,106 @@
+/**
+ * Records of cache files
+ *
+ * キャッシュファイル（コマンドキャッシュ、プログラムのハッシュ、スニペットとリンクの索引、状態、bake のマニフェスト）で共通の処理
+ * レコードは 1 行で、フィールドはタブで区切る。タブと改行を含む文字列はフィールドにできない
+ * 最近（数秒以内）に変更されたファイルは、同じ秒の次の変更を mtime で検出できないのでキャッシュしない
+ * キャッシュとハッシュテーブルのハッシュは FNV-1a
+ * ソースをキャッシュできるかは、ソースに含まれる単語（識別子）で判定する
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+/**
+ * Numbers
+ */
+enum {
+    CAP_RECORD__RACY_SECONDS = 2,
+};
+
+/**
+ * Initial value of CapRecord_Hash
+ */
+#define CAP_RECORD__HASH_INIT 14695981039346656037ULL
+
+/**
+ * Split line by tab. Tabs in line are replaced by nul
+ *
+ * @param[in]  *line   line of record
+ * @param[out] *fields destination of fields
+ * @param[in]  nfields max number of fields
+ *
+ * @return number of fields
+ */
+int
+CapRecord_SplitFields(char *line, char *fields[], int nfields);
+
+/**
+ * Check string can be field of record
+ *
+ * @param[in] *s string
+ *
+ * @return string has not tab and newline to true else false
+ */
+bool
+CapRecord_IsField(const char *s);
+
+/**
+ * Check file of mtime was modified in last few seconds
+ * The stamp of racy file is not cached
+ *
+ * @param[in] mtime mtime of file
+ *
+ * @return racy to true else false
+ */
+bool
+CapRecord_IsRacy(int64_t mtime);
+
+/**
+ * Hash bytes by FNV-1a (64 bit)
+ *
+ * @param[in] h    initial value (CAP_RECORD__HASH_INIT) or hash of previous bytes
+ * @param[in] *p   bytes
+ * @param[in] len  number of bytes
+ *
+ * @return hash
+ */
+uint64_t
+CapRecord_Hash(uint64_t h, const void *p, size_t len);
+
+/**
+ * Hash string by FNV-1a (64 bit)
+ *
+ * @param[in] *s string
+ *
+ * @return hash
+ */
+uint64_t
+CapRecord_HashStr(const char *s);
+
+/**
+ * Check source has word. The word is not part of other identifier
+ * For example "file" is found in "file.read" but not in "Makefile" and "profile"
+ *
+ * @param[in] *src  source
+ * @param[in] *word word (identifier)
+ *
+ * @return found to true else false
+ */
+bool
+CapRecord_HasWord(const char *src, const char *word);
+
+/**
+ * Hash string by FNV-1a (32 bit) for hash tables
+ *
+ * @param[in] *s string
+ *
+ * @return hash
+ */
+uint32_t
+CapRecord_HashStr32(const char *s);
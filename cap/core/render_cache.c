@@ -0,0 +1,315 @@
+#include <cap/core/render_cache.h>
+
+/**
+ * Numbers
+ */
+enum {
+    COPY_SIZE = 1024 * 64,
+};
+
+/**
+ * Words in source that make result of render not determined by content
+ */
+static const char *UNCACHEABLE_WORDS[] = {
+    "exec",  // depends on result of commands
+    "file",  // depends on file system
+    NULL,
+};
+
+static const char OUT_EXT[] = ".out";
+
+CapRenderCacheKey *
+CapRenderCacheKey_Init(
+    CapRenderCacheKey *key,
+    const CapConfig *config,
+    const char *path,
+    const char *src,
+    int argc,
+    char *argv[]
+) {
+    // imports are solved by path of template and scope
+    char scope[32];
+    snprintf(scope, sizeof scope, "%d", config->scope);
+    char *env[] = {
+        (char *) (path ? path : ""),
+        scope,
+        (char *) config->cd_path,
+        (char *) config->home_path,
+    };
+
+    uint64_t hashes[] = {
+        CapBake_HashArgs(argc, argv),
+        CapBake_HashArgs(sizeof env / sizeof env[0], env),
+    };
+
+    *key = (CapRenderCacheKey) {
+        .src_hash = CapBake_HashStr(src),
+        .args_hash = CapBake_HashBytes(hashes, sizeof hashes),
+    };
+    return key;
+}
+
+bool
+CapRenderCache_IsCacheable(const char *src) {
+    if (!src) {
+        return false;
+    }
+
+    for (const char **w = UNCACHEABLE_WORDS; *w; ++w) {
+        if (CapRecord_HasWord(src, *w)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Make name of entry of key. Path of output is name with OUT_EXT
+ */
+static bool
+make_name(char *dst, uint32_t dstsz, const CapRenderCacheKey *key) {
+    int n = snprintf(dst, dstsz, "%016llx%016llx",
+        (unsigned long long) key->src_hash,
+        (unsigned long long) key->args_hash
+    );
+    return n >= 0 && (uint32_t) n < dstsz;
+}
+
+static bool
+make_path(char *dst, uint32_t dstsz, const char *dirpath, const char *name, const char *ext) {
+    int n = snprintf(dst, dstsz, "%s%c%s%s", dirpath, PAD_FILE__SEP, name, ext);
+    return n >= 0 && (uint32_t) n < dstsz;
+}
+
+char *
+CapRenderCache_Find(char *dst, uint32_t dstsz, const char *dirpath, const CapRenderCacheKey *key) {
+    if (!dst || !dirpath || !key) {
+        return NULL;
+    }
+
+    char name[64];
+    char entry_path[PAD_FILE__NPATH];
+    char out_name[64 + sizeof OUT_EXT];
+    if (!make_name(name, sizeof name, key) ||
+        !make_path(entry_path, sizeof entry_path, dirpath, name, "") ||
+        !make_path(dst, dstsz, dirpath, name, OUT_EXT)) {
+        return NULL;
+    }
+    snprintf(out_name, sizeof out_name, "%s%s", name, OUT_EXT);
+
+    CapBakeManifest *manifest = CapBakeManifest_New();
+    if (!manifest) {
+        return NULL;
+    }
+
+    char *result = NULL;
+    if (!CapBakeManifest_Load(manifest, entry_path)) {
+        goto done;  // miss
+    }
+
+    const CapBakeEntry *entry = CapBakeManifest_Find(manifest, out_name);
+    if (!entry ||
+        entry->src_hash != key->src_hash ||
+        entry->args_hash != key->args_hash ||
+        !CapBakeEntry_IsDepsFresh(entry) ||
+        !PadFile_IsExists(dst)) {
+        goto done;
+    }
+
+    result = dst;
+done:
+    CapBakeManifest_Del(manifest);
+    return result;
+}
+
+/**
+ * Copy bytes of file to sink by read
+ */
+static bool
+copy_to_sink(CapSink *sink, int fin, off_t len) {
+    char buf[COPY_SIZE];
+    while (len > 0) {
+        ssize_t n = read(fin, buf, len < (off_t) sizeof buf ? (size_t) len : sizeof buf);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        if (!CapSink_Write(sink, buf, n)) {
+            return false;
+        }
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * Copy bytes of file by read and write
+ */
+static bool
+copy_fd(int fd, int fin, off_t len) {
+    CapSink *sink = CapSink_NewFd(fd);
+    if (!sink) {
+        return false;
+    }
+
+    bool ok = copy_to_sink(sink, fin, len);
+    ok = CapSink_Close(sink) && ok;
+    CapSink_Del(sink);
+    return ok;
+}
+
+/**
+ * Open output of render and get number of bytes to send
+ *
+ * @return success to file descriptor, failed to -1
+ */
+static int
+open_output(const char *path, bool pop_last_newline, off_t *len) {
+    int fin = open(path, O_RDONLY);
+    if (fin < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fin, &st) != 0) {
+        close(fin);
+        return -1;
+    }
+
+    *len = st.st_size;
+    if (pop_last_newline && *len > 0) {
+        char c;
+        if (lseek(fin, *len - 1, SEEK_SET) < 0 || read(fin, &c, 1) != 1 ||
+            lseek(fin, 0, SEEK_SET) < 0) {
+            close(fin);
+            return -1;
+        }
+        if (c == '\n') {
+            (*len)--;
+        }
+    }
+
+    return fin;
+}
+
+bool
+CapRenderCache_SendFile(const char *path, int fd, bool pop_last_newline) {
+    if (!path || fd < 0) {
+        return false;
+    }
+
+    off_t len;
+    int fin = open_output(path, pop_last_newline, &len);
+    if (fin < 0) {
+        return false;
+    }
+
+    off_t offset = 0;
+#ifdef __linux__
+    while (offset < len) {
+        ssize_t n = sendfile(fd, fin, &offset, len - offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;  // destination is not supported by sendfile. copy rest
+        }
+    }
+#endif
+
+    bool ok = lseek(fin, offset, SEEK_SET) == offset &&
+              copy_fd(fd, fin, len - offset);
+    close(fin);
+    return ok;
+}
+
+bool
+CapRenderCache_SendFileToSink(const char *path, CapSink *sink, bool pop_last_newline) {
+    if (!path || !sink) {
+        return false;
+    }
+
+    off_t len;
+    int fin = open_output(path, pop_last_newline, &len);
+    if (fin < 0) {
+        return false;
+    }
+
+    bool ok = copy_to_sink(sink, fin, len);
+    close(fin);
+    return ok;
+}
+
+/**
+ * Check imported modules are cacheable
+ */
+static bool
+is_cacheable_deps(const PadCStrAry *deps) {
+    for (int32_t i = 0; i < PadCStrAry_Len(deps); ++i) {
+        char *src = PadFile_ReadCopyFromPath(PadCStrAry_Getc(deps, i));
+        bool ok = CapRenderCache_IsCacheable(src);
+        free(src);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+CapRenderCache_Write(
+    const char *dirpath,
+    const CapRenderCacheKey *key,
+    const char *out,
+    const PadCStrAry *deps
+) {
+    if (!dirpath || !key || !out || !deps) {
+        return false;
+    }
+    if (!is_cacheable_deps(deps)) {
+        return false;
+    }
+
+    char name[64];
+    char entry_path[PAD_FILE__NPATH];
+    char out_path[PAD_FILE__NPATH];
+    if (!make_name(name, sizeof name, key) ||
+        !make_path(entry_path, sizeof entry_path, dirpath, name, "") ||
+        !make_path(out_path, sizeof out_path, dirpath, name, OUT_EXT)) {
+        return false;
+    }
+
+    if (!PadFile_IsExists(dirpath)) {
+        PadFile_MkdirQ(dirpath);
+    }
+
+    // output is written before entry. entry is not found without output
+    size_t len = strlen(out);
+    CapSink *sink = CapSink_NewAtomicFile(out_path);
+    bool ok = sink && CapSink_Write(sink, out, len) && CapSink_Close(sink);
+    CapSink_Del(sink);
+    if (!ok) {
+        return false;
+    }
+
+    char out_name[64 + sizeof OUT_EXT];
+    snprintf(out_name, sizeof out_name, "%s%s", name, OUT_EXT);
+    CapBakeEntry entry = {
+        .path = PadCStr_Dup(out_name),
+        .src_hash = key->src_hash,
+        .args_hash = key->args_hash,
+        .out_hash = CapBake_HashBytes(out, len),
+    };
+
+    CapBakeManifest *manifest = CapBakeManifest_New();
+    ok = manifest && entry.path &&
+         CapBakeEntry_SetDeps(&entry, deps) &&
+         CapBakeManifest_Add(manifest, &entry) &&
+         CapBakeManifest_Save(manifest, entry_path);
+
+    CapBakeManifest_Del(manifest);
+    CapBakeEntry_Fini(&entry);
+    return ok;
+}
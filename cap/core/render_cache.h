@@ -0,0 +1,140 @@
+/**
+ * Cache of results of render of templates
+ *
+ * テンプレートのレンダリング結果を ~/.cap/cache に保存する（cap make --cache、cap cat -m --cache）
+ * キーはソースのハッシュと、引数、テンプレートのパス、設定のスコープと cd、home のハッシュ
+ * エントリはキーごとに bake_manifest.h の形式で記録し、インポートしたモジュールのパスとハッシュを持つ
+ * モジュールが変わっていなければ、キットを作らずに保存した出力をそのまま書き出す
+ * exec やファイルを使うテンプレートは実行ごとに出力が変わりうるのでキャッシュしない
+ *
+ * Files in cache directory:
+ *
+ *      <src hash><args hash>      entry (manifest of one file)
+ *      <src hash><args hash>.out  output of render
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/cstring_array.h>
+
+#include <cap/core/config.h>
+#include <cap/core/sink.h>
+#include <cap/core/bake_manifest.h>
+
+#ifdef __linux__
+# include <sys/sendfile.h>
+#endif
+
+/**
+ * Key of cache of render
+ */
+typedef struct {
+    uint64_t src_hash;  // hash of source
+    uint64_t args_hash;  // hash of arguments, path of template and scope of config
+} CapRenderCacheKey;
+
+/**
+ * Make key of render
+ *
+ * @param[out] *key    pointer to destination
+ * @param[in]  *config pointer to CapConfig (read-only)
+ * @param[in]  *path   path of template or NULL if source is read from stdin
+ * @param[in]  *src    source of template
+ * @param[in]  argc    number of arguments
+ * @param[in]  *argv[] arguments
+ *
+ * @return pointer to key
+ */
+CapRenderCacheKey *
+CapRenderCacheKey_Init(
+    CapRenderCacheKey *key,
+    const CapConfig *config,
+    const char *path,
+    const char *src,
+    int argc,
+    char *argv[]
+);
+
+/**
+ * Check result of render of source can be cached
+ * The source that uses exec or file is not cacheable
+ * because the result is not determined by content
+ *
+ * @param[in] *src source of template or module
+ *
+ * @return cacheable to true else false
+ */
+bool
+CapRenderCache_IsCacheable(const char *src);
+
+/**
+ * Find output of render of key
+ * The output is found if imported modules are not changed
+ *
+ * @param[out] *dst     pointer to destination of path of output
+ * @param[in]  dstsz    number of size of destination
+ * @param[in]  *dirpath path of cache directory
+ * @param[in]  *key     key of render
+ *
+ * @return hit to pointer to dst
+ * @return miss to NULL
+ */
+char *
+CapRenderCache_Find(char *dst, uint32_t dstsz, const char *dirpath, const CapRenderCacheKey *key);
+
+/**
+ * Write output of file to file descriptor without copy to user space
+ * sendfile(2) is used on Linux, else read and write
+ *
+ * @param[in] *path            path of output
+ * @param[in] fd               file descriptor of destination
+ * @param[in] pop_last_newline if true then last newline of output is not written
+ *
+ * @return success to true else false
+ */
+bool
+CapRenderCache_SendFile(const char *path, int fd, bool pop_last_newline);
+
+/**
+ * Write output of file to sink
+ *
+ * @param[in] *path            path of output
+ * @param[in] *sink            pointer to CapSink of destination
+ * @param[in] pop_last_newline if true then last newline of output is not written
+ *
+ * @return success to true else false
+ */
+bool
+CapRenderCache_SendFileToSink(const char *path, CapSink *sink, bool pop_last_newline);
+
+/**
+ * Write output of render at cache
+ * Output is not written if imported modules are not cacheable
+ * Files are replaced by rename(2) after write to temporary file
+ *
+ * @param[in] *dirpath path of cache directory. the directory is created if not exists
+ * @param[in] *key     key of render
+ * @param[in] *out     output of render
+ * @param[in] *deps    paths of imported modules
+ *
+ * @return success to true else false
+ */
+bool
+CapRenderCache_Write(
+    const char *dirpath,
+    const CapRenderCacheKey *key,
+    const char *out,
+    const PadCStrAry *deps
+);
@@ -0,0 +1,323 @@
+#define _DEFAULT_SOURCE 1 /* cap: core/sink: realpath, mkstemp, fchmod */
+#include <cap/core/sink.h>
+
+typedef enum {
+    SINK_FD,
+    SINK_FILE,
+    SINK_FUNC,
+    SINK_ATOMIC_FILE,
+} SinkType;
+
+struct CapSink {
+    SinkType type;
+    int fd;
+    FILE *fp;  // stream or temporary file of atomic file
+    CapSinkWriteFunc func;
+    void *arg;
+    char *path;  // path of atomic file
+    char *tmppath;  // path of temporary file of atomic file
+    bool is_pop_last_newline;
+    bool has_newline;  // last newline is held
+    bool is_closed;
+    bool is_err;
+};
+
+void
+CapSink_Del(CapSink *self) {
+    if (!self) {
+        return;
+    }
+
+    if (self->type == SINK_ATOMIC_FILE && !self->is_closed) {
+        if (self->fp) {
+            fclose(self->fp);
+        }
+        PadFile_Remove(self->tmppath);
+    }
+
+    free(self->path);
+    free(self->tmppath);
+    free(self);
+}
+
+static CapSink *
+sink_new(SinkType type) {
+    CapSink *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->type = type;
+    self->fd = -1;
+    return self;
+}
+
+CapSink *
+CapSink_NewFd(int fd) {
+    if (fd < 0) {
+        return NULL;
+    }
+
+    CapSink *self = sink_new(SINK_FD);
+    if (self) {
+        self->fd = fd;
+    }
+    return self;
+}
+
+CapSink *
+CapSink_NewFile(FILE *fp) {
+    if (!fp) {
+        return NULL;
+    }
+
+    CapSink *self = sink_new(SINK_FILE);
+    if (self) {
+        self->fp = fp;
+    }
+    return self;
+}
+
+CapSink *
+CapSink_NewFunc(CapSinkWriteFunc func, void *arg) {
+    if (!func) {
+        return NULL;
+    }
+
+    CapSink *self = sink_new(SINK_FUNC);
+    if (self) {
+        self->func = func;
+        self->arg = arg;
+    }
+    return self;
+}
+
+/**
+ * Duplicate path of file. Symlink of file system is followed
+ * so that rename replaces the target and keeps the link
+ */
+static char *
+dup_target_path(const char *path) {
+#ifndef CAP__WINDOWS
+    char *real = realpath(path, NULL);
+    if (real) {
+        return real;
+    }
+#endif
+    return PadCStr_Dup(path);  // not exists yet
+}
+
+#ifndef CAP__WINDOWS
+/**
+ * Mode of new file. umask is read once because umask(2) cannot read it without change
+ */
+static pthread_once_t new_file_mode_once = PTHREAD_ONCE_INIT;
+static mode_t new_file_mode;
+
+static void
+init_new_file_mode(void) {
+    mode_t mask = umask(0);
+    umask(mask);
+    new_file_mode = 0666 & ~mask;
+}
+
+/**
+ * Create temporary file by mkstemp. tmppath is template of mkstemp
+ * The mode is set to mode of new file because mkstemp creates file readable only by owner
+ * Mode of existing file is set by close
+ */
+static FILE *
+open_tmpfile(char *tmppath) {
+    int fd = mkstemp(tmppath);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    pthread_once(&new_file_mode_once, init_new_file_mode);
+
+    FILE *fp = NULL;
+    if (fchmod(fd, new_file_mode) != 0 || !(fp = fdopen(fd, "wb"))) {
+        close(fd);
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+    return fp;
+}
+#else
+static pthread_mutex_t tmpfile_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t tmpfile_count;
+
+/**
+ * Create temporary file. Name is unique by number of process and counter
+ * tmppath has template of mkstemp and the XXXXXX is replaced
+ */
+static FILE *
+open_tmpfile(char *tmppath) {
+    pthread_mutex_lock(&tmpfile_mutex);
+    uint32_t count = tmpfile_count++;
+    pthread_mutex_unlock(&tmpfile_mutex);
+
+    size_t len = strlen(tmppath);
+    snprintf(tmppath + len - 6, 7, "%06x", (unsigned) (count & 0xffffff));
+    return fopen(tmppath, "wbx");
+}
+#endif
+
+CapSink *
+CapSink_NewAtomicFile(const char *path) {
+    if (!path) {
+        return NULL;
+    }
+
+    CapSink *self = sink_new(SINK_ATOMIC_FILE);
+    if (!self) {
+        return NULL;
+    }
+
+    self->path = dup_target_path(path);
+    if (!self->path) {
+        goto error;
+    }
+
+    // temporary file is in same directory for rename. the name is unique in threads and processes
+    char tmppath[PAD_FILE__NPATH];
+    if (snprintf(tmppath, sizeof tmppath, "%s.%ld.XXXXXX", self->path, (long) getpid()) >= (int) sizeof tmppath) {
+        goto error;
+    }
+
+    self->fp = open_tmpfile(tmppath);
+    if (!self->fp) {
+        goto error;
+    }
+
+    self->tmppath = PadCStr_Dup(tmppath);
+    if (!self->tmppath) {
+        fclose(self->fp);
+        self->fp = NULL;
+        PadFile_Remove(tmppath);
+        goto error;
+    }
+
+    return self;
+error:
+    self->is_closed = true;  // temporary file is not created
+    CapSink_Del(self);
+    return NULL;
+}
+
+CapSink *
+CapSink_PopLastNewline(CapSink *self) {
+    if (self) {
+        self->is_pop_last_newline = true;
+    }
+    return self;
+}
+
+static bool
+write_fd(int fd, const char *data, size_t len) {
+    while (len) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool
+write_raw(CapSink *self, const char *data, size_t len) {
+    if (!len) {
+        return true;
+    }
+
+    switch (self->type) {
+    case SINK_FD:
+        return write_fd(self->fd, data, len);
+    case SINK_FILE:
+    case SINK_ATOMIC_FILE:
+        return fwrite(data, 1, len, self->fp) == len;
+    case SINK_FUNC:
+        return self->func(self->arg, data, len);
+    }
+
+    return false;
+}
+
+bool
+CapSink_Write(CapSink *self, const char *data, size_t len) {
+    if (!self || !data || self->is_closed) {
+        return false;
+    }
+    if (!len) {
+        return true;
+    }
+
+    if (self->is_pop_last_newline) {
+        if (self->has_newline) {
+            self->has_newline = false;
+            if (!write_raw(self, "\n", 1)) {
+                self->is_err = true;
+            }
+        }
+        if (data[len - 1] == '\n') {
+            self->has_newline = true;
+            len--;
+        }
+    }
+
+    if (!write_raw(self, data, len)) {
+        self->is_err = true;
+    }
+
+    return !self->is_err;
+}
+
+static bool
+close_atomic_file(CapSink *self) {
+    bool ok = fclose(self->fp) == 0 && !self->is_err;
+    self->fp = NULL;
+
+    struct stat st;
+    if (ok && stat(self->path, &st) == 0) {
+        chmod(self->tmppath, st.st_mode & 07777);
+    }
+
+    if (!ok || PadFile_Rename(self->tmppath, self->path) != 0) {
+        PadFile_Remove(self->tmppath);
+        return false;
+    }
+
+    return true;
+}
+
+bool
+CapSink_Close(CapSink *self) {
+    if (!self || self->is_closed) {
+        return false;
+    }
+
+    self->is_closed = true;
+
+    switch (self->type) {
+    case SINK_FD:
+    case SINK_FUNC:
+        break;
+    case SINK_FILE:
+        if (fflush(self->fp) != 0) {
+            self->is_err = true;
+        }
+        break;
+    case SINK_ATOMIC_FILE:
+        if (!close_atomic_file(self)) {
+            self->is_err = true;
+        }
+        break;
+    }
+
+    return !self->is_err;
+}
@@ -0,0 +1,127 @@
+/**
+ * Sink of output of templates
+ *
+ * テンプレートの出力の書き込み先を抽象化する
+ * 書き込み先はファイルディスクリプタ、FILE、コールバックとアトミックなファイルのいずれか
+ * アトミックなファイルは同じディレクトリの一時ファイルに書き込み、CapSink_Close でリネームする
+ * パスがシンボリックリンクの場合はリンク先を置き換え、リンクは残す
+ * CapSink_Close を呼ばずに CapSink_Del した場合は一時ファイルを削除し、書き込み先は変更しない
+ *
+ * 最後の改行を取り除く設定では、改行を次の書き込みまで保留し、CapSink_Close で捨てる
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/constant.h>
+
+/**
+ * Function of callback of sink
+ *
+ * @param[in] *arg  argument of callback
+ * @param[in] *data bytes
+ * @param[in] len   number of bytes
+ *
+ * @return success to true, failed to false
+ */
+typedef bool (*CapSinkWriteFunc)(void *arg, const char *data, size_t len);
+
+struct CapSink;
+typedef struct CapSink CapSink;
+
+/**
+ * Destruct sink
+ * Temporary file of atomic file is removed if sink is not closed
+ *
+ * @param[in] *self pointer to CapSink
+ */
+void
+CapSink_Del(CapSink *self);
+
+/**
+ * Construct sink of file descriptor. The descriptor is not closed
+ *
+ * @param[in] fd file descriptor
+ *
+ * @return success to pointer to CapSink, failed to NULL
+ */
+CapSink *
+CapSink_NewFd(int fd);
+
+/**
+ * Construct sink of stream. The stream is flushed by close but not closed
+ *
+ * @param[in] *fp pointer to FILE
+ *
+ * @return success to pointer to CapSink, failed to NULL
+ */
+CapSink *
+CapSink_NewFile(FILE *fp);
+
+/**
+ * Construct sink of callback
+ *
+ * @param[in] func callback
+ * @param[in] *arg argument of callback
+ *
+ * @return success to pointer to CapSink, failed to NULL
+ */
+CapSink *
+CapSink_NewFunc(CapSinkWriteFunc func, void *arg);
+
+/**
+ * Construct sink of atomic file
+ * Output is written to temporary file and renamed to path by close
+ * Mode of existing file is kept. If path is symlink then target of link is replaced
+ *
+ * @param[in] *path path of file
+ *
+ * @return success to pointer to CapSink, failed to NULL
+ */
+CapSink *
+CapSink_NewAtomicFile(const char *path);
+
+/**
+ * Remove last newline of output
+ *
+ * @param[in] *self pointer to CapSink
+ *
+ * @return pointer to self
+ */
+CapSink *
+CapSink_PopLastNewline(CapSink *self);
+
+/**
+ * Write bytes
+ *
+ * @param[in] *self pointer to CapSink
+ * @param[in] *data bytes
+ * @param[in] len   number of bytes
+ *
+ * @return success to true, failed to false
+ */
+bool
+CapSink_Write(CapSink *self, const char *data, size_t len);
+
+/**
+ * Finish output. Atomic file is renamed to path
+ *
+ * @param[in] *self pointer to CapSink
+ *
+ * @return all writes succeeded to true, else false
+ */
+bool
+CapSink_Close(CapSink *self);
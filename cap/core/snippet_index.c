@@ -0,0 +1,297 @@
+#include <cap/core/snippet_index.h>
+
+/**
+ * Numbers
+ */
+enum {
+    LINE_SIZE = PAD_FILE__NPATH + 256,
+};
+
+/**
+ * Structure of index
+ */
+struct CapSnptIndex {
+    char dirpath[PAD_FILE__NPATH];  // path of directory of snippets
+    CapSymlinkStamp stamp;  // stamp of directory at indexing
+    PadCStrAry *names;  // sorted file names
+};
+
+static const char INDEX_SIGNATURE[] = "cap snippet index 2";
+
+void
+CapSnptIndex_Del(CapSnptIndex *self) {
+    if (!self) {
+        return;
+    }
+
+    PadCStrAry_Del(self->names);
+    Pad_SafeFree(self);
+}
+
+CapSnptIndex *
+CapSnptIndex_New(void) {
+    CapSnptIndex *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->names = PadCStrAry_New();
+    if (!self->names) {
+        CapSnptIndex_Del(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+/**
+ * Clear names and set directory
+ */
+static CapSnptIndex *
+reset(CapSnptIndex *self, const char *dirpath) {
+    PadCStrAry *names = PadCStrAry_New();
+    if (!names) {
+        return NULL;
+    }
+
+    PadCStrAry_Del(self->names);
+    self->names = names;
+    self->stamp = (CapSymlinkStamp) {0};
+    snprintf(self->dirpath, sizeof self->dirpath, "%s", dirpath);
+    return self;
+}
+
+/**
+ * Load stamp of directory
+ * If directory was modified in last few seconds then the stamp never matches
+ * because next modification in same second is not detected by mtime
+ */
+static void
+load_stamp(CapSnptIndex *self) {
+    CapSymlinkStamp_Load(&self->stamp, self->dirpath);
+    if (self->stamp.exists && CapRecord_IsRacy(self->stamp.mtime)) {
+        self->stamp.mtime = -1;
+    }
+}
+
+static bool
+load_lines(CapSnptIndex *self, FILE *fin, char *line, const char *dirpath) {
+    if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF ||
+        strcmp(line, INDEX_SIGNATURE)) {
+        return false;
+    }
+
+    char *fields[9];
+    if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF ||
+        CapRecord_SplitFields(line, fields, 9) != 9 ||
+        !PadCStr_Eq(fields[0], "dir") ||
+        !PadCStr_Eq(fields[8], dirpath)) {
+        return false;
+    }
+
+    CapSymlinkStamp stamp;
+    CapSymlinkStamp_Read(&stamp, fields + 1);
+
+    // validate before read of names
+    CapSymlinkStamp cur;
+    CapSymlinkStamp_Load(&cur, dirpath);
+    if (!CapSymlinkStamp_Eq(&stamp, &cur)) {
+        return false;
+    }
+
+    if (!reset(self, dirpath)) {
+        return false;
+    }
+    self->stamp = stamp;
+
+    for (;;) {
+        if (PadFile_GetLine(line, LINE_SIZE, fin) == EOF) {
+            break;
+        }
+        if (CapRecord_SplitFields(line, fields, 2) != 2 || !PadCStr_Eq(fields[0], "name")) {
+            return false;
+        }
+        if (!PadCStrAry_PushBack(self->names, fields[1])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+CapSnptIndex *
+CapSnptIndex_Load(CapSnptIndex *self, const char *path, const char *dirpath) {
+    if (!self || !path || !dirpath) {
+        return NULL;
+    }
+
+    FILE *fin = fopen(path, "r");
+    if (!fin) {
+        return NULL;
+    }
+
+    char *line = PadMem_Malloc(LINE_SIZE);
+    bool is_valid = line && load_lines(self, fin, line, dirpath);
+    Pad_SafeFree(line);
+    fclose(fin);
+
+    if (!is_valid) {
+        reset(self, dirpath);
+        return NULL;
+    }
+
+    return self;
+}
+
+static bool
+is_savable(const CapSnptIndex *self) {
+    if (strpbrk(self->dirpath, "\t\r\n")) {
+        return false;
+    }
+    for (int32_t i = 0; i < PadCStrAry_Len(self->names); ++i) {
+        if (strpbrk(PadCStrAry_Getc(self->names, i), "\r\n")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CapSnptIndex *
+CapSnptIndex_Save(CapSnptIndex *self, const char *path) {
+    if (!self || !path || !is_savable(self)) {
+        return NULL;
+    }
+
+    // other processes may save same index at same time
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.%ld.tmp", path, (long) getpid());
+
+    FILE *fout = fopen(tmppath, "w");
+    if (!fout) {
+        return NULL;
+    }
+
+    fprintf(fout, "%s\n", INDEX_SIGNATURE);
+    fprintf(fout, "dir");
+    CapSymlinkStamp_Write(&self->stamp, fout);
+    fprintf(fout, "\t%s\n", self->dirpath);
+    for (int32_t i = 0; i < PadCStrAry_Len(self->names); ++i) {
+        fprintf(fout, "name\t%s\n", PadCStrAry_Getc(self->names, i));
+    }
+
+    if (fclose(fout) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    if (PadFile_Rename(tmppath, path) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    return self;
+}
+
+CapSnptIndex *
+CapSnptIndex_Scan(CapSnptIndex *self, const char *dirpath) {
+    if (!self || !dirpath) {
+        return NULL;
+    }
+
+    if (!reset(self, dirpath)) {
+        return NULL;
+    }
+
+    // stamp before read of directory
+    load_stamp(self);
+
+    PadDir *dir = PadDir_Open(dirpath);
+    if (!dir) {
+        return NULL;
+    }
+
+    for (PadDirNode *node; (node = PadDir_Read(dir)); PadDirNode_Del(node)) {
+        const char *name = PadDirNode_Name(node);
+        if (!strcmp(name, ".") || !strcmp(name, "..")) {
+            continue;
+        }
+        if (!PadCStrAry_PushBack(self->names, name)) {
+            PadDirNode_Del(node);
+            PadDir_Close(dir);
+            return NULL;
+        }
+    }
+
+    PadDir_Close(dir);
+    PadCStrAry_Sort(self->names);
+    return self;
+}
+
+CapSnptIndex *
+CapSnptIndex_Update(CapSnptIndex *self, const CapConfig *config) {
+    if (!self || !config) {
+        return NULL;
+    }
+
+    if (CapSnptIndex_Load(self, config->var_snippets_path, config->codes_dir_path)) {
+        return self;
+    }
+
+    if (!CapSnptIndex_Scan(self, config->codes_dir_path)) {
+        return NULL;
+    }
+
+    // failure of save is not error. next time scans again
+    CapSnptIndex_Save(self, config->var_snippets_path);
+    return self;
+}
+
+bool
+CapSnptIndex_IsFresh(const CapSnptIndex *self) {
+    if (!self || !self->dirpath[0]) {
+        return false;
+    }
+
+    CapSymlinkStamp cur;
+    CapSymlinkStamp_Load(&cur, self->dirpath);
+    return CapSymlinkStamp_Eq(&self->stamp, &cur);
+}
+
+CapSnptIndex *
+CapSnptIndex_Add(CapSnptIndex *self, const char *name) {
+    if (!self || !name) {
+        return NULL;
+    }
+
+    bool has = false;
+    for (int32_t i = 0; i < PadCStrAry_Len(self->names); ++i) {
+        if (PadCStr_Eq(PadCStrAry_Getc(self->names, i), name)) {
+            has = true;
+            break;
+        }
+    }
+
+    if (!has) {
+        if (!PadCStrAry_PushBack(self->names, name)) {
+            return NULL;
+        }
+        PadCStrAry_Sort(self->names);
+    }
+
+    load_stamp(self);
+    return self;
+}
+
+int32_t
+CapSnptIndex_Len(const CapSnptIndex *self) {
+    return self ? PadCStrAry_Len(self->names) : 0;
+}
+
+const char *
+CapSnptIndex_GetcNameAt(const CapSnptIndex *self, int32_t index) {
+    if (!self || index < 0 || index >= PadCStrAry_Len(self->names)) {
+        return NULL;
+    }
+
+    return PadCStrAry_Getc(self->names, index);
+}
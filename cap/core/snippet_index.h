@@ -0,0 +1,152 @@
+/**
+ * Index of snippet codes
+ *
+ * スニペットのディレクトリ（~/.cap/codes）のファイル名を ~/.cap/var/snippets に記録する
+ * cap snippet ls はディレクトリを読まずにインデックスからファイル名を表示する
+ * cap snippet add と clear はインデックスを更新する
+ *
+ * インデックスは作成時のディレクトリのスタンプを持つ
+ * cap 以外でディレクトリが変更されるとスタンプが一致しなくなり、ディレクトリを読み直してインデックスを作り直す
+ * インデックスをスニペットのディレクトリに置かないのは、インデックスの保存自体がディレクトリの mtime を変えるため
+ *
+ * The format of file is text:
+ *
+ *      cap snippet index 2
+ *      dir <TAB> exists <TAB> dev <TAB> ino <TAB> mtime <TAB> mtime_nsec <TAB> size <TAB> mode <TAB> /path/of/codes
+ *      name <TAB> file name
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/cstring_array.h>
+
+#include <cap/core/config.h>
+#include <cap/core/symlink_cache.h>
+#include <cap/core/record.h>
+
+struct CapSnptIndex;
+typedef struct CapSnptIndex CapSnptIndex;
+
+/**
+ * Destruct index
+ *
+ * @param[in] *self pointer to CapSnptIndex
+ */
+void
+CapSnptIndex_Del(CapSnptIndex *self);
+
+/**
+ * Construct index
+ *
+ * @return success to pointer to CapSnptIndex (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapSnptIndex *
+CapSnptIndex_New(void);
+
+/**
+ * Load index from file
+ * The index is valid if it was made for dirpath and the directory was not changed after that
+ *
+ * @param[in] *self    pointer to CapSnptIndex
+ * @param[in] *path    path of index file
+ * @param[in] *dirpath path of directory of snippets
+ *
+ * @return valid to pointer to self
+ * @return not exists, broken or stale to NULL
+ */
+CapSnptIndex *
+CapSnptIndex_Load(CapSnptIndex *self, const char *path, const char *dirpath);
+
+/**
+ * Save index at file
+ * The file is replaced by rename(2) after write to temporary file
+ *
+ * @param[in] *self pointer to CapSnptIndex
+ * @param[in] *path path of index file
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSnptIndex *
+CapSnptIndex_Save(CapSnptIndex *self, const char *path);
+
+/**
+ * Make index by read of directory
+ *
+ * @param[in] *self    pointer to CapSnptIndex
+ * @param[in] *dirpath path of directory of snippets
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSnptIndex *
+CapSnptIndex_Scan(CapSnptIndex *self, const char *dirpath);
+
+/**
+ * Load index of config->codes_dir_path from config->var_snippets_path
+ * If index is not valid then scan directory and save index
+ *
+ * @param[in] *self   pointer to CapSnptIndex
+ * @param[in] *config pointer to CapConfig
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSnptIndex *
+CapSnptIndex_Update(CapSnptIndex *self, const CapConfig *config);
+
+/**
+ * Check directory was not changed after index was made
+ * Index of racy directory is not fresh
+ *
+ * @param[in] *self pointer to CapSnptIndex
+ *
+ * @return fresh to true else false
+ */
+bool
+CapSnptIndex_IsFresh(const CapSnptIndex *self);
+
+/**
+ * Add file name to index and stamp directory again
+ * Call this after the file was created in directory
+ *
+ * @param[in] *self pointer to CapSnptIndex
+ * @param[in] *name file name
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSnptIndex *
+CapSnptIndex_Add(CapSnptIndex *self, const char *name);
+
+/**
+ * Get number of file names
+ *
+ * @param[in] *self pointer to CapSnptIndex
+ *
+ * @return number of file names
+ */
+int32_t
+CapSnptIndex_Len(const CapSnptIndex *self);
+
+/**
+ * Get file name at index. file names are sorted
+ *
+ * @param[in] *self  pointer to CapSnptIndex
+ * @param[in] index  index of file name
+ *
+ * @return found to pointer to file name else NULL
+ */
+const char *
+CapSnptIndex_GetcNameAt(const CapSnptIndex *self, int32_t index);
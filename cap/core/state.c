@@ -0,0 +1,220 @@
+#include <cap/core/state.h>
+
+/**
+ * Numbers
+ */
+enum {
+    BUF_SIZE = PAD_FILE__NPATH * (CAP_STATE__MAX_DEPS + 3) + 1024,
+};
+
+static const char STATE_SIGNATURE[] = "cap state 2";
+
+/**
+ * Cut next line from buffer
+ *
+ * @return found to pointer to line else NULL
+ */
+static char *
+next_line(char **p) {
+    if (!**p) {
+        return NULL;
+    }
+
+    char *line = *p;
+    char *nl = strchr(line, '\n');
+    if (nl) {
+        *nl = '\0';
+        *p = nl + 1;
+    } else {
+        *p = line + strlen(line);
+    }
+    return line;
+}
+
+static bool
+copy_value(char *dst, const char *src) {
+    if (strlen(src) >= PAD_FILE__NPATH) {
+        return false;
+    }
+    strcpy(dst, src);
+    return true;
+}
+
+static bool
+load_dep(CapState *self, char *fields[]) {
+    if (self->ndeps >= CAP_STATE__MAX_DEPS) {
+        return false;
+    }
+
+    CapStateDep *dep = &self->deps[self->ndeps++];
+    CapSymlinkStamp_Read(&dep->stamp, fields + 1);
+    if (!copy_value(dep->path, fields[8])) {
+        return false;
+    }
+
+    CapSymlinkStamp cur;
+    CapSymlinkStamp_Load(&cur, dep->path);
+    return CapSymlinkStamp_Eq(&dep->stamp, &cur);
+}
+
+static bool
+load_lines(CapState *self, char *buf) {
+    char *p = buf;
+    char *line = next_line(&p);
+    if (!line || strcmp(line, STATE_SIGNATURE)) {
+        return false;
+    }
+
+    int nvalues = 0;
+    while ((line = next_line(&p))) {
+        char *fields[9];
+        int n = CapRecord_SplitFields(line, fields, 9);
+        if (n == 9 && PadCStr_Eq(fields[0], "dep")) {
+            if (!load_dep(self, fields)) {
+                return false;
+            }
+        } else if (n == 2 && PadCStr_Eq(fields[0], "cd")) {
+            nvalues += copy_value(self->cd_path, fields[1]);
+        } else if (n == 2 && PadCStr_Eq(fields[0], "home")) {
+            nvalues += copy_value(self->home_path, fields[1]);
+        } else if (n == 2 && PadCStr_Eq(fields[0], "editor")) {
+            nvalues += copy_value(self->editor, fields[1]);
+        } else {
+            return false;
+        }
+    }
+
+    return self->ndeps == CAP_STATE__MAX_DEPS && nvalues == 3;
+}
+
+CapState *
+CapState_Load(CapState *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+
+    *self = (CapState) {0};
+
+    FILE *fin = fopen(path, "rb");
+    if (!fin) {
+        return NULL;
+    }
+
+    // read whole of file at once
+    char *buf = PadMem_Malloc(BUF_SIZE);
+    size_t len = buf ? fread(buf, 1, BUF_SIZE, fin) : BUF_SIZE;
+    fclose(fin);
+
+    bool is_valid = false;
+    if (len < BUF_SIZE) {
+        buf[len] = '\0';
+        is_valid = load_lines(self, buf);
+    }
+    Pad_SafeFree(buf);
+
+    if (!is_valid) {
+        *self = (CapState) {0};
+        return NULL;
+    }
+
+    return self;
+}
+
+static void
+add_dep(CapState *self, const char *path) {
+    CapStateDep *dep = &self->deps[self->ndeps++];
+    snprintf(dep->path, sizeof dep->path, "%s", path);
+    CapSymlinkStamp_Load(&dep->stamp, path);
+
+    if (!dep->stamp.exists ||
+        CapRecord_IsRacy(dep->stamp.mtime)) {
+        self->is_uncacheable = true;
+    }
+}
+
+CapState *
+CapState_Make(CapState *self, const CapConfig *config) {
+    if (!self || !config) {
+        return NULL;
+    }
+
+    *self = (CapState) {0};
+
+    char appdir[PAD_FILE__NPATH];
+    if (!PadFile_Solve(appdir, sizeof appdir, "~/.cap")) {
+        return NULL;
+    }
+
+    // load stamps before read of variables
+    add_dep(self, appdir);
+    add_dep(self, config->var_cd_path);
+    add_dep(self, config->var_home_path);
+    add_dep(self, config->var_editor_path);
+
+    if (!PadFile_ReadLine(self->cd_path, sizeof self->cd_path, config->var_cd_path) ||
+        !PadFile_ReadLine(self->home_path, sizeof self->home_path, config->var_home_path) ||
+        !PadFile_ReadLine(self->editor, sizeof self->editor, config->var_editor_path)) {
+        self->is_uncacheable = true;
+    }
+
+    return self;
+}
+
+static bool
+is_savable(const CapState *self) {
+    if (self->is_uncacheable ||
+        self->ndeps != CAP_STATE__MAX_DEPS ||
+        !CapRecord_IsField(self->cd_path) ||
+        !CapRecord_IsField(self->home_path) ||
+        !CapRecord_IsField(self->editor)) {
+        return false;
+    }
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        if (!CapRecord_IsField(self->deps[i].path)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CapState *
+CapState_Save(CapState *self, const char *path) {
+    if (!self || !path) {
+        return NULL;
+    }
+    if (!is_savable(self)) {
+        return NULL;
+    }
+
+    // other processes may save same state at same time
+    char tmppath[PAD_FILE__NPATH];
+    snprintf(tmppath, sizeof tmppath, "%s.%ld.tmp", path, (long) getpid());
+
+    FILE *fout = fopen(tmppath, "w");
+    if (!fout) {
+        return NULL;
+    }
+
+    fprintf(fout, "%s\n", STATE_SIGNATURE);
+    for (int32_t i = 0; i < self->ndeps; ++i) {
+        const CapStateDep *d = &self->deps[i];
+        fprintf(fout, "dep");
+        CapSymlinkStamp_Write(&d->stamp, fout);
+        fprintf(fout, "\t%s\n", d->path);
+    }
+    fprintf(fout, "cd\t%s\n", self->cd_path);
+    fprintf(fout, "home\t%s\n", self->home_path);
+    fprintf(fout, "editor\t%s\n", self->editor);
+
+    if (fclose(fout) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    if (PadFile_Rename(tmppath, path) != 0) {
+        PadFile_Remove(tmppath);
+        return NULL;
+    }
+
+    return self;
+}
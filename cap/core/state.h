@@ -0,0 +1,102 @@
+/**
+ * State file of startup
+ *
+ * cd、home、editor の値を ~/.cap/var/state にまとめて保存する
+ * 起動時は 3 つの変数ファイルを読む代わりに、この 1 つのファイルを 1 回の read で読む
+ *
+ * 状態ファイルは ~/.cap と変数ファイル（cd、home、editor）のスタンプを持つ
+ * スタンプがすべて一致していれば環境は配置済みとみなし、ディレクトリの確認と CapApp_DeployEnv を省略する
+ * ~/.cap の子（var、codes、stdlib）が消えると ~/.cap の mtime が変わるため、状態ファイルは無効になる
+ * 変数ファイルは従来どおり値の正本で、cd や home のコマンドは変数ファイルを書く
+ *
+ * The format of file is text:
+ *
+ *      cap state 2
+ *      dep <TAB> exists <TAB> dev <TAB> ino <TAB> mtime <TAB> mtime_nsec <TAB> size <TAB> mode <TAB> path
+ *      cd <TAB> value
+ *      home <TAB> value
+ *      editor <TAB> value
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/config.h>
+#include <cap/core/symlink_cache.h>
+#include <cap/core/record.h>
+
+/**
+ * Numbers
+ */
+enum {
+    CAP_STATE__MAX_DEPS = 4,  // application directory and variables of cd, home and editor
+};
+
+/**
+ * Dependency of state
+ */
+typedef struct {
+    char path[PAD_FILE__NPATH];
+    CapSymlinkStamp stamp;
+} CapStateDep;
+
+/**
+ * Structure of state
+ */
+typedef struct {
+    CapStateDep deps[CAP_STATE__MAX_DEPS];
+    int32_t ndeps;
+    char cd_path[PAD_FILE__NPATH];  // value of variable of cd
+    char home_path[PAD_FILE__NPATH];  // value of variable of home
+    char editor[PAD_FILE__NPATH];  // value of variable of editor
+    bool is_uncacheable;  // dependencies are racy or not exists
+} CapState;
+
+/**
+ * Load state from file
+ * The state is valid if stamps of dependencies are not changed
+ *
+ * @param[out] *self pointer to CapState
+ * @param[in]  *path path of state file
+ *
+ * @return valid to pointer to self
+ * @return not exists, broken or stale to NULL
+ */
+CapState *
+CapState_Load(CapState *self, const char *path);
+
+/**
+ * Make state from variable files of config
+ * Call this after deploy of environment
+ *
+ * @param[out] *self   pointer to CapState
+ * @param[in]  *config pointer to CapConfig (paths of variables are used)
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapState *
+CapState_Make(CapState *self, const CapConfig *config);
+
+/**
+ * Save state at file
+ * If the state is not cacheable then does nothing and returns NULL
+ *
+ * @param[in] *self pointer to CapState
+ * @param[in] *path path of state file
+ *
+ * @return success to pointer to self
+ * @return failed or not cacheable to NULL
+ */
+CapState *
+CapState_Save(CapState *self, const char *path);
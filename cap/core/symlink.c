@@ -1,5 +1,58 @@
+#define _DEFAULT_SOURCE 1 /* cap: symlink: openat, fstatat, pread */
 #include <cap/core/symlink.h>
 
+#if defined(__linux__) || defined(__APPLE__)
+# define CAP_SYMLINK__XATTR 1
+# include <sys/xattr.h>
+#endif
+
+/**
+ * Name of extended attribute of link file
+ * The value is mtime of link file at tagging and Cap's path of link ("<sec>.<nsec> <TAB> /cap/path")
+ */
+#define CAP_SYMLINK__XATTR_NAME "user.cap.symlink"
+
+/**
+ * Numbers
+ */
+enum {
+    SYMLINK_CACHE_CAPACITY = 1024 * 16,
+    SCAN_MAX_WORKERS = 16,
+};
+
+/**
+ * Resolution cache of process
+ */
+static CapSymlinkCache *_cache;
+
+/**
+ * Link index of process (loaded from file at first time)
+ * If the index file is not exists then _index is NULL
+ * _index_path and _index_st are path and stamp of file at load. _index_st is zero if file was not exists
+ */
+static CapLinkIndex *_index;
+static bool _index_loaded;
+static char _index_path[PAD_FILE__NPATH];
+static struct stat _index_st;
+
+/**
+ * Lock of cache and index for templates rendered by threads
+ */
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Walker of components of path
+ *
+ * path is resolved prefix of dirty path and dirfd is directory of that prefix
+ * if dirfd is -1 then components are accessed by path
+ */
+typedef struct {
+    char path[PAD_FILE__NPATH];
+    int dirfd;
+    bool has_dirst;  // if true then dirst is stat of path
+    struct stat dirst;
+} Walker;
+
 static const char *
 skip_drive_letter(const char *path) {
     const char *found = strchr(path, ':');
@@ -9,56 +62,215 @@ skip_drive_letter(const char *path) {
     return ++found;
 }
 
+static ssize_t
+read_at(int fd, char *buf, size_t bufsz, off_t offset) {
+#ifdef CAP__WINDOWS
+    if (lseek(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+    return read(fd, buf, bufsz);
+#else
+    return pread(fd, buf, bufsz, offset);
+#endif
+}
+
+/**
+ * Check the header of Cap's symbolic link at top of file
+ * Read only bytes of length of header
+ *
+ * @param[in] fd descriptor of file
+ *
+ * @return has header to true else false
+ */
 static bool
-is_contain_header(char *data, uint32_t datasz) {
-    size_t len1 = strlen(data);
-    size_t len2 = strlen(CAP_SYMLINK__HEADER);
-    size_t size = len1 < len2 ? len1 : len2;
-    return memcmp(data, CAP_SYMLINK__HEADER, size) == 0;
+has_header(int fd) {
+    char head[sizeof CAP_SYMLINK__HEADER];
+    size_t headlen = strlen(CAP_SYMLINK__HEADER);
+    if (read_at(fd, head, headlen, 0) != (ssize_t) headlen) {
+        return false;
+    }
+    return memcmp(head, CAP_SYMLINK__HEADER, headlen) == 0;
 }
 
+/**
+ * Read Cap's path of symbolic link from file
+ *
+ * @param[out] *cappath  pointer to destination
+ * @param[in]  cappathsz number of size of destination
+ * @param[in]  fd        descriptor of file
+ *
+ * @return file is link to pointer to cappath else NULL
+ */
 static const char *
-read_sympath(const CapConfig *config, char *sympath, uint32_t sympathsz, const char *path) {
-    FILE *fin = fopen(path, "r");
-    if (!fin) {
+read_cappath(char *cappath, uint32_t cappathsz, int fd) {
+    if (!has_header(fd)) {
         return NULL;
     }
 
-    uint32_t symheaderlen = strlen(CAP_SYMLINK__HEADER);
-    char line[PAD_FILE__NPATH + symheaderlen + 1];
-    int32_t linelen = PadFile_GetLine(line, sizeof line, fin);
-    if (linelen == EOF) {
-        fclose(fin);
-        return NULL;
-    }
-    if (fclose(fin) < 0) {
+    size_t headlen = strlen(CAP_SYMLINK__HEADER);
+    char line[PAD_FILE__NPATH];
+    ssize_t linelen = read_at(fd, line, sizeof(line)-1, headlen);
+    if (linelen < 0) {
         return NULL;
     }
+    line[linelen] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+
+    const char *p = line;
+    for (; *p == ' '; ++p) ;
+
+    snprintf(cappath, cappathsz, "%s", p);
+    return cappath;
+}
 
-    if (!is_contain_header(line, linelen)) {
+/**
+ * Solve Cap's path of symbolic link to path on file system
+ *
+ * @param[in]  *config    pointer to CapConfig
+ * @param[out] *sympath   pointer to destination
+ * @param[in]  sympathsz  number of size of destination
+ * @param[in]  *cappath   Cap's path
+ *
+ * @return success to pointer to sympath else NULL
+ */
+static const char *
+solve_cappath(const CapConfig *config, char *sympath, uint32_t sympathsz, const char *cappath) {
+    // origin is home path (symlink path is always absolute path)
+    const char *org = config->home_path;
+    if (!PadFile_SolveFmt(sympath, sympathsz, "%s/%s", org, cappath)) {
         return NULL;
     }
 
-    const char *p = strchr(line, ':');
-    if (!p) {
+    return sympath;
+}
+
+_Static_assert(
+    sizeof(CAP_SYMLINK__HEADER) - 1 == CAP_LINK_INDEX__MIN_LINK_SIZE,
+    "minimum size of link in index is not length of header"
+);
+
+/**
+ * Check size of file can be size of link file
+ */
+static bool
+is_link_size(const struct stat *st) {
+    return st->st_size >= (off_t) strlen(CAP_SYMLINK__HEADER);
+}
+
+/**
+ * Check size of file is size of link file written by CapSymlink_Link
+ * The file may be changed after set of extended attribute
+ */
+static bool
+is_written_link_size(const struct stat *st, const char *cappath) {
+    off_t size = strlen(CAP_SYMLINK__HEADER) + 1 + strlen(cappath);
+    return st->st_size == size + 1 || st->st_size == size + 2;  // LF or CRLF
+}
+
+#ifdef CAP_SYMLINK__XATTR
+/**
+ * Make stamp of file for extended attribute. mtime is not changed by set of extended attribute
+ */
+static void
+make_xattr_stamp(char *dst, uint32_t dstsz, const struct stat *st) {
+# ifdef __APPLE__
+    long nsec = st->st_mtimespec.tv_nsec;
+# else
+    long nsec = st->st_mtim.tv_nsec;
+# endif
+    snprintf(dst, dstsz, "%lld.%09ld", (long long) st->st_mtime, nsec);
+}
+#endif
+
+/**
+ * Read Cap's path of link from extended attribute of file
+ * The value is not used if file was changed after tagging
+ *
+ * @param[out] *cappath  pointer to destination
+ * @param[in]  cappathsz number of size of destination
+ * @param[in]  *path     path of file
+ * @param[in]  *st       pointer to result of stat of file
+ *
+ * @return file is tagged link to pointer to cappath else NULL
+ */
+static const char *
+read_tag(char *cappath, uint32_t cappathsz, const char *path, const struct stat *st) {
+#ifdef CAP_SYMLINK__XATTR
+    char value[PAD_FILE__NPATH + 64];
+# ifdef __APPLE__
+    ssize_t len = getxattr(path, CAP_SYMLINK__XATTR_NAME, value, sizeof(value)-1, 0, 0);
+# else
+    ssize_t len = getxattr(path, CAP_SYMLINK__XATTR_NAME, value, sizeof(value)-1);
+# endif
+    if (len < 0) {
+        // not tagged or not supported
         return NULL;
     }
-    ++p;
-    for (; *p == ' '; ++p) ;
+    value[len] = '\0';
 
-    char cappath[PAD_FILE__NPATH];
-    for (int i = 0; i < sizeof(cappath)-1 && *p; ++i, ++p) {
-        cappath[i] = *p;
-        cappath[i+1] = '\0';
+    char stamp[64];
+    make_xattr_stamp(stamp, sizeof stamp, st);
+    char *tab = strchr(value, '\t');
+    if (!tab) {
+        return NULL;  // tagged by old version
+    }
+    *tab = '\0';
+    if (strcmp(value, stamp) || !is_written_link_size(st, tab + 1)) {
+        return NULL;  // changed after tagging
     }
 
-    // origin is home path (symlink path is always absolute path)
-    const char *org = config->home_path;
-    if (!PadFile_SolveFmt(sympath, sympathsz, "%s/%s", org, cappath)) {
+    snprintf(cappath, cappathsz, "%s", tab + 1);
+    return cappath;
+#else
+    return NULL;
+#endif
+}
+
+/**
+ * Read Cap's path of link from extended attribute of file for resolution
+ * The file changed in last few seconds is read because change in same time of tagging is not detected by mtime
+ */
+static const char *
+read_xattr(char *cappath, uint32_t cappathsz, const char *path, const struct stat *st) {
+    if (CapRecord_IsRacy(st->st_mtime)) {
         return NULL;
     }
+    return read_tag(cappath, cappathsz, path, st);
+}
+
+/**
+ * Save Cap's path of link at extended attribute of file with stamp of file
+ *
+ * @param[in] *path    path of file
+ * @param[in] *st      pointer to result of stat of file after write
+ * @param[in] *cappath Cap's path of link
+ *
+ * @return success to true else false
+ */
+static bool
+write_xattr(const char *path, const struct stat *st, const char *cappath) {
+#ifdef CAP_SYMLINK__XATTR
+    char stamp[64];
+    char value[PAD_FILE__NPATH + 64];
+    make_xattr_stamp(stamp, sizeof stamp, st);
+    int len = snprintf(value, sizeof value, "%s\t%s", stamp, cappath);
+    if (len < 0 || len >= (int) sizeof value) {
+        return false;
+    }
 
-    return sympath;
+# ifdef __APPLE__
+    if (setxattr(path, CAP_SYMLINK__XATTR_NAME, value, len, 0, 0) == 0) {
+        return true;
+    }
+    removexattr(path, CAP_SYMLINK__XATTR_NAME, 0);
+# else
+    if (setxattr(path, CAP_SYMLINK__XATTR_NAME, value, len, 0) == 0) {
+        return true;
+    }
+    removexattr(path, CAP_SYMLINK__XATTR_NAME);
+# endif
+#endif
+    return false;
 }
 
 static void
@@ -69,7 +281,7 @@ fix_path_seps(char *dst, uint32_t dstsz, const char *src) {
     char replace_sep = '\\';
 #endif
     char *dp = dst;
-    char *dpend = dst + dstsz;
+    char *dpend = dst + dstsz - 1;
     const char *p = src;
     for (; *p && dp < dpend; ++p, ++dp) {
         char ch = *p;
@@ -94,83 +306,558 @@ find_path_head(const char *path) {
 #endif
 }
 
+static void
+pop_tail_seps(char *path) {
+    const char *head = find_path_head(path);
+    size_t headlen = head - path;
+    size_t len = strlen(path);
+    for (; len > headlen + 1 && path[len-1] == PAD_FILE__SEP; --len) {
+        path[len-1] = '\0';
+    }
+}
+
+static CapSymlinkCache *
+get_cache(void) {
+    if (!_cache) {
+        _cache = CapSymlinkCache_New(SYMLINK_CACHE_CAPACITY);
+    }
+    return _cache;
+}
+
+static void
+drop_index(void) {
+    CapLinkIndex_Del(_index);
+    _index = NULL;
+    _index_loaded = false;
+}
+
+/**
+ * Check index file was changed after load
+ * The file modified in last few seconds is treated as changed because same second change is not detected
+ */
+static bool
+is_index_changed(void) {
+    struct stat st;
+    if (stat(_index_path, &st) != 0) {
+        return _index_st.st_ino != 0;
+    }
+
+    return st.st_dev != _index_st.st_dev ||
+           st.st_ino != _index_st.st_ino ||
+           st.st_size != _index_st.st_size ||
+           st.st_mtime != _index_st.st_mtime ||
+           CapRecord_IsRacy(st.st_mtime);
+}
+
+/**
+ * Get link index. call this with lock of _mutex
+ */
+static CapLinkIndex *
+get_index(const CapConfig *config) {
+    if (_index_loaded && PadCStr_Eq(_index_path, config->var_links_path)) {
+        return _index;
+    }
+
+    drop_index();
+    _index_loaded = true;
+    snprintf(_index_path, sizeof _index_path, "%s", config->var_links_path);
+    if (stat(_index_path, &_index_st) != 0) {
+        memset(&_index_st, 0, sizeof _index_st);
+    }
+
+    _index = CapLinkIndex_New();
+    if (!CapLinkIndex_Load(_index, config->var_links_path)) {
+        CapLinkIndex_Del(_index);
+        _index = NULL;
+    }
+
+    return _index;
+}
+
+/**
+ * Lookup file in link index with lock of _mutex
+ * If file is link then Cap's path of link is copied to cappath
+ */
+static CapLinkIndexResult
+lookup_index(
+    const CapConfig *config,
+    const struct stat *st,
+    const struct stat *dirst,
+    char *cappath,
+    uint32_t cappathsz
+) {
+    pthread_mutex_lock(&_mutex);
+    const CapLinkIndex *index = get_index(config);
+    const char *found = NULL;
+    CapLinkIndexResult result = index ?
+        CapLinkIndex_Lookup(index, st, dirst, &found) :
+        CAP_LINK_INDEX__UNKNOWN;
+    if (result == CAP_LINK_INDEX__LINK && cappath) {
+        snprintf(cappath, cappathsz, "%s", found);
+    }
+    pthread_mutex_unlock(&_mutex);
+
+    return result;
+}
+
+/**
+ * Find entry of resolution cache and validate stamps of entry outside of lock
+ * Stamps of valid entry are added to deps
+ *
+ * @return valid entry is found to true else false
+ */
+static bool
+cache_find(const char *key, char *dst, uint32_t dstsz, CapSymlinkDeps *deps) {
+    CapSymlinkDeps found = {0};
+
+    pthread_mutex_lock(&_mutex);
+    bool ok = CapSymlinkCache_Find(get_cache(), key, dst, dstsz, &found);
+    pthread_mutex_unlock(&_mutex);
+    if (!ok) {
+        CapSymlinkDeps_Fini(&found);
+        return false;
+    }
+
+    ok = CapSymlinkDeps_IsFresh(&found, 0);
+    pthread_mutex_lock(&_mutex);
+    if (ok) {
+        CapSymlinkCache_Hit(_cache);
+    } else {
+        CapSymlinkCache_Invalidate(_cache, key);
+    }
+    pthread_mutex_unlock(&_mutex);
+
+    ok = ok && CapSymlinkDeps_Extend(deps, &found);
+    CapSymlinkDeps_Fini(&found);
+    return ok;
+}
+
+static void
+cache_set(const char *key, const char *resolved, const CapSymlinkDeps *deps) {
+    pthread_mutex_lock(&_mutex);
+    CapSymlinkCache_Set(get_cache(), key, resolved, deps);
+    pthread_mutex_unlock(&_mutex);
+}
+
+/**
+ * Add stamp of path examined in resolution. If st is NULL then path is not exists
+ */
+static bool
+add_dep(CapSymlinkDeps *deps, const char *path, const struct stat *st) {
+    CapSymlinkStamp stamp = {0};
+    if (st) {
+        CapSymlinkStamp_FromStat(&stamp, st);
+    }
+    return CapSymlinkDeps_Add(deps, path, &stamp) != NULL;
+}
+
+/*********
+* walker *
+*********/
+
+static void
+walker_close(Walker *self) {
+    if (self->dirfd >= 0) {
+        close(self->dirfd);
+    }
+    self->dirfd = -1;
+    self->has_dirst = false;
+}
+
+static void
+walker_reset(Walker *self, const char *path) {
+    walker_close(self);
+    snprintf(self->path, sizeof self->path, "%s", path);
+}
+
 static char *
-follow_path(const CapConfig *config, char *dst, uint32_t dstsz, const char *abspath, int dep) {
-    if (dep >= 8) {
-        return NULL;
+walker_join(const Walker *self, char *dst, uint32_t dstsz, const char *name) {
+    size_t len = strlen(self->path);
+    if (!len || self->path[len-1] == PAD_FILE__SEP) {
+        snprintf(dst, dstsz, "%s%s", self->path, name);
+    } else {
+        snprintf(dst, dstsz, "%s%c%s", self->path, PAD_FILE__SEP, name);
     }
+    return dst;
+}
 
-    char normpath[PAD_FILE__NPATH];
-    fix_path_seps(normpath, sizeof normpath, abspath);
+static int
+walker_stat(const Walker *self, const char *name, struct stat *st) {
+#ifndef CAP__WINDOWS
+    if (self->dirfd >= 0) {
+        return fstatat(self->dirfd, name, st, 0);
+    }
+#endif
+    char path[PAD_FILE__NPATH];
+    walker_join(self, path, sizeof path, name);
+    return stat(path, st);
+}
 
-    const char *p = find_path_head(normpath);
-    if (!p) {
+static int
+walker_open(const Walker *self, const char *name) {
+#ifndef CAP__WINDOWS
+    if (self->dirfd >= 0) {
+        return openat(self->dirfd, name, O_RDONLY);
+    }
+#endif
+    char path[PAD_FILE__NPATH];
+    walker_join(self, path, sizeof path, name);
+    return open(path, O_RDONLY);
+}
+
+/**
+ * Step into directory
+ * If keep_fd is true then open directory for next components
+ */
+static void
+walker_enter(Walker *self, const char *name, const struct stat *st, bool keep_fd) {
+    int fd = -1;
+#ifndef CAP__WINDOWS
+    if (keep_fd && self->dirfd >= 0) {
+        fd = openat(self->dirfd, name, O_RDONLY | O_DIRECTORY);
+    } else if (keep_fd) {
+        char path[PAD_FILE__NPATH];
+        walker_join(self, path, sizeof path, name);
+        fd = open(path, O_RDONLY | O_DIRECTORY);
+    }
+#endif
+    walker_close(self);
+    self->dirfd = fd;
+    self->has_dirst = true;
+    self->dirst = *st;
+
+    char path[PAD_FILE__NPATH];
+    walker_join(self, path, sizeof path, name);
+    snprintf(self->path, sizeof self->path, "%s", path);
+}
+
+/**
+ * Step out to parent directory (lexical)
+ */
+static void
+walker_leave(Walker *self) {
+    walker_close(self);
+
+    const char *head = find_path_head(self->path);
+    char *sep = strrchr(head, PAD_FILE__SEP);
+    if (!sep) {
+        return;
+    }
+    if (sep == head) {
+        sep[1] = '\0';  // keep root
+    } else {
+        *sep = '\0';
+    }
+}
+
+/**
+ * Append rest of path that not contains links
+ */
+static void
+walker_append(Walker *self, const char *rest) {
+    walker_close(self);
+
+    char path[PAD_FILE__NPATH];
+    walker_join(self, path, sizeof path, rest);
+    snprintf(self->path, sizeof self->path, "%s", path);
+}
+
+/**
+ * Read Cap's path of symbolic link of walker/name
+ * The link index and extended attribute are used instead of read of file if possible
+ *
+ * @return file is link to pointer to cappath else NULL
+ */
+static const char *
+walker_read_cappath(
+    Walker *self,
+    const CapConfig *config,
+    char *cappath,
+    uint32_t cappathsz,
+    const char *name,
+    const struct stat *st
+) {
+    if (!self->has_dirst && stat(self->path, &self->dirst) == 0) {
+        self->has_dirst = true;
+    }
+
+    const struct stat *dirst = self->has_dirst ? &self->dirst : NULL;
+    switch (lookup_index(config, st, dirst, cappath, cappathsz)) {
+    case CAP_LINK_INDEX__LINK:
+        return cappath;
+    case CAP_LINK_INDEX__NOT_LINK:
         return NULL;
+    case CAP_LINK_INDEX__UNKNOWN:
+        break;
+    }
+
+    if (!is_link_size(st)) {
+        return NULL;
+    }
+
+    char path[PAD_FILE__NPATH];
+    walker_join(self, path, sizeof path, name);
+    if (read_xattr(cappath, cappathsz, path, st)) {
+        return cappath;
     }
 
-    char **toks = PadCStr_SplitIgnoreEmpty(p, PAD_FILE__SEP);
-    if (!toks) {
+    int fd = walker_open(self, name);
+    if (fd < 0) {
         return NULL;
     }
 
-    char **save_toks = NULL;
-    char sympath[PAD_FILE__NPATH];
+    const char *result = read_cappath(cappath, cappathsz, fd);
+    close(fd);
+    return result;
+}
+
+/****************
+* link chaining *
+****************/
 
-    PadStr *path = PadStr_New();
+/**
+ * Create key of link file for detection of circular links
+ */
+static char *
+link_key(char *dst, uint32_t dstsz, const Walker *walker, const char *name, const struct stat *st) {
 #ifdef CAP__WINDOWS
-    // append drive letter
-    PadStr_PushBack(path, normpath[0]);
-    PadStr_App(path, ":\\");
+    // inode is not available
+    walker_join(walker, dst, dstsz, name);
+#else
+    snprintf(dst, dstsz, "%llu:%llu",
+        (unsigned long long) st->st_dev,
+        (unsigned long long) st->st_ino
+    );
 #endif
-    for (char **toksp = toks; *toksp; ++toksp) {
-        PadStr_PushBack(path, PAD_FILE__SEP);
-        PadStr_App(path, *toksp);
-        // printf("path[%s] toksp[%s]\n", PadStr_Getc(path), *toksp);
-        if (PadFile_IsDir(PadStr_Getc(path))) {
-            continue;
+    return dst;
+}
+
+static bool
+is_following(const PadCStrAry *chain, const char *key) {
+    for (int32_t i = 0; i < PadCStrAry_Len(chain); ++i) {
+        if (PadCStr_Eq(PadCStrAry_Getc(chain, i), key)) {
+            return true;
         }
+    }
+    return false;
+}
+
+static char *
+follow_path(
+    const CapConfig *config,
+    char *dst,
+    uint32_t dstsz,
+    const char *drtpath,
+    PadCStrAry *chain,
+    CapSymlinkDeps *deps
+);
+
+/**
+ * Follow link file at walker/name and step walker to the target of link
+ *
+ * @return success to true, circular link or failed to false
+ */
+static bool
+walker_follow(
+    Walker *self,
+    const CapConfig *config,
+    const char *sympath,
+    const char *key,
+    PadCStrAry *chain,
+    CapSymlinkDeps *deps
+) {
+    if (is_following(chain, key)) {
+        // circular link
+        return false;
+    }
+
+    char resolved[PAD_FILE__NPATH];
+    walker_close(self);
 
-        sympath[0] = '\0';
-        if (!read_sympath(config, sympath, sizeof sympath, PadStr_Getc(path))) {
+    PadCStrAry_PushBack(chain, key);
+    const char *result = follow_path(config, resolved, sizeof resolved, sympath, chain, deps);
+    char *popped = PadCStrAry_PopMove(chain);
+    Pad_SafeFree(popped);
+    if (!result) {
+        return false;
+    }
+
+    walker_reset(self, resolved);
+    return true;
+}
+
+/**
+ * Find longest prefix of path in cache and set walker to resolved prefix
+ * Stamps of prefix are added to deps
+ *
+ * @return pointer to rest of path
+ */
+static const char *
+start_walk(Walker *self, const char *normpath, const char *head, CapSymlinkDeps *deps) {
+    char prefix[PAD_FILE__NPATH];
+    char resolved[PAD_FILE__NPATH];
+    size_t headoff = head - normpath;
+
+    for (const char *p = normpath + strlen(normpath); p > head; --p) {
+        if (*p != PAD_FILE__SEP || p == head) {
             continue;
         }
-        // printf("sympath[%s]\n", sympath);
 
-        ++toksp;
-        save_toks = toksp;
-        break;
+        snprintf(prefix, sizeof prefix, "%.*s", (int) (p - normpath), normpath);
+        if (cache_find(prefix, resolved, sizeof resolved, deps)) {
+            walker_reset(self, resolved);
+            return p + 1;
+        }
+    }
+
+    // start from root
+    snprintf(self->path, sizeof self->path, "%.*s%c", (int) headoff, normpath, PAD_FILE__SEP);
+    return head;
+}
+
+/**
+ * Follow path for symbolic links by components
+ *
+ * Components are checked relative to opened directory of resolved prefix.
+ * The first found link is replaced by the target of link and the rest components
+ * are followed from that target
+ *
+ * @param[in] *config  pointer to CapConfig
+ * @param[in] *dst     pointer to destination
+ * @param[in] dstsz    number of size of destination
+ * @param[in] *drtpath dirty path
+ * @param[in] *chain   keys of link files in following for detection of circular links
+ * @param[in] *deps    stamps of paths examined in resolution are added to this
+ *
+ * @return success to pointer to dst, failed to NULL
+ */
+static char *
+follow_path(
+    const CapConfig *config,
+    char *dst,
+    uint32_t dstsz,
+    const char *drtpath,
+    PadCStrAry *chain,
+    CapSymlinkDeps *deps
+) {
+    char normpath[PAD_FILE__NPATH];
+    fix_path_seps(normpath, sizeof normpath, drtpath);
+    pop_tail_seps(normpath);
+
+    const char *head = find_path_head(normpath);
+    if (!head) {
+        return NULL;
     }
 
-    if (!save_toks) {
-        if (!PadFile_Solve(dst, dstsz, normpath)) {
+    if (head[0] != PAD_FILE__SEP) {
+        // relative path or home (~) path is not key of cache because it depends on cwd and HOME
+        char solved[PAD_FILE__NPATH];
+        if (!PadFile_Solve(solved, sizeof solved, normpath)) {
             return NULL;
         }
-        goto done;
+        return follow_path(config, dst, dstsz, solved, chain, deps);
+    }
+
+    if (cache_find(normpath, dst, dstsz, deps)) {
+        return dst;
     }
 
-    PadStr_Set(path, sympath);
-    for (char **toksp = save_toks; *toksp; ++toksp) {
-        PadStr_PushBack(path, PAD_FILE__SEP);
-        PadStr_App(path, *toksp);
+    Walker walker = { .dirfd = -1 };
+    const char *p = start_walk(&walker, normpath, head, deps);
+    bool cached_full = false;
+
+    for (;;) {
+        for (; *p == PAD_FILE__SEP; ++p) ;
+        if (!*p) {
+            break;
+        }
+
+        const char *end = strchr(p, PAD_FILE__SEP);
+        if (!end) {
+            end = p + strlen(p);
+        }
+
+        char name[PAD_FILE__NPATH];
+        snprintf(name, sizeof name, "%.*s", (int) (end - p), p);
+        bool has_next = end[0] && end[1];
+
+        char prefix[PAD_FILE__NPATH];
+        snprintf(prefix, sizeof prefix, "%.*s", (int) (end - normpath), normpath);
+        cached_full = !end[0];
+
+        if (PadCStr_Eq(name, ".")) {
+            p = end;
+            continue;
+        } else if (PadCStr_Eq(name, "..")) {
+            walker_leave(&walker);
+            p = end;
+            continue;
+        }
+
+        // creation of not exists path and overwrite of file by link are detected by stamp of path
+        char path[PAD_FILE__NPATH];
+        walker_join(&walker, path, sizeof path, name);
+
+        struct stat st;
+        if (walker_stat(&walker, name, &st) != 0) {
+            // not exists. the rest of path does not contain links
+            if (!add_dep(deps, path, NULL)) {
+                goto fail;
+            }
+            walker_append(&walker, p);
+            cached_full = false;
+            break;
+        }
+        if (!add_dep(deps, path, &st)) {
+            goto fail;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            walker_enter(&walker, name, &st, has_next);
+
+            char resolved[PAD_FILE__NPATH];
+            if (!PadFile_Solve(resolved, sizeof resolved, walker.path)) {
+                goto fail;
+            }
+            cache_set(prefix, resolved, deps);
+
+            p = end;
+            continue;
+        }
+
+        char cappath[PAD_FILE__NPATH];
+        char sympath[PAD_FILE__NPATH];
+        if (!walker_read_cappath(&walker, config, cappath, sizeof cappath, name, &st) ||
+            !solve_cappath(config, sympath, sizeof sympath, cappath)) {
+            // not link. the rest of path does not contain links
+            walker_append(&walker, p);
+            cached_full = false;
+            break;
+        }
+
+        char key[PAD_FILE__NPATH];
+        link_key(key, sizeof key, &walker, name, &st);
+        if (!walker_follow(&walker, config, sympath, key, chain, deps)) {
+            goto fail;
+        }
+
+        cache_set(prefix, walker.path, deps);
+
+        p = end;
     }
 
-    if (!follow_path(config, dst, dstsz, PadStr_Getc(path), dep+1)) {
-        goto fail;
+    walker_close(&walker);
+    if (!PadFile_Solve(dst, dstsz, walker.path)) {
+        return NULL;
     }
 
-#define cleanup() { \
-        for (char **toksp = toks; *toksp; ++toksp) { \
-            Pad_SafeFree(*toksp); \
-        } \
-        Pad_SafeFree(toks); \
-        PadStr_Del(path); \
+    if (!cached_full) {
+        cache_set(normpath, dst, deps);
     }
 
-done:
-    cleanup();
     return dst;
 fail:
-    cleanup();
+    walker_close(&walker);
     return NULL;
 }
 
@@ -180,99 +867,554 @@ CapSymlink_FollowPath(const CapConfig *config, char *dst, uint32_t dstsz, const
         return NULL;
     }
 
+    PadCStrAry *chain = PadCStrAry_New();
+    if (!chain) {
+        return NULL;
+    }
+
+    // the cache and index are locked in resolution. I/O of resolution is not locked
+    CapSymlinkDeps deps = {0};
     dst[0] = '\0';
-    if (!follow_path(config, dst, dstsz, abspath, 0)) {
+    char *result = follow_path(config, dst, dstsz, abspath, chain, &deps);
+    CapSymlinkDeps_Fini(&deps);
+    PadCStrAry_Del(chain);
+
+    return result;
+}
+
+char *
+CapSymlink_NormPath(const CapConfig *config, char *dst, uint32_t dstsz, const char *drtpath) {
+    if (!config || !dst || !dstsz || !drtpath) {
         return NULL;
     }
 
+#ifdef CAP__WINDOWS
+    char replace_sep = '/';
+#else
+    char replace_sep = '\\';
+#endif
+
+    // out is normalized path and segs is stack of offsets of segments in out
+    // segs[i] is length of out before push of segment i (includes separator)
+    char out[PAD_FILE__NPATH];
+    uint32_t segs[PAD_FILE__NPATH/2 + 1];
+    uint32_t nsegs = 0;
+    uint32_t outlen = 0;
+    uint32_t rootlen = 0;
+    const uint32_t outmax = sizeof(out) - 1;
+
+    const char *p = drtpath;
+
+#ifdef CAP__WINDOWS
+    // append drive letter of Windows
+    const char *colon = strchr(drtpath, ':');
+    if (colon) {
+        out[outlen++] = drtpath[0];
+        out[outlen++] = ':';
+        p = colon + 1;
+    }
+#endif
+
+    if (*p == PAD_FILE__SEP || *p == replace_sep) {
+        out[outlen++] = PAD_FILE__SEP;
+    }
+    rootlen = outlen;
+
+    // single pass over tokens. ".." pops segment, empty tokens are ignored
+    while (*p) {
+        for (; *p == PAD_FILE__SEP || *p == replace_sep; ++p) ;
+        if (!*p) {
+            break;
+        }
+
+        const char *tok = p;
+        for (; *p && *p != PAD_FILE__SEP && *p != replace_sep; ++p) ;
+        uint32_t toklen = p - tok;
+
+        if (toklen == 2 && tok[0] == '.' && tok[1] == '.') {
+            if (nsegs) {
+                outlen = segs[--nsegs];
+            }
+            continue;
+        }
+
+        uint32_t seglen = toklen + (outlen > rootlen);
+        if (outlen + seglen > outmax || nsegs >= sizeof(segs)/sizeof(*segs)) {
+            // too long path
+            break;
+        }
+
+        segs[nsegs++] = outlen;
+        if (outlen > rootlen) {
+            out[outlen++] = PAD_FILE__SEP;
+        }
+        memcpy(out + outlen, tok, toklen);
+        outlen += toklen;
+    }
+
+    if (outlen >= dstsz) {
+        outlen = dstsz - 1;
+    }
+    memcpy(dst, out, outlen);
+    dst[outlen] = '\0';
+
     return dst;
 }
 
-static PadCStrAry *
-split_ignore_empty(const char *p, char sep) {
-    char **toks = PadCStr_SplitIgnoreEmpty(p, PAD_FILE__SEP);
-    if (!toks) {
+/**
+ * Get parent directory of path
+ */
+static char *
+parent_dir(char *dst, uint32_t dstsz, const char *path) {
+    snprintf(dst, dstsz, "%s", path);
+    char *head = (char *) find_path_head(dst);
+    char *sep = strrchr(head, PAD_FILE__SEP);
+    if (!sep) {
         return NULL;
     }
+    if (sep == head) {
+        sep[1] = '\0';
+    } else {
+        *sep = '\0';
+    }
+    return dst;
+}
+
+bool
+CapSymlink_IsLinkFile(const CapConfig *config, const char *path) {
+    struct stat st;
+    char cappath[PAD_FILE__NPATH];
+
+    if (!config || !path) {
+        return false;
+    }
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) || !is_link_size(&st)) {
+        return false;
+    }
+
+    struct stat dirst;
+    char dirpath[PAD_FILE__NPATH];
+    bool has_dirst = parent_dir(dirpath, sizeof dirpath, path) && stat(dirpath, &dirst) == 0;
+
+    switch (lookup_index(config, &st, has_dirst ? &dirst : NULL, NULL, 0)) {
+    case CAP_LINK_INDEX__LINK: return true; break;
+    case CAP_LINK_INDEX__NOT_LINK: return false; break;
+    case CAP_LINK_INDEX__UNKNOWN: break;
+    }
 
-    PadCStrAry *arr = PadCStrAry_New();
+    if (read_xattr(cappath, sizeof cappath, path, &st)) {
+        return true;
+    }
 
-    for (char **toksp = toks; *toksp; ++toksp) {
-        PadCStrAry_Move(arr, *toksp);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
     }
 
-    Pad_SafeFree(toks);
-    return arr;
+    bool result = has_header(fd);
+    close(fd);
+    return result;
 }
 
-char *
-CapSymlink_NormPath(const CapConfig *config, char *dst, uint32_t dstsz, const char *drtpath) {
-    if (!config || !dst || !dstsz || !drtpath) {
-        return NULL;
+/**
+ * Save index after change of link file at path. call this with lock of _mutex
+ *
+ * @param[in] *config   pointer to CapConfig
+ * @param[in] *path     path of link file
+ * @param[in] *cappath  Cap's path of link or NULL if link was removed
+ * @param[in] *oldst    stat of file before change or NULL if file was not exists
+ * @param[in] is_fresh  directory of link file was fresh before change
+ */
+static void
+update_index(
+    const CapConfig *config,
+    const char *path,
+    const char *cappath,
+    const struct stat *oldst,
+    bool is_fresh
+) {
+    CapLinkIndex *index = get_index(config);
+    if (!index || !CapLinkIndex_IsCovered(index, path)) {
+        return;
     }
 
-    char cleanpath[PAD_FILE__NPATH];
-    fix_path_seps(cleanpath, sizeof cleanpath, drtpath);
-    const char *pathhead = find_path_head(cleanpath);
-    if (!pathhead) {
-        return NULL;
+    struct stat st;
+    if (oldst) {
+        CapLinkIndex_Remove(index, oldst);
+    }
+    if (cappath && stat(path, &st) == 0) {
+        CapLinkIndex_Set(index, path, cappath, &st);
+    }
+
+    // only directory not changed by others keeps fresh
+    char dirpath[PAD_FILE__NPATH];
+    if (is_fresh &&
+        parent_dir(dirpath, sizeof dirpath, path) &&
+        stat(dirpath, &st) == 0) {
+        CapLinkIndex_SetDir(index, dirpath, &st);
+    }
+
+    CapLinkIndex_Save(index, config->var_links_path);
+}
+
+/**
+ * Check directory of path is fresh in index. call this with lock of _mutex
+ */
+static bool
+is_fresh_dir(const CapConfig *config, const char *path) {
+    CapLinkIndex *index = get_index(config);
+    char dirpath[PAD_FILE__NPATH];
+    struct stat dirst;
+
+    return index &&
+           parent_dir(dirpath, sizeof dirpath, path) &&
+           stat(dirpath, &dirst) == 0 &&
+           CapLinkIndex_IsFreshDir(index, &dirst);
+}
+
+bool
+CapSymlink_Link(const CapConfig *config, const char *path, const char *cappath) {
+    if (!config || !path || !cappath) {
+        return false;
     }
 
+    char line[PAD_FILE__NPATH + 100];
+    snprintf(line, sizeof line, "%s %s", CAP_SYMLINK__HEADER, cappath);
+
+    pthread_mutex_lock(&_mutex);
+    struct stat oldst;
+    bool is_exists = stat(path, &oldst) == 0;
+    bool is_fresh = is_fresh_dir(config, path);
+    bool result = PadFile_WriteLine(line, path);
+    struct stat st;
+    if (result && stat(path, &st) == 0) {
+        // the file is read if file system does not support extended attributes
+        write_xattr(path, &st, cappath);
+    }
+    if (result) {
+        update_index(config, path, cappath, is_exists ? &oldst : NULL, is_fresh);
+    }
+    pthread_mutex_unlock(&_mutex);
+
+    if (result) {
+        CapSymlink_ClearCache();
+    }
+    return result;
+}
+
+bool
+CapSymlink_Unlink(const CapConfig *config, const char *path) {
+    if (!config || !path) {
+        return false;
+    }
+
+    pthread_mutex_lock(&_mutex);
+    struct stat oldst;
+    bool result = stat(path, &oldst) == 0;
+    if (result) {
+        bool is_fresh = is_fresh_dir(config, path);
+        result = PadFile_Remove(path) == 0;
+        if (result) {
+            update_index(config, path, NULL, &oldst, is_fresh);
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+
+    if (result) {
+        CapSymlink_ClearCache();
+    }
+    return result;
+}
+
+/**
+ * Directory waiting for scan
+ */
+typedef struct {
+    char *path;
+    struct stat st;
+} ScanDir;
+
+/**
+ * Context of scan of links under home
+ * Directories are scanned by workers at same time. mutex protects all fields except index and is_tag
+ */
+typedef struct {
+    CapLinkIndex *index;  // if not NULL then save links and directories (with lock of mutex)
+    bool is_tag;  // if true then tag links by extended attribute
+    int32_t ntagged;  // number of tagged links
+    ScanDir *dirs;  // stack of directories waiting for scan
+    int32_t ndirs;
+    int32_t capa;
+    int32_t nbusy;  // number of workers scanning directory
+    bool is_err;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} ScanCtx;
+
+/**
+ * Push directory for scan. call this with lock of mutex
+ */
+static bool
+scan_push_dir(ScanCtx *ctx, const char *path, const struct stat *st) {
+    if (ctx->ndirs >= ctx->capa) {
+        int32_t capa = ctx->capa ? ctx->capa * 2 : 64;
+        ScanDir *dirs = PadMem_Realloc(ctx->dirs, sizeof(*dirs) * capa);
+        if (!dirs) {
+            return false;
+        }
+        ctx->dirs = dirs;
+        ctx->capa = capa;
+    }
+
+    char *dup = PadCStr_Dup(path);
+    if (!dup) {
+        return false;
+    }
+
+    ctx->dirs[ctx->ndirs++] = (ScanDir) { .path = dup, .st = *st };
+    pthread_cond_signal(&ctx->cond);
+    return true;
+}
+
+/**
+ * Scan link file at path
+ */
+static void
+scan_file(ScanCtx *ctx, const char *path, const struct stat *st) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    char cappath[PAD_FILE__NPATH];
+    char tagged[PAD_FILE__NPATH];
+    if (read_cappath(cappath, sizeof cappath, fd)) {
+        bool is_tagged = ctx->is_tag &&
+                         is_written_link_size(st, cappath) &&
+                         !read_tag(tagged, sizeof tagged, path, st) &&
+                         write_xattr(path, st, cappath);
+
+        pthread_mutex_lock(&ctx->mutex);
+        if (ctx->index && !CapLinkIndex_Set(ctx->index, path, cappath, st)) {
+            ctx->is_err = true;
+        }
+        if (is_tagged) {
+            ctx->ntagged++;
+        }
+        pthread_mutex_unlock(&ctx->mutex);
+    }
+    close(fd);
+}
+
+/**
+ * Scan links in directory. Sub directories are pushed for other workers
+ *
+ * @return success to true else false
+ */
+static bool
+scan_dir(ScanCtx *ctx, const char *dirpath, const struct stat *dirst) {
+    // save stamp before read entries. if directory is changed while reading then it is not fresh
+    if (ctx->index) {
+        pthread_mutex_lock(&ctx->mutex);
+        bool ok = CapLinkIndex_SetDir(ctx->index, dirpath, dirst);
+        pthread_mutex_unlock(&ctx->mutex);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    PadDir *dir = PadDir_Open(dirpath);
+    if (!dir) {
+        // not readable directory is not fresh
+        return true;
+    }
+
+    bool result = true;
+    for (PadDirNode *node; (node = PadDir_Read(dir)); PadDirNode_Del(node)) {
+        const char *name = PadDirNode_Name(node);
+        if (PadCStr_Eq(name, ".") || PadCStr_Eq(name, "..")) {
+            continue;
+        }
+
+        char path[PAD_FILE__NPATH];
+        if (dirpath[strlen(dirpath)-1] == PAD_FILE__SEP) {
+            snprintf(path, sizeof path, "%s%s", dirpath, name);
+        } else {
+            snprintf(path, sizeof path, "%s%c%s", dirpath, PAD_FILE__SEP, name);
+        }
+
+        // do not follow symbolic links of file system
+        struct stat st;
 #ifdef CAP__WINDOWS
-    const char *hasdriveletter = strchr(drtpath, ':');
+        if (stat(path, &st) != 0) {
+#else
+        if (lstat(path, &st) != 0) {
 #endif
+            continue;
+        }
 
-    // save tokens from srctoks to dsttoks by ".." token
-    PadCStrAry *srctoks = split_ignore_empty(pathhead, PAD_FILE__SEP);
-    PadCStrAry *dsttoks = PadCStrAry_New();
+        if (S_ISDIR(st.st_mode)) {
+            pthread_mutex_lock(&ctx->mutex);
+            bool ok = scan_push_dir(ctx, path, &st);
+            pthread_mutex_unlock(&ctx->mutex);
+            if (!ok) {
+                result = false;
+                PadDirNode_Del(node);
+                break;
+            }
+        } else if (S_ISREG(st.st_mode) && is_link_size(&st)) {
+            scan_file(ctx, path, &st);
+        }
+    }
 
-    for (int32_t i = 0; i < PadCStrAry_Len(srctoks); ++i) {
-        const char *tok = PadCStrAry_Getc(srctoks, i);
-        if (PadCStr_Eq(tok, "..")) {
-            char *el = PadCStrAry_PopMove(dsttoks);
-            Pad_SafeFree(el);
-        } else {
-            PadCStrAry_PushBack(dsttoks, tok);
+    PadDir_Close(dir);
+    return result;
+}
+
+static void *
+scan_worker_main(void *arg) {
+    ScanCtx *ctx = arg;
+
+    pthread_mutex_lock(&ctx->mutex);
+    for (;;) {
+        while (!ctx->is_err && !ctx->ndirs && ctx->nbusy) {
+            pthread_cond_wait(&ctx->cond, &ctx->mutex);
+        }
+        if (ctx->is_err || !ctx->ndirs) {
+            break;  // failed or all directories were scanned
+        }
+
+        ScanDir dir = ctx->dirs[--ctx->ndirs];
+        ctx->nbusy++;
+        pthread_mutex_unlock(&ctx->mutex);
+
+        bool ok = scan_dir(ctx, dir.path, &dir.st);
+        free(dir.path);
+
+        pthread_mutex_lock(&ctx->mutex);
+        ctx->nbusy--;
+        if (!ok) {
+            ctx->is_err = true;
         }
     }
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->mutex);
 
-    // save normalized path by tokens
-    dst[0] = '\0';
+    return NULL;
+}
 
+static int32_t
+count_scan_workers(void) {
 #ifdef CAP__WINDOWS
-    // append drive letter of Windows
-    if (hasdriveletter) {
-        PadCStr_AppFmt(dst, dstsz, "%c:", drtpath[0]);
-    }
+    int32_t n = 1;
+#else
+    int32_t n = sysconf(_SC_NPROCESSORS_ONLN);
 #endif
+    if (n <= 0) {
+        n = 1;
+    }
+    if (n > SCAN_MAX_WORKERS) {
+        n = SCAN_MAX_WORKERS;
+    }
+    return n;
+}
+
+/**
+ * Scan links under home by workers
+ *
+ * @return success to true else false
+ */
+static bool
+scan_home(ScanCtx *ctx, const CapConfig *config) {
+    struct stat st;
+    if (stat(config->home_path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
 
-    if (pathhead[0] == PAD_FILE__SEP) {
-        PadCStr_AppFmt(dst, dstsz, "%c", PAD_FILE__SEP);
+    pthread_mutex_init(&ctx->mutex, NULL);
+    pthread_cond_init(&ctx->cond, NULL);
+
+    if (!scan_push_dir(ctx, config->home_path, &st)) {
+        ctx->is_err = true;
     }
 
-    for (int32_t i = 0; i < PadCStrAry_Len(dsttoks)-1; ++i) {
-        const char *tok = PadCStrAry_Getc(dsttoks, i);
-        PadCStr_App(dst, dstsz, tok);
-        PadCStr_AppFmt(dst, dstsz, "%c", PAD_FILE__SEP);
+    pthread_t threads[SCAN_MAX_WORKERS];
+    int32_t nthreads = 0;
+    for (int32_t n = count_scan_workers(); nthreads < n - 1; ++nthreads) {
+        if (pthread_create(&threads[nthreads], NULL, scan_worker_main, ctx) != 0) {
+            break;
+        }
     }
-    if (PadCStrAry_Len(dsttoks)) {
-        const char *tok = PadCStrAry_Getc(dsttoks, PadCStrAry_Len(dsttoks)-1);
-        PadCStr_App(dst, dstsz, tok);
+    // this thread is worker too
+    scan_worker_main(ctx);
+    for (int32_t i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], NULL);
     }
 
-    PadCStrAry_Del(srctoks);
-    PadCStrAry_Del(dsttoks);
+    for (int32_t i = 0; i < ctx->ndirs; ++i) {
+        free(ctx->dirs[i].path);  // rest of failed scan
+    }
+    free(ctx->dirs);
+    pthread_cond_destroy(&ctx->cond);
+    pthread_mutex_destroy(&ctx->mutex);
 
-    return dst;
+    return !ctx->is_err;
 }
 
-bool
-CapSymlink_IsLinkFile(const char *path) {
-    char line[PAD_FILE__NPATH + 100];
-    if (!PadFile_ReadLine(line, sizeof line, path)) {
-        return false;
+int32_t
+CapSymlink_Reindex(const CapConfig *config) {
+    if (!config) {
+        return -1;
+    }
+
+    CapLinkIndex *index = CapLinkIndex_New();
+    if (!index) {
+        return -1;
     }
 
-    return is_contain_header(line, strlen(line));
+    ScanCtx ctx = { .index = index };
+    if (!CapLinkIndex_Reset(index, config->home_path) ||
+        !scan_home(&ctx, config) ||
+        !CapLinkIndex_Save(index, config->var_links_path)) {
+        CapLinkIndex_Del(index);
+        return -1;
+    }
+
+    int32_t len = CapLinkIndex_Len(index);
+    CapLinkIndex_Del(index);
+    CapSymlink_ClearCache();
+    return len;
+}
+
+int32_t
+CapSymlink_TagLinks(const CapConfig *config) {
+    if (!config) {
+        return -1;
+    }
+
+    ScanCtx ctx = { .is_tag = true };
+    if (!scan_home(&ctx, config)) {
+        return -1;
+    }
+
+    CapSymlink_ClearCache();
+    return ctx.ntagged;
+}
+
+void
+CapSymlink_ClearCache(void) {
+    pthread_mutex_lock(&_mutex);
+    CapSymlinkCache_Clear(_cache);
+    if (_index_loaded && is_index_changed()) {
+        drop_index();
+    }
+    pthread_mutex_unlock(&_mutex);
 }
 
+CapSymlinkCacheStats
+CapSymlink_GetCacheStats(void) {
+    pthread_mutex_lock(&_mutex);
+    CapSymlinkCacheStats stats = CapSymlinkCache_GetStats(_cache);
+    pthread_mutex_unlock(&_mutex);
+    return stats;
+}
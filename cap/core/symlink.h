@@ -19,6 +19,11 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
 
 #include <pad/lib/file.h>
 #include <pad/lib/cstring.h>
@@ -27,12 +32,25 @@
 
 #include <cap/core/constant.h>
 #include <cap/core/config.h>
+#include <cap/core/symlink_cache.h>
+#include <cap/core/link_index.h>
 
 #define CAP_SYMLINK__HEADER "cap symlink:"
 
 /**
  * Follow path for symbolic links and save real path at destination
  *
+ * Components of path are checked one by one relative to the opened directory
+ * of resolved prefix and only header bytes of files are read
+ * Links to links are followed without limit of depth but circular links are failed
+ *
+ * If link index exists (created by CapSymlink_Reindex) then files are
+ * checked by the index without read of files
+ *
+ * Resolved paths are saved at resolution cache of process
+ * and each prefix of path is resolved only once while the file of entry is not changed
+ * Threads can call this at same time. the resolution is serialized by lock
+ *
  * @param[in] *dst     pointer to destination
  * @param[in] dstsz    number of size of destination
  * @param[in] *drtpath string of dirty path
@@ -64,10 +82,75 @@ CapSymlink_NormPath(const CapConfig *config, char *dst, uint32_t dstsz, const ch
 
 /**
  * Check file is Cap's symbolic link
+ * The link index is used if the file is covered by index
  *
- * @param[in] *path pointer to path
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *path   pointer to path
  *
  * @return file is link to true, else false
  */
 bool
-CapSymlink_IsLinkFile(const char *path);
+CapSymlink_IsLinkFile(const CapConfig *config, const char *path);
+
+/**
+ * Create Cap's symbolic link file and update link index
+ * The link file is tagged by extended attribute "user.cap.symlink" if supported
+ * The tag has mtime of file. The file changed after tagging is read
+ *
+ * @param[in] *config  pointer to CapConfig
+ * @param[in] *path    path of link file on file system
+ * @param[in] *cappath path of target in Cap's environment
+ *
+ * @return success to true else false
+ */
+bool
+CapSymlink_Link(const CapConfig *config, const char *path, const char *cappath);
+
+/**
+ * Remove Cap's symbolic link file and update link index
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *path   path of link file on file system
+ *
+ * @return success to true else false
+ */
+bool
+CapSymlink_Unlink(const CapConfig *config, const char *path);
+
+/**
+ * Rebuild link index of home by reading all files under home
+ * The index is saved at config->var_links_path
+ *
+ * @param[in] *config pointer to CapConfig
+ *
+ * @return success to number of links, failed to -1
+ */
+int32_t
+CapSymlink_Reindex(const CapConfig *config);
+
+/**
+ * Tag existing links under home by extended attribute
+ * Links created by old version of Cap or without cap link are not tagged
+ *
+ * @param[in] *config pointer to CapConfig
+ *
+ * @return success to number of tagged links, failed to -1
+ */
+int32_t
+CapSymlink_TagLinks(const CapConfig *config);
+
+/**
+ * Clear resolution cache of CapSymlink_FollowPath
+ * The link index is reloaded at next resolution if the index file was changed
+ * Call this after create or remove Cap's symbolic links in the process
+ */
+void
+CapSymlink_ClearCache(void);
+
+/**
+ * Get counters of resolution cache of CapSymlink_FollowPath
+ *
+ * @return counters
+ */
+CapSymlinkCacheStats
+CapSymlink_GetCacheStats(void);
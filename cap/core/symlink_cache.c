@@ -0,0 +1,362 @@
+#define _DEFAULT_SOURCE 1 /* cap: symlink_cache: st_mtim */
+
+#include <cap/core/symlink_cache.h>
+
+/**
+ * Entry of cache
+ */
+typedef struct CapSymlinkCacheEntry {
+    struct CapSymlinkCacheEntry *next;
+    uint32_t hash;
+    char *key;  // dirty path
+    char *value;  // resolved path
+    CapSymlinkDeps deps;  // stamps for validation
+} CapSymlinkCacheEntry;
+
+/**
+ * Structure of cache
+ */
+struct CapSymlinkCache {
+    CapSymlinkCacheEntry **buckets;
+    uint32_t nbuckets;  // power of 2
+    uint32_t capacity;
+    CapSymlinkCacheStats stats;
+};
+
+CapSymlinkStamp *
+CapSymlinkStamp_Load(CapSymlinkStamp *stamp, const char *path) {
+    struct stat st;
+
+    *stamp = (CapSymlinkStamp){0};
+    if (stat(path, &st) != 0) {
+        return stamp;
+    }
+
+    return CapSymlinkStamp_FromStat(stamp, &st);
+}
+
+CapSymlinkStamp *
+CapSymlinkStamp_FromStat(CapSymlinkStamp *stamp, const struct stat *st) {
+    *stamp = (CapSymlinkStamp){0};
+    stamp->exists = true;
+    stamp->dev = st->st_dev;
+    stamp->ino = st->st_ino;
+    stamp->mtime = st->st_mtime;
+#if defined(CAP__WINDOWS)
+    stamp->mtime_nsec = 0;
+#elif defined(__APPLE__)
+    stamp->mtime_nsec = st->st_mtimespec.tv_nsec;
+#else
+    stamp->mtime_nsec = st->st_mtim.tv_nsec;
+#endif
+    stamp->size = st->st_size;
+    stamp->mode = st->st_mode;
+    return stamp;
+}
+
+bool
+CapSymlinkStamp_Eq(const CapSymlinkStamp *lhs, const CapSymlinkStamp *rhs) {
+    return lhs->exists == rhs->exists &&
+           lhs->dev == rhs->dev &&
+           lhs->ino == rhs->ino &&
+           lhs->mtime == rhs->mtime &&
+           lhs->mtime_nsec == rhs->mtime_nsec &&
+           lhs->size == rhs->size &&
+           lhs->mode == rhs->mode;
+}
+
+void
+CapSymlinkStamp_Write(const CapSymlinkStamp *stamp, FILE *fout) {
+    fprintf(fout, "\t%d\t%llu\t%llu\t%lld\t%lld\t%lld\t%lu",
+        stamp->exists,
+        (unsigned long long) stamp->dev,
+        (unsigned long long) stamp->ino,
+        (long long) stamp->mtime,
+        (long long) stamp->mtime_nsec,
+        (long long) stamp->size,
+        (unsigned long) stamp->mode
+    );
+}
+
+CapSymlinkStamp *
+CapSymlinkStamp_Read(CapSymlinkStamp *stamp, char *fields[]) {
+    *stamp = (CapSymlinkStamp) {
+        .exists = atoi(fields[0]),
+        .dev = strtoull(fields[1], NULL, 10),
+        .ino = strtoull(fields[2], NULL, 10),
+        .mtime = strtoll(fields[3], NULL, 10),
+        .mtime_nsec = strtoll(fields[4], NULL, 10),
+        .size = strtoll(fields[5], NULL, 10),
+        .mode = strtoul(fields[6], NULL, 10),
+    };
+    return stamp;
+}
+
+/*******
+* deps *
+*******/
+
+void
+CapSymlinkDeps_Fini(CapSymlinkDeps *self) {
+    if (!self) {
+        return;
+    }
+
+    for (int32_t i = 0; i < self->len; ++i) {
+        Pad_SafeFree(self->deps[i].path);
+    }
+    Pad_SafeFree(self->deps);
+    *self = (CapSymlinkDeps){0};
+}
+
+CapSymlinkDeps *
+CapSymlinkDeps_Add(CapSymlinkDeps *self, const char *path, const CapSymlinkStamp *stamp) {
+    if (!self || !path || !stamp) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < self->len; ++i) {
+        if (PadCStr_Eq(self->deps[i].path, path)) {
+            return self;
+        }
+    }
+
+    if (self->len >= self->capa) {
+        int32_t capa = self->capa ? self->capa * 2 : 8;
+        CapSymlinkDep *deps = PadMem_Realloc(self->deps, sizeof(*deps) * capa);
+        if (!deps) {
+            return NULL;
+        }
+        self->deps = deps;
+        self->capa = capa;
+    }
+
+    char *dup = PadCStr_Dup(path);
+    if (!dup) {
+        return NULL;
+    }
+
+    self->deps[self->len++] = (CapSymlinkDep) { .path = dup, .stamp = *stamp };
+    return self;
+}
+
+CapSymlinkDeps *
+CapSymlinkDeps_Extend(CapSymlinkDeps *self, const CapSymlinkDeps *other) {
+    if (!self || !other) {
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < other->len; ++i) {
+        if (!CapSymlinkDeps_Add(self, other->deps[i].path, &other->deps[i].stamp)) {
+            return NULL;
+        }
+    }
+
+    return self;
+}
+
+static bool
+is_fresh_dep(const CapSymlinkDep *dep) {
+    CapSymlinkStamp cur;
+    CapSymlinkStamp_Load(&cur, dep->path);
+
+    const CapSymlinkStamp *old = &dep->stamp;
+    if (old->exists && cur.exists && S_ISDIR(old->mode)) {
+        return old->dev == cur.dev && old->ino == cur.ino && old->mode == cur.mode;
+    }
+
+    return CapSymlinkStamp_Eq(old, &cur);
+}
+
+bool
+CapSymlinkDeps_IsFresh(const CapSymlinkDeps *self, int32_t from) {
+    if (!self) {
+        return false;
+    }
+
+    for (int32_t i = from; i < self->len; ++i) {
+        if (!is_fresh_dep(&self->deps[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/********
+* cache *
+********/
+
+static void
+entry_del(CapSymlinkCacheEntry *entry) {
+    if (!entry) {
+        return;
+    }
+
+    Pad_SafeFree(entry->key);
+    Pad_SafeFree(entry->value);
+    CapSymlinkDeps_Fini(&entry->deps);
+    Pad_SafeFree(entry);
+}
+
+void
+CapSymlinkCache_Del(CapSymlinkCache *self) {
+    if (!self) {
+        return;
+    }
+
+    CapSymlinkCache_Clear(self);
+    Pad_SafeFree(self->buckets);
+    Pad_SafeFree(self);
+}
+
+CapSymlinkCache *
+CapSymlinkCache_New(uint32_t capacity) {
+    CapSymlinkCache *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->capacity = capacity ? capacity : 1;
+    self->nbuckets = 16;
+    for (; self->nbuckets < self->capacity; self->nbuckets <<= 1) {
+    }
+
+    self->buckets = PadMem_Calloc(self->nbuckets, sizeof(*self->buckets));
+    if (!self->buckets) {
+        CapSymlinkCache_Del(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+static CapSymlinkCacheEntry **
+find_slot(CapSymlinkCache *self, uint32_t hash, const char *key) {
+    CapSymlinkCacheEntry **slot = &self->buckets[hash & (self->nbuckets-1)];
+    for (; *slot; slot = &(*slot)->next) {
+        if ((*slot)->hash == hash && !strcmp((*slot)->key, key)) {
+            break;
+        }
+    }
+    return slot;
+}
+
+bool
+CapSymlinkCache_Find(
+    CapSymlinkCache *self,
+    const char *drtpath,
+    char *dst,
+    uint32_t dstsz,
+    CapSymlinkDeps *deps
+) {
+    if (!self || !drtpath || !dst || !dstsz || !deps) {
+        return false;
+    }
+
+    uint32_t hash = CapRecord_HashStr32(drtpath);
+    CapSymlinkCacheEntry *entry = *find_slot(self, hash, drtpath);
+    if (!entry) {
+        self->stats.misses++;
+        return false;
+    }
+
+    if (!CapSymlinkDeps_Extend(deps, &entry->deps)) {
+        return false;
+    }
+    snprintf(dst, dstsz, "%s", entry->value);
+    return true;
+}
+
+void
+CapSymlinkCache_Hit(CapSymlinkCache *self) {
+    if (self) {
+        self->stats.hits++;
+    }
+}
+
+void
+CapSymlinkCache_Invalidate(CapSymlinkCache *self, const char *drtpath) {
+    if (!self || !drtpath) {
+        return;
+    }
+
+    // file was changed after resolution
+    self->stats.stales++;
+    CapSymlinkCacheEntry **slot = find_slot(self, CapRecord_HashStr32(drtpath), drtpath);
+    CapSymlinkCacheEntry *entry = *slot;
+    if (entry) {
+        *slot = entry->next;
+        entry_del(entry);
+        self->stats.len--;
+    }
+}
+
+CapSymlinkCache *
+CapSymlinkCache_Set(
+    CapSymlinkCache *self,
+    const char *drtpath,
+    const char *resolved,
+    const CapSymlinkDeps *deps
+) {
+    if (!self || !drtpath || !resolved || !deps) {
+        return NULL;
+    }
+
+    uint32_t hash = CapRecord_HashStr32(drtpath);
+    CapSymlinkCacheEntry **slot = find_slot(self, hash, drtpath);
+    if (*slot) {
+        CapSymlinkCacheEntry *old = *slot;
+        *slot = old->next;
+        entry_del(old);
+        self->stats.len--;
+    } else if (self->stats.len >= self->capacity) {
+        // simple eviction. tree walks refill hot prefixes soon
+        CapSymlinkCache_Clear(self);
+        slot = find_slot(self, hash, drtpath);
+    }
+
+    CapSymlinkCacheEntry *entry = PadMem_Calloc(1, sizeof(*entry));
+    if (!entry) {
+        return NULL;
+    }
+
+    entry->hash = hash;
+    entry->key = PadCStr_Dup(drtpath);
+    entry->value = PadCStr_Dup(resolved);
+    if (!entry->key || !entry->value || !CapSymlinkDeps_Extend(&entry->deps, deps)) {
+        entry_del(entry);
+        return NULL;
+    }
+
+    *slot = entry;
+    self->stats.len++;
+    return self;
+}
+
+void
+CapSymlinkCache_Clear(CapSymlinkCache *self) {
+    if (!self) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < self->nbuckets; ++i) {
+        for (CapSymlinkCacheEntry *entry = self->buckets[i]; entry; ) {
+            CapSymlinkCacheEntry *next = entry->next;
+            entry_del(entry);
+            entry = next;
+        }
+        self->buckets[i] = NULL;
+    }
+
+    self->stats.len = 0;
+}
+
+CapSymlinkCacheStats
+CapSymlinkCache_GetStats(const CapSymlinkCache *self) {
+    if (!self) {
+        return (CapSymlinkCacheStats){0};
+    }
+
+    return self->stats;
+}
@@ -0,0 +1,271 @@
+/**
+ * Resolution cache for CapSymlink_FollowPath
+ *
+ * 解決済みのパスを絶対パスのダーティパスをキーにしてプロセス内に保存する
+ * エントリは解決時に調べたすべてのパスの要素（ディレクトリ、リンクファイル、存在しないパスなど）のスタンプを持ち
+ * 参照時にどれかのスタンプが変わっていればそのエントリは無効になる
+ * ディレクトリは置き換えだけを検出する（中身の変化は次の要素のスタンプで検出する）
+ * スタンプの検証はロックの外で行えるように、エントリの値とスタンプはコピーして返す
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+
+#include <cap/core/constant.h>
+#include <cap/core/record.h>
+
+/**
+ * Stamp of file on file system
+ */
+typedef struct {
+    bool exists;
+    uint64_t dev;
+    uint64_t ino;
+    int64_t mtime;
+    int64_t mtime_nsec;  // rewrite in same second is detected by this
+    int64_t size;
+    uint32_t mode;
+} CapSymlinkStamp;
+
+/**
+ * Stamp of path examined in resolution
+ */
+typedef struct {
+    char *path;
+    CapSymlinkStamp stamp;
+} CapSymlinkDep;
+
+/**
+ * Paths examined in resolution. Zero value is empty
+ */
+typedef struct {
+    CapSymlinkDep *deps;
+    int32_t len;
+    int32_t capa;
+} CapSymlinkDeps;
+
+/**
+ * Counters of cache
+ */
+typedef struct {
+    uint64_t hits;  // number of valid entries found
+    uint64_t misses;  // number of keys not found
+    uint64_t stales;  // number of entries found but invalidated by stamp
+    uint32_t len;  // number of entries in cache
+} CapSymlinkCacheStats;
+
+struct CapSymlinkCache;
+typedef struct CapSymlinkCache CapSymlinkCache;
+
+/**
+ * Load stamp of path from file system
+ * If path is not exists then stamp->exists is false
+ *
+ * @param[out] *stamp pointer to destination
+ * @param[in]  *path  path on file system
+ *
+ * @return pointer to stamp
+ */
+CapSymlinkStamp *
+CapSymlinkStamp_Load(CapSymlinkStamp *stamp, const char *path);
+
+/**
+ * Make stamp from result of stat(2)
+ *
+ * @param[out] *stamp pointer to destination
+ * @param[in]  *st    pointer to result of stat
+ *
+ * @return pointer to stamp
+ */
+CapSymlinkStamp *
+CapSymlinkStamp_FromStat(CapSymlinkStamp *stamp, const struct stat *st);
+
+/**
+ * Compare stamps
+ *
+ * @param[in] *lhs
+ * @param[in] *rhs
+ *
+ * @return equal to true else false
+ */
+bool
+CapSymlinkStamp_Eq(const CapSymlinkStamp *lhs, const CapSymlinkStamp *rhs);
+
+/**
+ * Number of fields of stamp in record of cache files
+ */
+enum {
+    CAP_SYMLINK_STAMP__NFIELDS = 7,
+};
+
+/**
+ * Write stamp as fields of record. Fields are preceded by tab
+ *
+ * @param[in] *stamp pointer to stamp
+ * @param[in] *fout  destination stream
+ */
+void
+CapSymlinkStamp_Write(const CapSymlinkStamp *stamp, FILE *fout);
+
+/**
+ * Read stamp from fields of record that were written by CapSymlinkStamp_Write
+ *
+ * @param[out] *stamp  pointer to destination
+ * @param[in]  *fields array of CAP_SYMLINK_STAMP__NFIELDS fields
+ *
+ * @return pointer to stamp
+ */
+CapSymlinkStamp *
+CapSymlinkStamp_Read(CapSymlinkStamp *stamp, char *fields[]);
+
+/**
+ * Finalize deps. The deps is empty after this
+ *
+ * @param[in] *self pointer to CapSymlinkDeps
+ */
+void
+CapSymlinkDeps_Fini(CapSymlinkDeps *self);
+
+/**
+ * Add stamp of path. The path already added is ignored
+ *
+ * @param[in] *self  pointer to CapSymlinkDeps
+ * @param[in] *path  path on file system
+ * @param[in] *stamp stamp of path
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSymlinkDeps *
+CapSymlinkDeps_Add(CapSymlinkDeps *self, const char *path, const CapSymlinkStamp *stamp);
+
+/**
+ * Add stamps of other deps
+ *
+ * @param[in] *self  pointer to CapSymlinkDeps
+ * @param[in] *other pointer to other CapSymlinkDeps
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSymlinkDeps *
+CapSymlinkDeps_Extend(CapSymlinkDeps *self, const CapSymlinkDeps *other);
+
+/**
+ * Check paths are not changed after resolution
+ * Directory is compared by device, inode and mode because the change of entries
+ * is detected by stamp of next component
+ *
+ * @param[in] *self pointer to CapSymlinkDeps
+ * @param[in] from  index of first dep to check
+ *
+ * @return not changed to true else false
+ */
+bool
+CapSymlinkDeps_IsFresh(const CapSymlinkDeps *self, int32_t from);
+
+/**
+ * Destruct cache
+ *
+ * @param[in] *self pointer to CapSymlinkCache
+ */
+void
+CapSymlinkCache_Del(CapSymlinkCache *self);
+
+/**
+ * Construct cache
+ *
+ * @param[in] capacity maximum number of entries. if cache is full then cache is cleared
+ *
+ * @return success to pointer to CapSymlinkCache (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapSymlinkCache *
+CapSymlinkCache_New(uint32_t capacity);
+
+/**
+ * Find resolved path by dirty path
+ * The value and stamps of entry are copied. validate them by CapSymlinkDeps_IsFresh
+ * and report result by CapSymlinkCache_Hit or CapSymlinkCache_Invalidate
+ *
+ * @param[in]  *self    pointer to CapSymlinkCache
+ * @param[in]  *drtpath dirty path
+ * @param[out] *dst     pointer to destination of resolved path
+ * @param[in]  dstsz    number of size of destination
+ * @param[out] *deps    stamps of entry are added to this
+ *
+ * @return found to true else false
+ */
+bool
+CapSymlinkCache_Find(
+    CapSymlinkCache *self,
+    const char *drtpath,
+    char *dst,
+    uint32_t dstsz,
+    CapSymlinkDeps *deps
+);
+
+/**
+ * Count valid entry found by CapSymlinkCache_Find
+ *
+ * @param[in] *self pointer to CapSymlinkCache
+ */
+void
+CapSymlinkCache_Hit(CapSymlinkCache *self);
+
+/**
+ * Remove entry invalidated by stamps
+ *
+ * @param[in] *self    pointer to CapSymlinkCache
+ * @param[in] *drtpath dirty path
+ */
+void
+CapSymlinkCache_Invalidate(CapSymlinkCache *self, const char *drtpath);
+
+/**
+ * Save resolved path with stamps of paths examined in resolution
+ *
+ * @param[in] *self     pointer to CapSymlinkCache
+ * @param[in] *drtpath  dirty path (key)
+ * @param[in] *resolved resolved path (value)
+ * @param[in] *deps     stamps for validation of entry
+ *
+ * @return success to pointer to self
+ * @return failed to NULL
+ */
+CapSymlinkCache *
+CapSymlinkCache_Set(
+    CapSymlinkCache *self,
+    const char *drtpath,
+    const char *resolved,
+    const CapSymlinkDeps *deps
+);
+
+/**
+ * Clear all entries (counters are not cleared)
+ *
+ * @param[in] *self pointer to CapSymlinkCache
+ */
+void
+CapSymlinkCache_Clear(CapSymlinkCache *self);
+
+/**
+ * Get counters of cache
+ *
+ * @param[in] *self pointer to CapSymlinkCache
+ *
+ * @return counters
+ */
+CapSymlinkCacheStats
+CapSymlinkCache_GetStats(const CapSymlinkCache *self);
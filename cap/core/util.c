@@ -6,12 +6,41 @@
  *   Since: 2016
  */
 #include <cap/core/util.h>
+#include <cap/core/warm.h>
 
+/**
+ * Read PATH variable of resource file
+ * The standard output of resource file is written to output of config
+ *
+ * @param[in]  *config   pointer to CapConfig
+ * @param[in]  *rcpath   path of resource file
+ * @param[out] *is_quiet store false if resource file wrote any output
+ *
+ * @return found to pointer to PATH (dynamic allocate memory) else NULL
+ */
 static char *
-read_path_var_from_resource(const CapConfig *config, const char *rcpath) {
+read_path_var_from_resource(const CapConfig *config, const char *rcpath, bool *is_quiet) {
+    CapKit *kit = NULL;
     char *src = PadFile_ReadCopyFromPath(rcpath);
+    if (src == NULL) {
+        goto error;
+    }
 
-    CapKit *kit = CapKit_New(config);
+    // fast path for declarative resource file
+    CapRcScanResult result;
+    if (CapRcScanner_Scan(&result, NULL, src)) {
+        Pad_SafeFree(src);
+        if (!result.has_path) {
+            return NULL;
+        }
+        const char *out = CapRcScanResult_PopNewlineOfStdoutBuf(&result);
+        *is_quiet = out[0] == '\0';
+        CapOut_Printf(config, "%s", out);
+        CapOut_Flush(config);
+        return PadCStr_Dup(result.path);
+    }
+
+    kit = CapWarm_NewKit(config);
     if (kit == NULL) {
         goto error;
     }
@@ -35,8 +64,10 @@ read_path_var_from_resource(const CapConfig *config, const char *rcpath) {
     }
 
     PadCtx_PopNewlineOfStdoutBuf(ctx);
-    printf("%s", PadCtx_GetcStdoutBuf(ctx));
-    fflush(stdout);
+    const char *out = PadCtx_GetcStdoutBuf(ctx);
+    *is_quiet = out[0] == '\0';
+    CapOut_Printf(config, "%s", out);
+    CapOut_Flush(config);
 
     const char *s = PadUni_GetcMB(item->value->unicode);
     char *path = PadCStr_Dup(s);
@@ -44,10 +75,12 @@ read_path_var_from_resource(const CapConfig *config, const char *rcpath) {
         goto error;
     }
 
-    CapKit_Del(kit);
+    CapWarm_DelKit(config, kit, true);
+    Pad_SafeFree(src);
     return path;
 error:
-    CapKit_Del(kit);
+    CapWarm_DelKit(config, kit, false);
+    Pad_SafeFree(src);
     return NULL;
 }
 
@@ -119,7 +152,7 @@ Cap_GetOrigin(const CapConfig *config, const char *cap_path) {
         return config->home_path;
     }
 
-    PadErr_Die("impossible. invalid state in get origin");
+    CapOut_Err(config, "impossible. invalid state in get origin");
     return NULL;
 }
 
@@ -142,67 +175,86 @@ show_snippet(const CapConfig *config, const char *fname, int argc, char **argv)
 
     char path[PAD_FILE__NPATH];
     if (!PadFile_SolveFmt(path, sizeof path, "%s/%s", config->codes_dir_path, fname)) {
-        PadErr_Err("failed to solve path for snippet file");
+        CapOut_Err(config, "failed to solve path for snippet file");
         return false;
     }
 
     char *content = PadFile_ReadCopyFromPath(path);
     if (!content) {
-        PadErr_Err("failed to read from snippet \"%s\"", fname);
+        CapOut_Err(config, "failed to read from snippet \"%s\"", fname);
         return false;
     }
 
     PadErrStack *errstack = PadErrStack_New();
-    char *compiled = Cap_MakeArgv(config, errstack, fname, content, argc, argv);
-    if (!compiled) {
-        PadErrStack_TraceSimple(errstack, stderr);
-        fflush(stderr);
-        free(content);
-        PadErrStack_Del(errstack);
-        return false;
+    CapSink *sink = CapOut_NewSink(config);
+    bool ok = Cap_MakeArgvToSink(config, errstack, fname, content, argc, argv, sink) &&
+              CapSink_Close(sink);
+    if (!ok) {
+        CapOut_TraceErrStack(config, errstack);
     }
 
-    printf("%s", compiled);
-    fflush(stdout);
-
+    CapSink_Del(sink);
     free(content);
-    free(compiled);
-
     PadErrStack_Del(errstack);
-    return true;
+    return ok;
 }
 
 int
-Cap_ExecSnippet(const CapConfig *config, bool *found, int argc, char **argv, const char *name) {
-    if (!config || !found || !argv || !name) {
-        PadErr_Warn("util:Cap_ExecSnippet: invalid arguments");
+Cap_FindSnippet(const CapConfig *config, bool *found, const char *name) {
+    if (!config || !found || !name) {
+        CapOut_Warn(config, "util:Cap_FindSnippet: invalid arguments");
         return 1;
     }
 
-    PadDir *dir = PadDir_Open(config->codes_dir_path);
-    if (!dir) {
-        PadErr_Err("failed to open directory \"%s\"", config->codes_dir_path);
+    *found = false;
+    if (!*name || Pad_IsDotFile(name) || strchr(name, '/') || strchr(name, '\\')) {
+        // not file name in directory
+        return 0;
+    }
+
+    // look up file directly instead of read of directory
+    char path[PAD_FILE__NPATH];
+    if (!PadFile_SolveFmt(path, sizeof path, "%s/%s", config->codes_dir_path, name)) {
+        CapOut_Err(config, "failed to solve path for snippet file");
         return 1;
     }
 
-    *found = false;
-    for (PadDirNode *node; (node = PadDir_Read(dir)); ) {
-        const char *fname = PadDirNode_Name(node);
-        if (Pad_IsDotFile(fname)) {
-            continue;
-        }
+    if (PadFile_IsExists(path)) {
+        *found = true;
+        return 0;
+    }
 
-        if (PadCStr_Eq(fname, name)) {
-            *found = true;
-            if (!show_snippet(config, fname, argc, argv)) {
-                PadDir_Close(dir);
-                return 1;
-            }
-        }
+    if (!PadFile_IsDir(config->codes_dir_path)) {
+        CapOut_Err(config, "failed to open directory \"%s\"", config->codes_dir_path);
+        return 1;
+    }
+
+    return 0;
+}
+
+int
+Cap_ExecSnippetFile(const CapConfig *config, int argc, char **argv, const char *name) {
+    if (!show_snippet(config, name, argc, argv)) {
+        return 1;
     }
+    return 0;
+}
 
-    PadDir_Close(dir);
-    return *found ? 0 : -1;
+int
+Cap_ExecSnippet(const CapConfig *config, bool *found, int argc, char **argv, const char *name) {
+    if (!config || !found || !argv || !name) {
+        CapOut_Warn(config, "util:Cap_ExecSnippet: invalid arguments");
+        return 1;
+    }
+
+    if (Cap_FindSnippet(config, found, name) != 0) {
+        return 1;
+    }
+    if (!*found) {
+        return -1;
+    }
+
+    return Cap_ExecSnippetFile(config, argc, argv, name);
 }
 
 int
@@ -218,102 +270,273 @@ Cap_ExecRun(const CapConfig *config, int argc, char *argv[]) {
     return result;
 }
 
-static int
-exec_prog_by_dirname(const CapConfig *config, bool *found, int cmd_argc, char *cmd_argv[], const char *cap_dirname) {
-    *found = false;
-
-    const char *cmdname = cmd_argv[0];
-    char cap_fpath[PAD_FILE__NPATH];
-    snprintf(cap_fpath, sizeof cap_fpath, "%s/%s", cap_dirname, cmdname);
+static bool
+find_prog_by_dirname(
+    const CapConfig *config,
+    CapCmdCacheEntry *entry,
+    char *cap_fpath,
+    int32_t cap_fpathsz,
+    const char *cmdname,
+    const char *cap_dirname
+) {
+    snprintf(cap_fpath, cap_fpathsz, "%s/%s", cap_dirname, cmdname);
 
     const char *org = Cap_GetOrigin(config, cap_fpath);
+    char real_dirpath[PAD_FILE__NPATH];
     char real_path[PAD_FILE__NPATH];
-    if (!PadFile_SolveFmt(real_path, sizeof real_path, "%s/%s", org, cap_fpath)) {
-        PadErr_Err("failed to solve in execute program in directory");
-        return 1;
-    }
-    if (!PadFile_IsExists(real_path)) {
-        return 1;
+    if (!PadFile_SolveFmt(real_dirpath, sizeof real_dirpath, "%s/%s", org, cap_dirname) ||
+        !PadFile_SolveFmt(real_path, sizeof real_path, "%s/%s", org, cap_fpath)) {
+        CapOut_Err(config, "failed to solve in execute program in directory");
+        if (entry) {
+            entry->is_uncacheable = true;
+        }
+        return false;
     }
-    *found = true;
 
-    PadCStrAry *args = PadCStrAry_New();
-    PadCStrAry_PushBack(args, "run");
-    PadCStrAry_PushBack(args, cap_fpath);
-    for (int32_t i = 1; i < cmd_argc; ++i) {
-        PadCStrAry_PushBack(args, cmd_argv[i]);
+    // programs are added to or removed from the directory
+    if (entry) {
+        CapCmdCacheEntry_AddDep(entry, real_dirpath);
     }
 
-    int argc = PadCStrAry_Len(args);
-    char **argv = PadCStrAry_EscDel(args);
-    return Cap_ExecRun(config, argc, argv);
+    return PadFile_IsExists(real_path);
 }
 
-static int
-exec_prog_by_caprc(const CapConfig *config, bool *found, int cmd_argc, char *cmd_argv[], const char *org) {
-    *found = false;
+static bool
+find_prog_by_caprc(
+    const CapConfig *config,
+    CapCmdCacheEntry *entry,
+    char *cap_fpath,
+    int32_t cap_fpathsz,
+    const char *cmdname,
+    const char *org
+) {
     char rcpath[PAD_FILE__NPATH];
 
     if (!PadFile_SolveFmt(rcpath, sizeof rcpath, "%s/.caprc", org)) {
-        return 1;
+        if (entry) {
+            entry->is_uncacheable = true;
+        }
+        return false;
+    }
+
+    if (entry) {
+        CapCmdCacheEntry_AddDep(entry, rcpath);
     }
 
     if (!PadFile_IsExists(rcpath)) {
-        return 1;
+        return false;
     }
 
-    char *path = read_path_var_from_resource(config, rcpath);
+    bool is_quiet = true;
+    char *path = read_path_var_from_resource(config, rcpath, &is_quiet);
+    if (!is_quiet && entry) {
+        // the output of resource file is not reproduced by cache
+        entry->is_uncacheable = true;
+    }
     if (!path) {
-        return 1;
+        return false;
     }
-    
+
     PadCStrAry *dirs = split_path_var(path);
     free(path);
-    if (!PadCStrAry_Len(dirs)) {
-        return 1;
-    }
 
+    bool found = false;
     for (int32_t i = 0; i < PadCStrAry_Len(dirs); ++i) {
         const char *cap_dirname = PadCStrAry_Getc(dirs, i);
+        if (find_prog_by_dirname(config, entry, cap_fpath, cap_fpathsz, cmdname, cap_dirname)) {
+            found = true;
+            break;
+        }
+    }
+
+    PadCStrAry_Del(dirs);
+    return found;
+}
+
+/**
+ * Add programs in PATH of resource file to hash
+ *
+ * @param[in] *config pointer to CapConfig
+ * @param[in] *hash   pointer to CapProgHash
+ * @param[in] *org    directory of resource file
+ *
+ * @return success to true else false
+ */
+static bool
+hash_progs_by_caprc(const CapConfig *config, CapProgHash *hash, const char *org) {
+    char rcpath[PAD_FILE__NPATH];
+    if (!PadFile_SolveFmt(rcpath, sizeof rcpath, "%s/.caprc", org)) {
+        return false;
+    }
+
+    // stamp before read
+    if (!CapProgHash_AddDep(hash, rcpath)) {
+        return false;
+    }
+    if (!PadFile_IsExists(rcpath)) {
+        return true;
+    }
+
+    // PATH built by modules, commands or files is not reproduced by stamp of resource file
+    if (!CapAliasCache_IsCacheablePath(rcpath)) {
+        CapProgHash_SetUncacheable(hash);
+    }
+
+    bool is_quiet = true;
+    char *path = read_path_var_from_resource(config, rcpath, &is_quiet);
+    if (!is_quiet) {
+        // the output of resource file is not reproduced by hash
+        CapProgHash_SetUncacheable(hash);
+    }
+    if (!path) {
+        return true;
+    }
+
+    PadCStrAry *dirs = split_path_var(path);
+    free(path);
+
+    bool ok = true;
+    for (int32_t i = 0; ok && i < PadCStrAry_Len(dirs); ++i) {
+        const char *cap_dirname = PadCStrAry_Getc(dirs, i);
+        const char *dir_org = Cap_GetOrigin(config, cap_dirname);
+        char real_dirpath[PAD_FILE__NPATH];
+        if (!PadFile_SolveFmt(real_dirpath, sizeof real_dirpath, "%s/%s", dir_org, cap_dirname)) {
+            ok = false;
+            break;
+        }
+
+        if (!CapProgHash_AddDep(hash, real_dirpath)) {
+            ok = false;
+            break;
+        }
+
+        PadDir *dir = PadDir_Open(real_dirpath);
+        if (!dir) {
+            continue;
+        }
 
-        *found = false;
-        int result = exec_prog_by_dirname(
-            config,
-            found,
-            cmd_argc,
-            cmd_argv,
-            cap_dirname
-        );
-        if (*found) {
-            return result;
+        for (PadDirNode *node; (node = PadDir_Read(dir)); PadDirNode_Del(node)) {
+            const char *name = PadDirNode_Name(node);
+            if (Pad_IsDotFile(name)) {
+                continue;
+            }
+
+            char cap_fpath[PAD_FILE__NPATH];
+            snprintf(cap_fpath, sizeof cap_fpath, "%s/%s", cap_dirname, name);
+            if (!CapProgHash_Add(hash, name, cap_fpath)) {
+                ok = false;
+                PadDirNode_Del(node);
+                break;
+            }
         }
+
+        PadDir_Close(dir);
     }
 
-    return 1;
+    PadCStrAry_Del(dirs);
+    return ok;
 }
 
-int
-Cap_ExecProg(const CapConfig *config, bool *found, int cmd_argc, char *cmd_argv[], const char *cmdname) {
-    if (cmdname[0] == '.') {
-        *found = false;
-        return 1;
+CapProgHash *
+Cap_UpdateProgHash(const CapConfig *config, CapProgHash *hash, bool is_rebuild) {
+    if (!config || !hash) {
+        return NULL;
     }
 
-    int result;
+    if (!is_rebuild &&
+        CapProgHash_Load(hash, config->var_hash_path, config) &&
+        !CapProgHash_IsUncacheable(hash)) {
+        return hash;  // mark of uncacheable has not programs
+    }
 
-    *found = false;
-    result = exec_prog_by_caprc(config, found, cmd_argc, cmd_argv, config->cd_path);
-    if (*found) {
-        return result;
+    // local scope is first
+    if (!CapProgHash_Reset(hash, config) ||
+        !hash_progs_by_caprc(config, hash, config->cd_path) ||
+        !hash_progs_by_caprc(config, hash, config->home_path)) {
+        return NULL;
     }
 
-    *found = false;
-    result = exec_prog_by_caprc(config, found, cmd_argc, cmd_argv, config->home_path);
-    if (*found) {
-        return result;
+    // failure of save is not error. next time hashes again
+    CapProgHash_Save(hash, config->var_hash_path);
+    return hash;
+}
+
+bool
+Cap_FindProg(
+    const CapConfig *config,
+    CapCmdCacheEntry *entry,
+    char *cap_fpath,
+    int32_t cap_fpathsz,
+    const char *cmdname
+) {
+    if (!config || !cap_fpath || !cmdname || cmdname[0] == '.') {
+        return false;
+    }
+
+    CapProgHash *hash = NULL;
+    if (!strpbrk(cmdname, "/\\")) {
+        hash = CapProgHash_New();
+        if (hash &&
+            !CapProgHash_Load(hash, config->var_hash_path, config) &&
+            !Cap_UpdateProgHash(config, hash, true)) {
+            CapProgHash_Del(hash);
+            hash = NULL;
+        }
+        if (hash && CapProgHash_IsUncacheable(hash)) {
+            // not saved hash is built at each lookup. stat directories of PATH instead
+            CapProgHash_Del(hash);
+            hash = NULL;
+        }
+    }
+
+    if (!hash) {
+        // program in sub directory is not hashed
+        return find_prog_by_caprc(config, entry, cap_fpath, cap_fpathsz, cmdname, config->cd_path) ||
+               find_prog_by_caprc(config, entry, cap_fpath, cap_fpathsz, cmdname, config->home_path);
+    }
+
+    if (entry) {
+        for (int32_t i = 0; i < CapProgHash_DepsLen(hash); ++i) {
+            const CapProgHashDep *dep = CapProgHash_GetcDepAt(hash, i);
+            CapCmdCacheEntry_AddStampedDep(entry, dep->path, &dep->stamp);
+        }
+    }
+
+    const char *found = CapProgHash_Find(hash, cmdname);
+    if (found) {
+        snprintf(cap_fpath, cap_fpathsz, "%s", found);
     }
 
-    return 1;
+    CapProgHash_Del(hash);
+    return found != NULL;
+}
+
+int
+Cap_ExecProgPath(const CapConfig *config, int cmd_argc, char *cmd_argv[], const char *cap_fpath) {
+    PadCStrAry *args = PadCStrAry_New();
+    PadCStrAry_PushBack(args, "run");
+    PadCStrAry_PushBack(args, cap_fpath);
+    for (int32_t i = 1; i < cmd_argc; ++i) {
+        PadCStrAry_PushBack(args, cmd_argv[i]);
+    }
+
+    int argc = PadCStrAry_Len(args);
+    char **argv = PadCStrAry_EscDel(args);
+    int result = Cap_ExecRun(config, argc, argv);
+    Pad_FreeArgv(argc, argv);
+    return result;
+}
+
+int
+Cap_ExecProg(const CapConfig *config, bool *found, int cmd_argc, char *cmd_argv[], const char *cmdname) {
+    char cap_fpath[PAD_FILE__NPATH];
+
+    *found = Cap_FindProg(config, NULL, cap_fpath, sizeof cap_fpath, cmdname);
+    if (!*found) {
+        return 1;
+    }
+
+    return Cap_ExecProgPath(config, cmd_argc, cmd_argv, cap_fpath);
 }
 
 char *
@@ -325,12 +548,68 @@ Cap_MakeArgv(
     int argc,
     char *argv[]
 ) {
-    CapKit *kit = CapKit_New(config);
+    return Cap_MakeArgvWithDeps(config, errstack, program_filename, src, argc, argv, NULL);
+}
+
+char *
+Cap_MakeArgvWithDeps(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const char *program_filename,
+    const char *src,
+    int argc,
+    char *argv[],
+    PadCStrAry *deps
+) {
+    CapKit *kit = CapWarm_NewKit(config);
     if (kit == NULL) {
         PadErrStack_Add(errstack, "failed to create kit");
+        return NULL;
+    }
+
+    char *maked = Cap_MakeArgvByKit(kit, errstack, program_filename, src, argc, argv);
+    if (maked == NULL) {
         goto error;
     }
 
+    const PadCStrAry *kit_deps = CapKit_GetcDeps(kit);
+    for (int32_t i = 0; deps && i < PadCStrAry_Len(kit_deps); ++i) {
+        if (!PadCStrAry_PushBack(deps, PadCStrAry_Getc(kit_deps, i))) {
+            PadErrStack_Add(errstack, "failed to push dependency");
+            Pad_SafeFree(maked);
+            goto error;
+        }
+    }
+
+    CapWarm_DelKit(config, kit, true);
+    return maked;
+error:
+    CapWarm_DelKit(config, kit, false);
+    return NULL;
+}
+
+bool
+Cap_MakeArgvToSink(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const char *program_filename,
+    const char *src,
+    int argc,
+    char *argv[],
+    CapSink *sink
+) {
+    if (sink == NULL) {
+        PadErrStack_Add(errstack, "sink is null");
+        return false;
+    }
+
+    CapKit *kit = CapWarm_NewKit(config);
+    if (kit == NULL) {
+        PadErrStack_Add(errstack, "failed to create kit");
+        return false;
+    }
+
+    bool ok = false;
     if (CapKit_CompileFromStrArgs(
         kit,
         program_filename,
@@ -341,19 +620,48 @@ Cap_MakeArgv(
         const PadErrStack *es = CapKit_GetcErrStack(kit);
         PadErrStack_ExtendBackOther(errstack, es);
         PadErrStack_Add(errstack, "failed to compile");
-        goto error;
+        goto done;
+    }
+
+    if (!CapKit_WriteStdoutBuf(kit, sink)) {
+        PadErrStack_Add(errstack, "failed to write output");
+        goto done;
+    }
+
+    ok = true;
+done:
+    CapWarm_DelKit(config, kit, ok);
+    return ok;
+}
+
+char *
+Cap_MakeArgvByKit(
+    CapKit *kit,
+    PadErrStack *errstack,
+    const char *program_filename,
+    const char *src,
+    int argc,
+    char *argv[]
+) {
+    if (CapKit_CompileFromStrArgs(
+        kit,
+        program_filename,
+        src,
+        argc,
+        argv
+    ) == NULL) {
+        const PadErrStack *es = CapKit_GetcErrStack(kit);
+        PadErrStack_ExtendBackOther(errstack, es);
+        PadErrStack_Add(errstack, "failed to compile");
+        return NULL;
     }
 
     const char *stdout_buf = CapKit_GetcStdoutBuf(kit);
     char *maked = PadCStr_Dup(stdout_buf);
     if (maked == NULL) {
         PadErrStack_Add(errstack, "failed to dup");
-        goto error;
+        return NULL;
     }
 
-    CapKit_Del(kit);
     return maked;
-error:
-    CapKit_Del(kit);
-    return NULL;
 }
@@ -28,6 +28,11 @@
 #include <cap/core/types.h>
 #include <cap/core/constant.h>
 #include <cap/core/config.h>
+#include <cap/core/rc_scanner.h>
+#include <cap/core/cmd_cache.h>
+#include <cap/core/prog_hash.h>
+#include <cap/core/alias_cache.h>
+#include <cap/core/output.h>
 #include <cap/run/run.h>
 #include <cap/lang/opts.h>
 #include <cap/lang/kit.h>
@@ -80,6 +85,35 @@ Cap_SolveCmdlineArgPath(
 const char *
 Cap_GetOrigin(const CapConfig *config, const char *cap_path);
 
+/**
+ * Find snippet file by name in directory of snippets
+ * The file is looked up directly without read of directory
+ *
+ * @param[in]  *config reference to config
+ * @param[out] *found  store true if found else false
+ * @param[in]  *name   snippet name
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+int
+Cap_FindSnippet(const CapConfig *config, bool *found, const char *name);
+
+/**
+ * Show snippet code of snippet file
+ * The snippet file must be found by Cap_FindSnippet
+ *
+ * @param[in] *config reference to config
+ * @param[in] argc    number of arguments
+ * @param[in] **argv  arguments
+ * @param[in] *name   snippet name
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+int
+Cap_ExecSnippetFile(const CapConfig *config, int argc, char *argv[], const char *name);
+
 /**
  * Show snippet code by name
  *
@@ -94,6 +128,58 @@ Cap_GetOrigin(const CapConfig *config, const char *cap_path);
 int
 Cap_ExecSnippet(const CapConfig *config, bool *found, int argc, char *argv[], const char *name);
 
+/**
+ * find program in directory of token of PATH in resource file
+ * this function first find to local scope and next to find global scope
+ * the program is found by hash of programs (see Cap_UpdateProgHash)
+ * if hash is not cacheable then directories of PATH are checked in order without hash
+ * if entry is not NULL then resource files and directories of PATH are added to dependencies of entry
+ *
+ * @param[in]  *config     pointer to CapConfig
+ * @param[in]  *entry      pointer to CapCmdCacheEntry or NULL
+ * @param[out] *cap_fpath  destination of Cap's path of program
+ * @param[in]  cap_fpathsz size of destination
+ * @param[in]  *cmdname    name of program
+ *
+ * @return found to true else false
+ */
+bool
+Cap_FindProg(
+    const CapConfig *config,
+    CapCmdCacheEntry *entry,
+    char *cap_fpath,
+    int32_t cap_fpathsz,
+    const char *cmdname
+);
+
+/**
+ * load hash of programs in PATH of resource files
+ * if hash is stale, is marked as uncacheable or is_rebuild is true
+ * then read resource files and directories of PATH and save hash
+ *
+ * @param[in] *config    pointer to CapConfig
+ * @param[in] *hash      pointer to CapProgHash
+ * @param[in] is_rebuild if true then always rebuild hash
+ *
+ * @return success to pointer to hash
+ * @return failed to NULL
+ */
+CapProgHash *
+Cap_UpdateProgHash(const CapConfig *config, CapProgHash *hash, bool is_rebuild);
+
+/**
+ * execute program by Cap's path of program
+ *
+ * @param[in] *config    pointer to CapConfig
+ * @param[in] argc       number of arguments
+ * @param[in] *argv[]    arguments. argv[0] is name of program
+ * @param[in] *cap_fpath Cap's path of program
+ *
+ * @return success to 0 else other
+ */
+int
+Cap_ExecProgPath(const CapConfig *config, int argc, char *argv[], const char *cap_fpath);
+
 /**
  * execute program in directory of token of PATH in resource file
  * this function first find to local scope and next to find global scope and execute
@@ -139,4 +225,77 @@ Cap_MakeArgv(
     const char *src,
     int argc,
     char *argv[]
+);
+
+/**
+ * make source like Cap_MakeArgv and get paths of imported modules
+ *
+ * @param[in]  *config           pointer to CapConfig (read-only)
+ * @param[out] *errstack         pointer to PadErrStack
+ * @param[in]  *program_filename path of program
+ * @param[in]  *src              source of program
+ * @param[in]  argc              number of arguments
+ * @param[in]  *argv[]           arguments
+ * @param[out] *deps             paths of imported modules are pushed. NULL is ok
+ *
+ * @return success to pointer to made string (dynamic allocate memory)
+ * @return failed to NULL
+ */
+char *
+Cap_MakeArgvWithDeps(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const char *program_filename,
+    const char *src,
+    int argc,
+    char *argv[],
+    PadCStrAry *deps
+);
+
+/**
+ * make source and write output to sink without copy of output
+ * the sink is not closed
+ *
+ * @param[in]  *config           pointer to CapConfig (read-only)
+ * @param[out] *errstack         pointer to PadErrStack
+ * @param[in]  *program_filename path of program
+ * @param[in]  *src              source of program
+ * @param[in]  argc              number of arguments
+ * @param[in]  *argv[]           arguments
+ * @param[in]  *sink             pointer to CapSink
+ *
+ * @return success to true, failed to false
+ */
+bool
+Cap_MakeArgvToSink(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const char *program_filename,
+    const char *src,
+    int argc,
+    char *argv[],
+    CapSink *sink
+);
+
+/**
+ * make source by kit. the kit is not reset before compile
+ *
+ * @param[in]  *kit              pointer to CapKit
+ * @param[out] *errstack         pointer to PadErrStack
+ * @param[in]  *program_filename path of program
+ * @param[in]  *src              source of program
+ * @param[in]  argc              number of arguments
+ * @param[in]  *argv[]           arguments
+ *
+ * @return success to pointer to made string (dynamic allocate memory)
+ * @return failed to NULL
+ */
+char *
+Cap_MakeArgvByKit(
+    CapKit *kit,
+    PadErrStack *errstack,
+    const char *program_filename,
+    const char *src,
+    int argc,
+    char *argv[]
 );
\ No newline at end of file
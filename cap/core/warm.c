@@ -0,0 +1,164 @@
+#include <cap/core/warm.h>
+
+enum {
+    NALTABS = 2,  // local and global
+};
+
+/**
+ * Structure of warm state
+ */
+struct CapWarm {
+    CapConfig *config;
+    CapKitPool *kit_pool;
+    CapAliasTable *altabs[NALTABS];  // local and global
+    CapSnptIndex *snptindex;
+};
+
+void
+CapWarm_Del(CapWarm *self) {
+    if (!self) {
+        return;
+    }
+
+    // tables put back borrowed kits before delete of pool
+    for (int i = 0; i < NALTABS; ++i) {
+        CapAliasTable_Del(self->altabs[i]);
+    }
+    CapKitPool_Del(self->kit_pool);
+    CapSnptIndex_Del(self->snptindex);
+    CapConfig_Del(self->config);
+    Pad_SafeFree(self);
+}
+
+/**
+ * Make idle kits in pool
+ */
+static void
+fill_kit_pool(CapWarm *self) {
+    CapKit *kits[CAP_WARM__NKITS] = {0};
+    for (int i = 0; i < CAP_WARM__NKITS; ++i) {
+        kits[i] = CapKitPool_Get(self->kit_pool);
+    }
+    for (int i = 0; i < CAP_WARM__NKITS; ++i) {
+        if (kits[i]) {
+            CapKitPool_Put(self->kit_pool, kits[i], true);
+        }
+    }
+}
+
+CapWarm *
+CapWarm_New(const CapConfig *config) {
+    if (!config) {
+        return NULL;
+    }
+
+    CapWarm *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->config = CapConfig_New();
+    if (!self->config || !CapConfig_CopyValues(self->config, config)) {
+        goto error;
+    }
+    self->config->warm = self;
+
+    self->kit_pool = CapKitPool_New(self->config, CAP_WARM__NKITS);
+    if (!self->kit_pool) {
+        goto error;
+    }
+    fill_kit_pool(self);
+
+    const int scopes[NALTABS] = { CAP_SCOPE__LOCAL, CAP_SCOPE__GLOBAL };
+    for (int i = 0; i < NALTABS; ++i) {
+        self->altabs[i] = CapAliasTable_New(self->config, self->kit_pool, scopes[i]);
+        if (!self->altabs[i]) {
+            goto error;
+        }
+        CapAliasTable_Refresh(self->altabs[i]);
+    }
+
+    self->snptindex = CapSnptIndex_New();
+    if (!self->snptindex) {
+        goto error;
+    }
+    CapSnptIndex_Update(self->snptindex, self->config);
+
+    return self;
+error:
+    CapWarm_Del(self);
+    return NULL;
+}
+
+CapWarm *
+CapWarm_Refresh(CapWarm *self) {
+    CapConfig *config = self->config;
+    config->scope = CAP_SCOPE__LOCAL;
+    config->recursion_count = 0;
+    config->out_sink = NULL;
+    config->err_sink = NULL;
+
+    // cd and home may have been changed after start of daemon
+    if (!CapConfig_ReadVars(config)) {
+        return NULL;
+    }
+    for (int i = 0; i < NALTABS; ++i) {
+        CapAliasTable_Move(self->altabs[i]);
+    }
+
+    return self;
+}
+
+CapConfig *
+CapWarm_GetConfig(CapWarm *self) {
+    return self->config;
+}
+
+const CapAliasInfo *
+CapWarm_RefreshAliases(CapWarm *self, int scope) {
+    int i = scope == CAP_SCOPE__GLOBAL ? 1 : 0;
+    return CapAliasTable_Refresh(self->altabs[i]);
+}
+
+CapSnptIndex *
+CapWarm_UpdateSnptIndex(CapWarm *self) {
+    if (CapSnptIndex_IsFresh(self->snptindex)) {
+        return self->snptindex;
+    }
+    return CapSnptIndex_Update(self->snptindex, self->config);
+}
+
+/**
+ * Get pool of warm state of config
+ * Kits of pool are bound to config of warm state. Other configs don't use pool
+ */
+static CapKitPool *
+get_kit_pool(const CapConfig *config) {
+    if (!config || !config->warm || config->warm->config != config) {
+        return NULL;
+    }
+    return config->warm->kit_pool;
+}
+
+CapKit *
+CapWarm_NewKit(const CapConfig *config) {
+    CapKitPool *pool = get_kit_pool(config);
+    if (pool) {
+        return CapKitPool_Get(pool);
+    }
+    return CapKit_New(config);
+}
+
+void
+CapWarm_DelKit(const CapConfig *config, CapKit *move_kit, bool is_ok) {
+    if (!move_kit) {
+        return;
+    }
+
+    CapKitPool *pool = get_kit_pool(config);
+    if (pool) {
+        CapKitPool_Put(pool, move_kit, is_ok);
+    } else {
+        CapKit_Del(move_kit);
+    }
+}
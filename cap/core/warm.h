@@ -0,0 +1,119 @@
+/**
+ * Warm state of daemon
+ *
+ * cap daemon は accept の前に CapWarm を作り、接続ごとの子プロセスは fork で引き継いだ CapWarm をそのまま使う
+ * CapWarm は設定、ローカルとグローバルのエイリアス表、スニペットのインデックスとキットのプールを持つ
+ * エイリアス表を作るときにリソースファイルのパスを解決するので、シンボリックリンクの解決キャッシュとリンクの索引も親プロセスで温まる
+ * 子プロセスは CapWarm_Refresh で変数（cd、home、editor）を読み直し、スコープやファイルが変わったものだけを作り直す
+ * 子プロセスでの変更はコピーオンライトのページに書かれるので、親プロセスの状態は変わらない
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/error.h>
+
+#include <cap/core/constant.h>
+#include <cap/core/config.h>
+#include <cap/core/alias_info.h>
+#include <cap/core/alias_table.h>
+#include <cap/core/snippet_index.h>
+#include <cap/lang/kit.h>
+#include <cap/lang/kit_pool.h>
+
+/**
+ * Numbers
+ */
+enum {
+    CAP_WARM__NKITS = 2,  // number of kits made before accept
+};
+
+typedef struct CapWarm CapWarm;
+
+/**
+ * Destruct warm state
+ *
+ * @param[in] *self pointer to CapWarm
+ */
+void
+CapWarm_Del(CapWarm *self);
+
+/**
+ * Construct warm state. Aliases, snippet index and kits are made at once
+ * Failure of load of resource files and snippet index is not error. They are made again in child
+ *
+ * @param[in] *config read-only pointer to initialized CapConfig. values are copied
+ *
+ * @return success to pointer to CapWarm (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapWarm *
+CapWarm_New(const CapConfig *config);
+
+/**
+ * Prepare warm state for command in child process of daemon
+ * Values of variables are read again and alias tables solve paths of resource files again at next refresh
+ *
+ * @param[in] *self pointer to CapWarm
+ *
+ * @return success to pointer to self
+ * @return failed to NULL. errors are pushed to error stack of config
+ */
+CapWarm *
+CapWarm_Refresh(CapWarm *self);
+
+/**
+ * Get config of warm state. config->warm is self
+ *
+ * @param[in] *self pointer to CapWarm
+ *
+ * @return pointer to CapConfig
+ */
+CapConfig *
+CapWarm_GetConfig(CapWarm *self);
+
+/**
+ * Get aliases of scope. The table is reloaded if scope or resource file was changed
+ *
+ * @param[in] *self pointer to CapWarm
+ * @param[in] scope number of scope (@see constant.h)
+ *
+ * @return pointer to aliases of scope
+ */
+const CapAliasInfo *
+CapWarm_RefreshAliases(CapWarm *self, int scope);
+
+/**
+ * Get snippet index. The index is updated if directory of snippets was changed
+ *
+ * @param[in] *self pointer to CapWarm
+ *
+ * @return success to pointer to CapSnptIndex
+ * @return failed to NULL
+ */
+CapSnptIndex *
+CapWarm_UpdateSnptIndex(CapWarm *self);
+
+/**
+ * Get kit for compile. The kit is borrowed from pool of warm state of config
+ * If config has not warm state then new kit is created
+ *
+ * @param[in] *config read-only pointer to CapConfig
+ *
+ * @return success to pointer to CapKit, failed to NULL
+ */
+CapKit *
+CapWarm_NewKit(const CapConfig *config);
+
+/**
+ * Put back or delete kit got by CapWarm_NewKit
+ *
+ * @param[in] *config read-only pointer to CapConfig that was passed to CapWarm_NewKit
+ * @param[in] *kit    pointer to CapKit (move semantics) or NULL
+ * @param[in] is_ok   if compile of kit was failed then false
+ */
+void
+CapWarm_DelKit(const CapConfig *config, CapKit *move_kit, bool is_ok);
@@ -42,9 +42,7 @@ struct CapCpCmd {
  */
 static int
 usage(CapCpCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Copy files.\n"
+    CapOut_ErrPrintf(self->config, "Copy files.\n"
         "\n"
         "Usage:\n"
         "\n"
@@ -68,7 +66,6 @@ usage(CapCpCmd *self) {
         "        $ cap cp :path/to/src.txt path/to/dst.txt\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -91,14 +88,11 @@ parse_opts(CapCpCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hr", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hr", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -109,18 +103,18 @@ parse_opts(CapCpCmd *self) {
         case 'r': self->opts.is_recursive = true; break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -185,7 +179,8 @@ solve_path(CapCpCmd *self, char *dst, size_t dstsz, const char *path) {
     } else if (self->config->scope == CAP_SCOPE__GLOBAL) {
         org = self->config->home_path;
     } else {
-        PadErr_Die("impossible. invalid state in solve path");
+        set_err(self, CPCMD_ERR__SOLVEPATH, "impossible. invalid state in solve path");
+        return NULL;
     }
 
     snprintf(tmppath, sizeof tmppath, "%s/%s", org, src_path);
@@ -412,7 +407,7 @@ CapCpCmd_Run(CapCpCmd *self) {
 
     int ret = cp(self);
     if (ret != 0) {
-        PadErr_Err(self->what);
+        CapOut_Err(self->config, "%s", self->what);
     }
     return ret;
 }
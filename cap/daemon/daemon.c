@@ -0,0 +1,161 @@
+#include <cap/daemon/daemon.h>
+
+/**
+ * Structure of options
+ */
+struct Opts {
+    bool is_help;
+    bool is_stop;
+};
+
+/**
+ * Structure of command
+ */
+struct CapDaemonCmd {
+    const CapConfig *config;
+    int argc;
+    char **argv;
+    struct Opts opts;
+    CapDaemonExecFunc exec;
+    CapDaemonFilterFunc filter;
+};
+
+/**
+ * Show usage of command
+ *
+ * @param[in] self pointer to CapDaemonCmd
+ */
+static int
+usage(CapDaemonCmd *self) {
+    CapOut_ErrPrintf(self->config, "Keep warm process of cap and run commands of other cap processes.\n"
+        "\n"
+        "Usage:\n"
+        "\n"
+        "    cap daemon [options]\n"
+        "\n"
+        "The options are:\n"
+        "\n"
+        "    -h, --help    show usage\n"
+        "    -s, --stop    stop running daemon\n"
+        "\n"
+        "While the daemon is running, cap forwards commands to the daemon.\n"
+        "Built-in commands that don't use terminal and aliases of them are forwarded.\n"
+        "The daemon keeps configuration, aliases, snippet index and kits warm for them.\n"
+        "Set CAP_DAEMON environment variable to 0 for not forward.\n"
+        "\n"
+    );
+    return 0;
+}
+
+/**
+ * Parse options
+ *
+ * @param[in] self pointer to CapDaemonCmd
+ *
+ * @return success to true
+ * @return failed to false
+ */
+static bool
+parse_opts(CapDaemonCmd *self) {
+    // parse options
+    static struct option longopts[] = {
+        {"help", no_argument, 0, 'h'},
+        {"stop", no_argument, 0, 's'},
+        {0},
+    };
+
+    self->opts = (struct Opts){0};
+
+    CapGetopt opt = {0};
+
+    for (;;) {
+        int optsindex;
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hs", longopts, &optsindex);
+        if (cur == -1) {
+            break;
+        }
+
+        switch (cur) {
+        case 0: /* long option only */ break;
+        case 'h': self->opts.is_help = true; break;
+        case 's': self->opts.is_stop = true; break;
+        case '?':
+        default:
+            CapOut_Err(self->config, "unknown option");
+            return false;
+            break;
+        }
+    }
+
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
+        return false;
+    }
+
+    return true;
+}
+
+void
+CapDaemonCmd_Del(CapDaemonCmd *self) {
+    if (!self) {
+        return;
+    }
+
+    Pad_SafeFree(self);
+}
+
+CapDaemonCmd *
+CapDaemonCmd_New(const CapConfig *config, int argc, char **argv) {
+    CapDaemonCmd *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->config = config;
+    self->argc = argc;
+    self->argv = argv;
+
+    return self;
+}
+
+CapDaemonCmd *
+CapDaemonCmd_SetFuncs(CapDaemonCmd *self, CapDaemonExecFunc exec, CapDaemonFilterFunc filter) {
+    self->exec = exec;
+    self->filter = filter;
+    return self;
+}
+
+int
+CapDaemonCmd_Run(CapDaemonCmd *self) {
+    if (!parse_opts(self)) {
+        return 1;
+    }
+
+    if (self->opts.is_help) {
+        return usage(self);
+    }
+
+    if (self->opts.is_stop) {
+        if (!CapDaemon_Stop(self->config->var_daemon_path)) {
+            CapOut_Err(self->config, "daemon is not running");
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!self->exec) {
+        CapOut_Err(self->config, "function of execution is not set");
+        return 1;
+    }
+
+    // children of daemon inherit warm state by fork
+    CapWarm *warm = CapWarm_New(self->config);
+    if (!warm) {
+        CapOut_Err(self->config, "failed to make warm state");
+        return 1;
+    }
+
+    int result = CapDaemon_Serve(self->config->var_daemon_path, self->exec, self->filter, warm);
+    CapWarm_Del(warm);
+    return result;
+}
@@ -0,0 +1,75 @@
+/**
+ * Cap
+ *
+ * License: MIT
+ *  Author: narupo
+ *   Since: 2016
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <string.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/error.h>
+
+#include <cap/core/config.h>
+#include <cap/core/daemon.h>
+#include <cap/core/warm.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
+
+/**
+ * Structure and type of command
+ */
+struct CapDaemonCmd;
+typedef struct CapDaemonCmd CapDaemonCmd;
+
+/**
+ * Destruct command
+ *
+ * @param[in] self pointer to CapDaemonCmd
+ */
+void
+CapDaemonCmd_Del(CapDaemonCmd *self);
+
+/**
+ * Construct command
+ *
+ * @param[in] config reference to CapConfig
+ * @param[in] argc   number of arguments
+ * @param[in] argv   reference to array of arguments
+ *
+ * @return success to pointer to CapDaemonCmd
+ * @return failed to NULL
+ */
+CapDaemonCmd *
+CapDaemonCmd_New(const CapConfig *config, int argc, char **argv);
+
+/**
+ * Set functions of requests
+ * The daemon checks and executes requests by these functions in child processes
+ * The argument of functions is pointer to CapWarm that was made before accept
+ *
+ * @param[in] self   pointer to CapDaemonCmd
+ * @param[in] exec   function of execution
+ * @param[in] filter function of check of request or NULL
+ *
+ * @return pointer to self
+ */
+CapDaemonCmd *
+CapDaemonCmd_SetFuncs(CapDaemonCmd *self, CapDaemonExecFunc exec, CapDaemonFilterFunc filter);
+
+/**
+ * Run command
+ *
+ * @param[in] self pointer to CapDaemonCmd
+ *
+ * @return success to number of 0
+ * @return failed to number of not 0
+ */
+int
+CapDaemonCmd_Run(CapDaemonCmd *self);
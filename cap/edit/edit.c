@@ -8,6 +8,7 @@ struct CapEditCmd {
     const CapConfig *config;
     struct Opts opts;
     int argc;
+    int optind;
     char **argv;
     char editor[1024];
     char cmdline[2048];
@@ -25,13 +26,11 @@ parse_opts(CapEditCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hg", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hg", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -42,17 +41,18 @@ parse_opts(CapEditCmd *self) {
         case 'g': self->opts.is_global = true; break;
         case '?':
         default:
-            PadErr_Err("unsupported option");
+            CapOut_Err(self->config, "unsupported option");
             return NULL;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Err("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return NULL;
     }
 
+    self->optind = opt.optind;
     return self;
 }
 
@@ -76,7 +76,9 @@ CapEditCmd_New(const CapConfig *config, int argc, char **argv) {
     self->argv = argv;
 
     if (!parse_opts(self)) {
-        PadErr_Die("failed to parse options");
+        CapOut_Err(self->config, "failed to parse options");
+        CapEditCmd_Del(self);
+        return NULL;
     }
 
     return self;
@@ -97,7 +99,7 @@ read_editor(CapEditCmd *self) {
 static CapEditCmd *
 create_open_fname(CapEditCmd *self, const char *cap_path) {
     if (!Cap_SolveCmdlineArgPath(self->config, self->open_fname, sizeof self->open_fname, cap_path)) {
-        PadErr_Err("failed to solve cap path");
+        CapOut_Err(self->config, "failed to solve cap path");
         return NULL;
     }
 
@@ -107,19 +109,19 @@ create_open_fname(CapEditCmd *self, const char *cap_path) {
 int
 CapEditCmd_Run(CapEditCmd *self) {
     const char *fname = NULL;
-    if (self->argc >= 2) {
-        fname = self->argv[optind];
+    if (self->optind < self->argc) {
+        fname = self->argv[self->optind];
     }
 
     if (!read_editor(self)) {
-        PadErr_Die("not found editor. please setting with 'cap editor' command");
+        CapOut_Err(self->config, "not found editor. please setting with 'cap editor' command");
         return 1;
     }
 
     PadCStr_App(self->cmdline, sizeof self->cmdline, self->editor);
     if (fname) {
         if (!create_open_fname(self, fname)) {
-            PadErr_Die("failed to create open file name");
+            CapOut_Err(self->config, "failed to create open file name");
             return 1;
         }
         PadCStr_App(self->cmdline, sizeof self->cmdline, " ");
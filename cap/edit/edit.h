@@ -11,6 +11,8 @@
 #include <cap/core/util.h>
 #include <cap/core/config.h>
 #include <cap/core/symlink.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 struct CapEditCmd;
 typedef struct CapEditCmd CapEditCmd;
@@ -26,9 +26,7 @@ struct CapEditorCmd {
  */
 static int
 usage(CapEditorCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap editor [options...]\n"
         "\n"
@@ -37,7 +35,6 @@ usage(CapEditorCmd *self) {
         "    -h, --help    show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -59,14 +56,11 @@ parse_opts(CapEditorCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "h", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "h", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -76,18 +70,18 @@ parse_opts(CapEditorCmd *self) {
         case 'h': self->opts.is_help = true; break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -122,11 +116,11 @@ static int
 show_editor(CapEditorCmd *self) {
     self->editor[0] = '\0';
     if (!PadFile_ReadLine(self->editor, sizeof self->editor, self->config->var_editor_path)) {
-        PadErr_Err("failed to read editor from editor of variable");
+        CapOut_Err(self->config, "failed to read editor from editor of variable");
         return 1;
     }
     if (strlen(self->editor)) {
-        puts(self->editor);
+        CapOut_Printf(self->config, "%s\n", self->editor);
     }
     return 0;
 }
@@ -135,7 +129,7 @@ static int
 set_editor(CapEditorCmd *self) {
     const char *editor = self->argv[self->optind];
     if (!PadFile_WriteLine(editor, self->config->var_editor_path)) {
-        PadErr_Err("failed to write editor into editor of variable");
+        CapOut_Err(self->config, "failed to write editor into editor of variable");
         return 1;
     }
     return 0;
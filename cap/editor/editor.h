@@ -8,6 +8,8 @@
 #include <cap/core/constant.h>
 #include <cap/core/util.h>
 #include <cap/core/config.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 /**
  * structure and type of command
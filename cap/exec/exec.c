@@ -3,6 +3,13 @@
 static const int32_t READ = 0;
 static const int32_t WRITE = 1;
 
+// commands change state of process (signals and children). one command runs at a time
+static pthread_mutex_t _exec_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#ifndef CAP__WINDOWS
+extern char **environ;
+#endif
+
 /**
  * Structure of options
  */
@@ -34,9 +41,7 @@ struct CapExecCmd {
  */
 static int
 usage(CapExecCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap exec [options]... [command-line]\n"
         "\n"
@@ -45,7 +50,6 @@ usage(CapExecCmd *self) {
         "    -h, --help    Show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -66,15 +70,11 @@ parse_opts(CapExecCmd *self) {
     };
 
     self->opts = (struct Opts){0};
-
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hf:", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hf:", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -84,18 +84,18 @@ parse_opts(CapExecCmd *self) {
         case 'h': self->opts.is_help = true; break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -148,11 +148,181 @@ has_err(const CapExecCmd *self) {
     return self->what[0] != '\0';
 }
 
+#ifndef CAP__WINDOWS
+static void
+close_fd(int fd) {
+    if (fd != -1) {
+        close(fd);
+    }
+}
+
+/**
+ * create pipe. descriptors are not inherited by other children
+ */
+static bool
+open_pipe(int fd[2]) {
+    if (pipe(fd) != 0) {
+        return false;
+    }
+
+    fcntl(fd[READ], F_SETFD, FD_CLOEXEC);
+    fcntl(fd[WRITE], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+/**
+ * create pipe that children write to sink of config
+ * both descriptors are -1 if sink is not set
+ */
+static bool
+open_sink_pipe(CapExecCmd *self, const CapSink *sink, int fd[2]) {
+    fd[READ] = fd[WRITE] = -1;
+    if (!sink) {
+        return true;
+    }
+    if (!open_pipe(fd)) {
+        set_err(self, "failed to create pipe");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * copy output of children from read ends of pipes to sinks of config until end of file
+ * write ends of pipes must be closed in this process. the read ends are closed
+ */
+static void
+pump_sinks(CapExecCmd *self, int out_fd, int err_fd) {
+    CapSink *sinks[2] = {self->config->out_sink, self->config->err_sink};
+    struct pollfd fds[2] = {
+        {.fd = out_fd, .events = POLLIN},
+        {.fd = err_fd, .events = POLLIN},
+    };
+    char buf[BUFSIZ];
+
+    // poll ignores negative descriptors
+    while (fds[0].fd != -1 || fds[1].fd != -1) {
+        if (poll(fds, 2, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < 2; ++i) {
+            if (fds[i].fd == -1 || !fds[i].revents) {
+                continue;
+            }
+            ssize_t n = read(fds[i].fd, buf, sizeof buf);
+            if (n == -1 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                close(fds[i].fd);
+                fds[i].fd = -1;
+                continue;
+            }
+            CapSink_Write(sinks[i], buf, n);
+        }
+    }
+
+    close_fd(fds[0].fd);
+    close_fd(fds[1].fd);
+}
+
+/**
+ * spawn shell of command
+ * stdin, stdout and stderr of child are replaced by in_fd, out_fd and err_fd if they are not -1
+ *
+ * @return success to pid of child, failed to -1
+ */
+static pid_t
+spawn_cmd(CapExecCmd *self, const char *cmd, int in_fd, int out_fd, int err_fd) {
+    posix_spawn_file_actions_t actions;
+    if (posix_spawn_file_actions_init(&actions) != 0) {
+        set_err(self, "failed to init actions of spawn");
+        return -1;
+    }
+
+    if (in_fd != -1) {
+        posix_spawn_file_actions_adddup2(&actions, in_fd, STDIN_FILENO);
+    }
+    if (out_fd != -1) {
+        posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+    }
+    if (err_fd != -1) {
+        posix_spawn_file_actions_adddup2(&actions, err_fd, STDERR_FILENO);
+    }
+
+    pid_t pid;
+    char *argv[] = {"sh", "-c", (char *) cmd, NULL};
+    int err = posix_spawn(&pid, "/bin/sh", &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        set_err(self, "failed to spawn \"%s\"", cmd);
+        return -1;
+    }
+
+    return pid;
+}
+
+/**
+ * wait children of pids. other children of process are not reaped
+ *
+ * @return exit code of last child
+ */
+static int
+wait_pids(const pid_t *pids, int32_t npids) {
+    int exit_code = 0;
+
+    for (int32_t i = 0; i < npids; ++i) {
+        int status = 0;
+        while (waitpid(pids[i], &status, 0) == -1) {
+            if (errno != EINTR) {
+                status = -1;
+                break;
+            }
+        }
+        exit_code = (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+    }
+
+    return exit_code;
+}
+#endif
+
 static CapExecCmd *
 exec_first(CapExecCmd *self) {
     const PadCmdlineObj *first = PadCmdline_Getc(self->cmdline, 0);
     const char *cmd = PadStr_Getc(first->command);
+#ifdef CAP__WINDOWS
     Pad_SafeSystem(cmd, PAD_SAFESYSTEM__UNSAFE_UNIX_ONLY);
+#else
+    // output of child follows buffered output of this process
+    CapOut_Flush(self->config);
+
+    int out[2];
+    int err[2];
+    if (!open_sink_pipe(self, self->config->out_sink, out)) {
+        return NULL;
+    }
+    if (!open_sink_pipe(self, self->config->err_sink, err)) {
+        close_fd(out[READ]);
+        close_fd(out[WRITE]);
+        return NULL;
+    }
+
+    pid_t pid = spawn_cmd(self, cmd, -1, out[WRITE], err[WRITE]);
+    close_fd(out[WRITE]);
+    close_fd(err[WRITE]);
+    if (pid == -1) {
+        close_fd(out[READ]);
+        close_fd(err[READ]);
+        return NULL;
+    }
+
+    pump_sinks(self, out[READ], err[READ]);
+    wait_pids(&pid, 1);
+#endif
     return self;
 }
 
@@ -344,8 +514,8 @@ execcmd_pipe(CapExecCmd *self, const PadCmdlineObj *obj, const PadCmdlineObj *op
         close_hs();
         CloseHandle(child_process);
         if (!ope) {
-            printf("%s", PadStr_Getc(self->read_buffer));
-            fflush(stdout);
+            CapOut_Printf(self->config, "%s", PadStr_Getc(self->read_buffer));
+            CapOut_Flush(self->config);
         }
         return self;
         break;
@@ -526,156 +696,116 @@ exec_all_win(CapExecCmd *self) {
 }
 #else
 
+/**
+ * run command line. commands of pipe run at same time
+ * && runs next pipeline if exit code of last pipeline is 0. redirect ends command line
+ * output of pipeline is copied to sinks of config if they are set
+ */
 static CapExecCmd *
 exec_all_unix(CapExecCmd *self) {
-    int stdinno = dup(STDIN_FILENO);
-    int stdoutno = dup(STDOUT_FILENO);
-    int exit_code = 0;
+    int32_t len = PadCmdline_Len(self->cmdline);
+    pid_t *pids = PadMem_Calloc(len, sizeof(*pids));  // children of current pipeline
+    if (!pids) {
+        set_err(self, "failed to allocate memory");
+        return NULL;
+    }
 
-    for (int32_t i = 0; i < PadCmdline_Len(self->cmdline); i += 2) {
+    int32_t npids = 0;
+    int in_fd = -1;  // read end of pipe of previous command
+    int sink_out[2] = {-1, -1};  // pipe of output of last command to sink
+    int sink_err[2] = {-1, -1};  // pipe of error output of pipeline to sink
+    CapExecCmd *result = self;
+
+    // output of children follows buffered output of this process
+    CapOut_Flush(self->config);
+
+    for (int32_t i = 0; i < len; i += 2) {
         const PadCmdlineObj *obj = PadCmdline_Getc(self->cmdline, i);
         const PadCmdlineObj *ope = PadCmdline_Getc(self->cmdline, i+1);
+        bool is_and = ope && ope->type == PAD_CMDLINE_OBJ_TYPE__AND;
+        bool is_redirect = ope && ope->type == PAD_CMDLINE_OBJ_TYPE__REDIRECT;
+        int out_fd = -1;
+        int next_in_fd = -1;
 
-        if (ope && ope->type == PAD_CMDLINE_OBJ_TYPE__AND) {
-            // AND
-            const char *cmd = PadStr_Getc(obj->command);
-            int status = Pad_SafeSystem(cmd, PAD_SAFESYSTEM__UNSAFE_UNIX_ONLY);
-            exit_code = WEXITSTATUS(status);
-            if (exit_code != 0) {
-                break;
-            }
-        } else if (ope && ope->type == PAD_CMDLINE_OBJ_TYPE__REDIRECT) {
-            // REDIRECT
+        if (npids == 0 && !open_sink_pipe(self, self->config->err_sink, sink_err)) {
+            result = NULL;
+            break;
+        }
+
+        if (is_redirect) {
+            // REDIRECT. the file is opened by this process and written by child
             const PadCmdlineObj *fileobj = PadCmdline_Getc(self->cmdline, i+2);
             if (!fileobj) {
                 set_err(self, "not found file object in redirect");
+                result = NULL;
                 break;
             }
 
-            int fd[2] = {0};
-            if (pipe(fd) != 0) {
-                set_err(self, "failed to create pipe");
-                return NULL;
+            char fname[PAD_FILE__NPATH];
+            if (!Cap_SolveCmdlineArgPath(self->config, fname, sizeof fname, PadStr_Getc(fileobj->command))) {
+                set_err(self, "failed to solve path of command line argument");
+                result = NULL;
+                break;
             }
 
-            pid_t pid = fork();
-            switch (pid) {
-            default: { // parent
-                // STDOUT_FILENOに出力する
-                close(fd[READ]);
-                dup2(fd[WRITE], STDOUT_FILENO);
-                close(fd[WRITE]);
-
-                const char *cmd = PadStr_Getc(obj->command);
-                int status = Pad_SafeSystem(cmd, PAD_SAFESYSTEM__UNSAFE_UNIX_ONLY);
-                exit_code = WEXITSTATUS(status);
-                (void) &exit_code;
-
-                dup2(stdoutno, STDOUT_FILENO);
-                dup2(stdinno, STDIN_FILENO);
-
-                wait(NULL);
-                goto done;
-            } break;
-            case 0: { // child
-                // fd[READ]から入力を読み込み、fnameのファイルに出力する
-                close(fd[WRITE]);
-
-                char fname[PAD_FILE__NPATH];
-                if (!Cap_SolveCmdlineArgPath(self->config, fname, sizeof fname, PadStr_Getc(fileobj->command))) {
-                    set_err(self, "failed to solve path of command line argument");
-                    return NULL;
-                }
-
-                int filefd = open(fname, O_CREAT | O_WRONLY | O_TRUNC);
-                if (filefd == -1) {
-                    set_err(self, "failed to open \"%s\"", fname);
-                    return NULL;
-                }
-
-                char buf[1024+1];
-                for (;;) {
-                    ssize_t nread = read(fd[READ], buf, sizeof(buf)-1);
-                    if (nread == -1) {
-                        set_err(self, "failed to read from read descriptor");
-                        return NULL;
-                    } else if (nread == 0) {
-                        break;
-                    }
-                    buf[nread] = '\0';
-
-                    if (write(filefd, buf, nread) == -1) {
-                        set_err(self, "failed to write to file descriptor");
-                        break;
-                    }
-                }
-
-                close(filefd);
-                close(fd[READ]);
-
-                // execコマンドはテンプレート言語の組み込み関数（functions.c@builtin_exec）からも呼ばれる
-                // ここでexit()しないと言語のパースを継続してしまい、プロセスが作られるごとに
-                // 言語がパースされることになる。子プロセスでは言語のパースを継続しない（親ではする）
-                // そのため、パースを継続しないようにここでexit()する
-                exit(0);
-            } break;
-            case -1: { // error
-                set_err(self, "failed to fork (2)");
-                close(fd[READ]);
-                close(fd[WRITE]);
-                return NULL;
-            } break;
+            out_fd = open(fname, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0666);
+            if (out_fd == -1) {
+                set_err(self, "failed to open \"%s\"", fname);
+                result = NULL;
+                break;
             }
-        } else {
+        } else if (ope && !is_and) {
             // PIPE
             int fd[2] = {0};
-            if (pipe(fd) != 0) {
+            if (!open_pipe(fd)) {
                 set_err(self, "failed to create pipe");
-                return NULL;
+                result = NULL;
+                break;
+            }
+            out_fd = fd[WRITE];
+            next_in_fd = fd[READ];
+        } else {
+            // end of pipeline writes to output of this process
+            if (!open_sink_pipe(self, self->config->out_sink, sink_out)) {
+                result = NULL;
+                break;
             }
+            out_fd = sink_out[WRITE];
+            sink_out[WRITE] = -1;
+        }
 
-            pid_t pid = fork();
-            switch (pid) {
-            default: { // parent
-                close(fd[READ]);
-                if (ope) {
-                    dup2(fd[WRITE], STDOUT_FILENO);
-                    close(fd[WRITE]);
-                } else {
-                    close(fd[WRITE]);
-                }
-
-                const char *cmd = PadStr_Getc(obj->command);
-                int status = Pad_SafeSystem(cmd, PAD_SAFESYSTEM__UNSAFE_UNIX_ONLY);
-                exit_code = WEXITSTATUS(status);
-                (void) &exit_code;
-
-                dup2(stdoutno, STDOUT_FILENO);
-                dup2(stdinno, STDIN_FILENO);
-
-                wait(NULL);
-
-                goto done;
-            } break;
-            case 0: { // child
-                close(fd[WRITE]);
-                dup2(fd[READ], STDIN_FILENO);
-                close(fd[READ]);
-            } break;
-            case -1: { // error
-                set_err(self, "failed to fork");
-                close(fd[READ]);
-                close(fd[WRITE]);
-                return NULL;
-            } break;
+        pid_t pid = spawn_cmd(self, PadStr_Getc(obj->command), in_fd, out_fd, sink_err[WRITE]);
+        close_fd(in_fd);
+        close_fd(out_fd);
+        in_fd = next_in_fd;
+        if (pid == -1) {
+            result = NULL;
+            break;
+        }
+        pids[npids++] = pid;
+
+        if (!ope || is_and || is_redirect) {
+            // end of pipeline
+            close_fd(sink_err[WRITE]);
+            pump_sinks(self, sink_out[READ], sink_err[READ]);
+            sink_out[READ] = sink_err[READ] = sink_err[WRITE] = -1;
+
+            int exit_code = wait_pids(pids, npids);
+            npids = 0;
+            if (!is_and || exit_code != 0) {
+                break;
             }
         }
     }
 
-done:
-    close(stdinno);
-    close(stdoutno);
-    return self;
+    // rest of pipeline by error
+    close_fd(in_fd);
+    close_fd(sink_err[WRITE]);
+    close_fd(sink_out[READ]);
+    close_fd(sink_err[READ]);
+    wait_pids(pids, npids);
+    free(pids);
+    return result;
 }
 #endif
 
@@ -731,13 +861,8 @@ escape(const char *escaped) {
     return PadStr_EscDel(s);
 }
 
-int
-CapExecCmd_Run(CapExecCmd *self) {
-    if (self->argc - self->optind == 0 ||
-        self->opts.is_help) {
-        return usage(self);
-    }
-
+static int
+run(CapExecCmd *self) {
     for (int32_t i = self->optind; i < self->argc; ++i) {
         const char *plain = self->argv[i];
         char *cltxt = escape(plain);
@@ -746,7 +871,7 @@ CapExecCmd_Run(CapExecCmd *self) {
 
         if (!cmd_exec(self, cltxt)) {
             Pad_SafeFree(cltxt);
-            PadErr_Err(self->what);
+            CapOut_Err(self->config, "%s", self->what);
             return 1;
         }
         Pad_SafeFree(cltxt);
@@ -754,3 +879,16 @@ CapExecCmd_Run(CapExecCmd *self) {
 
     return 0;
 }
+
+int
+CapExecCmd_Run(CapExecCmd *self) {
+    if (self->argc - self->optind == 0 ||
+        self->opts.is_help) {
+        return usage(self);
+    }
+
+    pthread_mutex_lock(&_exec_mutex);
+    int result = run(self);
+    pthread_mutex_unlock(&_exec_mutex);
+    return result;
+}
@@ -6,8 +6,12 @@
  * &&でパイプを含むコマンドのグループ分けが必要かもしれない
  * 現在の用途には足りているので是正しないが、あまり美しい仕様にはなっていないので時間がある時に是正してほしい
  */
+#define _DEFAULT_SOURCE 1 /* cap: exec: posix_spawn, O_CLOEXEC */
+
 #include <stdio.h>
+#include <errno.h>
 #include <getopt.h>
+#include <pthread.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -24,6 +28,15 @@
 #include <cap/core/util.h>
 #include <cap/core/config.h>
 #include <cap/core/symlink.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
+#include <cap/core/sink.h>
+
+#ifndef CAP__WINDOWS
+# include <spawn.h>
+# include <sys/wait.h>
+# include <poll.h>
+#endif
 
 /**
  * Structure and type of command
@@ -54,6 +67,8 @@ CapExecCmd_New(const CapConfig *config, int argc, char **argv);
 
 /**
  * Run command
+ * Commands run one at a time in process. Children are spawned with
+ * redirection of their own then stdin and stdout of this process are not changed
  *
  * @param[in] self pointer to CapExecCmd
  *
@@ -2,6 +2,7 @@
 
 enum {
     FINDCMD_DEF_MAX_RECURSION = 8,
+    FINDCMD_MAX_JOBS = 64,
 };
 
 /**
@@ -12,6 +13,7 @@ struct Opts {
     bool is_normalize;
     bool is_alias;
     int max_recursion;
+    int jobs;
     char origin[PAD_FILE__NPATH];
 };
 
@@ -28,6 +30,25 @@ struct CapFindCmd {
     CapAliasMgr *almgr;  
 };
 
+/**
+ * Resource file found by walk of tree
+ */
+typedef struct {
+    char dirpath[PAD_FILE__NPATH];  // directory on file system
+    char cap_dirpath[PAD_FILE__NPATH];  // directory in Cap's environment
+    bool is_done;  // evaluated
+    CapAliasInfo *alinfo;  // aliases of resource file. NULL if failed to load
+} RcFile;
+
+/**
+ * Array of resource files in order of walk
+ */
+typedef struct {
+    RcFile *files;
+    int32_t len;
+    int32_t capa;
+} RcFiles;
+
 /**
  * Show usage of command
  *
@@ -35,9 +56,7 @@ struct CapFindCmd {
  */
 static int
 usage(CapFindCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap find [options]... [arguments]...\n"
         "\n"
@@ -48,9 +67,9 @@ usage(CapFindCmd *self) {
         "    -o, --origin           origin path\n"
         "    -a, --alias            find aliases\n"
         "    -m, --max-recursion    max recursion depth (default to 8)\n"
+        "    -j, --jobs             number of workers for aliases (default to number of CPUs)\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -71,20 +90,23 @@ parse_opts(CapFindCmd *self) {
         {"alias", no_argument, 0, 'a'},
         {"origin", required_argument, 0, 'o'},
         {"max-recursion", required_argument, 0, 'm'},
+        {"jobs", required_argument, 0, 'j'},
         {0},
     };
 
     self->opts = (struct Opts){0};
     self->opts.max_recursion = FINDCMD_DEF_MAX_RECURSION;
+#ifdef CAP__WINDOWS
+    self->opts.jobs = 1;
+#else
+    self->opts.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hnao:m:", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hnao:m:j:", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -94,22 +116,29 @@ parse_opts(CapFindCmd *self) {
         case 'h': self->opts.is_help = true; break;
         case 'n': self->opts.is_normalize = true; break;
         case 'a': self->opts.is_alias = true; break;
-        case 'o': snprintf(self->opts.origin, sizeof self->opts.origin, "%s", optarg); break;
-        case 'm': self->opts.max_recursion = atoi(optarg); break;
+        case 'o': snprintf(self->opts.origin, sizeof self->opts.origin, "%s", opt.optarg); break;
+        case 'm': self->opts.max_recursion = atoi(opt.optarg); break;
+        case 'j': self->opts.jobs = atoi(opt.optarg); break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    if (self->opts.jobs < 1) {
+        self->opts.jobs = 1;
+    } else if (self->opts.jobs > FINDCMD_MAX_JOBS) {
+        self->opts.jobs = FINDCMD_MAX_JOBS;
+    }
+
+    self->optind = opt.optind;
     return true;
 }
 
@@ -173,7 +202,7 @@ find_files_r(const CapFindCmd *self, const char *dirpath, const char *cap_dirpat
 
     PadDir *dir = PadDir_Open(dirpath);
     if (!dir) {
-        PadErr_Err("failed to open directory \"%s\"", dirpath);
+        CapOut_Err(self->config, "failed to open directory \"%s\"", dirpath);
         return 1;
     }
 
@@ -199,20 +228,20 @@ find_files_r(const CapFindCmd *self, const char *dirpath, const char *cap_dirpat
 
         char path[PAD_FILE__NPATH];
         if (!CapSymlink_FollowPath(self->config, path, sizeof path, tmp_path)) {
-            PadErr_Err("failed to follow path on find file recursive");
+            CapOut_Err(self->config, "failed to follow path on find file recursive");
             PadDirNode_Del(node);
             continue;
         }
 
         if (CapArgsMgr_ContainsAll(self->argsmgr, name)) {
             if (self->opts.is_normalize) {
-                puts(path);
+                CapOut_Printf(self->config, "%s\n", path);
             } else {
-                puts(cap_path);
+                CapOut_Printf(self->config, "%s\n", cap_path);
             }
         }
 
-        if (CapSymlink_IsLinkFile(path)) {
+        if (CapSymlink_IsLinkFile(self->config, path)) {
             // pass
         } else if (PadFile_IsDir(path)) {
             ret = find_files_r(self, path, cap_path, dep+1);
@@ -227,13 +256,13 @@ find_files_r(const CapFindCmd *self, const char *dirpath, const char *cap_dirpat
 }
 
 static bool
-has_contents(const CapFindCmd *self, const PadDict *alias_kvmap, int32_t *maxkeylen, int32_t *maxvallen) {
+has_contents(const CapFindCmd *self, const CapAliasInfo *alinfo, int32_t *maxkeylen, int32_t *maxvallen) {
     bool has = false;
-    for (int32_t i = 0; i < PadDict_Len(alias_kvmap); ++i) {
-        const PadDictItem *item = PadDict_GetcIndex(alias_kvmap, i);
-        if (CapArgsMgr_ContainsAll(self->argsmgr, item->key)) {
-            int32_t keylen = strlen(item->key);
-            int32_t vallen = strlen(item->value);
+    for (int32_t i = 0; i < CapAliasInfo_Len(alinfo); ++i) {
+        const char *key = CapAliasInfo_GetcKeyAt(alinfo, i);
+        if (CapArgsMgr_ContainsAll(self->argsmgr, key)) {
+            int32_t keylen = strlen(key);
+            int32_t vallen = strlen(CapAliasInfo_GetcValueAt(alinfo, i));
             *maxkeylen = keylen > *maxkeylen ? keylen : *maxkeylen;
             *maxvallen = vallen > *maxvallen ? vallen : *maxvallen;
             has = true;
@@ -243,56 +272,57 @@ has_contents(const CapFindCmd *self, const PadDict *alias_kvmap, int32_t *maxkey
     return has;
 }
 
-static int
-find_aliases_r(const CapFindCmd *self, const char *dirpath, const char *cap_dirpath, int dep) {
-    char alpath[PAD_FILE__NPATH];
-    if (dep >= self->opts.max_recursion) {
-        return 1;
-    }
+/****************
+* find aliases *
+****************/
 
-    if (!PadFile_SolveFmt(alpath, sizeof alpath, "%s/.caprc", dirpath)) {
-        // not error
+static void
+rcfiles_fini(RcFiles *rcfiles) {
+    for (int32_t i = 0; i < rcfiles->len; ++i) {
+        CapAliasInfo_Del(rcfiles->files[i].alinfo);
     }
+    free(rcfiles->files);
+}
 
-    CapAliasMgr_Clear(self->almgr);
-    if (PadFile_IsExists(alpath)) {
-        if (!CapAliasMgr_LoadPath(self->almgr, alpath)) {
-            PadErr_Err("failed to load resource file \"%s\" for alias", alpath);
-            return 1;
+static RcFile *
+rcfiles_push(RcFiles *rcfiles, const char *dirpath, const char *cap_dirpath) {
+    if (rcfiles->len >= rcfiles->capa) {
+        int32_t capa = rcfiles->capa ? rcfiles->capa * 2 : 16;
+        RcFile *files = PadMem_Realloc(rcfiles->files, sizeof(*files) * capa);
+        if (!files) {
+            return NULL;
         }
+        rcfiles->files = files;
+        rcfiles->capa = capa;
     }
 
-    const CapAliasInfo *alinfo = CapAliasMgr_GetcAliasInfo(self->almgr);
-    const PadDict *alias_kvmap = CapAliasInfo_GetcKeyValueMap(alinfo);
-    int32_t maxkeylen = 0;
-    int32_t maxvallen = 0;
-    bool hascontents = has_contents(self, alias_kvmap, &maxkeylen, &maxvallen);
-    const char *disppath = self->opts.is_normalize ? dirpath : cap_dirpath;
-    disppath = strlen(disppath) ? disppath : ".";
-
-    if (PadDict_Len(alias_kvmap) && hascontents) {
-        printf("%s\n\n", disppath);
-    }
-
-    for (int32_t i = 0; i < PadDict_Len(alias_kvmap); ++i) {
-        const PadDictItem *item = PadDict_GetcIndex(alias_kvmap, i);
-        if (CapArgsMgr_ContainsAll(self->argsmgr, item->key)) {
-            printf("    %-*s    %-*s\n", maxkeylen, item->key, maxvallen, item->value);
-        }
-    }
+    RcFile *rcfile = &rcfiles->files[rcfiles->len++];
+    *rcfile = (RcFile) {0};
+    snprintf(rcfile->dirpath, sizeof rcfile->dirpath, "%s", dirpath);
+    snprintf(rcfile->cap_dirpath, sizeof rcfile->cap_dirpath, "%s", cap_dirpath);
+    return rcfile;
+}
 
-    if (hascontents) {
-        printf("\n");
+static void
+make_rcpath(char *dst, int32_t dstsz, const RcFile *rcfile) {
+    if (!PadFile_SolveFmt(dst, dstsz, "%s/.caprc", rcfile->dirpath)) {
+        // not error
     }
+}
 
+/**
+ * Read names of directory in order of name
+ *
+ * @return success to pointer to PadCStrAry (dynamic allocate memory) else NULL
+ */
+static PadCStrAry *
+read_sorted_names(const char *dirpath) {
     PadDir *dir = PadDir_Open(dirpath);
     if (!dir) {
-        PadErr_Err("failed to open directory \"%s\"", dirpath);
-        return 1;
+        return NULL;
     }
 
-    int ret = 0;
-
+    PadCStrAry *names = PadCStrAry_New();
     for (;;) {
         PadDirNode *node = PadDir_Read(dir);
         if (!node) {
@@ -300,10 +330,57 @@ find_aliases_r(const CapFindCmd *self, const char *dirpath, const char *cap_dirp
         }
 
         const char *name = PadDirNode_Name(node);
-        if (PadCStr_Eq(name, ".") || PadCStr_Eq(name, "..")) {
-            PadDirNode_Del(node);
-            continue;
+        if (!PadCStr_Eq(name, ".") && !PadCStr_Eq(name, "..")) {
+            PadCStrAry_PushBack(names, name);
+        }
+        PadDirNode_Del(node);
+    }
+
+    PadDir_Close(dir);
+    PadCStrAry_Sort(names);
+    return names;
+}
+
+/**
+ * Collect directories that have resource file
+ * Directories are walked in order of name for deterministic output
+ *
+ * @return success to 0 else not 0
+ */
+static int
+collect_rcfiles_r(
+    const CapFindCmd *self,
+    RcFiles *rcfiles,
+    const char *dirpath,
+    const char *cap_dirpath,
+    int dep
+) {
+    if (dep >= self->opts.max_recursion) {
+        return 0;
+    }
+
+    char alpath[PAD_FILE__NPATH];
+    if (!PadFile_SolveFmt(alpath, sizeof alpath, "%s/.caprc", dirpath)) {
+        // not error
+    }
+
+    if (PadFile_IsExists(alpath)) {
+        if (!rcfiles_push(rcfiles, dirpath, cap_dirpath)) {
+            CapOut_Err(self->config, "failed to allocate memory");
+            return 1;
         }
+    }
+
+    PadCStrAry *names = read_sorted_names(dirpath);
+    if (!names) {
+        CapOut_Err(self->config, "failed to open directory \"%s\"", dirpath);
+        return 1;
+    }
+
+    int ret = 0;
+
+    for (int32_t i = 0; i < PadCStrAry_Len(names); ++i) {
+        const char *name = PadCStrAry_Getc(names, i);
 
         char cap_path[PAD_FILE__NPATH];
         join_cap_path(cap_path, sizeof cap_path, cap_dirpath, name);
@@ -313,18 +390,177 @@ find_aliases_r(const CapFindCmd *self, const char *dirpath, const char *cap_dirp
 
         char path[PAD_FILE__NPATH];
         if (!CapSymlink_FollowPath(self->config, path, sizeof path, tmp_path)) {
-            PadErr_Err("failed to follow path on find file recursive");
-            PadDirNode_Del(node);
+            CapOut_Err(self->config, "failed to follow path on find file recursive");
             continue;
         }
 
         if (PadFile_IsDir(path)) {
-            ret = find_aliases_r(self, path, cap_path, dep+1);
+            ret |= collect_rcfiles_r(self, rcfiles, path, cap_path, dep+1);
+        }
+    }
+
+    PadCStrAry_Del(names);
+    return ret;
+}
+
+/**
+ * Evaluate resource file by alias manager
+ *
+ * @return success to pointer to CapAliasInfo (dynamic allocate memory) else NULL
+ */
+static CapAliasInfo *
+eval_rcfile(CapAliasMgr *almgr, const RcFile *rcfile) {
+    char alpath[PAD_FILE__NPATH];
+    make_rcpath(alpath, sizeof alpath, rcfile);
+
+    CapAliasMgr_Clear(almgr);
+    if (!CapAliasMgr_LoadPath(almgr, alpath)) {
+        return NULL;
+    }
+
+    return CapAliasInfo_DeepCopy(CapAliasMgr_GetcAliasInfo(almgr));
+}
+
+/**
+ * Queue of resource files shared by workers
+ */
+typedef struct {
+    const CapConfig *config;
+    CapKitPool *kit_pool;  // kits are reused by workers
+    RcFiles *rcfiles;
+    int32_t next;  // index of next file for workers
+    pthread_mutex_t mutex;
+} Queue;
+
+/**
+ * Evaluate files of queue. Result of file is written by only worker that took the file
+ */
+static void *
+worker_main(void *arg) {
+    Queue *q = arg;
+    CapAliasMgr *almgr = CapAliasMgr_NewWithKitPool(q->config, q->kit_pool);
+    if (!almgr) {
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&q->mutex);
+        int32_t i = q->next < q->rcfiles->len ? q->next++ : -1;
+        pthread_mutex_unlock(&q->mutex);
+        if (i < 0) {
+            break;
         }
 
-        PadDirNode_Del(node);
+        RcFile *rcfile = &q->rcfiles->files[i];
+        rcfile->alinfo = eval_rcfile(almgr, rcfile);
+        rcfile->is_done = true;
+    }
+
+    CapAliasMgr_Del(almgr);
+    return NULL;
+}
+
+/**
+ * Evaluate resource files on worker threads and this thread
+ * Files that were not evaluated by workers are remained as not done
+ */
+static void
+eval_rcfiles_parallel(const CapFindCmd *self, RcFiles *rcfiles, int32_t njobs) {
+    Queue q = {
+        .config = self->config,
+        .rcfiles = rcfiles,
+    };
+    q.kit_pool = CapKitPool_New(self->config, njobs);
+    if (!q.kit_pool) {
+        return;
+    }
+    pthread_mutex_init(&q.mutex, NULL);
+
+    pthread_t threads[FINDCMD_MAX_JOBS];
+    int32_t nthreads = 0;
+    for (; nthreads < njobs - 1; ++nthreads) {
+        if (pthread_create(&threads[nthreads], NULL, worker_main, &q) != 0) {
+            break;
+        }
+    }
+
+    worker_main(&q);
+    for (int32_t i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&q.mutex);
+    CapKitPool_Del(q.kit_pool);
+}
+
+static void
+eval_rcfiles(const CapFindCmd *self, RcFiles *rcfiles) {
+    int32_t njobs = self->opts.jobs < rcfiles->len ? self->opts.jobs : rcfiles->len;
+    if (njobs > 1) {
+        eval_rcfiles_parallel(self, rcfiles, njobs);
+    }
+
+    // sequential or remained by failure of workers
+    for (int32_t i = 0; i < rcfiles->len; ++i) {
+        RcFile *rcfile = &rcfiles->files[i];
+        if (!rcfile->is_done) {
+            rcfile->alinfo = eval_rcfile(self->almgr, rcfile);
+            rcfile->is_done = true;
+        }
+    }
+}
+
+static void
+show_aliases(const CapFindCmd *self, const RcFile *rcfile) {
+    const CapAliasInfo *alinfo = rcfile->alinfo;
+    int32_t maxkeylen = 0;
+    int32_t maxvallen = 0;
+    bool hascontents = has_contents(self, alinfo, &maxkeylen, &maxvallen);
+    const char *disppath = self->opts.is_normalize ? rcfile->dirpath : rcfile->cap_dirpath;
+    disppath = strlen(disppath) ? disppath : ".";
+
+    if (CapAliasInfo_Len(alinfo) && hascontents) {
+        CapOut_Printf(self->config, "%s\n\n", disppath);
+    }
+
+    for (int32_t i = 0; i < CapAliasInfo_Len(alinfo); ++i) {
+        const char *key = CapAliasInfo_GetcKeyAt(alinfo, i);
+        if (CapArgsMgr_ContainsAll(self->argsmgr, key)) {
+            CapOut_Printf(self->config, "    %-*s    %-*s\n", maxkeylen, key, maxvallen, CapAliasInfo_GetcValueAt(alinfo, i));
+        }
+    }
+
+    if (hascontents) {
+        CapOut_Printf(self->config, "\n");
+    }
+}
+
+/**
+ * Find aliases in tree
+ * At first collects resource files, next evaluates them (in parallel),
+ * and last shows aliases in order of walk
+ */
+static int
+find_aliases(const CapFindCmd *self, const char *dirpath, const char *cap_dirpath) {
+    RcFiles rcfiles = {0};
+    int ret = collect_rcfiles_r(self, &rcfiles, dirpath, cap_dirpath, 0);
+
+    eval_rcfiles(self, &rcfiles);
+
+    for (int32_t i = 0; i < rcfiles.len; ++i) {
+        const RcFile *rcfile = &rcfiles.files[i];
+        if (!rcfile->alinfo) {
+            char alpath[PAD_FILE__NPATH];
+            make_rcpath(alpath, sizeof alpath, rcfile);
+            CapOut_Err(self->config, "failed to load resource file \"%s\" for alias", alpath);
+            ret = 1;
+            continue;
+        }
+        show_aliases(self, rcfile);
     }
 
+    CapOut_Flush(self->config);
+    rcfiles_fini(&rcfiles);
     return ret;
 }
 
@@ -336,12 +572,12 @@ find_start(const CapFindCmd *self) {
 
     char path[PAD_FILE__NPATH];
     if (!CapSymlink_FollowPath(self->config, path, sizeof path, tmppath)) {
-        PadErr_Err("failed to follow path in find files");
+        CapOut_Err(self->config, "failed to follow path in find files");
         return 1;
     }
     
     if (self->opts.is_alias) {
-        return find_aliases_r(self, path, self->opts.origin, 0);
+        return find_aliases(self, path, self->opts.origin);
     }
 
     return find_files_r(self, path, self->opts.origin, 0);
@@ -1,5 +1,8 @@
+#include <stdint.h>
+#include <stdlib.h>
 #include <getopt.h>
 #include <string.h>
+#include <pthread.h>
 
 #include <pad/lib/memory.h>
 #include <pad/lib/file.h>
@@ -12,9 +15,16 @@
 #include <cap/core/symlink.h>
 #include <cap/core/alias_manager.h>
 #include <cap/core/alias_info.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
+#include <cap/lang/kit_pool.h>
 #include <cap/find/arguments_manager.h>
 #include <cap/lang/builtin/modules/alias.h>
 
+#ifndef CAP__WINDOWS
+# include <unistd.h>
+#endif
+
 /**
  * Structure and type of command
  */
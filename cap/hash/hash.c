@@ -0,0 +1,154 @@
+#include <cap/hash/hash.h>
+
+/**
+ * Structure of options
+ */
+struct Opts {
+    bool is_help;
+    bool is_rebuild;
+    bool is_list;
+};
+
+/**
+ * Structure of command
+ */
+struct CapHashCmd {
+    const CapConfig *config;
+    int argc;
+    char **argv;
+    struct Opts opts;
+};
+
+/**
+ * Show usage of command
+ *
+ * @param[in] self pointer to CapHashCmd
+ */
+static int
+usage(CapHashCmd *self) {
+    CapOut_ErrPrintf(self->config, "Remember programs in PATH of resource files.\n"
+        "\n"
+        "Usage:\n"
+        "\n"
+        "    cap hash [options]\n"
+        "\n"
+        "The options are:\n"
+        "\n"
+        "    -h, --help       show usage\n"
+        "    -r, --rebuild    rebuild hash of programs\n"
+        "    -l, --list       show list of programs (default)\n"
+        "\n"
+    );
+    return 0;
+}
+
+/**
+ * Parse options
+ *
+ * @param[in] self pointer to CapHashCmd
+ *
+ * @return success to true
+ * @return failed to false
+ */
+static bool
+parse_opts(CapHashCmd *self) {
+    // parse options
+    static struct option longopts[] = {
+        {"help", no_argument, 0, 'h'},
+        {"rebuild", no_argument, 0, 'r'},
+        {"list", no_argument, 0, 'l'},
+        {0},
+    };
+
+    self->opts = (struct Opts){0};
+
+    CapGetopt opt = {0};
+
+    for (;;) {
+        int optsindex;
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hrl", longopts, &optsindex);
+        if (cur == -1) {
+            break;
+        }
+
+        switch (cur) {
+        case 0: /* long option only */ break;
+        case 'h': self->opts.is_help = true; break;
+        case 'r': self->opts.is_rebuild = true; break;
+        case 'l': self->opts.is_list = true; break;
+        case '?':
+        default:
+            CapOut_Err(self->config, "unknown option");
+            return false;
+            break;
+        }
+    }
+
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
+        return false;
+    }
+
+    return true;
+}
+
+void
+CapHashCmd_Del(CapHashCmd *self) {
+    if (!self) {
+        return;
+    }
+
+    Pad_SafeFree(self);
+}
+
+CapHashCmd *
+CapHashCmd_New(const CapConfig *config, int argc, char **argv) {
+    CapHashCmd *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->config = config;
+    self->argc = argc;
+    self->argv = argv;
+
+    return self;
+}
+
+static void
+show_list(const CapHashCmd *self, CapProgHash *hash) {
+    for (int32_t i = 0; i < CapProgHash_Len(hash); ++i) {
+        CapOut_Printf(self->config, "%s\t%s\n", CapProgHash_GetcNameAt(hash, i), CapProgHash_GetcPathAt(hash, i));
+    }
+    CapOut_Flush(self->config);
+}
+
+int
+CapHashCmd_Run(CapHashCmd *self) {
+    if (!parse_opts(self)) {
+        return 1;
+    }
+
+    if (self->opts.is_help) {
+        return usage(self);
+    }
+
+    CapProgHash *hash = CapProgHash_New();
+    if (!hash) {
+        CapOut_Err(self->config, "failed to create hash");
+        return 1;
+    }
+
+    if (!Cap_UpdateProgHash(self->config, hash, self->opts.is_rebuild)) {
+        CapOut_Err(self->config, "failed to hash programs");
+        CapProgHash_Del(hash);
+        return 1;
+    }
+
+    if (self->opts.is_list || !self->opts.is_rebuild) {
+        show_list(self, hash);
+    }
+
+    CapProgHash_Del(hash);
+    return 0;
+}
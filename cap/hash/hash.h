@@ -0,0 +1,62 @@
+/**
+ * Cap
+ *
+ * License: MIT
+ *  Author: narupo
+ *   Since: 2016
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <string.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/error.h>
+#include <pad/lib/file.h>
+
+#include <cap/core/util.h>
+#include <cap/core/config.h>
+#include <cap/core/prog_hash.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
+
+/**
+ * Structure and type of command
+ */
+struct CapHashCmd;
+typedef struct CapHashCmd CapHashCmd;
+
+/**
+ * Destruct command
+ *
+ * @param[in] self pointer to CapHashCmd
+ */
+void
+CapHashCmd_Del(CapHashCmd *self);
+
+/**
+ * Construct command
+ *
+ * @param[in] config reference to CapConfig
+ * @param[in] argc   number of arguments
+ * @param[in] argv   reference to array of arguments
+ *
+ * @return success to pointer to CapHashCmd
+ * @return failed to NULL
+ */
+CapHashCmd *
+CapHashCmd_New(const CapConfig *config, int argc, char **argv);
+
+/**
+ * Run command
+ *
+ * @param[in] self pointer to CapHashCmd
+ *
+ * @return success to number of 0
+ * @return failed to number of not 0
+ */
+int
+CapHashCmd_Run(CapHashCmd *self);
@@ -36,30 +36,30 @@ CapHomeCmd_Run(CapHomeCmd *self) {
     if (argc < 2) {
         char line[PAD_FILE__NPATH];
         if (!PadFile_ReadLine(line, sizeof line, self->config->var_home_path)) {
-            PadErr_Err("failed to read line from home of variable");
+            CapOut_Err(self->config, "failed to read line from home of variable");
             return 1;
         }
-        printf("%s\n", line);
+        CapOut_Printf(self->config, "%s\n", line);
         return 0;
     }
 
     char newhome[PAD_FILE__NPATH];
     if (!PadFile_Solve(newhome, sizeof newhome, argv[1])) {
-        PadErr_Err("failed to solve path from \"%s\"", argv[1]);
+        CapOut_Err(self->config, "failed to solve path from \"%s\"", argv[1]);
         return 1;
     }
     if (!PadFile_IsDir(newhome)) {
-        PadErr_Err("%s is not a directory", newhome);
+        CapOut_Err(self->config, "%s is not a directory", newhome);
         return 1;
     }
 
     if (!PadFile_WriteLine(newhome, self->config->var_home_path)) {
-        PadErr_Err("failed to write line to home variable");
+        CapOut_Err(self->config, "failed to write line to home variable");
         return 1;
     }
 
     if (!PadFile_WriteLine(newhome, self->config->var_cd_path)) {
-        PadErr_Err("failed to write line to cd variable");
+        CapOut_Err(self->config, "failed to write line to cd variable");
         return 1;
     }
 
@@ -4,6 +4,7 @@
 #include <pad/lib/file.h>
 #include <cap/core/util.h>
 #include <cap/core/config.h>
+#include <cap/core/output.h>
 
 struct CapHomeCmd;
 typedef struct CapHomeCmd CapHomeCmd;
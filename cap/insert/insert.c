@@ -34,9 +34,7 @@ struct CapInsertCmd {
  */
 static int
 usage(CapInsertCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap insert [file] [elem] [options]...\n"
         "\n"
@@ -47,7 +45,6 @@ usage(CapInsertCmd *self) {
         "    -b, --before    Insert before position of label or line no\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -71,14 +68,11 @@ parse_opts(CapInsertCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "ha:b:", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "ha:b:", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -86,22 +80,22 @@ parse_opts(CapInsertCmd *self) {
         switch (cur) {
         case 0: /* long option only */ break;
         case 'h': self->opts.is_help = true; break;
-        case 'a': snprintf(self->opts.after, sizeof self->opts.after, "%s", optarg); break;
-        case 'b': snprintf(self->opts.before, sizeof self->opts.before, "%s", optarg); break;
+        case 'a': snprintf(self->opts.after, sizeof self->opts.after, "%s", opt.optarg); break;
+        case 'b': snprintf(self->opts.before, sizeof self->opts.before, "%s", opt.optarg); break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -362,13 +356,13 @@ insert(CapInsertCmd *self) {
     if (self->argc < 3) {
         return usage(self);
     } else {
-        cap_path = self->argv[optind];
+        cap_path = self->argv[self->optind];
         if (!Cap_SolveCmdlineArgPath(self->config, path, sizeof path, cap_path)) {
             Pad_PushErr("failed to solve path");
             goto error;
         }
 
-        raw_elem = self->argv[optind + 1];
+        raw_elem = self->argv[self->optind + 1];
         elem = unescape(self, raw_elem);
     }
 
@@ -390,7 +384,7 @@ int
 CapInsertCmd_Run(CapInsertCmd *self) {
     int result = insert(self);
     if (PadErrStack_Len(self->errstack)) {
-        PadErrStack_TraceSimple(self->errstack, stderr);
+        CapOut_TraceErrStack(self->config, self->errstack);
         return result;
     }
     return result;
@@ -10,6 +10,8 @@
 #include <cap/core/constant.h>
 #include <cap/core/util.h>
 #include <cap/core/config.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 /**
  * structure and type of command
@@ -3,7 +3,11 @@
 #define push_error(fmt, ...) \
     Pad_PushBackErrNode(ref_ast->error_stack, fargs->ref_node, fmt, ##__VA_ARGS__)
 
-static const CapConfig *_cap_config;
+// config of kit of compiling on this thread
+static _Thread_local const CapConfig *_cap_config;
+
+// commands parse options by getopt of process
+static pthread_mutex_t _getopt_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static PadObj *
 blt_exec(PadBltFuncArgs *fargs) {
@@ -20,6 +24,11 @@ blt_exec(PadBltFuncArgs *fargs) {
         return NULL;
     }
 
+    if (!_cap_config) {
+        push_error("config is not set");
+        return NULL;
+    }
+
     PadObj *cmdlineobj = PadObjAry_Get(args, 0);
     PadStr *cmdline = Pad_ObjToString(ref_ast->error_stack, fargs->ref_node, cmdlineobj);
     if (!cmdline) {
@@ -32,7 +41,15 @@ blt_exec(PadBltFuncArgs *fargs) {
     int argc = PadCStrAry_Len(strarr);
     char **argv = PadCStrAry_EscDel(strarr);
 
+    pthread_mutex_lock(&_getopt_mutex);
     CapExecCmd *execcmd = CapExecCmd_New(_cap_config, argc, argv);
+    pthread_mutex_unlock(&_getopt_mutex);
+    if (!execcmd) {
+        Pad_FreeArgv(argc, argv);
+        push_error("failed to create exec command");
+        return NULL;
+    }
+
     int result = CapExecCmd_Run(execcmd);
     CapExecCmd_Del(execcmd);
 
@@ -50,7 +67,9 @@ CapBltFuncs_GetBltFuncInfos(void) {
     return blt_func_infos;
 }
 
-void
+const CapConfig *
 CapBltFuncs_SetCapConfig(const CapConfig *config) {
+    const CapConfig *prev = _cap_config;
     _cap_config = config;
+    return prev;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <pthread.h>
+
 #include <pad/lib/file.h>
 #include <pad/lib/error.h>
 #include <pad/lib/cl.h>
@@ -21,5 +23,14 @@
 PadBltFuncInfo *
 CapBltFuncs_GetBltFuncInfos(void);
 
-void
+/**
+ * set config for built-in functions on current thread
+ * pad's arguments of built-in function have not user data. CapKit sets
+ * config of kit while compile and restores previous config after it
+ *
+ * @param[in] *config reference to CapConfig
+ *
+ * @return previous config of current thread
+ */
+const CapConfig *
 CapBltFuncs_SetCapConfig(const CapConfig *config);
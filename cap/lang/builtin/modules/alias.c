@@ -3,26 +3,26 @@
 #define push_error(fmt, ...) \
     Pad_PushBackErrNode(ref_ast->error_stack, fargs->ref_node, fmt, ##__VA_ARGS__)
 
+// map of context to alias info. shared by threads and locked
 static PadVoidDict *_alias_info_map;
-
-static void
-_construct(void) {
-    if (_alias_info_map == NULL) {
-        _alias_info_map = PadVoidDict_New();
-    }
-}
+static pthread_mutex_t _alias_info_map_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static CapAliasInfo *
 get_item(const PadCtx *ctx) {
     char key[PAD_VOID_DICT_ITEM__KEY_SIZE];
     snprintf(key, sizeof key, "%p", ctx);
 
-    const PadVoidDictItem *i = PadVoidDict_Getc(_alias_info_map, key);
-    if (i == NULL) {
-        return NULL;
+    CapAliasInfo *alinfo = NULL;
+    pthread_mutex_lock(&_alias_info_map_mutex);
+    if (_alias_info_map) {
+        const PadVoidDictItem *i = PadVoidDict_Getc(_alias_info_map, key);
+        if (i) {
+            alinfo = i->value;
+        }
     }
+    pthread_mutex_unlock(&_alias_info_map_mutex);
 
-    return i->value;
+    return alinfo;
 }
 
 static PadVoidDict *
@@ -30,18 +30,34 @@ set_item(const PadCtx *ctx, CapAliasInfo *alinfo) {
     char key[PAD_VOID_DICT_ITEM__KEY_SIZE];
     snprintf(key, sizeof key, "%p", ctx);
 
-    return PadVoidDict_Move(_alias_info_map, key, alinfo);
+    PadVoidDict *result = NULL;
+    pthread_mutex_lock(&_alias_info_map_mutex);
+    if (_alias_info_map == NULL) {
+        _alias_info_map = PadVoidDict_New();
+    }
+    if (_alias_info_map) {
+        result = PadVoidDict_Move(_alias_info_map, key, alinfo);
+    }
+    pthread_mutex_unlock(&_alias_info_map_mutex);
+
+    return result;
 }
 
 const CapAliasInfo *
 CapBltAliasMod_GetAliasInfo(const PadCtx *ctx) {
-    _construct();
     return get_item(ctx);
 }
 
+void
+CapBltAliasMod_ClearAliasInfo(const PadCtx *ctx) {
+    CapAliasInfo *alinfo = get_item(ctx);
+    if (alinfo) {
+        CapAliasInfo_Clear(alinfo);
+    }
+}
+
 static PadObj *
 builtin_alias_set(PadBltFuncArgs *fargs) {
-    _construct();
     PadAST *ref_ast = fargs->ref_ast;
     assert(ref_ast);
     PadObj *actual_args = fargs->ref_args;
@@ -113,7 +129,6 @@ CapBltAliasMod_NewMod(const PadConfig *ref_config, PadGC *ref_gc) {
 
     PadBltFuncInfoAry *info_ary = PadBltFuncInfoAry_New();
     PadBltFuncInfoAry_ExtendBackAry(info_ary, builtin_func_infos);
-    _construct();
 
     return PadObj_NewModBy(
         ref_gc,
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <pthread.h>
+
 #include <pad/core/config.h>
 #include <pad/lib/void_dict.h>
 #include <pad/lang/types.h>
@@ -15,6 +17,15 @@
 const CapAliasInfo *
 CapBltAliasMod_GetAliasInfo(const PadCtx *ctx);
 
+/**
+ * clear aliases set in context
+ * call this before reuse of context for other source
+ *
+ * @param[in] *ctx
+ */
+void
+CapBltAliasMod_ClearAliasInfo(const PadCtx *ctx);
+
 /**
  * construct alias module
  *
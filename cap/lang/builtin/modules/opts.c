@@ -7,6 +7,7 @@
    つまりコンテキストのアドレスごとにoptsを用意する必要がある */
 
 static PadVoidDict *_opts_map;
+static pthread_mutex_t _opts_map_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 bool
 CapBltOptsMod_MoveOpts(void *pkey, CapOpts *move_opts) {
@@ -14,34 +15,34 @@ CapBltOptsMod_MoveOpts(void *pkey, CapOpts *move_opts) {
         return false;
     }
 
+    char key[PAD_VOID_DICT_ITEM__KEY_SIZE];
+    snprintf(key, sizeof key, "%p", pkey);
+
+    pthread_mutex_lock(&_opts_map_mutex);
     if (_opts_map == NULL) {
         _opts_map = PadVoidDict_New();
-        if (_opts_map == NULL) {
-            return false;
-        }
     }
+    bool ok = _opts_map && PadVoidDict_Move(_opts_map, key, PadMem_Move(move_opts));
+    pthread_mutex_unlock(&_opts_map_mutex);
 
-    char key[PAD_VOID_DICT_ITEM__KEY_SIZE];
-    snprintf(key, sizeof key, "%p", pkey);
-
-    return !!PadVoidDict_Move(_opts_map, key, PadMem_Move(move_opts));
+    return ok;
 }
 
 static CapOpts *
 get_item(void *pkey) {
-    if (_opts_map == NULL) {
-        return NULL;
-    }
-
     char key[PAD_VOID_DICT_ITEM__KEY_SIZE];
     snprintf(key, sizeof key, "%p", pkey);
 
-    const PadVoidDictItem *item = PadVoidDict_Getc(_opts_map, key);
-    if (item == NULL) {
-        return NULL;
+    CapOpts *opts = NULL;
+    pthread_mutex_lock(&_opts_map_mutex);
+    if (_opts_map) {
+        const PadVoidDictItem *item = PadVoidDict_Getc(_opts_map, key);
+        if (item) {
+            opts = item->value;
+        }
     }
+    pthread_mutex_unlock(&_opts_map_mutex);
 
-    CapOpts *opts = item->value;
     return opts;
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <pthread.h>
+
 #include <pad/lib/void_dict.h>
 #include <pad/core/config.h>
 #include <pad/core/util.h>
@@ -15,6 +17,16 @@
 
 #include <cap/lang/opts.h>
 
+/**
+ * move opts for context of pkey
+ * the map of opts is shared by threads and locked
+ *
+ * @param[in] *pkey      pointer to context
+ * @param[in] *move_opts pointer to CapOpts (move semantics)
+ *
+ * @return success to true
+ * @return failed to false
+ */
 bool
 CapBltOptsMod_MoveOpts(void *pkey, CapOpts *move_opts);
 
@@ -0,0 +1,26 @@
+#include <cap/lang/builtin/modules/registry.h>
+
+// modules are constructed by kit at first compile of source that uses it
+static const CapBltModInfo blt_mod_infos[] = {
+    {"alias", CapBltAliasMod_NewMod},
+    {0},
+};
+
+_Static_assert(
+    sizeof(blt_mod_infos) / sizeof(blt_mod_infos[0]) <= CAP_BLT_MODS__MAX,
+    "too many built-in modules"
+);
+
+const CapBltModInfo *
+CapBltMods_GetInfos(void) {
+    return blt_mod_infos;
+}
+
+bool
+CapBltMods_IsUsed(const char *src, const char *name) {
+    if (!src || !name) {
+        return false;
+    }
+
+    return CapRecord_HasWord(src, name) || CapRecord_HasWord(src, "import");
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <pad/core/config.h>
+#include <pad/lang/object.h>
+#include <pad/lang/gc.h>
+
+#include <cap/core/record.h>
+#include <cap/lang/builtin/modules/alias.h>
+
+/**
+ * max number of built-in modules
+ */
+enum {
+    CAP_BLT_MODS__MAX = 16,
+};
+
+/**
+ * factory of built-in module
+ *
+ * @param[in] *ref_config
+ * @param[in] *ref_gc
+ *
+ * @return success to pointer to PadObj of module, failed to NULL
+ */
+typedef PadObj *(*CapBltModNewFunc)(const PadConfig *ref_config, PadGC *ref_gc);
+
+/**
+ * information of built-in module
+ */
+typedef struct {
+    const char *name;  // name of module in source
+    CapBltModNewFunc new_mod;
+} CapBltModInfo;
+
+/**
+ * get built-in modules of cap
+ *
+ * @return array of CapBltModInfo. the last element has NULL of name
+ */
+const CapBltModInfo *
+CapBltMods_GetInfos(void);
+
+/**
+ * check if source may use module
+ * the name as a word or import (imported source is not known before compile) is use
+ *
+ * @param[in] *src  source of program
+ * @param[in] *name name of module
+ *
+ * @return may use to true, else false
+ */
+bool
+CapBltMods_IsUsed(const char *src, const char *name);
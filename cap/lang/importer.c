@@ -1,10 +1,38 @@
 #include <cap/lang/importer.h>
 
-static const CapConfig *_cap_config;
+// config of kit of compiling on this thread
+static _Thread_local const CapConfig *_cap_config;
 
-void
+// paths of imported modules of kit of compiling on this thread
+static _Thread_local PadCStrAry *_deps;
+
+PadCStrAry *
+CapImporter_SetDeps(PadCStrAry *deps) {
+    PadCStrAry *prev = _deps;
+    _deps = deps;
+    return prev;
+}
+
+static void
+add_dep(const char *path) {
+    if (!_deps) {
+        return;
+    }
+
+    for (int32_t i = 0; i < PadCStrAry_Len(_deps); ++i) {
+        if (!strcmp(PadCStrAry_Getc(_deps, i), path)) {
+            return;
+        }
+    }
+
+    PadCStrAry_PushBack(_deps, path);
+}
+
+const CapConfig *
 CapImporter_SetCapConfig(const CapConfig *config) {
+    const CapConfig *prev = _cap_config;
     _cap_config = config;
+    return prev;
 }
 
 char *
@@ -13,6 +41,10 @@ CapImporter_FixPath(PadImporter *imptr, char *dst, int32_t dstsz, const char *ca
         PadImporter_SetErr(imptr, "invalid arguments");
         return NULL;
     }
+    if (!_cap_config) {
+        PadImporter_SetErr(imptr, "config is not set");
+        return NULL;
+    }
 
     if (!Cap_SolveCmdlineArgPath(_cap_config, dst, dstsz, cap_path)) {
         PadImporter_SetErr(imptr, "failed to solve cap path of \"%s\"", cap_path);
@@ -33,5 +65,6 @@ CapImporter_FixPath(PadImporter *imptr, char *dst, int32_t dstsz, const char *ca
         }
     }
 
+    add_dep(dst);
     return dst;
 }
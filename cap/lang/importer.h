@@ -1,12 +1,33 @@
 #pragma once
 
 #include <pad/lib/file.h>
+#include <pad/lib/cstring_array.h>
 
 #include <cap/core/config.h>
 #include <cap/core/util.h>
 
-void
+/**
+ * set config for fix-path function on current thread
+ * pad's fix-path function has not user data. CapKit sets config of kit
+ * while compile and restores previous config after it
+ *
+ * @param[in] *config reference to CapConfig
+ *
+ * @return previous config of current thread
+ */
+const CapConfig *
 CapImporter_SetCapConfig(const CapConfig *config);
 
+/**
+ * set array for paths of imported modules on current thread
+ * fix-path function appends solved paths to it without duplicates
+ *
+ * @param[in] *deps pointer to PadCStrAry or NULL
+ *
+ * @return previous array of current thread
+ */
+PadCStrAry *
+CapImporter_SetDeps(PadCStrAry *deps);
+
 char *
 CapImporter_FixPath(PadImporter *self, char *dst, int32_t dstsz, const char *cap_path);
@@ -4,8 +4,35 @@ struct CapKit {
     const CapConfig *config;
     PadKit *kit;
     PadErrStack *errstack;
+    PadCStrAry *deps;  // paths of imported modules
+    bool is_installed;  // if true then built-in functions are installed
+    bool installed_mods[CAP_BLT_MODS__MAX];  // installed built-in modules by index of infos
 };
 
+/**
+ * install built-in modules that source uses
+ * installed modules are kept by kit between compiles
+ */
+static void
+install_blt_mods(CapKit *self, const char *src) {
+    PadGC *ref_gc = PadKit_GetRefGC(self->kit);
+    const CapBltModInfo *infos = CapBltMods_GetInfos();
+
+    for (int32_t i = 0; infos[i].name; ++i) {
+        if (self->installed_mods[i] || !CapBltMods_IsUsed(src, infos[i].name)) {
+            continue;
+        }
+
+        PadObj *mod = infos[i].new_mod(self->config->pad_config, ref_gc);
+        if (!mod) {
+            continue;  // compile reports undefined name
+        }
+        PadObj_IncRef(mod);
+        PadKit_MoveBltMod(self->kit, PadMem_Move(mod));
+        self->installed_mods[i] = true;
+    }
+}
+
 void
 CapKit_Del(CapKit *self) {
     if (self == NULL) {
@@ -14,6 +41,7 @@ CapKit_Del(CapKit *self) {
 
     PadKit_Del(self->kit);
     PadErrStack_Del(self->errstack);
+    PadCStrAry_Del(self->deps);
     free(self);
 }
 
@@ -39,6 +67,11 @@ CapKit_New(const CapConfig *config) {
         goto error;
     }
 
+    self->deps = PadCStrAry_New();
+    if (!self->deps) {
+        goto error;
+    }
+
     return self;
 error:
     CapKit_Del(self);
@@ -54,11 +87,14 @@ CapKit_CompileFromStrArgs(
     char **argv  // optional
 ) {
     PadAST *ref_ast = PadKit_GetRefAST(self->kit);
-    PadGC *ref_gc = PadKit_GetRefGC(self->kit);
 
-    // set fix-path function at importer
-    CapImporter_SetCapConfig(self->config);
-    PadKit_SetImporterFixPathFunc(self->kit, CapImporter_FixPath);
+    // config of this kit is bound to current thread while compile
+    // other kits can compile on other threads at same time
+    const CapConfig *prev_imptr_config = CapImporter_SetCapConfig(self->config);
+    const CapConfig *prev_funcs_config = CapBltFuncs_SetCapConfig(self->config);
+    PadCStrAry_Clear(self->deps);
+    PadCStrAry *prev_deps = CapImporter_SetDeps(self->deps);
+
 
     // parse pad-options
     PadOpts *opts = PadOpts_New();
@@ -70,14 +106,19 @@ CapKit_CompileFromStrArgs(
     // set pad-options
     PadAST_MoveOpts(ref_ast, PadMem_Move(opts));
 
-    // install built-in functions
-    CapBltFuncs_SetCapConfig(self->config);
-    PadKit_SetBltFuncInfos(self->kit, CapBltFuncs_GetBltFuncInfos());
+    // built-ins are kept by kit between compiles
+    if (!self->is_installed) {
+        // set fix-path function at importer
+        PadKit_SetImporterFixPathFunc(self->kit, CapImporter_FixPath);
 
-    // install alias module
-    PadObj *alias_mod = CapBltAliasMod_NewMod(self->config->pad_config, ref_gc);
-    PadObj_IncRef(alias_mod);
-    PadKit_MoveBltMod(self->kit, PadMem_Move(alias_mod));
+        // install built-in functions
+        PadKit_SetBltFuncInfos(self->kit, CapBltFuncs_GetBltFuncInfos());
+
+        self->is_installed = true;
+    }
+
+    // install built-in modules on demand
+    install_blt_mods(self, src);
 
     // compile
     if (!PadKit_CompileFromStrArgs(self->kit, prog_fname, src, argc, argv)) {
@@ -86,8 +127,14 @@ CapKit_CompileFromStrArgs(
         goto error;
     }
 
+    CapImporter_SetCapConfig(prev_imptr_config);
+    CapBltFuncs_SetCapConfig(prev_funcs_config);
+    CapImporter_SetDeps(prev_deps);
     return self;
 error:
+    CapImporter_SetCapConfig(prev_imptr_config);
+    CapBltFuncs_SetCapConfig(prev_funcs_config);
+    CapImporter_SetDeps(prev_deps);
     return NULL;
 }
 
@@ -100,6 +147,26 @@ CapKit_GetcStdoutBuf(const CapKit *self) {
     return PadKit_GetcStdoutBuf(self->kit);
 }
 
+bool
+CapKit_WriteStdoutBuf(const CapKit *self, CapSink *sink) {
+    if (self == NULL || sink == NULL) {
+        return false;
+    }
+
+    // write by chunks. sinks of stream don't copy whole output
+    const char *p = PadKit_GetcStdoutBuf(self->kit);
+    for (size_t len = strlen(p); len; ) {
+        size_t n = len < CAP_KIT__SINK_CHUNK_SIZE ? len : CAP_KIT__SINK_CHUNK_SIZE;
+        if (!CapSink_Write(sink, p, n)) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+
+    return true;
+}
+
 PadCtx *
 CapKit_GetRefCtx(const CapKit *self) {
     if (self == NULL) {
@@ -118,6 +185,35 @@ CapKit_Clear(CapKit *self) {
     PadKit_ClearCtx(self->kit);
 }
 
+CapKit *
+CapKit_Reset(CapKit *self) {
+    if (self == NULL) {
+        return NULL;
+    }
+
+    PadErrStack *errstack = PadErrStack_New();
+    if (!errstack) {
+        return NULL;
+    }
+    PadErrStack_Del(self->errstack);
+    self->errstack = errstack;
+
+    CapBltAliasMod_ClearAliasInfo(PadKit_GetRefCtx(self->kit));
+    PadKit_ClearCtx(self->kit);
+    PadCStrAry_Clear(self->deps);
+
+    return self;
+}
+
+const PadCStrAry *
+CapKit_GetcDeps(const CapKit *self) {
+    if (self == NULL) {
+        return NULL;
+    }
+
+    return self->deps;
+}
+
 const PadErrStack *
 CapKit_GetcErrStack(CapKit *self) {
     if (self == NULL) {
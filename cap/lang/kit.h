@@ -5,13 +5,21 @@
 #include <pad/lang/kit.h>
 #include <pad/lang/builtin/functions.h>
 
+/**
+ * size of chunk of writing stdout buffer to sink
+ */
+#define CAP_KIT__SINK_CHUNK_SIZE (64 * 1024)
+
+// declared before headers of cap because core/util.h refers CapKit
+struct CapKit;
+typedef struct CapKit CapKit;
+
 #include <cap/core/config.h>
+#include <cap/core/sink.h>
 #include <cap/lang/opts.h>
 #include <cap/lang/importer.h>
 #include <cap/lang/builtin/functions.h>
-
-struct CapKit;
-typedef struct CapKit CapKit;
+#include <cap/lang/builtin/modules/registry.h>
 
 void
 CapKit_Del(CapKit *self);
@@ -19,6 +27,12 @@ CapKit_Del(CapKit *self);
 CapKit *
 CapKit_New(const CapConfig *config);
 
+/**
+ * compile source and run it
+ * built-in modules (alias) are constructed when source uses them first
+ * kits can compile on different threads at same time
+ * a kit must not be used by threads at same time
+ */
 CapKit *
 CapKit_CompileFromStrArgs(
     CapKit *self,
@@ -31,12 +45,46 @@ CapKit_CompileFromStrArgs(
 const char *
 CapKit_GetcStdoutBuf(const CapKit *self);
 
+/**
+ * write stdout buffer of last compile to sink by chunks
+ * the sink is not closed
+ *
+ * @param[in] *self
+ * @param[in] *sink pointer to CapSink
+ *
+ * @return success to true, failed to false
+ */
+bool
+CapKit_WriteStdoutBuf(const CapKit *self, CapSink *sink);
+
 PadCtx *
 CapKit_GetRefCtx(const CapKit *self);
 
 void
 CapKit_Clear(CapKit *self);
 
+/**
+ * reset kit for next compile
+ * context, stdout buffer, aliases, error stack and dependencies are cleared
+ * built-in functions and modules are kept
+ *
+ * @param[in] *self
+ *
+ * @return success to pointer to self, failed to NULL
+ */
+CapKit *
+CapKit_Reset(CapKit *self);
+
+/**
+ * get paths of modules imported by last compile
+ *
+ * @param[in] *self
+ *
+ * @return pointer to PadCStrAry (read-only)
+ */
+const PadCStrAry *
+CapKit_GetcDeps(const CapKit *self);
+
 const PadErrStack *
 CapKit_GetcErrStack(CapKit *self);
 
@@ -0,0 +1,115 @@
+#include <cap/lang/kit_pool.h>
+
+struct CapKitPool {
+    const CapConfig *config;
+    CapKit **idles;  // reset at get
+    int32_t nidles;
+    int32_t max_idles;
+    CapKitPoolStats stats;
+    pthread_mutex_t mutex;
+};
+
+void
+CapKitPool_Del(CapKitPool *self) {
+    if (!self) {
+        return;
+    }
+
+    for (int32_t i = 0; i < self->nidles; ++i) {
+        CapKit_Del(self->idles[i]);
+    }
+    free(self->idles);
+    pthread_mutex_destroy(&self->mutex);
+    free(self);
+}
+
+CapKitPool *
+CapKitPool_New(const CapConfig *config, int32_t max_idles) {
+    if (!config || max_idles < 0) {
+        return NULL;
+    }
+
+    CapKitPool *self = PadMem_Calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    self->config = config;
+    self->max_idles = max_idles;
+    self->idles = PadMem_Calloc(max_idles + 1, sizeof(CapKit *));
+    if (!self->idles) {
+        free(self);
+        return NULL;
+    }
+    pthread_mutex_init(&self->mutex, NULL);
+
+    return self;
+}
+
+CapKit *
+CapKitPool_Get(CapKitPool *self) {
+    if (!self) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&self->mutex);
+    CapKit *kit = self->nidles ? self->idles[--self->nidles] : NULL;
+    pthread_mutex_unlock(&self->mutex);
+
+    // reset and construct outside of lock
+    if (kit && !CapKit_Reset(kit)) {
+        CapKit_Del(kit);
+        kit = NULL;
+    }
+
+    bool is_reused = kit != NULL;
+    if (!kit) {
+        kit = CapKit_New(self->config);
+        if (!kit) {
+            return NULL;
+        }
+    }
+
+    pthread_mutex_lock(&self->mutex);
+    if (is_reused) {
+        self->stats.nreuses++;
+    } else {
+        self->stats.nnews++;
+    }
+    pthread_mutex_unlock(&self->mutex);
+
+    return kit;
+}
+
+void
+CapKitPool_Put(CapKitPool *self, CapKit *move_kit, bool is_ok) {
+    if (!self || !move_kit) {
+        return;
+    }
+    if (!is_ok) {
+        CapKit_Del(move_kit);
+        return;
+    }
+
+    pthread_mutex_lock(&self->mutex);
+    if (self->nidles < self->max_idles) {
+        self->idles[self->nidles++] = move_kit;
+        move_kit = NULL;
+    }
+    pthread_mutex_unlock(&self->mutex);
+
+    CapKit_Del(move_kit);
+}
+
+CapKitPoolStats
+CapKitPool_GetStats(CapKitPool *self) {
+    if (!self) {
+        return (CapKitPoolStats) {0};
+    }
+
+    pthread_mutex_lock(&self->mutex);
+    CapKitPoolStats stats = self->stats;
+    pthread_mutex_unlock(&self->mutex);
+
+    return stats;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include <pad/lib/memory.h>
+
+#include <cap/core/config.h>
+#include <cap/lang/kit.h>
+
+/**
+ * statistics of pool
+ */
+typedef struct {
+    int64_t nnews;  // number of kits created by pool
+    int64_t nreuses;  // number of kits reused by pool
+} CapKitPoolStats;
+
+struct CapKitPool;
+typedef struct CapKitPool CapKitPool;
+
+/**
+ * destruct pool and idle kits
+ * kits got from pool must be put or deleted before
+ *
+ * @param[in] *self
+ */
+void
+CapKitPool_Del(CapKitPool *self);
+
+/**
+ * construct pool of kits
+ * threads can get and put kits at same time
+ *
+ * @param[in] *config   pointer to CapConfig (read-only) for kits
+ * @param[in] max_idles max number of idle kits kept by pool
+ *
+ * @return success to pointer to CapKitPool (dynamic allocate memory)
+ * @return failed to NULL
+ */
+CapKitPool *
+CapKitPool_New(const CapConfig *config, int32_t max_idles);
+
+/**
+ * get kit for compile. idle kit is reset and reused
+ *
+ * @param[in] *self
+ *
+ * @return success to pointer to CapKit, failed to NULL
+ */
+CapKit *
+CapKitPool_Get(CapKitPool *self);
+
+/**
+ * put kit back to pool. the kit is deleted if pool is full
+ * the kit of failed compile is deleted too because state of kit is unknown
+ *
+ * @param[in] *self
+ * @param[in] *kit  pointer to CapKit got from pool (move semantics)
+ * @param[in] is_ok if compile of kit was failed then false
+ */
+void
+CapKitPool_Put(CapKitPool *self, CapKit *move_kit, bool is_ok);
+
+/**
+ * get statistics of pool
+ *
+ * @param[in] *self
+ *
+ * @return statistics
+ */
+CapKitPoolStats
+CapKitPool_GetStats(CapKitPool *self);
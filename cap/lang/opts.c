@@ -229,8 +229,8 @@ CapOpts_Show(CapOpts *self, FILE *fout) {
         return;
     }
 
-    printf("opts:\n");
+    fprintf(fout, "opts:\n");
     PadDict_Show(self->opts, fout);
-    printf("args:\n");
+    fprintf(fout, "args:\n");
     PadCStrAry_Show(self->args, fout);
 }
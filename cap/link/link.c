@@ -6,6 +6,8 @@
 struct Opts {
     bool is_help;
     bool is_unlink;
+    bool is_reindex;
+    bool is_tag;
 };
 
 /**
@@ -35,19 +37,22 @@ parse_opts(CapLinkCmd *self) {
     static struct option longopts[] = {
         {"help", no_argument, 0, 'h'},
         {"unlink", no_argument, 0, 'u'},
+        {"reindex", no_argument, 0, 'r'},
+        {"tag", no_argument, 0, 't'},
         {0},
     };
 
     self->opts = (struct Opts){
         .is_help = false,
         .is_unlink = false,
+        .is_reindex = false,
+        .is_tag = false,
     };
-    opterr = 0;
-    optind = 0;
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hu", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hurt", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -56,19 +61,21 @@ parse_opts(CapLinkCmd *self) {
         case 0: /* Long option only */ break;
         case 'h': self->opts.is_help = true; break;
         case 'u': self->opts.is_unlink = true; break;
+        case 'r': self->opts.is_reindex = true; break;
+        case 't': self->opts.is_tag = true; break;
         case '?':
         default:
-            PadErr_Die("unsupported option");
+            CapOut_Err(self->config, "unsupported option");
             return NULL;
             break;
         }
     }
 
-    if (self->argc < optind) {
+    if (self->argc < opt.optind) {
         return NULL;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
 
     return self;
 }
@@ -102,7 +109,7 @@ CapLinkCmd_New(const CapConfig *config, int argc, char **argv) {
 
 static int
 usage(const CapLinkCmd *self) {
-    fprintf(stderr,
+    CapOut_ErrPrintf(self->config,
         "Usage:\n"
         "\n"
         "    cap link [options] [link-name] [cap-path]\n"
@@ -111,12 +118,23 @@ usage(const CapLinkCmd *self) {
         "\n"
         "    -h, --help       show usage.\n"
         "    -u, --unlink     unlink link.\n"
+        "    -r, --reindex    rebuild index of links under home.\n"
+        "    -t, --tag        tag existing links under home by extended attribute.\n"
+        "\n"
+        "If index of links exists then cap link and cap link -u update the index\n"
+        "and links are found without read of files.\n"
+        "Run --reindex after create links without cap link.\n"
+        "\n"
+        "cap link tags link by extended attribute \"user.cap.symlink\" if supported.\n"
+        "Run --tag for links created by old version.\n"
         "\n"
         "Examples:\n"
         "\n"
         "    $ cap link mylink /path/to/file\n"
         "    $ cap link mylink /path/to/dir\n"
         "    $ cap link -u mylink\n"
+        "    $ cap link --reindex\n"
+        "    $ cap link --tag\n"
         "\n"
     );
     return 0;
@@ -133,22 +151,22 @@ cmd_unlink(CapLinkCmd *self) {
 
     char path[PAD_FILE__NPATH];
     if (!PadFile_SolveFmt(path, sizeof path, "%s/%s", org, linkname)) {
-        PadErr_Err("failed to solve path");
+        CapOut_Err(self->config, "failed to solve path");
         return 1;
     }
 
     if (Cap_IsOutOfHome(self->config->home_path, path)) {
-        PadErr_Err("\"%s\" is out of home", linkname);
+        CapOut_Err(self->config, "\"%s\" is out of home", linkname);
         return 1;
     }
 
-    if (!CapSymlink_IsLinkFile(path)) {
-        PadErr_Err("\"%s\" is not Cap's symbolic link", linkname);
+    if (!CapSymlink_IsLinkFile(self->config, path)) {
+        CapOut_Err(self->config, "\"%s\" is not Cap's symbolic link", linkname);
         return 1;
     }
 
-    if (PadFile_Remove(path) != 0) {
-        PadErr_Err("failed to unlink");
+    if (!CapSymlink_Unlink(self->config, path)) {
+        CapOut_Err(self->config, "failed to unlink");
         return 1;
     }
 
@@ -163,7 +181,7 @@ cmd_link(CapLinkCmd *self) {
 
     const char *linkname = self->argv[self->optind];
     if (strstr(linkname, "..")) {
-        PadErr_Err("Cap's symbolic link is not allow relative path");
+        CapOut_Err(self->config, "Cap's symbolic link is not allow relative path");
         return 1;
     }
 
@@ -172,25 +190,47 @@ cmd_link(CapLinkCmd *self) {
 
     char dstpath[PAD_FILE__NPATH];
     if (!PadFile_SolveFmt(dstpath, sizeof dstpath, "%s/%s", org, linkname)) {
-        PadErr_Err("failed to solve path");
+        CapOut_Err(self->config, "failed to solve path");
         return 1;
     }
 
     if (Cap_IsOutOfHome(self->config->home_path, dstpath)) {
-        PadErr_Err("\"%s\" is out of home", linkname);
+        CapOut_Err(self->config, "\"%s\" is out of home", linkname);
         return 1;
     }
 
-    char line[PAD_FILE__NPATH + 100];
-    snprintf(line, sizeof line, "%s %s", CAP_SYMLINK__HEADER, cappath);
-    if (!PadFile_WriteLine(line, dstpath)) {
-        PadErr_Err("failed to create link");
+    if (!CapSymlink_Link(self->config, dstpath, cappath)) {
+        CapOut_Err(self->config, "failed to create link");
         return 1;        
     }
 
     return 0;
 }
 
+static int
+cmd_reindex(CapLinkCmd *self) {
+    int32_t len = CapSymlink_Reindex(self->config);
+    if (len < 0) {
+        CapOut_Err(self->config, "failed to rebuild index of links");
+        return 1;
+    }
+
+    CapOut_Printf(self->config, "%d links\n", len);
+    return 0;
+}
+
+static int
+cmd_tag(CapLinkCmd *self) {
+    int32_t ntagged = CapSymlink_TagLinks(self->config);
+    if (ntagged < 0) {
+        CapOut_Err(self->config, "failed to tag links");
+        return 1;
+    }
+
+    CapOut_Printf(self->config, "%d links tagged\n", ntagged);
+    return 0;
+}
+
 int
 CapLinkCmd_Run(CapLinkCmd *self) {
     if (self->opts.is_help) {
@@ -201,5 +241,13 @@ CapLinkCmd_Run(CapLinkCmd *self) {
         return cmd_unlink(self);
     }
 
+    if (self->opts.is_reindex) {
+        return cmd_reindex(self);
+    }
+
+    if (self->opts.is_tag) {
+        return cmd_tag(self);
+    }
+
     return cmd_link(self);
 }
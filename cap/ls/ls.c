@@ -8,6 +8,7 @@ struct Opts {
 struct CapLsCmd {
     const CapConfig *config;
     int argc;
+    int optind;
     char **argv;
     struct Opts opts;
 };
@@ -30,12 +31,11 @@ parse_opts(CapLsCmd *self) {
     };
 
     self->opts = (struct Opts){0};
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "ha", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "ha", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -45,22 +45,23 @@ parse_opts(CapLsCmd *self) {
         case 'a': self->opts.is_all = true; break;
         case '?':
         default:
-            PadErr_Err("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
+    if (self->argc < opt.optind) {
         return false;
     }
 
+    self->optind = opt.optind;
     return true;
 }
 
 static int
 usage(const CapLsCmd *self) {
-    fprintf(stderr,
+    CapOut_ErrPrintf(self->config,
         "Usage:\n"
         "\n"
         "    cap ls [options]\n"
@@ -93,19 +94,19 @@ CapLsCmd_New(const CapConfig *config, int argc, char **argv) {
 static void
 print_fname(const CapLsCmd *self, FILE *fout, bool print_color, const char *path, const char *name) {
     if (!print_color) {
-        fprintf(fout, "%s\n", name);
+        CapOut_Printf(self->config, "%s\n", name);
         return;
     }
 
     char fpath[PAD_FILE__NPATH];
     if (!PadFile_SolveFmt(fpath, sizeof fpath, "%s/%s", path, name)) {
-        PadErr_Err("failed to solve path by name \"%s\"", name);
+        CapOut_Err(self->config, "failed to solve path by name \"%s\"", name);
         return;
     }
 
     if (PadFile_IsDir(fpath)) {
         PadTerm_CFPrintf(fout, PAD_TERM__WHITE, PAD_TERM__GREEN, PAD_TERM__BRIGHT, "%s", name);
-    } else if (CapSymlink_IsLinkFile(fpath)) {
+    } else if (CapSymlink_IsLinkFile(self->config, fpath)) {
         PadTerm_CFPrintf(fout, PAD_TERM__CYAN, PAD_TERM__BLACK, PAD_TERM__BRIGHT, "%s", name);
     } else {
         PadTerm_CFPrintf(fout, PAD_TERM__GREEN, PAD_TERM__BLACK, PAD_TERM__BRIGHT, "%s", name);
@@ -114,15 +115,17 @@ print_fname(const CapLsCmd *self, FILE *fout, bool print_color, const char *path
 }
 
 static void
-dump_ary(const CapLsCmd *self, FILE *fout, const char *path, const PadCStrAry *arr) {
-    bool print_color = isatty(PadFile_GetNum(fout));
+dump_ary(const CapLsCmd *self, const char *path, const PadCStrAry *arr) {
+    // colors are written to terminal only. sink of caller gets plain text
+    FILE *fout = stdout;
+    bool print_color = !self->config->out_sink && isatty(PadFile_GetNum(fout));
 
     for (int i = 0; i < PadCStrAry_Len(arr); ++i) {
         const char *name = PadCStrAry_Getc(arr, i);
         print_fname(self, fout, print_color, path, name);
     }
 
-    fflush(fout);
+    CapOut_Flush(self->config);
 }
 
 static bool
@@ -157,28 +160,28 @@ dir_to_ary(const CapLsCmd *self, PadDir *dir) {
 static int
 _ls(const CapLsCmd *self, const char *path) {
     if (Cap_IsOutOfHome(self->config->home_path, path)) {
-        PadErr_Err("\"%s\" is out of home", path);
+        CapOut_Err(self->config, "\"%s\" is out of home", path);
         return 1;
     }
 
     PadDir *dir = PadDir_Open(path);
     if (!dir) {
-        PadErr_Err("failed to open directory \"%s\"", path);
+        CapOut_Err(self->config, "failed to open directory \"%s\"", path);
         return 2;
     }
 
     PadCStrAry *arr = dir_to_ary(self, dir);
     if (!arr) {
-        PadErr_Err("failed to read directory \"%s\"", path);
+        CapOut_Err(self->config, "failed to read directory \"%s\"", path);
         return 3;
     }
 
     PadCStrAry_Sort(arr);
-    dump_ary(self, stdout, path, arr);
+    dump_ary(self, path, arr);
     PadCStrAry_Del(arr);
 
     if (PadDir_Close(dir) < 0) {
-        PadErr_Err("failed to close directory \"%s\"", path);
+        CapOut_Err(self->config, "failed to close directory \"%s\"", path);
         return 4;
     }
 
@@ -193,14 +196,14 @@ CapLsCmd_Run(CapLsCmd *self) {
 
     char realpath[PAD_FILE__NPATH];
 
-    if (optind - self->argc == 0) {
+    if (self->optind - self->argc == 0) {
         if (!CapSymlink_FollowPath(self->config, realpath, sizeof realpath, self->config->cd_path)) {
-            PadErr_Err("failed to follow path");
+            CapOut_Err(self->config, "failed to follow path");
             return 1;
         }
         return _ls(self, realpath);
     } else {
-        for (int i = optind; i < self->argc; ++i) {
+        for (int i = self->optind; i < self->argc; ++i) {
             const char *arg = self->argv[i];
             const char *org = (arg[0] == '/' ? self->config->home_path : self->config->cd_path);
             if (!strcmp(arg, "/")) {
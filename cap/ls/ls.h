@@ -10,6 +10,8 @@
 #include <cap/core/util.h>
 #include <cap/core/config.h>
 #include <cap/core/symlink.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 struct CapLsCmd;
 typedef struct CapLsCmd CapLsCmd;
@@ -0,0 +1,53 @@
+/**
+ * Cap
+ *
+ * license: MIT
+ *  author: narupo
+ *   since: 2016
+ */
+#include <cap/app.h>
+
+/**
+ * forward arguments to daemon if daemon is running
+ *
+ * @param[out] *result exit code of command
+ * @param[in]  argc
+ * @param[in]  argv
+ *
+ * @return forwarded to true else false
+ */
+static bool
+CapApp_ForwardToDaemon(int *result, int argc, char *argv[]) {
+    if (!CapApp_IsForwardable(argc, argv)) {
+        return false;
+    }
+
+    char sockpath[PAD_FILE__NPATH];
+    if (!PadFile_Solve(sockpath, sizeof sockpath, "~/.cap/var/daemon.sock")) {
+        return false;
+    }
+
+    return CapDaemon_Forward(result, sockpath, argc, argv);
+}
+
+/**
+ * main routine
+ *
+ * @param[in] argc
+ * @param[in] argv
+ *
+ * @return success to 0
+ * @return failed to not 0
+ */
+int
+main(int argc, char *argv[]) {
+    // set locale for unicode object (char32_t, char16_t)
+    setlocale(LC_CTYPE, "");
+
+    int result = 0;
+    if (CapApp_ForwardToDaemon(&result, argc, argv)) {
+        return result;
+    }
+
+    return CapApp_Main(argc, argv);
+}
@@ -0,0 +1,328 @@
+#include <cap/make/jobs.h>
+
+/**
+ * numbers
+ */
+enum {
+    MAX_JOBS = 256,
+    WINDOW_PER_JOB = 2,
+};
+
+/**
+ * job of one file
+ */
+typedef struct {
+    char *path;  // path of template
+    char *dest;  // path of destination or NULL for output
+    char *result;  // compiled text for output
+    PadErrStack *errstack;
+    bool is_done;
+    bool is_ok;
+} Job;
+
+/**
+ * queue of jobs shared by workers
+ */
+typedef struct {
+    const CapConfig *config;
+    CapKitPool *kit_pool;  // kits are reused by workers
+    Job *jobs;
+    int32_t len;
+    int32_t next;  // index of next job for workers
+    int32_t nprinted;  // number of results written to output
+    int32_t window;  // max number of results waiting for output. 0 is unlimited
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} Queue;
+
+static void
+jobs_del(Job *jobs, int32_t len) {
+    if (!jobs) {
+        return;
+    }
+
+    for (int32_t i = 0; i < len; ++i) {
+        free(jobs[i].path);
+        free(jobs[i].dest);
+        free(jobs[i].result);
+        PadErrStack_Del(jobs[i].errstack);
+    }
+    free(jobs);
+}
+
+char *
+CapMakeJobs_MakeDest(const char *path) {
+    const char *sep = strrchr(path, PAD_FILE__SEP);
+    const char *dot = strrchr(sep ? sep : path, '.');
+    if (!dot || dot == path || (sep && dot == sep + 1)) {
+        return NULL;
+    }
+
+    char *dest = PadCStr_Dup(path);
+    if (dest) {
+        dest[dot - path] = '\0';
+    }
+    return dest;
+}
+
+/**
+ * solve paths of files in thread of caller
+ * resolution of cap's paths uses cache of process
+ */
+static Job *
+jobs_new(const CapConfig *config, PadErrStack *errstack, int nfiles, char *files[], const CapMakeJobsOpts *opts) {
+    Job *jobs = PadMem_Calloc(nfiles, sizeof(*jobs));
+    if (!jobs) {
+        PadErrStack_Add(errstack, "failed to allocate memory");
+        return NULL;
+    }
+
+    for (int32_t i = 0; i < nfiles; ++i) {
+        Job *job = &jobs[i];
+        char path[PAD_FILE__NPATH];
+
+        if (opts->solve_path) {
+            if (!Cap_SolveCmdlineArgPath(config, path, sizeof path, files[i])) {
+                PadErrStack_Add(errstack, "failed to solve cap path of \"%s\"", files[i]);
+                goto error;
+            }
+        } else {
+            PadCStr_Copy(path, sizeof path, files[i]);
+        }
+
+        job->path = PadCStr_Dup(path);
+        job->errstack = PadErrStack_New();
+        if (!job->path || !job->errstack) {
+            PadErrStack_Add(errstack, "failed to allocate memory");
+            goto error;
+        }
+
+        if (opts->is_strip_ext) {
+            job->dest = CapMakeJobs_MakeDest(path);
+            if (!job->dest) {
+                PadErrStack_Add(errstack, "\"%s\" has not extension for destination", files[i]);
+                goto error;
+            }
+        }
+    }
+
+    return jobs;
+error:
+    jobs_del(jobs, nfiles);
+    return NULL;
+}
+
+static bool
+make_job(CapKitPool *kit_pool, Job *job) {
+    char *src = PadFile_ReadCopyFromPath(job->path);
+    if (!src) {
+        PadErrStack_Add(job->errstack, "failed to read from \"%s\"", job->path);
+        return false;
+    }
+
+    CapKit *kit = CapKitPool_Get(kit_pool);
+    if (!kit) {
+        PadErrStack_Add(job->errstack, "failed to create kit");
+        free(src);
+        return false;
+    }
+
+    char *argv[] = {job->path, NULL};
+    if (!job->dest) {
+        // result is printed in order of files by main thread
+        char *compiled = Cap_MakeArgvByKit(kit, job->errstack, job->path, src, 1, argv);
+        CapKitPool_Put(kit_pool, kit, compiled != NULL);
+        free(src);
+        if (!compiled) {
+            PadErrStack_Add(job->errstack, "failed to compile from \"%s\"", job->path);
+            return false;
+        }
+        PadCStr_PopLastNewline(compiled);
+        job->result = compiled;
+        return true;
+    }
+
+    bool ok = false;
+    bool is_compiled = false;
+    CapSink *sink = CapSink_PopLastNewline(CapSink_NewAtomicFile(job->dest));
+    if (!sink) {
+        PadErrStack_Add(job->errstack, "failed to open \"%s\"", job->dest);
+        goto done;
+    }
+
+    if (!CapKit_CompileFromStrArgs(kit, job->path, src, 1, argv)) {
+        PadErrStack_ExtendBackOther(job->errstack, CapKit_GetcErrStack(kit));
+        PadErrStack_Add(job->errstack, "failed to compile from \"%s\"", job->path);
+        goto done;
+    }
+    is_compiled = true;
+
+    // destination is not changed if write is failed
+    if (!CapKit_WriteStdoutBuf(kit, sink) || !CapSink_Close(sink)) {
+        PadErrStack_Add(job->errstack, "failed to write to \"%s\"", job->dest);
+        goto done;
+    }
+
+    ok = true;
+done:
+    CapSink_Del(sink);
+    CapKitPool_Put(kit_pool, kit, is_compiled);
+    free(src);
+    return ok;
+}
+
+static void *
+worker_main(void *arg) {
+    Queue *q = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&q->mutex);
+        while (q->window &&
+               q->next < q->len &&
+               q->next >= q->nprinted + q->window) {
+            pthread_cond_wait(&q->cond, &q->mutex);
+        }
+        int32_t i = q->next < q->len ? q->next++ : -1;
+        pthread_mutex_unlock(&q->mutex);
+        if (i < 0) {
+            break;
+        }
+
+        Job *job = &q->jobs[i];
+        bool ok = make_job(q->kit_pool, job);
+
+        pthread_mutex_lock(&q->mutex);
+        job->is_ok = ok;
+        job->is_done = true;
+        pthread_cond_broadcast(&q->cond);
+        pthread_mutex_unlock(&q->mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * write results to output in order of files while workers make next files
+ *
+ * @return number of failed jobs
+ */
+static int32_t
+print_results(Queue *q) {
+    int32_t nfails = 0;
+
+    for (int32_t i = 0; i < q->len; ++i) {
+        Job *job = &q->jobs[i];
+
+        pthread_mutex_lock(&q->mutex);
+        while (!job->is_done) {
+            pthread_cond_wait(&q->cond, &q->mutex);
+        }
+        pthread_mutex_unlock(&q->mutex);
+
+        if (job->is_ok && job->result) {
+            CapOut_Printf(q->config, "%s", job->result);
+            CapOut_Flush(q->config);
+        } else if (!job->is_ok) {
+            CapOut_TraceErrStack(q->config, job->errstack);
+            nfails++;
+        }
+        free(job->result);
+        job->result = NULL;
+
+        pthread_mutex_lock(&q->mutex);
+        q->nprinted = i + 1;
+        pthread_cond_broadcast(&q->cond);
+        pthread_mutex_unlock(&q->mutex);
+    }
+
+    return nfails;
+}
+
+int
+CapMakeJobs_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    int nfiles,
+    char *files[],
+    const CapMakeJobsOpts *opts
+) {
+    if (!config || !errstack || !files || !opts) {
+        return 1;
+    }
+    if (nfiles <= 0) {
+        PadErrStack_Add(errstack, "need files for jobs");
+        return 1;
+    }
+    if (opts->njobs <= 0) {
+        PadErrStack_Add(errstack, "invalid number of jobs");
+        return 1;
+    }
+
+    int32_t nworkers = opts->njobs;
+    if (nworkers > nfiles) {
+        nworkers = nfiles;
+    }
+    if (nworkers > MAX_JOBS) {
+        nworkers = MAX_JOBS;
+    }
+
+    Queue q = {
+        .config = config,
+        .len = nfiles,
+        .window = opts->is_strip_ext ? 0 : nworkers * WINDOW_PER_JOB,
+    };
+    q.jobs = jobs_new(config, errstack, nfiles, files, opts);
+    if (!q.jobs) {
+        return 1;
+    }
+    q.kit_pool = CapKitPool_New(config, nworkers);
+    if (!q.kit_pool) {
+        PadErrStack_Add(errstack, "failed to create pool of kits");
+        jobs_del(q.jobs, q.len);
+        return 1;
+    }
+    pthread_mutex_init(&q.mutex, NULL);
+    pthread_cond_init(&q.cond, NULL);
+
+    pthread_t threads[MAX_JOBS];
+    int32_t nthreads = 0;
+    for (; nthreads < nworkers; ++nthreads) {
+        if (pthread_create(&threads[nthreads], NULL, worker_main, &q) != 0) {
+            break;
+        }
+    }
+
+    int32_t nfails = 0;
+    if (nthreads == 0) {
+        // can't create threads. make all in this thread
+        q.window = 0;
+        worker_main(&q);
+    }
+    if (!opts->is_strip_ext) {
+        nfails = print_results(&q);
+    }
+
+    for (int32_t i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (opts->is_strip_ext) {
+        for (int32_t i = 0; i < q.len; ++i) {
+            if (!q.jobs[i].is_ok) {
+                CapOut_TraceErrStack(config, q.jobs[i].errstack);
+                nfails++;
+            }
+        }
+    }
+
+    pthread_cond_destroy(&q.cond);
+    pthread_mutex_destroy(&q.mutex);
+    jobs_del(q.jobs, q.len);
+    CapKitPool_Del(q.kit_pool);
+
+    if (nfails) {
+        PadErrStack_Add(errstack, "failed to make %d files", nfails);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/core/error_stack.h>
+
+#include <cap/core/config.h>
+#include <cap/core/util.h>
+#include <cap/core/output.h>
+#include <cap/lang/kit_pool.h>
+
+/**
+ * options of jobs
+ */
+typedef struct {
+    int32_t njobs;  // number of workers
+    bool is_strip_ext;  // write result to path of file without last extension. else write to stdout
+    bool solve_path;  // if true then files are cap's paths
+} CapMakeJobsOpts;
+
+/**
+ * make path of destination of file by strip of last extension ("a.c.cap" to "a.c")
+ *
+ * @param[in] *path path of file
+ *
+ * @return success to pointer to dynamic allocated path, file has not extension to NULL
+ */
+char *
+CapMakeJobs_MakeDest(const char *path);
+
+/**
+ * make files by workers at same time
+ * results are written to stdout in order of files. the number of results
+ * waiting for output is bounded by the number of workers
+ * if is_strip_ext then each result is written to own file ("a.c.cap" to "a.c")
+ *
+ * @param[in]  *config   pointer to CapConfig (read-only)
+ * @param[out] *errstack pointer to PadErrStack
+ * @param[in]  nfiles    number of files
+ * @param[in]  *files[]  paths of files
+ * @param[in]  *opts     pointer to CapMakeJobsOpts
+ *
+ * @return success to 0, else other
+ */
+int
+CapMakeJobs_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    int nfiles,
+    char *files[],
+    const CapMakeJobsOpts *opts
+);
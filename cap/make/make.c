@@ -44,6 +44,452 @@ error:
     return NULL;
 }
 
+/**
+ * options of make before file
+ */
+typedef struct {
+    CapMakeJobsOpts jobs;
+    bool is_jobs;
+    bool is_watch;
+    const char *out_path;  // path of output by -o or NULL
+    const char *deps_path;  // path of depfile by --deps or NULL
+    bool is_incremental;
+    bool is_cache;  // read and write result of render at cache by --cache
+    int optind;  // index of file in argv
+} MakeOpts;
+
+static bool
+is_make_opt(const char *arg) {
+    static const char *longs[] = {
+        "--jobs", "--strip-ext", "--output", "--deps", "--incremental", "--watch",
+        "--cache", NULL,
+    };
+
+    if (!arg || arg[0] != '-') {
+        return false;
+    }
+    if (arg[1] == 'j' || arg[1] == 'x' || arg[1] == 'o') {
+        return true;
+    }
+
+    size_t len = strcspn(arg, "=");
+    for (const char **p = longs; *p; ++p) {
+        if (strlen(*p) == len && !strncmp(arg, *p, len)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * parse options of make
+ * index of file in argv is set to optind of options
+ *
+ * @return success to true, else false
+ */
+static bool
+parse_make_opts(
+    MakeOpts *opts,
+    PadErrStack *errstack,
+    int argc,
+    char *argv[],
+    bool solve_path
+) {
+    static struct option longopts[] = {
+        {"jobs", required_argument, 0, 'j'},
+        {"strip-ext", no_argument, 0, 'x'},
+        {"output", required_argument, 0, 'o'},
+        {"deps", required_argument, 0, 'd'},
+        {"incremental", no_argument, 0, 'i'},
+        {"watch", no_argument, 0, 'w'},
+        {"cache", no_argument, 0, 'c'},
+        {0},
+    };
+
+    *opts = (MakeOpts) {
+        .jobs = {
+            .njobs = 1,
+            .solve_path = solve_path,
+        },
+    };
+
+    CapGetopt opt = {0};
+
+    for (;;) {
+        int optsindex;
+        // arguments after first file are not options of make
+        int cur = CapGetopt_Long(&opt, argc, argv, "+j:xo:", longopts, &optsindex);
+        if (cur == -1) {
+            break;
+        }
+
+        switch (cur) {
+        case 'j': opts->is_jobs = true; opts->jobs.njobs = atoi(opt.optarg); break;
+        case 'x': opts->jobs.is_strip_ext = true; break;
+        case 'o': opts->out_path = opt.optarg; break;
+        case 'd': opts->deps_path = opt.optarg; break;
+        case 'i': opts->is_incremental = true; break;
+        case 'w': opts->is_watch = true; break;
+        case 'c': opts->is_cache = true; break;
+        case '?':
+        default:
+            PadErrStack_Add(errstack, "invalid option of make");
+            return false;
+        }
+    }
+
+    if (opts->is_jobs || opts->is_watch) {
+        if (opts->out_path || opts->deps_path || opts->is_incremental) {
+            PadErrStack_Add(errstack, "can't use output options with jobs or watch");
+            return false;
+        }
+        if (opts->is_jobs && opts->is_watch) {
+            PadErrStack_Add(errstack, "can't use jobs with watch");
+            return false;
+        }
+        if (opts->jobs.njobs <= 0) {
+            PadErrStack_Add(errstack, "invalid number of jobs");
+            return false;
+        }
+    } else if (opts->jobs.is_strip_ext) {
+        PadErrStack_Add(errstack, "strip-ext needs jobs or watch");
+        return false;
+    }
+    if (opts->is_cache &&
+        (opts->is_jobs || opts->is_watch || opts->out_path || opts->deps_path)) {
+        PadErrStack_Add(errstack, "cache needs output to stdout");
+        return false;
+    }
+    if (opts->is_incremental && !opts->out_path) {
+        PadErrStack_Add(errstack, "incremental needs output");
+        return false;
+    }
+    if (argc <= opt.optind) {
+        PadErrStack_Add(errstack, "need file");
+        return false;
+    }
+
+    opts->optind = opt.optind;
+    return true;
+}
+
+/**
+ * write path to depfile
+ * spaces are escaped for make and ninja
+ */
+static void
+write_dep_path(FILE *fout, const char *path) {
+    for (const char *p = path; *p; ++p) {
+        if (*p == ' ' || *p == '#') {
+            fputc('\\', fout);
+        } else if (*p == '$') {
+            fputc('$', fout);
+        }
+        fputc(*p, fout);
+    }
+}
+
+/**
+ * write depfile of Makefile format
+ *
+ *     target: source module...
+ *
+ * @return success to true, else false
+ */
+static bool
+write_depfile(
+    const char *deps_path,
+    const char *target,
+    const char *src_path,
+    const char **deps,
+    int32_t ndeps
+) {
+    FILE *fout = fopen(deps_path, "w");
+    if (!fout) {
+        return false;
+    }
+
+    write_dep_path(fout, target);
+    fputs(": ", fout);
+    write_dep_path(fout, src_path);
+    for (int32_t i = 0; i < ndeps; ++i) {
+        fputs(" \\\n  ", fout);
+        write_dep_path(fout, deps[i]);
+    }
+    fputs("\n", fout);
+
+    return fclose(fout) == 0;
+}
+
+static bool
+write_depfile_by_ary(
+    const char *deps_path,
+    const char *target,
+    const char *src_path,
+    const PadCStrAry *deps
+) {
+    int32_t ndeps = PadCStrAry_Len(deps);
+    const char **paths = PadMem_Calloc(ndeps + 1, sizeof(char *));
+    if (!paths) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < ndeps; ++i) {
+        paths[i] = PadCStrAry_Getc(deps, i);
+    }
+    bool ok = write_depfile(deps_path, target, src_path, paths, ndeps);
+
+    free(paths);
+    return ok;
+}
+
+static bool
+write_depfile_by_entry(
+    const char *deps_path,
+    const char *target,
+    const char *src_path,
+    const CapBakeEntry *entry
+) {
+    const char **paths = PadMem_Calloc(entry->ndeps + 1, sizeof(char *));
+    if (!paths) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < entry->ndeps; ++i) {
+        paths[i] = entry->deps[i].path;
+    }
+    bool ok = write_depfile(deps_path, target, src_path, paths, entry->ndeps);
+
+    free(paths);
+    return ok;
+}
+
+/**
+ * hash of output without last newline same as written output
+ */
+static uint64_t
+hash_output(const char *out) {
+    size_t len = strlen(out);
+    if (len && out[len - 1] == '\n') {
+        len--;
+    }
+    return CapBake_HashBytes(out, len);
+}
+
+/**
+ * check if output of last make is fresh by stamp
+ * output is fresh if source, arguments, imported modules and output are not changed
+ */
+static const CapBakeEntry *
+find_fresh_entry(
+    const CapBakeManifest *stamp,
+    const MakeOpts *opts,
+    const char *path,
+    const char *src,
+    uint64_t args_hash
+) {
+    const CapBakeEntry *entry = CapBakeManifest_Find(stamp, path);
+    if (!entry || entry->src_hash != CapBake_HashStr(src)) {
+        return NULL;
+    }
+
+    uint64_t out_hash;
+    if (!CapBake_HashFile(&out_hash, opts->out_path) ||
+        !CapBakeEntry_IsFresh(entry, out_hash, args_hash)) {
+        return NULL;
+    }
+
+    return entry;
+}
+
+/**
+ * make one file by options of output
+ *
+ * @return success to 0, else other
+ */
+static int
+make_file_by_opts(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    const MakeOpts *opts,
+    int argc,
+    char *argv[],
+    bool solve_path
+) {
+    char path[PAD_FILE__NPATH];
+    if (solve_path) {
+        if (!Cap_SolveCmdlineArgPath(config, path, sizeof path, argv[0])) {
+            PadErrStack_Add(errstack, "failed to solve cap path");
+            return 1;
+        }
+    } else {
+        PadCStr_Copy(path, sizeof path, argv[0]);
+    }
+
+    char stamp_path[PAD_FILE__NPATH] = {0};
+    if (opts->is_incremental) {
+        snprintf(stamp_path, sizeof stamp_path, "%s%s", opts->out_path, CAP_MAKE__STAMP_EXT);
+    }
+    const char *target = opts->out_path ? opts->out_path : path;
+
+    int result = 1;
+    char cache_path[PAD_FILE__NPATH];
+    CapRenderCacheKey cache_key;
+    bool is_cacheable = false;
+    CapKit *kit = NULL;
+    bool is_compiled = false;  // state of kit of failed compile is unknown
+    CapSink *sink = NULL;
+    CapBakeManifest *stamp = NULL;
+    CapBakeEntry entry = {0};
+
+    char *src = PadFile_ReadCopyFromPath(path);
+    if (!src) {
+        PadErrStack_Add(errstack, "failed to read from \"%s\"", path);
+        goto done;
+    }
+
+    uint64_t args_hash = CapBake_HashArgs(argc, argv);
+    if (opts->is_incremental) {
+        stamp = CapBakeManifest_New();
+        if (!stamp) {
+            PadErrStack_Add(errstack, "failed to create stamp");
+            goto done;
+        }
+        CapBakeManifest_Load(stamp, stamp_path);
+
+        const CapBakeEntry *fresh = find_fresh_entry(stamp, opts, path, src, args_hash);
+        if (fresh) {
+            if (opts->deps_path &&
+                !write_depfile_by_entry(opts->deps_path, target, path, fresh)) {
+                PadErrStack_Add(errstack, "failed to write depfile \"%s\"", opts->deps_path);
+                goto done;
+            }
+            result = 0;  // not changed since last make
+            goto done;
+        }
+    }
+
+    is_cacheable = opts->is_cache && CapRenderCache_IsCacheable(src);
+    if (is_cacheable) {
+        CapRenderCacheKey_Init(&cache_key, config, path, src, argc, argv);
+        if (CapRenderCache_Find(cache_path, sizeof cache_path, config->render_cache_dir_path, &cache_key)) {
+            // hit. the kit is not needed
+            CapOut_Flush(config);
+            bool is_sent = config->out_sink ?
+                CapRenderCache_SendFileToSink(cache_path, config->out_sink, true) :
+                CapRenderCache_SendFile(cache_path, STDOUT_FILENO, true);
+            if (!is_sent) {
+                PadErrStack_Add(errstack, "failed to write to \"stdout\"");
+                goto done;
+            }
+            result = 0;
+            goto done;
+        }
+    }
+
+    kit = CapWarm_NewKit(config);
+    if (!kit) {
+        PadErrStack_Add(errstack, "failed to create kit");
+        goto done;
+    }
+
+    if (!CapKit_CompileFromStrArgs(kit, path, src, argc, argv)) {
+        PadErrStack_ExtendBackOther(errstack, CapKit_GetcErrStack(kit));
+        PadErrStack_Add(errstack, "failed to compile from \"%s\"", argv[0]);
+        goto done;
+    }
+    is_compiled = true;
+
+    // output file is replaced after all of output is written
+    const char *out_name = opts->out_path ? opts->out_path : "stdout";
+    sink = opts->out_path ?
+           CapSink_NewAtomicFile(opts->out_path) :
+           CapOut_NewSink(config);
+    if (!sink) {
+        PadErrStack_Add(errstack, "failed to open \"%s\"", out_name);
+        goto done;
+    }
+    CapSink_PopLastNewline(sink);
+
+    if (!CapKit_WriteStdoutBuf(kit, sink) || !CapSink_Close(sink)) {
+        PadErrStack_Add(errstack, "failed to write to \"%s\"", out_name);
+        goto done;
+    }
+
+    const PadCStrAry *deps = CapKit_GetcDeps(kit);
+
+    if (opts->deps_path &&
+        !write_depfile_by_ary(opts->deps_path, target, path, deps)) {
+        PadErrStack_Add(errstack, "failed to write depfile \"%s\"", opts->deps_path);
+        goto done;
+    }
+
+    if (opts->is_incremental) {
+        entry = (CapBakeEntry) {
+            .path = PadCStr_Dup(path),
+            .src_hash = CapBake_HashStr(src),
+            .args_hash = args_hash,
+            .out_hash = hash_output(CapKit_GetcStdoutBuf(kit)),
+        };
+        // failure of save is not error. next time makes again
+        CapBakeManifest *cur = CapBakeManifest_New();
+        if (cur && entry.path && CapBakeEntry_SetDeps(&entry, deps) &&
+            CapBakeManifest_Add(cur, &entry)) {
+            CapBakeManifest_Save(cur, stamp_path);
+        } else {
+            PadFile_Remove(stamp_path);
+        }
+        CapBakeManifest_Del(cur);
+    }
+
+    if (is_cacheable) {
+        // failure of write is not error. next time makes again
+        CapRenderCache_Write(config->render_cache_dir_path, &cache_key, CapKit_GetcStdoutBuf(kit), deps);
+    }
+
+    result = 0;
+done:
+    CapBakeEntry_Fini(&entry);
+    CapBakeManifest_Del(stamp);
+    CapSink_Del(sink);
+    CapWarm_DelKit(config, kit, is_compiled);
+    free(src);
+    return result;
+}
+
+/**
+ * make by options before file
+ *
+ * @return success to 0, else other
+ */
+static int
+make_from_opts(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    int argc,
+    char *argv[],
+    bool solve_path
+) {
+    MakeOpts opts;
+    if (!parse_make_opts(&opts, errstack, argc, argv, solve_path)) {
+        return 1;
+    }
+
+    if (opts.is_jobs) {
+        return CapMakeJobs_Run(config, errstack, argc - opts.optind, argv + opts.optind, &opts.jobs);
+    }
+    if (opts.is_watch) {
+        CapMakeWatchOpts watch = {
+            .is_strip_ext = opts.jobs.is_strip_ext,
+            .solve_path = solve_path,
+        };
+        return CapMakeWatch_Run(config, errstack, argc - opts.optind, argv + opts.optind, &watch);
+    }
+
+    return make_file_by_opts(config, errstack, &opts, argc - opts.optind, argv + opts.optind, solve_path);
+}
+
 int
 CapMakeCmd_MakeFromArgs(
     const CapConfig *config,
@@ -52,6 +498,10 @@ CapMakeCmd_MakeFromArgs(
     char *argv[],
     bool solve_path
 ) {
+    if (argc >= 2 && is_make_opt(argv[1])) {
+        return make_from_opts(config, errstack, argc, argv, solve_path);
+    }
+
     bool use_stdin = false;
     if (argc < 2) {
         use_stdin = true;
@@ -93,31 +543,28 @@ CapMakeCmd_MakeFromArgs(
         }
     }
 
-    char *compiled = Cap_MakeArgv(
+    CapSink *sink = CapSink_PopLastNewline(CapOut_NewSink(config));
+    bool ok = Cap_MakeArgvToSink(
         config,
         errstack,
         make_path,
         src,
         argc - 1,
-        argv + 1
-    );
-    if (!compiled) {
+        argv + 1,
+        sink
+    ) && CapSink_Close(sink);
+    CapSink_Del(sink);
+    Pad_SafeFree(src);
+
+    if (!ok) {
         PadErrStack_Add(
             errstack,
             "failed to compile from \"%s\"",
             (argv[1] ? argv[1] : "stdin")
         );
-        fflush(stderr);
-        Pad_SafeFree(src);
         return 1;
     }
 
-    PadCStr_PopLastNewline(compiled);
-    printf("%s", compiled);
-    fflush(stdout);
-
-    Pad_SafeFree(compiled);
-    Pad_SafeFree(src);
     return 0;
 }
 
@@ -131,7 +578,7 @@ CapMakeCmd_Run(CapMakeCmd *self) {
         true
     );
     if (result != 0) {
-        PadErrStack_TraceSimple(self->errstack, stderr);
+        CapOut_TraceErrStack(self->config, self->errstack);
     }
 
     return result;
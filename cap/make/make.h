@@ -1,5 +1,7 @@
 #pragma once
 
+#include <getopt.h>
+
 #include <pad/lib/error.h>
 #include <pad/lib/string.h>
 #include <pad/lib/file.h>
@@ -14,6 +16,18 @@
 #include <cap/core/config.h>
 #include <cap/core/util.h>
 #include <cap/core/symlink.h>
+#include <cap/core/bake_manifest.h>
+#include <cap/core/render_cache.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
+#include <cap/core/warm.h>
+#include <cap/make/jobs.h>
+#include <cap/make/watch.h>
+
+/**
+ * extension of stamp file of --incremental. the stamp is put next to output
+ */
+#define CAP_MAKE__STAMP_EXT ".capmake"
 
 struct CapMakeCmd;
 typedef struct CapMakeCmd CapMakeCmd;
@@ -51,6 +65,16 @@ CapMakeCmd_Run(CapMakeCmd *self);
 
 /**
  * make script or stdin from program arguments
+ * if first argument is -j (--jobs) then make files at same time
+ * --watch makes files again when files or imported modules are changed
+ * -o writes output to file, --deps writes depfile of imported modules and
+ * --incremental skips make if source, modules and arguments are not changed
+ * --cache reads output from cache of render (~/.cap/cache) if same source was made
+ *
+ *     make [-j N | --jobs N] [-x | --strip-ext] file...
+ *     make --watch [-x | --strip-ext] file|dir...
+ *     make [-o out [--incremental]] [--deps depfile] file [args]
+ *     make --cache file [args]
  * 
  * @param[in] *config    pointer to CapConfig (read-only)
  * @param[out] *errstack pointer to PadErrStack (writeable)
@@ -0,0 +1,557 @@
+#include <cap/make/watch.h>
+
+#ifndef __linux__
+
+int
+CapMakeWatch_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    int nfiles,
+    char *files[],
+    const CapMakeWatchOpts *opts
+) {
+    PadErrStack_Add(errstack, "watch is not supported on this platform");
+    return 1;
+}
+
+#else
+
+/**
+ * numbers
+ */
+enum {
+    EVENT_BUF_SIZE = 1024 * 16,
+    SETTLE_MSEC = 30,  // events in this time after first event are one round
+    WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE,
+};
+
+/**
+ * file of make
+ */
+typedef struct {
+    char *path;  // absolute path of template
+    char *dest;  // path of destination or NULL for output
+    CapKit *kit;  // warm kit. NULL until first render or after failure
+    PadCStrAry *deps;  // imported modules of last successful render
+    bool is_dirty;
+} Target;
+
+/**
+ * watched directory
+ */
+typedef struct {
+    int wd;
+    char *path;
+} Watch;
+
+typedef struct {
+    const CapConfig *config;
+    const CapMakeWatchOpts *opts;
+    int fd;  // inotify
+    Target *targets;
+    int32_t ntargets;
+    int32_t targets_capa;
+    Watch *watches;
+    int32_t nwatches;
+    int32_t watches_capa;
+} Watcher;
+
+static void
+watcher_fini(Watcher *w) {
+    for (int32_t i = 0; i < w->ntargets; ++i) {
+        Target *t = &w->targets[i];
+        free(t->path);
+        free(t->dest);
+        CapKit_Del(t->kit);
+        PadCStrAry_Del(t->deps);
+    }
+    free(w->targets);
+
+    for (int32_t i = 0; i < w->nwatches; ++i) {
+        free(w->watches[i].path);
+    }
+    free(w->watches);
+
+    if (w->fd >= 0) {
+        close(w->fd);
+    }
+}
+
+static bool
+has_ext(const char *path, const char *ext) {
+    size_t len = strlen(path);
+    size_t extlen = strlen(ext);
+    return len > extlen && !strcmp(path + len - extlen, ext);
+}
+
+static bool
+push_target(Watcher *w, PadErrStack *errstack, const char *path) {
+    for (int32_t i = 0; i < w->ntargets; ++i) {
+        if (!strcmp(w->targets[i].path, path)) {
+            return true;  // already added
+        }
+    }
+
+    if (w->ntargets >= w->targets_capa) {
+        int32_t capa = w->targets_capa ? w->targets_capa * 2 : 16;
+        Target *targets = PadMem_Realloc(w->targets, sizeof(*targets) * capa);
+        if (!targets) {
+            PadErrStack_Add(errstack, "failed to allocate memory");
+            return false;
+        }
+        w->targets = targets;
+        w->targets_capa = capa;
+    }
+
+    Target *t = &w->targets[w->ntargets];
+    *t = (Target) {
+        .path = PadCStr_Dup(path),
+        .deps = PadCStrAry_New(),
+        .is_dirty = true,
+    };
+    if (!t->path || !t->deps) {
+        free(t->path);
+        PadCStrAry_Del(t->deps);
+        PadErrStack_Add(errstack, "failed to allocate memory");
+        return false;
+    }
+    w->ntargets++;
+
+    if (w->opts->is_strip_ext) {
+        t->dest = CapMakeJobs_MakeDest(path);
+        if (!t->dest) {
+            PadErrStack_Add(errstack, "\"%s\" has not extension for destination", path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * watch directory once
+ */
+static bool
+watch_dir(Watcher *w, const char *dirpath) {
+    for (int32_t i = 0; i < w->nwatches; ++i) {
+        if (!strcmp(w->watches[i].path, dirpath)) {
+            return true;
+        }
+    }
+
+    if (w->nwatches >= w->watches_capa) {
+        int32_t capa = w->watches_capa ? w->watches_capa * 2 : 16;
+        Watch *watches = PadMem_Realloc(w->watches, sizeof(*watches) * capa);
+        if (!watches) {
+            return false;
+        }
+        w->watches = watches;
+        w->watches_capa = capa;
+    }
+
+    char *path = PadCStr_Dup(dirpath);
+    if (!path) {
+        return false;
+    }
+
+    int wd = inotify_add_watch(w->fd, dirpath, WATCH_MASK);
+    if (wd < 0) {
+        free(path);
+        return false;
+    }
+
+    w->watches[w->nwatches++] = (Watch) {
+        .wd = wd,
+        .path = path,
+    };
+    return true;
+}
+
+/**
+ * watch directory of file. editors replace file by rename then watch
+ * directory instead of file
+ */
+static bool
+watch_file(Watcher *w, const char *path) {
+    char dirpath[PAD_FILE__NPATH];
+    PadCStr_Copy(dirpath, sizeof dirpath, path);
+
+    char *sep = strrchr(dirpath, PAD_FILE__SEP);
+    if (!sep) {
+        return false;
+    }
+    if (sep == dirpath) {
+        sep[1] = '\0';  // root
+    } else {
+        *sep = '\0';
+    }
+
+    return watch_dir(w, dirpath);
+}
+
+static const Watch *
+find_watch(const Watcher *w, int wd) {
+    for (int32_t i = 0; i < w->nwatches; ++i) {
+        if (w->watches[i].wd == wd) {
+            return &w->watches[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * collect templates under directory
+ * hidden files and Cap's symbolic links are ignored
+ */
+static bool
+collect_dir(Watcher *w, PadErrStack *errstack, const char *dirpath) {
+    PadDir *dir = PadDir_Open(dirpath);
+    if (!dir) {
+        PadErrStack_Add(errstack, "failed to open directory \"%s\"", dirpath);
+        return false;
+    }
+
+    bool ok = true;
+    for (PadDirNode *node; ok && (node = PadDir_Read(dir)); PadDirNode_Del(node)) {
+        const char *name = PadDirNode_Name(node);
+        if (name[0] == '.') {
+            continue;
+        }
+
+        char path[PAD_FILE__NPATH];
+        if (snprintf(path, sizeof path, "%s%c%s", dirpath, PAD_FILE__SEP, name) >= (int) sizeof path) {
+            PadErrStack_Add(errstack, "too long path under \"%s\"", dirpath);
+            ok = false;
+            continue;
+        }
+
+        // symlinks of file system are not followed. the target can be out of tree or cycle
+        struct stat st;
+        if (lstat(path, &st) != 0 || S_ISLNK(st.st_mode)) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            ok = collect_dir(w, errstack, path);
+        } else if (S_ISREG(st.st_mode) &&
+                   has_ext(path, CAP_MAKE_WATCH__EXT) &&
+                   !CapSymlink_IsLinkFile(w->config, path)) {
+            ok = push_target(w, errstack, path);
+        }
+    }
+
+    PadDir_Close(dir);
+    return ok;
+}
+
+static bool
+collect_targets(Watcher *w, PadErrStack *errstack, int nfiles, char *files[]) {
+    for (int i = 0; i < nfiles; ++i) {
+        char path[PAD_FILE__NPATH];
+
+        if (w->opts->solve_path) {
+            if (!Cap_SolveCmdlineArgPath(w->config, path, sizeof path, files[i])) {
+                PadErrStack_Add(errstack, "failed to solve cap path of \"%s\"", files[i]);
+                return false;
+            }
+        } else if (!PadFile_Solve(path, sizeof path, files[i])) {
+            PadErrStack_Add(errstack, "failed to solve path of \"%s\"", files[i]);
+            return false;
+        }
+
+        if (!PadFile_IsExists(path)) {
+            PadErrStack_Add(errstack, "\"%s\" is not found", files[i]);
+            return false;
+        }
+
+        bool ok = PadFile_IsDir(path) ?
+                  collect_dir(w, errstack, path) :
+                  push_target(w, errstack, path);
+        if (!ok) {
+            return false;
+        }
+    }
+
+    if (!w->ntargets) {
+        PadErrStack_Add(errstack, "not found files for watch");
+        return false;
+    }
+
+    return true;
+}
+
+static double
+elapsed_msec(const struct timespec *begin) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - begin->tv_sec) * 1000.0 +
+           (end.tv_nsec - begin->tv_nsec) / 1000000.0;
+}
+
+/**
+ * write output to destination. destination is replaced after all of output is written
+ * so that readers of destination do not see half of output
+ */
+static bool
+write_dest(const char *dest, const char *s) {
+    CapSink *sink = CapSink_NewAtomicFile(dest);
+    if (!sink) {
+        return false;
+    }
+
+    bool ok = CapSink_Write(sink, s, strlen(s)) && CapSink_Close(sink);
+    CapSink_Del(sink);
+    return ok;
+}
+
+static bool
+copy_deps(PadCStrAry *dst, const PadCStrAry *src) {
+    PadCStrAry_Clear(dst);
+    for (int32_t i = 0; i < PadCStrAry_Len(src); ++i) {
+        if (!PadCStrAry_PushBack(dst, PadCStrAry_Getc(src, i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * render template by warm kit
+ * failed kit is deleted because state of kit is unknown
+ */
+static bool
+render(Watcher *w, Target *t) {
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    t->is_dirty = false;
+
+    char *src = PadFile_ReadCopyFromPath(t->path);
+    if (!src) {
+        CapOut_ErrPrintf(w->config, "failed to read from \"%s\"\n", t->path);
+        return false;
+    }
+
+    if (t->kit && !CapKit_Reset(t->kit)) {
+        CapKit_Del(t->kit);
+        t->kit = NULL;
+    }
+    if (!t->kit) {
+        t->kit = CapKit_New(w->config);
+        if (!t->kit) {
+            CapOut_ErrPrintf(w->config, "failed to create kit\n");
+            free(src);
+            return false;
+        }
+    }
+
+    char *argv[] = {t->path, NULL};
+    if (!CapKit_CompileFromStrArgs(t->kit, t->path, src, 1, argv)) {
+        CapOut_TraceErrStack(w->config, CapKit_GetcErrStack(t->kit));
+        CapOut_ErrPrintf(w->config, "failed to compile from \"%s\"\n", t->path);
+        CapKit_Del(t->kit);
+        t->kit = NULL;
+        free(src);
+        return false;
+    }
+    free(src);
+
+    char *out = PadCStr_Dup(CapKit_GetcStdoutBuf(t->kit));
+    if (!out) {
+        CapOut_ErrPrintf(w->config, "failed to allocate memory\n");
+        return false;
+    }
+    PadCStr_PopLastNewline(out);
+
+    bool ok = true;
+    if (t->dest) {
+        ok = write_dest(t->dest, out);
+        if (!ok) {
+            CapOut_ErrPrintf(w->config, "failed to write to \"%s\"\n", t->dest);
+        }
+    } else {
+        CapOut_Printf(w->config, "%s", out);
+        CapOut_Flush(w->config);
+    }
+    free(out);
+
+    // modules of this render are watched for next change
+    const PadCStrAry *deps = CapKit_GetcDeps(t->kit);
+    copy_deps(t->deps, deps);
+    for (int32_t i = 0; i < PadCStrAry_Len(deps); ++i) {
+        watch_file(w, PadCStrAry_Getc(deps, i));
+    }
+
+    CapOut_ErrPrintf(w->config, "made \"%s\" in %.2f ms\n", t->path, elapsed_msec(&begin));
+    return ok;
+}
+
+static bool
+is_affected(const Target *t, const char *path) {
+    if (!strcmp(t->path, path)) {
+        return true;
+    }
+    for (int32_t i = 0; i < PadCStrAry_Len(t->deps); ++i) {
+        if (!strcmp(PadCStrAry_Getc(t->deps, i), path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+mark_all_dirty(Watcher *w) {
+    for (int32_t i = 0; i < w->ntargets; ++i) {
+        w->targets[i].is_dirty = true;
+    }
+}
+
+static void
+mark_dirty(Watcher *w, const char *path) {
+    for (int32_t i = 0; i < w->ntargets; ++i) {
+        if (is_affected(&w->targets[i], path)) {
+            w->targets[i].is_dirty = true;
+        }
+    }
+}
+
+/**
+ * read events of inotify and mark affected targets
+ * if queue of events was overflowed then events were lost and all targets are marked
+ *
+ * @return success to true, else false
+ */
+static bool
+read_events(Watcher *w) {
+    _Alignas(struct inotify_event) char buf[EVENT_BUF_SIZE];
+
+    ssize_t len = read(w->fd, buf, sizeof buf);
+    if (len < 0) {
+        return errno == EINTR || errno == EAGAIN;
+    }
+
+    for (char *p = buf; p < buf + len; ) {
+        const struct inotify_event *ev = (const struct inotify_event *) p;
+        p += sizeof(*ev) + ev->len;
+
+        if (ev->mask & IN_Q_OVERFLOW) {
+            mark_all_dirty(w);  // wd is -1
+            continue;
+        }
+
+        const Watch *watch = find_watch(w, ev->wd);
+        if (!watch || !ev->len) {
+            continue;
+        }
+
+        char path[PAD_FILE__NPATH];
+        const char *fmt = watch->path[strlen(watch->path) - 1] == PAD_FILE__SEP ? "%s%s" : "%s/%s";
+        snprintf(path, sizeof path, fmt, watch->path, ev->name);
+        mark_dirty(w, path);
+    }
+
+    return true;
+}
+
+/**
+ * wait one round of changes. events in short time are collected together
+ * because editors write file by some operations
+ *
+ * @return success to true, else false
+ */
+static bool
+wait_changes(Watcher *w) {
+    struct pollfd pfd = {
+        .fd = w->fd,
+        .events = POLLIN,
+    };
+
+    for (;;) {
+        int n = poll(&pfd, 1, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (!read_events(w)) {
+            return false;
+        }
+
+        while (poll(&pfd, 1, SETTLE_MSEC) > 0) {
+            if (!read_events(w)) {
+                return false;
+            }
+        }
+
+        for (int32_t i = 0; i < w->ntargets; ++i) {
+            if (w->targets[i].is_dirty) {
+                return true;
+            }
+        }
+    }
+}
+
+static void
+render_dirty(Watcher *w) {
+    for (int32_t i = 0; i < w->ntargets; ++i) {
+        Target *t = &w->targets[i];
+        if (t->is_dirty) {
+            render(w, t);
+        }
+    }
+}
+
+int
+CapMakeWatch_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    int nfiles,
+    char *files[],
+    const CapMakeWatchOpts *opts
+) {
+    if (!config || !errstack || !files || !opts) {
+        return 1;
+    }
+
+    Watcher w = {
+        .config = config,
+        .opts = opts,
+        .fd = inotify_init1(IN_CLOEXEC),
+    };
+    if (w.fd < 0) {
+        PadErrStack_Add(errstack, "failed to initialize inotify");
+        return 1;
+    }
+
+    int result = 1;
+    if (!collect_targets(&w, errstack, nfiles, files)) {
+        goto done;
+    }
+
+    for (int32_t i = 0; i < w.ntargets; ++i) {
+        if (!watch_file(&w, w.targets[i].path)) {
+            PadErrStack_Add(errstack, "failed to watch \"%s\"", w.targets[i].path);
+            goto done;
+        }
+    }
+
+    // failed renders are retried when files are changed
+    render_dirty(&w);
+
+    for (int32_t round = 0; !opts->nrounds || round < opts->nrounds; ++round) {
+        if (!wait_changes(&w)) {
+            PadErrStack_Add(errstack, "failed to read events of inotify");
+            goto done;
+        }
+        // links may be changed while waiting. resolve them again in this round
+        CapSymlink_ClearCache();
+        render_dirty(&w);
+    }
+
+    result = 0;
+done:
+    watcher_fini(&w);
+    return result;
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#define _DEFAULT_SOURCE 1 /* cap: make/watch: clock_gettime, lstat */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <pad/lib/memory.h>
+#include <pad/lib/file.h>
+#include <pad/lib/cstring.h>
+#include <pad/lib/cstring_array.h>
+#include <pad/core/error_stack.h>
+
+#include <cap/core/constant.h>
+#include <cap/core/config.h>
+#include <cap/core/util.h>
+#include <cap/core/symlink.h>
+#include <cap/core/sink.h>
+#include <cap/core/output.h>
+#include <cap/lang/kit.h>
+#include <cap/make/jobs.h>
+
+#ifdef __linux__
+# include <poll.h>
+# include <sys/inotify.h>
+#endif
+
+/**
+ * extension of templates in directory of watch
+ */
+#define CAP_MAKE_WATCH__EXT ".cap"
+
+/**
+ * options of watch
+ */
+typedef struct {
+    bool is_strip_ext;  // write result to path of file without last extension. else write to stdout
+    bool solve_path;  // if true then files are cap's paths
+    int32_t nrounds;  // number of rounds of re-render before return. 0 is forever
+} CapMakeWatchOpts;
+
+/**
+ * make files and make again when files or imported modules are changed
+ * directories are searched for templates (*.cap) recursively
+ * each file keeps own kit between renders and latency of render is reported to stderr
+ * watch uses inotify then it is supported on Linux only
+ *
+ * @param[in]  *config   pointer to CapConfig (read-only)
+ * @param[out] *errstack pointer to PadErrStack
+ * @param[in]  nfiles    number of files or directories
+ * @param[in]  *files[]  paths of files or directories
+ * @param[in]  *opts     pointer to CapMakeWatchOpts
+ *
+ * @return success to 0, else other
+ */
+int
+CapMakeWatch_Run(
+    const CapConfig *config,
+    PadErrStack *errstack,
+    int nfiles,
+    char *files[],
+    const CapMakeWatchOpts *opts
+);
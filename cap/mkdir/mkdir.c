@@ -1,8 +1,5 @@
 #include <cap/mkdir/mkdir.h>
 
-extern int opterr;
-extern int optind;
-
 struct Opts {
     bool is_help;
     bool is_parents;
@@ -16,7 +13,7 @@ struct CapMkdirCmd {
     int optind;
 };
 
-void
+static bool
 parse_opts(CapMkdirCmd *self) {
     // parse options
     static struct option longopts[] = {
@@ -25,13 +22,12 @@ parse_opts(CapMkdirCmd *self) {
         {0},
     };
 
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
     self->opts = (struct Opts){0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hp", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hp", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -42,16 +38,19 @@ parse_opts(CapMkdirCmd *self) {
         case 'p': self->opts.is_parents = true; break;
         case '?':
         default:
-            PadErr_Die("unsupported option");
+            CapOut_Err(self->config, "unsupported option");
+            return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("Failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "Failed to parse option");
+        return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
+    return true;
 }
 
 void
@@ -73,16 +72,17 @@ CapMkdirCmd_New(const CapConfig *config, int argc, char **argv) {
     self->argc = argc;
     self->argv = argv;
 
-    parse_opts(self);
+    if (!parse_opts(self)) {
+        CapMkdirCmd_Del(self);
+        return NULL;
+    }
 
     return self;
 }
 
 static int 
 usage(CapMkdirCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap mkdir [path] [options...]\n"
         "\n"
@@ -92,7 +92,6 @@ usage(CapMkdirCmd *self) {
         "    -p, --parents    not error if existing, make parent directories as needed\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -103,7 +102,7 @@ _mkdirp(CapMkdirCmd *self) {
 
     if (argpath[0] == ':') {
         if (!PadFile_Solve(path, sizeof path, argpath+1)) {
-            PadErr_Err("failed to solve path");
+            CapOut_Err(self->config, "failed to solve path");
             return 1;
         }
     } else {
@@ -113,13 +112,13 @@ _mkdirp(CapMkdirCmd *self) {
         snprintf(tmppath, sizeof tmppath, "%s/%s", org, argpath);
 
         if (!CapSymlink_FollowPath(self->config, path, sizeof path, tmppath)) {
-            PadErr_Err("failed to follow path");
+            CapOut_Err(self->config, "failed to follow path");
             return 1;
         }
     }
 
     if (PadFile_MkdirsQ(path) != 0) {
-        PadErr_Err("failed to create directory \"%s\"", path);
+        CapOut_Err(self->config, "failed to create directory \"%s\"", path);
         return 1;
     }
 
@@ -133,7 +132,7 @@ _mkdir(CapMkdirCmd *self) {
 
     if (argpath[0] == ':') {
         if (!PadFile_Solve(path, sizeof path, argpath+1)) {
-            PadErr_Err("failed to solve path");
+            CapOut_Err(self->config, "failed to solve path");
             return 1;
         }
     } else {
@@ -143,18 +142,18 @@ _mkdir(CapMkdirCmd *self) {
         snprintf(tmppath, sizeof tmppath, "%s/%s", org, argpath);
 
         if (!CapSymlink_FollowPath(self->config, path, sizeof path, tmppath)) {
-            PadErr_Err("failed to follow path");
+            CapOut_Err(self->config, "failed to follow path");
             return 1;
         }
     }
 
     if (PadFile_IsExists(path)) {
-        PadErr_Err("failed to create directory. \"%s\" is exists", path);
+        CapOut_Err(self->config, "failed to create directory. \"%s\" is exists", path);
         return 1;
     }
 
     if (PadFile_MkdirQ(path) != 0) {
-        PadErr_Err("failed to create directory \"%s\"", path);
+        CapOut_Err(self->config, "failed to create directory \"%s\"", path);
         return 1;
     }
 
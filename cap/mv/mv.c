@@ -12,7 +12,7 @@ struct CapMvCmd {
     struct Opts opts;
 };
 
-static void
+static bool
 parse_opts(CapMvCmd *self) {
     // parse options
     static struct option longopts[] = {
@@ -20,14 +20,11 @@ parse_opts(CapMvCmd *self) {
         {0},
     };
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "h", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "h", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -36,15 +33,17 @@ parse_opts(CapMvCmd *self) {
         case 0: /* long option only */ break;
         case 'h': self->opts.is_help = true; break;
         case '?':
-        default: PadErr_Die("Unknown option"); break;
+        default: CapOut_Err(self->config, "Unknown option"); return false; break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("Failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "Failed to parse option");
+        return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
+    return true;
 }
 
 void
@@ -66,16 +65,17 @@ CapMvCmd_New(CapConfig *config, int argc, char **argv) {
     self->argc = argc;
     self->argv = argv;
 
-    parse_opts(self);
+    if (!parse_opts(self)) {
+        CapMvCmd_Del(self);
+        return NULL;
+    }
 
     return self;
 }
 
 static int
 usage(CapMvCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap mv [old file] [new file] [options...]\n"
         "    cap mv [file] [dst dir] [options...]\n"
@@ -86,7 +86,6 @@ usage(CapMvCmd *self) {
         "    -h, --help    show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -97,29 +96,29 @@ mv_file_to_dir(CapMvCmd *self, const char *cap_path, const char *dirname) {
     char tmppath[PAD_FILE__NPATH*3];
 
     if (!Cap_SolveCmdlineArgPath(self->config, srcpath, sizeof srcpath, cap_path)) {
-        PadErr_Err("failed to solve path for source file name");
+        CapOut_Err(self->config, "failed to solve path for source file name");
         return false;
     }
 
     if (!PadFile_IsExists(srcpath)) {
-        PadErr_Err("\"%s\" is not exists", cap_path);
+        CapOut_Err(self->config, "\"%s\" is not exists", cap_path);
         return false;
     }
 
     char basename[PAD_FILE__NPATH];
     if (!PadFile_BaseName(basename, sizeof basename, cap_path)) {
-        PadErr_Err("failed to get basename from file name");
+        CapOut_Err(self->config, "failed to get basename from file name");
         return false;
     }
 
     snprintf(tmppath, sizeof tmppath, "%s/%s", dirname, basename);
     if (!Cap_SolveCmdlineArgPath(self->config, dstpath, sizeof dstpath, tmppath)) {
-        PadErr_Err("failed to solve path for destination file name");
+        CapOut_Err(self->config, "failed to solve path for destination file name");
         return false;
     }
 
     if (PadFile_Rename(srcpath, dstpath) != 0) {
-        PadErr_Err("failed to rename file \"%s\" to \"%s\" directory", srcpath, dstpath);
+        CapOut_Err(self->config, "failed to rename file \"%s\" to \"%s\" directory", srcpath, dstpath);
         return false;
     }
 
@@ -133,7 +132,7 @@ mv_files_to_dir(CapMvCmd *self) {
     for (int i = self->optind; i < self->argc-1; ++i) {
         const char *fname = self->argv[i];
         if (!mv_file_to_dir(self, fname, lastfname)) {
-            PadErr_Err("failed to move file %s to %s", fname, lastfname);
+            CapOut_Err(self->config, "failed to move file %s to %s", fname, lastfname);
             return 1;
         }
     }
@@ -149,19 +148,19 @@ mv_file_to_other(CapMvCmd *self) {
     char srcpath[PAD_FILE__NPATH];
 
     if (!Cap_SolveCmdlineArgPath(self->config, srcpath, sizeof srcpath, src_cap_path)) {
-        PadErr_Err("failed to follow path for source file name");
+        CapOut_Err(self->config, "failed to follow path for source file name");
         return 1;
     }
 
     if (!PadFile_IsExists(srcpath)) {
-        PadErr_Err("\"%s\" is not exists. can not move to other", src_cap_path);
+        CapOut_Err(self->config, "\"%s\" is not exists. can not move to other", src_cap_path);
         return 1;
     }
 
     char dstpath[PAD_FILE__NPATH * 2];
 
     if (!Cap_SolveCmdlineArgPath(self->config, dstpath, sizeof dstpath, dst_cap_path)) {
-        PadErr_Err("failed to solve path for destination file name");
+        CapOut_Err(self->config, "failed to solve path for destination file name");
         return 1;
     }
 
@@ -179,7 +178,7 @@ mv_file_to_other(CapMvCmd *self) {
             src_cap_path += 1;
         }
         if (!PadFile_BaseName(basename, sizeof basename, src_cap_path)) {
-            PadErr_Err("failed to get basename in file to other");
+            CapOut_Err(self->config, "failed to get basename in file to other");
             return 1;
         }
 
@@ -187,17 +186,17 @@ mv_file_to_other(CapMvCmd *self) {
         char tmppath[PAD_FILE__NPATH * 3];
         snprintf(tmppath, sizeof tmppath, "%s/%s", dstpath, basename);
         if (!PadFile_Solve(dstpath2, sizeof dstpath2, tmppath)) {
-            PadErr_Err("failed to follow path for second destination path in file to other");
+            CapOut_Err(self->config, "failed to follow path for second destination path in file to other");
             return 1;
         }
 
         if (PadFile_Rename(srcpath, dstpath2) != 0) {
-            PadErr_Err("failed to rename \"%s\" to \"%s\"", srcpath, dstpath2);
+            CapOut_Err(self->config, "failed to rename \"%s\" to \"%s\"", srcpath, dstpath2);
             return 1;
         }
     } else {
         if (PadFile_Rename(srcpath, dstpath) != 0) {
-            PadErr_Err("failed to rename \"%s\" to \"%s\" (2)", srcpath, dstpath);
+            CapOut_Err(self->config, "failed to rename \"%s\" to \"%s\" (2)", srcpath, dstpath);
             return 1;
         }
     }
@@ -213,7 +212,7 @@ _mv(CapMvCmd *self) {
     } else if (nargs == 2) {
         return mv_file_to_other(self);
     } else {
-        PadErr_Err("not found destination");
+        CapOut_Err(self->config, "not found destination");
         return 1;
     }
 }
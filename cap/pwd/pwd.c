@@ -30,14 +30,11 @@ parse_opts(CapPwdCmd *self) {
     const char *shortopts = "hn";
 
     self->opts = (struct Opts){0};
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, shortopts, longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, shortopts, longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -47,12 +44,12 @@ parse_opts(CapPwdCmd *self) {
         case 'h': self->opts.ishelp = true; break;
         case 'n': self->opts.isnorm = true; break;
         case '?':
-        default: PadErr_Err("Unknown option"); break;
+        default: CapOut_Err(self->config, "Unknown option"); break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Err("Failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "Failed to parse option");
         return false;
     }
 
@@ -99,7 +96,7 @@ replace_slashes(const char *s) {
 int
 CapPwdCmd_Run(CapPwdCmd *self) {
     if (!parse_opts(self)) {
-        PadErr_Err("failed to parse option");
+        CapOut_Err(self->config, "failed to parse option");
         return 1;
     }
 
@@ -107,24 +104,24 @@ CapPwdCmd_Run(CapPwdCmd *self) {
     const char *home = self->config->home_path;
 
     if (self->opts.isnorm) {
-    	printf("%s\n", cd);
+    	CapOut_Printf(self->config, "%s\n", cd);
     } else {
         int32_t homelen = strlen(home);
         int32_t cdlen = strlen(cd);
         if (cdlen - homelen < 0) {
-            PadErr_Err("invalid cd \"%s\" or home \"%s\"", cd, home);
+            CapOut_Err(self->config, "invalid cd \"%s\" or home \"%s\"", cd, home);
             return 4;
         }
         if (cdlen - homelen == 0) {
-            printf("/\n");
+            CapOut_Printf(self->config, "/\n");
         } else {
             const char *p = cd + homelen;
             char *s = replace_slashes(p);
-            printf("%s\n", s);
+            CapOut_Printf(self->config, "%s\n", s);
             Pad_SafeFree(s);
         }
     }
 
-    fflush(stdout);
+    CapOut_Flush(self->config);
 	return 0;
 }
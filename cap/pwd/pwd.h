@@ -20,6 +20,8 @@
 
 #include <cap/core/util.h>
 #include <cap/core/config.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 struct CapPwdCmd;
 typedef struct CapPwdCmd CapPwdCmd;
@@ -26,9 +26,7 @@ struct CapReplaceCmd {
  */
 static int
 usage(CapReplaceCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Replace text of file\n"
+    CapOut_ErrPrintf(self->config, "Replace text of file\n"
         "\n"
         "Usage:\n"
         "\n"
@@ -39,7 +37,6 @@ usage(CapReplaceCmd *self) {
         "    -h, --help    Show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -61,14 +58,11 @@ parse_opts(CapReplaceCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "h", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "h", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -78,18 +72,18 @@ parse_opts(CapReplaceCmd *self) {
         case 'h': self->opts.is_help = true; break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -156,9 +150,9 @@ replace(CapReplaceCmd *self) {
         return usage(self);
     }
 
-    const char *cap_fname = self->argv[optind];
-    const char *target_ = self->argv[optind + 1];
-    const char *replaced = self->argv[optind + 2];
+    const char *cap_fname = self->argv[self->optind];
+    const char *target_ = self->argv[self->optind + 1];
+    const char *replaced = self->argv[self->optind + 2];
     assert(cap_fname && target_ && replaced);
 
     PadStr *target = PadStr_New();
@@ -203,7 +197,7 @@ int
 CapReplaceCmd_Run(CapReplaceCmd *self) {
     int result = replace(self);
     if (result != 0) {
-        PadErrStack_TraceSimple(self->errstack, stderr);
+        CapOut_TraceErrStack(self->config, self->errstack);
     }
     return result;
 }
@@ -1,8 +1,5 @@
 #include <cap/rm/rm.h>
 
-extern int opterr;
-extern int optind;
-
 struct Opts {
     bool is_help;
     bool is_recursive;
@@ -27,12 +24,11 @@ parse_opts(CapRmCmd *self) {
         {0},
     };
 
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "hr", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "hr", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -49,13 +45,13 @@ parse_opts(CapRmCmd *self) {
         }
     }
 
-    if (self->argc < optind) {
+    if (self->argc < opt.optind) {
         PadCStr_AppFmt(self->what, sizeof self->what, "failed to parse option.");
         self->errno_ = CAP_RMCMD_ERR__PARSE_OPTS;
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -90,9 +86,7 @@ error:
 
 static int
 usage(CapRmCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Remove files or directories from environment.\n"
+    CapOut_ErrPrintf(self->config, "Remove files or directories from environment.\n"
         "\n"
         "Usage:\n"
         "\n"
@@ -104,7 +98,6 @@ usage(CapRmCmd *self) {
         "   -r, --recursive    remove directories and their contents recursively\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -12,6 +12,8 @@
 #include <cap/core/util.h>
 #include <cap/core/config.h>
 #include <cap/core/symlink.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 
 typedef enum {
     CAP_RMCMD_ERR__NOERR = 0,
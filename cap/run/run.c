@@ -81,7 +81,7 @@ read_script_line(CapRunCmd *self, char *dst, size_t dstsz, const char *path) {
 int
 CapRunCmd_Run(CapRunCmd *self) {
     if (self->argc < 2) {
-        PadErr_Err("need script file name");
+        CapOut_Err(self->config, "need script file name");
         return 1;
     }
 
@@ -94,12 +94,12 @@ CapRunCmd_Run(CapRunCmd *self) {
 
     char filepath[PAD_FILE__NPATH];
     if (!CapSymlink_FollowPath(self->config, filepath, sizeof filepath, tmppath)) {
-        PadErr_Err("failed to follow path");
+        CapOut_Err(self->config, "failed to follow path");
         return 1;
     }
 
     if (Cap_IsOutOfHome(self->config->home_path, filepath)) {
-        PadErr_Err("invalid script. \"%s\" is out of home.", filepath);
+        CapOut_Err(self->config, "invalid script. \"%s\" is out of home.", filepath);
         return 1;
     }
 
@@ -10,6 +10,7 @@
 #include <cap/core/util.h>
 #include <cap/core/config.h>
 #include <cap/core/symlink.h>
+#include <cap/core/output.h>
 
 struct CapRunCmd;
 typedef struct CapRunCmd CapRunCmd;
@@ -2,6 +2,7 @@
 
 enum {
     LINE_BUFFER_SIZE = 1024 * 10,
+    NALTABS = 2,  // local and global
 };
 
 /**
@@ -22,6 +23,7 @@ struct CapShCmd {
     struct Opts opts;
     PadCmdline *cmdline;
     PadKit *kit;
+    CapAliasTable *altabs[NALTABS];  // local and global (order of find). alive while session
     int last_exit_code;
     char line_buf[LINE_BUFFER_SIZE];
 };
@@ -44,9 +46,7 @@ exec_cmd(CapShCmd *self, int argc, char **argv);
  */
 static int
 usage(CapShCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap sh [options]...\n"
         "\n"
@@ -55,7 +55,6 @@ usage(CapShCmd *self) {
         "    -h, --help    Show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -77,14 +76,11 @@ parse_opts(CapShCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "h", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "h", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -94,18 +90,18 @@ parse_opts(CapShCmd *self) {
         case 'h': self->opts.is_help = true; break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -118,6 +114,9 @@ CapShCmd_Del(CapShCmd *self) {
     // DO NOT DELETE config and argv
     PadCmdline_Del(self->cmdline);
     PadKit_Del(self->kit);
+    for (int i = 0; i < NALTABS; ++i) {
+        CapAliasTable_Del(self->altabs[i]);
+    }
     Pad_SafeFree(self);
 }
 
@@ -141,6 +140,14 @@ CapShCmd_New(CapConfig *config, int argc, char **argv) {
         goto error;
     }
 
+    const int scopes[NALTABS] = { CAP_SCOPE__LOCAL, CAP_SCOPE__GLOBAL };
+    for (int i = 0; i < NALTABS; ++i) {
+        self->altabs[i] = CapAliasTable_New(config, NULL, scopes[i]);
+        if (self->altabs[i] == NULL) {
+            goto error;
+        }
+    }
+
     if (!parse_opts(self)) {
         goto error;
     }
@@ -181,10 +188,14 @@ shcmd_input(CapShCmd *self) {
     char prompt[PAD_FILE__NPATH];
     create_prompt(self, prompt, sizeof prompt);
 
-    PadTerm_CFPrintf(stderr, PAD_TERM__CYAN, PAD_TERM__DEFAULT, PAD_TERM__BRIGHT, "(cap) ");
-    PadTerm_CFPrintf(stderr, PAD_TERM__GREEN, PAD_TERM__DEFAULT, PAD_TERM__BRIGHT, "%s", prompt);
-    PadTerm_CFPrintf(stderr, PAD_TERM__BLUE, PAD_TERM__DEFAULT, PAD_TERM__BRIGHT, "$ ");
-    fflush(stderr);
+    if (self->config->err_sink) {
+        // colors are written to terminal only
+        CapOut_ErrPrintf(self->config, "(cap) %s$ ", prompt);
+    } else {
+        PadTerm_CFPrintf(stderr, PAD_TERM__CYAN, PAD_TERM__DEFAULT, PAD_TERM__BRIGHT, "(cap) ");
+        PadTerm_CFPrintf(stderr, PAD_TERM__GREEN, PAD_TERM__DEFAULT, PAD_TERM__BRIGHT, "%s", prompt);
+        PadTerm_CFPrintf(stderr, PAD_TERM__BLUE, PAD_TERM__DEFAULT, PAD_TERM__BRIGHT, "$ ");
+    }
 
     self->line_buf[0] = '\0';
     if (PadFile_GetLine(self->line_buf, sizeof self->line_buf, stdin) == EOF) {
@@ -194,25 +205,38 @@ shcmd_input(CapShCmd *self) {
     return 0;
 }
 
+/**
+ * Notice moving of scopes to alias tables
+ *
+ * @param[in] self pointer to CapShCmd
+ */
+static void
+move_alias_tables(CapShCmd *self) {
+    for (int i = 0; i < NALTABS; ++i) {
+        CapAliasTable_Move(self->altabs[i]);
+    }
+}
+
 static int
 exec_alias(CapShCmd *self, bool *found, int argc, char **argv) {
     *found = false;
-    CapAliasMgr *almgr = CapAliasMgr_New(self->config);
 
     // find alias value by name
     // find first from local scope
     // not found to find from global scope
     const char *cmdname = argv[0];
     char alias_val[1024];
-    if (CapAliasMgr_FindAliasValue(almgr, alias_val, sizeof alias_val, cmdname, CAP_SCOPE__LOCAL) == NULL) {
-        CapAliasMgr_ClearError(almgr);
-        if (CapAliasMgr_FindAliasValue(almgr, alias_val, sizeof alias_val, cmdname, CAP_SCOPE__GLOBAL) == NULL) {
-            *found = false;
-            return 1;
+    for (int i = 0; i < NALTABS && !*found; ++i) {
+        const CapAliasInfo *alinfo = CapAliasTable_Refresh(self->altabs[i]);
+        const char *value = CapAliasInfo_GetcValue(alinfo, cmdname);
+        if (value) {
+            snprintf(alias_val, sizeof alias_val, "%s", value);
+            *found = true;
         }
     }
-    CapAliasMgr_Del(almgr);
-    *found = true;
+    if (!*found) {
+        return 1;
+    }
 
     // create cap's command line with alias value
     PadStr *cmdline = PadStr_New();
@@ -288,13 +312,15 @@ exec_cmd(CapShCmd *self, int argc, char **argv) {
     } else if (PadCStr_Eq(cmdname, "clear")) {
         Pad_ClearScreen();
     } else if (argc >= 2 && PadCStr_Eq(cmdname, "echo") && PadCStr_Eq(argv[1], "$?")) {
-        printf("%d\n", self->last_exit_code);
+        CapOut_Printf(self->config, "%d\n", self->last_exit_code);
     } else if (PadCStr_Eq(cmdname, "home")) {
         routine(CapHomeCmd);
         CapConfig_Init(self->config);
+        move_alias_tables(self);
     } else if (PadCStr_Eq(cmdname, "cd")) {
         routine(CapCdCmd);
         CapConfig_Init(self->config);
+        move_alias_tables(self);
     } else if (PadCStr_Eq(cmdname, "pwd")) {
         routine(CapPwdCmd);
     } else if (PadCStr_Eq(cmdname, "ls")) {
@@ -318,7 +344,7 @@ exec_cmd(CapShCmd *self, int argc, char **argv) {
         result = CapRmCmd_Run(cmd);
         switch (CapRmCmd_Errno(cmd)) {
         case CAP_RMCMD_ERR__NOERR: break;
-        default: PadErr_Err(CapRmCmd_What(cmd)); break;
+        default: CapOut_Err(self->config, "%s", CapRmCmd_What(cmd)); break;
         }
         CapRmCmd_Del(cmd);
     } else if (PadCStr_Eq(cmdname, "mv")) {
@@ -345,20 +371,24 @@ exec_cmd(CapShCmd *self, int argc, char **argv) {
 
 int
 shcmd_update(CapShCmd *self) {
+    // the shell is long-lived process
+    // links may be changed by other processes between lines
+    CapSymlink_ClearCache();
+
     if (strstr(self->line_buf, "{@")) {
         PadKit_ClearCtxBuf(self->kit);
         if (!PadKit_CompileFromStr(self->kit, self->line_buf)) {
-            PadKit_TraceErr(self->kit, stderr);
+            CapOut_TraceErrStackFull(self->config, PadKit_GetcErrStack(self->kit));
             return 1;
         }
         const char *result = PadKit_GetcStdoutBuf(self->kit);
-        printf("%s", result);
-        fflush(stdout);
+        CapOut_Printf(self->config, "%s", result);
+        CapOut_Flush(self->config);
         return 0;
     }
 
     if (!PadCmdline_Parse(self->cmdline, self->line_buf)) {
-        PadErr_Err("failed to parse command line");
+        CapOut_Err(self->config, "failed to parse command line");
         return 1;
     }
 
@@ -15,6 +15,10 @@
 #include <cap/core/util.h>
 #include <cap/core/config.h>
 #include <cap/core/alias_manager.h>
+#include <cap/core/alias_table.h>
+#include <cap/core/symlink.h>
+#include <cap/core/getopt.h>
+#include <cap/core/output.h>
 #include <cap/home/home.h>
 #include <cap/cd/cd.h>
 #include <cap/pwd/pwd.h>
@@ -17,9 +17,7 @@ struct CapSnptCmd {
  */
 static int
 usage(CapSnptCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Save or show snippet codes.\n"
+    CapOut_ErrPrintf(self->config, "Save or show snippet codes.\n"
         "\n"
         "Usage:\n"
         "\n"
@@ -32,7 +30,6 @@ usage(CapSnptCmd *self) {
         "    clear   clear all snippet codes\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -60,29 +57,34 @@ CapSnptCmd_New(const CapConfig *config, int argc, char **argv) {
 
 static int
 _show_files(CapSnptCmd *self) {
-    PadDir *dir = PadDir_Open(self->config->codes_dir_path);
-    if (!dir) {
-        PadErr_Err("failed to open directory \"%s\"", self->config->codes_dir_path);
+    // list file names without read of directory
+    // index of warm state of daemon is not read from file while directory is not changed
+    CapSnptIndex *own = NULL;
+    const CapSnptIndex *index = NULL;
+    if (self->config->warm) {
+        index = CapWarm_UpdateSnptIndex(self->config->warm);
+    } else {
+        own = CapSnptIndex_New();
+        index = own ? CapSnptIndex_Update(own, self->config) : NULL;
+    }
+    if (!index) {
+        CapOut_Err(self->config, "failed to open directory \"%s\"", self->config->codes_dir_path);
+        CapSnptIndex_Del(own);
         return 1;
     }
 
-    for (PadDirNode *node; (node = PadDir_Read(dir)); ) {
-        const char *name = PadDirNode_Name(node);
-        if (!strcmp(name, ".") || !strcmp(name, "..")) {
-            continue;
-        }
-        puts(name);
-        PadDirNode_Del(node);
+    for (int32_t i = 0; i < CapSnptIndex_Len(index); ++i) {
+        CapOut_Printf(self->config, "%s\n", CapSnptIndex_GetcNameAt(index, i));
     }
 
-    PadDir_Close(dir);
+    CapSnptIndex_Del(own);
     return 0;
 }
 
 static int
 _add(CapSnptCmd *self) {
     if (self->argc < 3) {
-        PadErr_Err("failed to add snippet. need file name");
+        CapOut_Err(self->config, "failed to add snippet. need file name");
         return 1;
     }
 
@@ -90,18 +92,26 @@ _add(CapSnptCmd *self) {
     char path[PAD_FILE__NPATH];
 
     if (!strlen(self->config->codes_dir_path)) {
-        PadErr_Err("codes directory path is empty");
+        CapOut_Err(self->config, "codes directory path is empty");
         return 1;
     }
 
     if (!PadFile_SolveFmt(path, sizeof path, "%s/%s", self->config->codes_dir_path, name)) {
-        PadErr_Err("failed to solve path for \"%s\"", name);
+        CapOut_Err(self->config, "failed to solve path for \"%s\"", name);
         return 1;
     }
 
+    // index of before add. stale index is made again by read of directory
+    CapSnptIndex *index = CapSnptIndex_New();
+    if (index && !CapSnptIndex_Update(index, self->config)) {
+        CapSnptIndex_Del(index);
+        index = NULL;
+    }
+
     FILE *fout = PadFile_Open(path, "wb");
     if (!fout) {
-        PadErr_Err("failed to open snippet \"%s\"", name);
+        CapOut_Err(self->config, "failed to open snippet \"%s\"", name);
+        CapSnptIndex_Del(index);
         return 1;
     }
 
@@ -111,13 +121,24 @@ _add(CapSnptCmd *self) {
 
     fflush(fout);
     PadFile_Close(fout);
+
+    if (index) {
+        // name can be path in sub directory
+        bool ok = strpbrk(name, "/\\") ?
+            CapSnptIndex_Scan(index, self->config->codes_dir_path) :
+            CapSnptIndex_Add(index, name);
+        if (ok) {
+            CapSnptIndex_Save(index, self->config->var_snippets_path);
+        }
+    }
+    CapSnptIndex_Del(index);
     return 0;
 }
 
 static int
 snptcmd_show(CapSnptCmd *self) {
     if (self->argc < 2) {
-        PadErr_Err("failed to show snippet. need file name");
+        CapOut_Err(self->config, "failed to show snippet. need file name");
         return 1;
     }
 
@@ -125,19 +146,19 @@ snptcmd_show(CapSnptCmd *self) {
     char path[PAD_FILE__NPATH];
 
     if (!PadFile_SolveFmt(path, sizeof path, "%s/%s", self->config->codes_dir_path, name)) {
-        PadErr_Err("failed to solve path for \"%s\"", name);
+        CapOut_Err(self->config, "failed to solve path for \"%s\"", name);
         return 1;
     }
 
     FILE *fin = PadFile_Open(path, "rb");
     if (!fin) {
-        PadErr_Err("failed to open snippet \"%s\"", name);
+        CapOut_Err(self->config, "failed to open snippet \"%s\"", name);
         return 1;
     }
 
     char *content = PadFile_ReadCopy(fin);
     if (!content) {
-        PadErr_Err("failed to read snippet code from \"%s\"", path);
+        CapOut_Err(self->config, "failed to read snippet code from \"%s\"", path);
         return 1;
     }
 
@@ -152,15 +173,14 @@ snptcmd_show(CapSnptCmd *self) {
         content
     );
     if (!compiled) {
-        PadErrStack_Trace(errstack, stderr);
-        fflush(stderr);
+        CapOut_TraceErrStackFull(self->config, errstack);
         Pad_SafeFree(content);
         PadErrStack_Del(errstack);
         return 1;
     }
 
-    printf("%s", compiled);
-    fflush(stdout);
+    CapOut_Printf(self->config, "%s", compiled);
+    CapOut_Flush(self->config);
 
     Pad_SafeFree(compiled);
     Pad_SafeFree(content);
@@ -172,7 +192,7 @@ static int
 _clear(CapSnptCmd *self) {
     PadDir *dir = PadDir_Open(self->config->codes_dir_path);
     if (!dir) {
-        PadErr_Err("failed to open directory \"%s\"", self->config->codes_dir_path);
+        CapOut_Err(self->config, "failed to open directory \"%s\"", self->config->codes_dir_path);
         return 1;
     }
 
@@ -183,12 +203,12 @@ _clear(CapSnptCmd *self) {
         }
         char path[PAD_FILE__NPATH];
         if (!PadFile_SolveFmt(path, sizeof path, "%s/%s", self->config->codes_dir_path, name)) {
-            PadErr_Err("failed to solve path for \"%s\"", name);
+            CapOut_Err(self->config, "failed to solve path for \"%s\"", name);
             goto fail;
         }
 
         if (PadFile_Remove(path) != 0) {
-            PadErr_Err("failed to remove file \"%s\"", path);
+            CapOut_Err(self->config, "failed to remove file \"%s\"", path);
             goto fail;
         }
 
@@ -197,6 +217,13 @@ _clear(CapSnptCmd *self) {
 
 fail:
     PadDir_Close(dir);
+
+    // files may be left by failure. scan again at next time
+    CapSnptIndex *index = CapSnptIndex_New();
+    if (index && CapSnptIndex_Scan(index, self->config->codes_dir_path)) {
+        CapSnptIndex_Save(index, self->config->var_snippets_path);
+    }
+    CapSnptIndex_Del(index);
     return 0;
 }
 
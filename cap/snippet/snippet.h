@@ -16,6 +16,9 @@
 #include <cap/core/constant.h>
 #include <cap/core/util.h>
 #include <cap/core/config.h>
+#include <cap/core/snippet_index.h>
+#include <cap/core/warm.h>
+#include <cap/core/output.h>
 
 /**
  * Structure and type of command
@@ -332,6 +332,249 @@ test_util_Cap_ExecProg(void) {
     PadFile_Remove("tests_env/util/.caprc");
 }
 
+static void
+test_util_Cap_FindProg(void) {
+    CapConfig *config = CapConfig_New();
+
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/util"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/util"));
+    assert(solve_path(config->var_hash_path, sizeof config->var_hash_path, "./tests_env/util/hash"));
+
+    FILE *fout = fopen("tests_env/util/.caprc", "wt");
+    fputs("{@\n    PATH = \"bin,bin2\"\n@}\n", fout);
+    fclose(fout);
+
+    if (!PadFile_IsExists("tests_env/util/bin")) {
+        PadFile_MkdirQ("tests_env/util/bin");
+    }
+    fout = fopen("tests_env/util/bin/prog", "wt");
+    fclose(fout);
+
+    char cap_fpath[PAD_FILE__NPATH];
+    assert(Cap_FindProg(config, NULL, cap_fpath, sizeof cap_fpath, "prog"));
+    assert(!strcmp(cap_fpath, "bin/prog"));
+    assert(!Cap_FindProg(config, NULL, cap_fpath, sizeof cap_fpath, "nothing"));
+    assert(!Cap_FindProg(config, NULL, cap_fpath, sizeof cap_fpath, ".prog"));
+
+    CapProgHash *hash = CapProgHash_New();
+    assert(Cap_UpdateProgHash(config, hash, true));
+    assert(CapProgHash_Len(hash) == 1);
+    assert(!strcmp(CapProgHash_GetcNameAt(hash, 0), "prog"));
+    assert(!strcmp(CapProgHash_GetcPathAt(hash, 0), "bin/prog"));
+    assert(CapProgHash_DepsLen(hash) == 3);
+    assert(!CapProgHash_Find(hash, "nothing"));
+    CapProgHash_Del(hash);
+
+    // first one is used in same names
+    hash = CapProgHash_New();
+    assert(CapProgHash_Reset(hash, config));
+    assert(CapProgHash_Add(hash, "b", "bin/b"));
+    assert(CapProgHash_Add(hash, "a", "bin/a"));
+    assert(CapProgHash_Add(hash, "a", "bin2/a"));
+    assert(CapProgHash_Len(hash) == 2);
+    assert(!strcmp(CapProgHash_Find(hash, "a"), "bin/a"));
+
+    // mark of uncacheable is saved without programs
+    CapProgHash_SetUncacheable(hash);
+    assert(CapProgHash_AddDep(hash, "tests_env/util/nothing"));
+    assert(CapProgHash_Save(hash, config->var_hash_path));
+    CapProgHash_Del(hash);
+    hash = CapProgHash_New();
+    assert(CapProgHash_Load(hash, config->var_hash_path, config));
+    assert(CapProgHash_IsUncacheable(hash));
+    assert(CapProgHash_Len(hash) == 0);
+    CapProgHash_Del(hash);
+
+    // program is found without hash
+    assert(Cap_FindProg(config, NULL, cap_fpath, sizeof cap_fpath, "prog"));
+    assert(!strcmp(cap_fpath, "bin/prog"));
+
+    // resource file that uses file system is not cacheable
+    fout = fopen("tests_env/util/.caprc", "wt");
+    fputs("{@\n    PATH = \"bin,file\"\n@}\n", fout);
+    fclose(fout);
+    hash = CapProgHash_New();
+    assert(Cap_UpdateProgHash(config, hash, true));
+    assert(CapProgHash_IsUncacheable(hash));
+    CapProgHash_Del(hash);
+    assert(Cap_FindProg(config, NULL, cap_fpath, sizeof cap_fpath, "prog"));
+    assert(!strcmp(cap_fpath, "bin/prog"));
+
+    CapConfig_Del(config);
+    PadFile_Remove("tests_env/util/bin/prog");
+    PadFile_Remove("tests_env/util/.caprc");
+    PadFile_Remove("tests_env/util/hash");
+}
+
+static void
+test_util_CapCmdCache(void) {
+    CapConfig *config = CapConfig_New();
+
+    config->scope = CAP_SCOPE__LOCAL;
+    strcpy(config->cd_path, "tests_env/util");
+    strcpy(config->home_path, "tests_env/util");
+
+    const char *deppath = "tests_env/util/cmdcache-dep";
+    const char *cachepath = "tests_env/util/cmds";
+    PadFile_Remove(deppath);
+
+    CapCmdCacheEntry entry;
+    assert(CapCmdCacheEntry_Init(&entry, config, "foo"));
+    assert(CapCmdCacheEntry_AddDep(&entry, deppath));
+    assert(CapCmdCacheEntry_AddDep(&entry, deppath));
+    assert(entry.ndeps == 1);
+    assert(CapCmdCacheEntry_SetResult(&entry, CAP_CMD_CACHE__PROG, "bin/foo"));
+
+    CapCmdCache *cache = CapCmdCache_New();
+    assert(CapCmdCache_Set(cache, &entry));
+    assert(CapCmdCache_Len(cache) == 1);
+    assert(CapCmdCache_Save(cache, cachepath));
+    CapCmdCache_Del(cache);
+
+    cache = CapCmdCache_New();
+    assert(CapCmdCache_Load(cache, cachepath));
+    assert(CapCmdCache_Len(cache) == 1);
+    const CapCmdCacheEntry *hit = CapCmdCache_Find(cache, config, "foo");
+    assert(hit);
+    assert(hit->kind == CAP_CMD_CACHE__PROG);
+    assert(!strcmp(hit->value, "bin/foo"));
+    assert(!CapCmdCache_Find(cache, config, "bar"));
+
+    // other scope is other key
+    config->scope = CAP_SCOPE__GLOBAL;
+    assert(!CapCmdCache_Find(cache, config, "foo"));
+    config->scope = CAP_SCOPE__LOCAL;
+
+    // invalidated by change of dependency
+    FILE *fout = fopen(deppath, "wt");
+    fclose(fout);
+    assert(!CapCmdCache_Find(cache, config, "foo"));
+
+    // modified just now. not cacheable
+    assert(CapCmdCacheEntry_Init(&entry, config, "foo"));
+    assert(!CapCmdCacheEntry_AddDep(&entry, deppath));
+    assert(CapCmdCacheEntry_SetResult(&entry, CAP_CMD_CACHE__RUN, NULL));
+    assert(!CapCmdCache_Set(cache, &entry));
+    CapCmdCacheEntry_Fini(&entry);
+
+    CapCmdCache_Del(cache);
+    CapConfig_Del(config);
+    PadFile_Remove(deppath);
+    PadFile_Remove(cachepath);
+}
+
+static void
+test_util_CapState(void) {
+    CapConfig *config = CapConfig_New();
+
+    strcpy(config->var_cd_path, "tests_env/util/state-cd");
+    strcpy(config->var_home_path, "tests_env/util/state-home");
+    strcpy(config->var_editor_path, "tests_env/util/state-editor");
+    const char *statepath = "tests_env/util/state";
+
+    assert(PadFile_WriteLine("/path/to/cd", config->var_cd_path));
+    assert(PadFile_WriteLine("/path/to/home", config->var_home_path));
+    assert(PadFile_WriteLine("vim", config->var_editor_path));
+
+    CapState *state = PadMem_Calloc(1, sizeof(*state));
+
+    // written just now. not cacheable
+    assert(CapState_Make(state, config));
+    assert(state->is_uncacheable);
+    assert(state->ndeps == CAP_STATE__MAX_DEPS);
+    assert(!CapState_Save(state, statepath));
+
+    state->is_uncacheable = false;
+    assert(CapState_Save(state, statepath));
+
+    assert(CapState_Load(state, statepath));
+    assert(!strcmp(state->cd_path, "/path/to/cd"));
+    assert(!strcmp(state->home_path, "/path/to/home"));
+    assert(!strcmp(state->editor, "vim"));
+
+    // invalidated by change of variable
+    assert(PadFile_WriteLine("/path/to/other", config->var_cd_path));
+    assert(!CapState_Load(state, statepath));
+    assert(!state->cd_path[0]);
+
+    // invalidated by remove of variable
+    assert(CapState_Make(state, config));
+    state->is_uncacheable = false;
+    assert(CapState_Save(state, statepath));
+    assert(CapState_Load(state, statepath));
+    PadFile_Remove(config->var_editor_path);
+    assert(!CapState_Load(state, statepath));
+
+    // broken
+    assert(PadFile_WriteLine("cap state 0", statepath));
+    assert(!CapState_Load(state, statepath));
+
+    free(state);
+    PadFile_Remove(config->var_cd_path);
+    PadFile_Remove(config->var_home_path);
+    PadFile_Remove(statepath);
+    CapConfig_Del(config);
+}
+
+static void
+test_util_CapBakeManifest(void) {
+    const char *path = "tests_env/util/manifest";
+    const char *deppath = "tests_env/util/manifest-dep";
+    assert(PadFile_WriteLine("module", deppath));
+
+    PadCStrAry *deps = PadCStrAry_New();
+    PadCStrAry_PushBack(deps, deppath);
+
+    char *argv[] = {"a", "b", NULL};
+    uint64_t args_hash = CapBake_HashArgs(2, argv);
+    assert(args_hash != CapBake_HashArgs(1, argv));
+
+    CapBakeEntry entry = {
+        .path = PadCStr_Dup("dir/file.txt"),
+        .src_hash = CapBake_HashStr("{: 1 :}"),
+        .args_hash = args_hash,
+        .out_hash = CapBake_HashStr("1"),
+    };
+    assert(CapBakeEntry_SetDeps(&entry, deps));
+    assert(entry.ndeps == 1);
+
+    CapBakeManifest *manifest = CapBakeManifest_New();
+    assert(CapBakeManifest_Add(manifest, &entry));
+    entry.path[0] = 'x';
+    assert(CapBakeManifest_Add(manifest, &entry));
+    assert(CapBakeManifest_Save(manifest, path));
+    CapBakeManifest_Del(manifest);
+
+    manifest = CapBakeManifest_New();
+    assert(CapBakeManifest_Load(manifest, path));
+    assert(CapBakeManifest_Len(manifest) == 2);
+    const CapBakeEntry *found = CapBakeManifest_Find(manifest, "dir/file.txt");
+    assert(found);
+    assert(found->src_hash == entry.src_hash);
+    assert(found->ndeps == 1);
+    assert(CapBakeManifest_Find(manifest, "xir/file.txt"));
+    assert(!CapBakeManifest_Find(manifest, "none"));
+
+    // fresh while content, arguments and modules are not changed
+    assert(CapBakeEntry_IsFresh(found, CapBake_HashStr("1"), args_hash));
+    assert(!CapBakeEntry_IsFresh(found, CapBake_HashStr("2"), args_hash));
+    assert(!CapBakeEntry_IsFresh(found, CapBake_HashStr("1"), CapBake_HashArgs(1, argv)));
+    assert(PadFile_WriteLine("changed", deppath));
+    assert(!CapBakeEntry_IsFresh(found, CapBake_HashStr("1"), args_hash));
+
+    // broken
+    assert(PadFile_WriteLine("cap bake manifest 0", path));
+    assert(!CapBakeManifest_Load(manifest, path));
+    assert(CapBakeManifest_Len(manifest) == 0);
+
+    CapBakeManifest_Del(manifest);
+    CapBakeEntry_Fini(&entry);
+    PadCStrAry_Del(deps);
+    PadFile_Remove(path);
+    PadFile_Remove(deppath);
+}
+
 static const struct testcase
 utiltests[] = {
     {"Cap_IsOutOfHome", test_util_Cap_IsOutOfHome},
@@ -342,6 +585,10 @@ utiltests[] = {
     {"Cap_ExecSnippet", test_util_Cap_ExecSnippet},
     {"Cap_ExecRun", test_util_Cap_ExecRun},
     {"Cap_ExecProg", test_util_Cap_ExecProg},
+    {"Cap_FindProg", test_util_Cap_FindProg},
+    {"CapCmdCache", test_util_CapCmdCache},
+    {"CapState", test_util_CapState},
+    {"CapBakeManifest", test_util_CapBakeManifest},
     {0},
 };
 
@@ -414,14 +661,283 @@ test_CapSymlink_NormPath(void) {
 
     assert(CapSymlink_NormPath(config, path, sizeof path, "/path/to/../../dir") == path);
     assert(strcmp(path, "/dir") == 0);
+
+    assert(CapSymlink_NormPath(config, path, sizeof path, "//path//to///dir//") == path);
+    assert(strcmp(path, "/path/to/dir") == 0);
+
+    assert(CapSymlink_NormPath(config, path, sizeof path, "/../..") == path);
+    assert(strcmp(path, "/") == 0);
+
+    assert(CapSymlink_NormPath(config, path, sizeof path, "path/..") == path);
+    assert(strcmp(path, "") == 0);
+
+    char small[8];
+    assert(CapSymlink_NormPath(config, small, sizeof small, "/path/to/dir") == small);
+    assert(strcmp(small, "/path/t") == 0);
 #endif
 
     CapConfig_Del(config);
 }
 
+static void
+test_CapSymlink_FollowPath_cache(void) {
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->home_path, sizeof config->home_path, "."));
+
+    char linkpath[PAD_FILE__NPATH];
+    assert(solve_path(linkpath, sizeof linkpath, "./tests_env/link/link-to-a"));
+    assert(PadFile_WriteLine("cap symlink: /tests_env/link/a", linkpath));
+
+    char drtpath[PAD_FILE__NPATH];
+    char expect[PAD_FILE__NPATH];
+    char path[PAD_FILE__NPATH];
+
+    CapSymlink_ClearCache();
+
+    // first time resolves all prefixes
+    snprintf(drtpath, sizeof drtpath, "%s/b", linkpath);
+    assert(solve_path(expect, sizeof expect, "./tests_env/link/a/b"));
+    CapSymlinkCacheStats st1 = CapSymlink_GetCacheStats();
+    assert(CapSymlink_FollowPath(config, path, sizeof path, drtpath));
+    assert(!strcmp(path, expect));
+    CapSymlinkCacheStats st2 = CapSymlink_GetCacheStats();
+    assert(st2.misses > st1.misses);
+
+    // second time is resolved by cache
+    assert(CapSymlink_FollowPath(config, path, sizeof path, drtpath));
+    assert(!strcmp(path, expect));
+    CapSymlinkCacheStats st3 = CapSymlink_GetCacheStats();
+    assert(st3.hits == st2.hits + 1);
+    assert(st3.misses == st2.misses);
+
+    // shared prefix is resolved by cache
+    snprintf(drtpath, sizeof drtpath, "%s/c", linkpath);
+    assert(solve_path(expect, sizeof expect, "./tests_env/link/a/c"));
+    assert(CapSymlink_FollowPath(config, path, sizeof path, drtpath));
+    assert(!strcmp(path, expect));
+    CapSymlinkCacheStats st4 = CapSymlink_GetCacheStats();
+    assert(st4.hits == st3.hits + 1);
+    assert(st4.misses == st3.misses + 1);
+
+    // changed link is resolved again
+    assert(PadFile_WriteLine("cap symlink: /tests_env/link", linkpath));
+    assert(solve_path(expect, sizeof expect, "./tests_env/link"));
+    assert(CapSymlink_FollowPath(config, path, sizeof path, linkpath));
+    assert(!strcmp(path, expect));
+    CapSymlinkCacheStats st5 = CapSymlink_GetCacheStats();
+    assert(st5.stales == st4.stales + 1);
+
+    // changed link in middle of chain is resolved again
+    char midpath[PAD_FILE__NPATH];
+    assert(solve_path(midpath, sizeof midpath, "./tests_env/link/link-to-mid"));
+    assert(PadFile_WriteLine("cap symlink: /tests_env/link/link-to-mid", linkpath));
+    assert(PadFile_WriteLine("cap symlink: /tests_env/link/a", midpath));
+    assert(solve_path(expect, sizeof expect, "./tests_env/link/a"));
+    assert(CapSymlink_FollowPath(config, path, sizeof path, linkpath));
+    assert(!strcmp(path, expect));
+
+    assert(PadFile_WriteLine("cap symlink: /tests_env/link/empty", midpath));
+    assert(solve_path(expect, sizeof expect, "./tests_env/link/empty"));
+    CapSymlinkCacheStats st6 = CapSymlink_GetCacheStats();
+    assert(CapSymlink_FollowPath(config, path, sizeof path, linkpath));
+    assert(!strcmp(path, expect));
+    CapSymlinkCacheStats st7 = CapSymlink_GetCacheStats();
+    assert(st7.stales > st6.stales);
+
+    PadFile_Remove(midpath);
+    PadFile_Remove(linkpath);
+    CapSymlink_ClearCache();
+    CapConfig_Del(config);
+}
+
+static void
+test_CapSymlink_FollowPath_chain(void) {
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->home_path, sizeof config->home_path, "."));
+
+    char path[PAD_FILE__NPATH];
+    char linkpath[PAD_FILE__NPATH];
+    char line[PAD_FILE__NPATH];
+    char expect[PAD_FILE__NPATH];
+    enum { N = 16 };
+
+    CapSymlink_ClearCache();
+
+    // deep chain of links (over old limit of depth)
+    for (int i = 0; i < N; ++i) {
+        snprintf(path, sizeof path, "./tests_env/link/chain%d", i);
+        assert(solve_path(linkpath, sizeof linkpath, path));
+        if (i == N-1) {
+            snprintf(line, sizeof line, "cap symlink: /tests_env/link/a");
+        } else {
+            snprintf(line, sizeof line, "cap symlink: /tests_env/link/chain%d", i+1);
+        }
+        assert(PadFile_WriteLine(line, linkpath));
+    }
+
+    assert(solve_path(linkpath, sizeof linkpath, "./tests_env/link/chain0/b"));
+    assert(solve_path(expect, sizeof expect, "./tests_env/link/a/b"));
+    assert(CapSymlink_FollowPath(config, path, sizeof path, linkpath));
+    assert(!strcmp(path, expect));
+
+    // circular links
+    assert(solve_path(linkpath, sizeof linkpath, "./tests_env/link/chain15"));
+    assert(PadFile_WriteLine("cap symlink: /tests_env/link/chain0", linkpath));
+    CapSymlink_ClearCache();
+    assert(solve_path(linkpath, sizeof linkpath, "./tests_env/link/chain0/b"));
+    assert(!CapSymlink_FollowPath(config, path, sizeof path, linkpath));
+
+    for (int i = 0; i < N; ++i) {
+        snprintf(path, sizeof path, "./tests_env/link/chain%d", i);
+        assert(solve_path(linkpath, sizeof linkpath, path));
+        PadFile_Remove(linkpath);
+    }
+    CapSymlink_ClearCache();
+    CapConfig_Del(config);
+}
+
+static void
+test_CapSymlink_Reindex(void) {
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/link"));
+    assert(solve_path(config->var_links_path, sizeof config->var_links_path, "./tests_env/link/links"));
+
+    char linkpath[PAD_FILE__NPATH];
+    char drtpath[PAD_FILE__NPATH];
+    char path[PAD_FILE__NPATH];
+    char expect[PAD_FILE__NPATH];
+    char plainpath[PAD_FILE__NPATH];
+    assert(solve_path(linkpath, sizeof linkpath, "./tests_env/link/link-to-a"));
+    assert(solve_path(plainpath, sizeof plainpath, "./tests_env/link/plain-file"));
+
+    assert(PadFile_WriteLine("plain file", plainpath));
+    assert(CapSymlink_Link(config, linkpath, "/a"));
+    assert(CapSymlink_Reindex(config) == 1);
+    assert(PadFile_IsExists(config->var_links_path));
+
+    // file overwritten in place by link after indexing is link
+    assert(!CapSymlink_IsLinkFile(config, plainpath));
+    assert(PadFile_WriteLine("cap symlink: /a", plainpath));
+    assert(CapSymlink_IsLinkFile(config, plainpath));
+    PadFile_Remove(plainpath);
+
+    // resolved by index
+    assert(CapSymlink_IsLinkFile(config, linkpath));
+    snprintf(drtpath, sizeof drtpath, "%s/b", linkpath);
+    assert(solve_path(expect, sizeof expect, "./tests_env/link/a/b"));
+    assert(CapSymlink_FollowPath(config, path, sizeof path, drtpath));
+    assert(!strcmp(path, expect));
+
+    // index is updated by unlink
+    assert(CapSymlink_Unlink(config, linkpath));
+    assert(!PadFile_IsExists(linkpath));
+    CapLinkIndex *index = CapLinkIndex_New();
+    assert(CapLinkIndex_Load(index, config->var_links_path));
+    assert(CapLinkIndex_Len(index) == 0);
+    CapLinkIndex_Del(index);
+
+    PadFile_Remove(config->var_links_path);
+    CapSymlink_ClearCache();
+    CapConfig_Del(config);
+}
+
+static void
+test_CapSymlink_TagLinks(void) {
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/link"));
+
+    char linkpath[PAD_FILE__NPATH];
+    assert(solve_path(linkpath, sizeof linkpath, "./tests_env/link/link-to-a"));
+
+    // link without tag (tagged if file system supports extended attributes)
+    assert(PadFile_WriteLine("cap symlink: /a", linkpath));
+    assert(CapSymlink_TagLinks(config) >= 0);
+    assert(CapSymlink_TagLinks(config) == 0);
+    assert(CapSymlink_IsLinkFile(config, linkpath));
+
+    // overwritten link is not link even if tag is remained
+    assert(PadFile_WriteLine("not link file", linkpath));
+    assert(!CapSymlink_IsLinkFile(config, linkpath));
+
+    PadFile_Remove(linkpath);
+    CapSymlink_ClearCache();
+    CapConfig_Del(config);
+}
+
+static void
+test_CapLinkIndex_Lookup(void) {
+    CapLinkIndex *index = CapLinkIndex_New();
+    assert(CapLinkIndex_Reset(index, "/home"));
+
+    struct stat dirst = { .st_dev = 1, .st_ino = 2, .st_mtime = 100, .st_size = 4096 };
+    struct stat otherdirst = { .st_dev = 1, .st_ino = 3, .st_mtime = 100, .st_size = 4096 };
+    assert(CapLinkIndex_SetDir(index, "/home/dir", &dirst));
+
+    // file changed before build was scanned
+    struct stat st = { .st_dev = 1, .st_ino = 4, .st_mtime = 100, .st_size = 100 };
+    st.st_ctime = time(NULL) - 60;
+    assert(CapLinkIndex_Lookup(index, &st, &dirst, NULL) == CAP_LINK_INDEX__NOT_LINK);
+    assert(CapLinkIndex_Lookup(index, &st, &otherdirst, NULL) == CAP_LINK_INDEX__UNKNOWN);
+
+    // file changed after build may be overwritten by link
+    st.st_ctime = time(NULL);
+    assert(CapLinkIndex_Lookup(index, &st, &dirst, NULL) == CAP_LINK_INDEX__UNKNOWN);
+
+    // small file in fresh directory is not link
+    st.st_size = CAP_LINK_INDEX__MIN_LINK_SIZE - 1;
+    assert(CapLinkIndex_Lookup(index, &st, &dirst, NULL) == CAP_LINK_INDEX__NOT_LINK);
+    dirst.st_mtime++;
+    assert(CapLinkIndex_Lookup(index, &st, &dirst, NULL) == CAP_LINK_INDEX__UNKNOWN);
+
+    CapLinkIndex_Del(index);
+}
+
+static void
+test_CapSymlinkStamp_Write(void) {
+    CapSymlinkStamp stamp = {
+        .exists = true,
+        .dev = 1,
+        .ino = 2,
+        .mtime = 100,
+        .mtime_nsec = 999999999,
+        .size = 4096,
+        .mode = 0100644,
+    };
+
+    FILE *f = tmpfile();
+    assert(f);
+    fprintf(f, "dep");
+    CapSymlinkStamp_Write(&stamp, f);
+    fprintf(f, "\t/path\n");
+    rewind(f);
+
+    char line[256];
+    assert(fgets(line, sizeof line, f));
+    fclose(f);
+    line[strcspn(line, "\n")] = '\0';
+
+    // every field of stamp is read back. rewrite in same second is detected
+    char *fields[9];
+    assert(CapRecord_SplitFields(line, fields, 9) == 2 + CAP_SYMLINK_STAMP__NFIELDS);
+    assert(!strcmp(fields[0], "dep"));
+    assert(!strcmp(fields[8], "/path"));
+
+    CapSymlinkStamp read;
+    CapSymlinkStamp_Read(&read, fields + 1);
+    assert(CapSymlinkStamp_Eq(&stamp, &read));
+    read.mtime_nsec = 0;
+    assert(!CapSymlinkStamp_Eq(&stamp, &read));
+}
+
 static const struct testcase
 symlink_tests[] = {
     {"CapSymlink_NormPath", test_CapSymlink_NormPath},
+    {"CapSymlink_FollowPath_cache", test_CapSymlink_FollowPath_cache},
+    {"CapSymlink_FollowPath_chain", test_CapSymlink_FollowPath_chain},
+    {"CapSymlink_Reindex", test_CapSymlink_Reindex},
+    {"CapSymlink_TagLinks", test_CapSymlink_TagLinks},
+    {"CapLinkIndex_Lookup", test_CapLinkIndex_Lookup},
+    {"CapSymlinkStamp_Write", test_CapSymlinkStamp_Write},
     {0},
 };
 
@@ -871,10 +1387,302 @@ test_makecmd_options(void) {
     CapConfig_Del(config);
 }
 
+static void
+test_makecmd_jobs(void) {
+    CapConfig *config = CapConfig_New();
+    int argc = 7;
+    char *argv[] = {
+        "make",
+        "-j",
+        "3",
+        "test.cap",
+        "test.cap",
+        "test.cap",
+        "test.cap",
+        NULL,
+    };
+
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/make"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/make"));
+
+    char buf[1024] = {0};
+    setvbuf(stdout, buf, _IOFBF, sizeof buf);
+
+    CapMakeCmd *makecmd = CapMakeCmd_New(config, argc, argv);
+    int result = CapMakeCmd_Run(makecmd);
+    CapMakeCmd_Del(makecmd);
+
+    fflush(stdout);
+    setvbuf(stdout, NULL, _IONBF, BUFSIZ);
+
+    assert(result == 0);
+    assert(!strcmp(buf, "1111"));
+
+    CapConfig_Del(config);
+}
+
+static void
+test_makecmd_jobs_strip_ext(void) {
+    CapConfig *config = CapConfig_New();
+    int argc = 6;
+    char *argv[] = {
+        "make",
+        "--jobs",
+        "2",
+        "-x",
+        "jobs1.txt.cap",
+        "jobs2.txt.cap",
+        NULL,
+    };
+
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/make"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/make"));
+
+    FILE *fout = fopen("tests_env/make/jobs1.txt.cap", "wt");
+    fputs("{: 1 + 1 :}\n", fout);
+    fclose(fout);
+    fout = fopen("tests_env/make/jobs2.txt.cap", "wt");
+    fputs("{: \"two\" :}\n", fout);
+    fclose(fout);
+
+    CapMakeCmd *makecmd = CapMakeCmd_New(config, argc, argv);
+    assert(CapMakeCmd_Run(makecmd) == 0);
+    CapMakeCmd_Del(makecmd);
+
+    char *s = PadFile_ReadCopyFromPath("tests_env/make/jobs1.txt");
+    assert(s && !strcmp(s, "2"));
+    free(s);
+    s = PadFile_ReadCopyFromPath("tests_env/make/jobs2.txt");
+    assert(s && !strcmp(s, "two"));
+    free(s);
+
+    PadFile_Remove("tests_env/make/jobs1.txt.cap");
+    PadFile_Remove("tests_env/make/jobs2.txt.cap");
+    PadFile_Remove("tests_env/make/jobs1.txt");
+    PadFile_Remove("tests_env/make/jobs2.txt");
+    CapConfig_Del(config);
+}
+
+static void
+test_makecmd_incremental(void) {
+    CapConfig *config = CapConfig_New();
+    int argc = 8;
+    char *argv[] = {
+        "make",
+        "-o",
+        "tests_env/make/out.txt",
+        "--incremental",
+        "--deps",
+        "tests_env/make/out.txt.d",
+        "test.cap",
+        "arg",
+        NULL,
+    };
+
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/make"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/make"));
+
+    CapMakeCmd *makecmd = CapMakeCmd_New(config, argc, argv);
+    assert(CapMakeCmd_Run(makecmd) == 0);
+    CapMakeCmd_Del(makecmd);
+
+    char *s = PadFile_ReadCopyFromPath("tests_env/make/out.txt");
+    assert(s && !strcmp(s, "1"));
+    free(s);
+    s = PadFile_ReadCopyFromPath("tests_env/make/out.txt.d");
+    assert(s && !strncmp(s, "tests_env/make/out.txt: ", 24));
+    assert(strstr(s, "test.cap"));
+    free(s);
+    assert(PadFile_IsExists("tests_env/make/out.txt" CAP_MAKE__STAMP_EXT));
+
+    // fresh output is not rewritten
+    struct stat before;
+    assert(stat("tests_env/make/out.txt", &before) == 0);
+    makecmd = CapMakeCmd_New(config, argc, argv);
+    assert(CapMakeCmd_Run(makecmd) == 0);
+    CapMakeCmd_Del(makecmd);
+    struct stat after;
+    assert(stat("tests_env/make/out.txt", &after) == 0);
+    assert(before.st_mtime == after.st_mtime);
+
+    // changed output is made again
+    FILE *fout = fopen("tests_env/make/out.txt", "wt");
+    fputs("edited", fout);
+    fclose(fout);
+    makecmd = CapMakeCmd_New(config, argc, argv);
+    assert(CapMakeCmd_Run(makecmd) == 0);
+    CapMakeCmd_Del(makecmd);
+    s = PadFile_ReadCopyFromPath("tests_env/make/out.txt");
+    assert(s && !strcmp(s, "1"));
+    free(s);
+
+    // incremental needs output
+    char *argv2[] = {"make", "--incremental", "test.cap", NULL};
+    makecmd = CapMakeCmd_New(config, 3, argv2);
+    assert(CapMakeCmd_Run(makecmd) != 0);
+    CapMakeCmd_Del(makecmd);
+
+    PadFile_Remove("tests_env/make/out.txt");
+    PadFile_Remove("tests_env/make/out.txt.d");
+    PadFile_Remove("tests_env/make/out.txt" CAP_MAKE__STAMP_EXT);
+    CapConfig_Del(config);
+}
+
+/**
+ * make by command and read stdout of make
+ */
+static char *
+makecmd_run_to_str(const CapConfig *config, int argc, char *argv[], int *result) {
+    const char *outpath = "tests_env/make/cache_stdout.txt";
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    FILE *fout = fopen(outpath, "wb");
+    dup2(fileno(fout), STDOUT_FILENO);
+
+    CapMakeCmd *makecmd = CapMakeCmd_New(config, argc, argv);
+    *result = CapMakeCmd_Run(makecmd);
+    CapMakeCmd_Del(makecmd);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    fclose(fout);
+
+    char *s = PadFile_ReadCopyFromPath(outpath);
+    PadFile_Remove(outpath);
+    return s;
+}
+
+static void
+test_makecmd_cache(void) {
+#ifndef CAP_TESTS__WINDOWS
+    CapConfig *config = CapConfig_New();
+    char *argv[] = {"make", "--cache", "cached.cap", "arg", NULL};
+    int result;
+
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/make"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/make"));
+    assert(solve_path(config->render_cache_dir_path, sizeof config->render_cache_dir_path, "./tests_env/make/cache"));
+
+    const char *src = "{: 1 + 2 :}\n";
+    FILE *fout = fopen("tests_env/make/cached.cap", "wt");
+    fputs(src, fout);
+    fclose(fout);
+
+    // miss. make and write cache
+    char *s = makecmd_run_to_str(config, 4, argv, &result);
+    assert(result == 0);
+    assert(s && !strcmp(s, "3"));
+    free(s);
+
+    char path[PAD_FILE__NPATH];
+    char cachepath[PAD_FILE__NPATH];
+    CapRenderCacheKey key;
+    assert(solve_path(path, sizeof path, "./tests_env/make/cached.cap"));
+    CapRenderCacheKey_Init(&key, config, path, src, 2, argv + 2);
+    assert(CapRenderCache_Find(cachepath, sizeof cachepath, config->render_cache_dir_path, &key));
+
+    // hit. output is read from cache
+    fout = fopen(cachepath, "wt");
+    fputs("cached\n", fout);
+    fclose(fout);
+    s = makecmd_run_to_str(config, 4, argv, &result);
+    assert(result == 0);
+    assert(s && !strcmp(s, "cached"));
+    free(s);
+
+    // other arguments are other key
+    CapRenderCacheKey other;
+    CapRenderCacheKey_Init(&other, config, path, src, 1, argv + 2);
+    assert(other.args_hash != key.args_hash);
+
+    // results of commands are not cached
+    assert(!CapRenderCache_IsCacheable("{: exec(\"date\") :}"));
+    assert(CapRenderCache_IsCacheable("{: executable :}"));
+
+    // cache needs stdout
+    char *argv2[] = {"make", "--cache", "-o", "out.txt", "cached.cap", NULL};
+    s = makecmd_run_to_str(config, 5, argv2, &result);
+    assert(result != 0);
+    free(s);
+
+    char entrypath[PAD_FILE__NPATH];
+    PadCStr_Copy(entrypath, sizeof entrypath, cachepath);
+    entrypath[strlen(entrypath) - strlen(".out")] = '\0';
+    PadFile_Remove(entrypath);
+    PadFile_Remove(cachepath);
+    rmdir(config->render_cache_dir_path);
+    PadFile_Remove("tests_env/make/cached.cap");
+    CapConfig_Del(config);
+#endif
+}
+
+static void *
+makecmd_watch_editor(void *arg) {
+    usleep(200 * 1000);  // after first render
+
+    FILE *fout = fopen("tests_env/make/watch.txt.cap.tmp", "wt");
+    fputs("{: 2 + 2 :}\n", fout);
+    fclose(fout);
+    rename("tests_env/make/watch.txt.cap.tmp", "tests_env/make/watch.txt.cap");
+
+    return NULL;
+}
+
+static void
+test_makecmd_watch(void) {
+#ifdef __linux__
+    CapConfig *config = CapConfig_New();
+    PadErrStack *errstack = PadErrStack_New();
+    char *files[] = {"watch.txt.cap", NULL};
+
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/make"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/make"));
+
+    FILE *fout = fopen("tests_env/make/watch.txt.cap", "wt");
+    fputs("{: 1 + 1 :}\n", fout);
+    fclose(fout);
+
+    pthread_t editor;
+    assert(pthread_create(&editor, NULL, makecmd_watch_editor, NULL) == 0);
+
+    CapMakeWatchOpts opts = {
+        .is_strip_ext = true,
+        .solve_path = true,
+        .nrounds = 1,
+    };
+    assert(CapMakeWatch_Run(config, errstack, 1, files, &opts) == 0);
+    pthread_join(editor, NULL);
+
+    char *s = PadFile_ReadCopyFromPath("tests_env/make/watch.txt");
+    assert(s && !strcmp(s, "4"));
+    free(s);
+
+    // not found file is error before watch
+    files[0] = "not-found.cap";
+    assert(CapMakeWatch_Run(config, errstack, 1, files, &opts) != 0);
+
+    PadFile_Remove("tests_env/make/watch.txt.cap");
+    PadFile_Remove("tests_env/make/watch.txt");
+    PadErrStack_Del(errstack);
+    CapConfig_Del(config);
+#endif
+}
+
 static const struct testcase
 make_tests[] = {
     {"default", test_makecmd_default},
     {"options", test_makecmd_options},
+    {"jobs", test_makecmd_jobs},
+    {"jobs_strip_ext", test_makecmd_jobs_strip_ext},
+    {"incremental", test_makecmd_incremental},
+    {"cache", test_makecmd_cache},
+    {"watch", test_makecmd_watch},
     {0},
 };
 
@@ -902,9 +1710,64 @@ test_execcmd_default(void) {
     // using Pad_SafeSystem or fork
 }
 
+static pthread_mutex_t execcmd_next_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *
+execcmd_thread(void *arg) {
+    const CapConfig *config = arg;
+    static int next = 0;
+    pthread_mutex_lock(&execcmd_next_mutex);
+    int n = next++;
+    pthread_mutex_unlock(&execcmd_next_mutex);
+
+    char cmdline[256];
+    char path[256];
+    char expected[32];
+    snprintf(cmdline, sizeof cmdline, "printf 'a%d\\nb\\n' | grep a%d | tr a A > exec_%d.txt", n, n, n);
+    snprintf(path, sizeof path, "tests_env/exec_%d.txt", n);
+    snprintf(expected, sizeof expected, "A%d\n", n);
+
+    for (int i = 0; i < 10; ++i) {
+        char *argv[] = {"exec", cmdline, NULL};
+        CapExecCmd *execcmd = CapExecCmd_New(config, 2, argv);
+        assert(execcmd);
+        assert(CapExecCmd_Run(execcmd) == 0);
+        CapExecCmd_Del(execcmd);
+
+        char *s = PadFile_ReadCopyFromPath(path);
+        assert(s && !strcmp(s, expected));
+        free(s);
+    }
+
+    PadFile_Remove(path);
+    return NULL;
+}
+
+static void
+test_execcmd_threads(void) {
+#ifndef CAP_TESTS__WINDOWS
+    CapConfig *config = CapConfig_New();
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env"));
+
+    // pipes and redirects of threads are not mixed
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) {
+        assert(pthread_create(&threads[i], NULL, execcmd_thread, config) == 0);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    CapConfig_Del(config);
+#endif
+}
+
 static const struct testcase
 exec_tests[] = {
     {"default", test_execcmd_default},
+    {"threads", test_execcmd_threads},
     {0},
 };
 
@@ -942,9 +1805,195 @@ test_alcmd_default(void) {
     CapConfig_Del(config);
 }
 
+static void
+test_alcmd_CapAliasMgr_cache(void) {
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->alias_cache_dir_path, sizeof config->alias_cache_dir_path, "./tests_env/alias/cache"));
+
+    char rcpath[PAD_FILE__NPATH] = {0};
+    char cachepath[PAD_FILE__NPATH] = {0};
+    assert(solve_path(rcpath, sizeof rcpath, "./tests_env/alias/cached.caprc"));
+    assert(CapAliasCache_MakePath(cachepath, sizeof cachepath, config->alias_cache_dir_path, rcpath));
+
+    FILE *fout = fopen(rcpath, "wt");
+    fputs("{@ alias.set(\"aaa\", \"AA\" + \"A\", \"desc\") @}", fout);
+    fclose(fout);
+
+    // miss. interpret and write cache
+    CapAliasMgr *mgr = CapAliasMgr_New(config);
+    assert(CapAliasMgr_LoadPath(mgr, rcpath));
+    assert(CapAliasMgr_GetcCtx(mgr));
+    assert(PadFile_IsExists(cachepath));
+    CapAliasMgr_Del(mgr);
+
+    // hit. not interpret
+    mgr = CapAliasMgr_New(config);
+    assert(CapAliasMgr_LoadPath(mgr, rcpath));
+    assert(!CapAliasMgr_GetcCtx(mgr));
+    const CapAliasInfo *alinfo = CapAliasMgr_GetcAliasInfo(mgr);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "aaa"), "AAA"));
+    assert(!strcmp(CapAliasInfo_GetcDesc(alinfo, "aaa"), "desc"));
+    CapAliasMgr_Del(mgr);
+
+    // changed. interpret again
+    fout = fopen(rcpath, "wt");
+    fputs("{@ alias.set(\"aaa\", \"BB\" + \"B\") @}", fout);
+    fclose(fout);
+
+    mgr = CapAliasMgr_New(config);
+    assert(CapAliasMgr_LoadPath(mgr, rcpath));
+    assert(CapAliasMgr_GetcCtx(mgr));
+    alinfo = CapAliasMgr_GetcAliasInfo(mgr);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "aaa"), "BBB"));
+    CapAliasMgr_Del(mgr);
+
+    // long value is cached
+    char longval[PAD_DICT_ITEM__VALUE_SIZE * 2] = {0};
+    memset(longval, 'c', sizeof(longval) - 1);
+    fout = fopen(rcpath, "wt");
+    fprintf(fout, "{@ alias.set(\"ccc\", \"%s\") @}", longval);
+    fclose(fout);
+
+    mgr = CapAliasMgr_New(config);
+    assert(CapAliasMgr_LoadPath(mgr, rcpath));
+    assert(CapAliasMgr_GetcCtx(mgr));
+    CapAliasMgr_Del(mgr);
+
+    mgr = CapAliasMgr_New(config);
+    assert(CapAliasMgr_LoadPath(mgr, rcpath));
+    assert(!CapAliasMgr_GetcCtx(mgr));
+    alinfo = CapAliasMgr_GetcAliasInfo(mgr);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "ccc"), longval));
+    CapAliasMgr_Del(mgr);
+
+    // depends on other files
+    assert(!CapAliasCache_IsCacheable("{@ import \"x\" @}"));
+    assert(CapAliasCache_IsCacheable("{@ alias.set(\"a\", \"b\") @}"));
+    assert(CapAliasCache_IsCacheable("{@ alias.set(\"m\", \"make -f Makefile\") @}"));
+    assert(CapAliasCache_IsCacheable("{@ alias.set(\"p\", \"source ~/.profile --options\") @}"));
+    assert(!CapAliasCache_IsCacheable("{@ alias.set(\"f\", file.read(\"x\")) @}"));
+
+    PadFile_Remove(cachepath);
+    PadFile_Remove(rcpath);
+    CapConfig_Del(config);
+}
+
+static void
+test_alcmd_CapRcScanner_Scan(void) {
+    CapRcScanResult result;
+    CapAliasInfo *alinfo = CapAliasInfo_New();
+
+    assert(CapRcScanner_Scan(&result, alinfo, ""));
+    assert(!result.has_path);
+
+    assert(CapRcScanner_Scan(&result, alinfo,
+        "{@\n"
+        "    alias.set(\"aaa\", \"AAA\")\n"
+        "    alias.set( \"bbb\" , \"BBB\", \"desc\" )\n"
+        "\n"
+        "    PATH = \"bin,tools\"\n"
+        "@}\n"
+        "{@ alias.set(\"ccc\", \"\") @}\n"
+    ));
+    assert(result.has_path);
+    assert(!strcmp(result.path, "bin,tools"));
+    assert(!strcmp(result.stdout_buf, "\n\n"));
+    assert(!strcmp(CapRcScanResult_PopNewlineOfStdoutBuf(&result), "\n"));
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "aaa"), "AAA"));
+    assert(!CapAliasInfo_GetcDesc(alinfo, "aaa"));
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "bbb"), "BBB"));
+    assert(!strcmp(CapAliasInfo_GetcDesc(alinfo, "bbb"), "desc"));
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "ccc"), ""));
+
+    // fallback to interpreter
+    assert(!CapRcScanner_Scan(&result, NULL, "text"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{: PATH :}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ PATH = \"a\" + \"b\" @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ PATH == \"a\" @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ PATH = \"a\\n\" @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ alias.set(\"a\") @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ alias.set(\"a\", \"b\") alias.set(\"c\", \"d\") @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ if 1: end @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ import \"alias\" @}"));
+    assert(!CapRcScanner_Scan(&result, NULL, "{@ PATH = \"a\""));
+
+    CapAliasInfo_Del(alinfo);
+}
+
+static void
+test_alcmd_CapAliasInfo(void) {
+    CapAliasInfo *alinfo = CapAliasInfo_New();
+    assert(CapAliasInfo_Len(alinfo) == 0);
+    assert(!CapAliasInfo_GetcValue(alinfo, "a"));
+    assert(!CapAliasInfo_GetcKeyAt(alinfo, 0));
+
+    assert(CapAliasInfo_SetValue(alinfo, "b", "B"));
+    assert(CapAliasInfo_SetValue(alinfo, "a", "A"));
+    assert(CapAliasInfo_SetDesc(alinfo, "a", "desc"));
+    assert(CapAliasInfo_SetValue(alinfo, "b", "longer value of b"));
+    assert(CapAliasInfo_SetValue(alinfo, "a", "a"));
+    assert(CapAliasInfo_Len(alinfo) == 2);
+
+    // insertion order
+    assert(!strcmp(CapAliasInfo_GetcKeyAt(alinfo, 0), "b"));
+    assert(!strcmp(CapAliasInfo_GetcValueAt(alinfo, 0), "longer value of b"));
+    assert(!CapAliasInfo_GetcDescAt(alinfo, 0));
+    assert(!strcmp(CapAliasInfo_GetcKeyAt(alinfo, 1), "a"));
+    assert(!strcmp(CapAliasInfo_GetcValueAt(alinfo, 1), "a"));
+    assert(!strcmp(CapAliasInfo_GetcDescAt(alinfo, 1), "desc"));
+    assert(!CapAliasInfo_GetcKeyAt(alinfo, 2));
+
+    // description without value is not listed
+    assert(CapAliasInfo_SetDesc(alinfo, "c", "C"));
+    assert(CapAliasInfo_Len(alinfo) == 2);
+    assert(!CapAliasInfo_GetcValue(alinfo, "c"));
+    assert(!strcmp(CapAliasInfo_GetcDesc(alinfo, "c"), "C"));
+
+    // grow
+    char key[32];
+    char val[32];
+    for (int32_t i = 0; i < 10000; ++i) {
+        snprintf(key, sizeof key, "key%d", i);
+        snprintf(val, sizeof val, "value%d", i);
+        assert(CapAliasInfo_SetValue(alinfo, key, val));
+    }
+    assert(CapAliasInfo_Len(alinfo) == 10002);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "key9999"), "value9999"));
+    assert(!strcmp(CapAliasInfo_GetcKeyAt(alinfo, 10001), "key9999"));
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "b"), "longer value of b"));
+
+    // value from self
+    assert(CapAliasInfo_SetValue(alinfo, "copy", CapAliasInfo_GetcValue(alinfo, "b")));
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "copy"), "longer value of b"));
+
+    CapAliasInfo *copied = CapAliasInfo_DeepCopy(alinfo);
+    assert(CapAliasInfo_SetValue(alinfo, "a", "changed"));
+    assert(!strcmp(CapAliasInfo_GetcValue(copied, "a"), "a"));
+    assert(!strcmp(CapAliasInfo_GetcDesc(copied, "a"), "desc"));
+    assert(CapAliasInfo_Len(copied) == 10003);
+
+    CapAliasInfo *merged = CapAliasInfo_New();
+    assert(CapAliasInfo_SetValue(merged, "z", "Z"));
+    assert(CapAliasInfo_Merge(merged, copied));
+    assert(CapAliasInfo_Len(merged) == 10004);
+    assert(!strcmp(CapAliasInfo_GetcKeyAt(merged, 1), "b"));
+    assert(!strcmp(CapAliasInfo_GetcDesc(merged, "c"), "C"));
+
+    CapAliasInfo_Clear(alinfo);
+    assert(CapAliasInfo_Len(alinfo) == 0);
+    assert(!CapAliasInfo_GetcValue(alinfo, "a"));
+
+    CapAliasInfo_Del(merged);
+    CapAliasInfo_Del(copied);
+    CapAliasInfo_Del(alinfo);
+}
+
 static const struct testcase
 alias_tests[] = {
+    {"CapAliasInfo", test_alcmd_CapAliasInfo},
     {"default", test_alcmd_default},
+    {"CapAliasMgr_cache", test_alcmd_CapAliasMgr_cache},
+    {"CapRcScanner_Scan", test_alcmd_CapRcScanner_Scan},
     {0},
 };
 
@@ -1823,10 +2872,46 @@ test_snippetcmd_add(void) {
     CapConfig_Del(config);
 }
 
+static void
+test_snippetcmd_index(void) {
+    const char *dirpath = "tests_env/snippet-index";
+    const char *indexpath = "tests_env/snippet-index.idx";
+    if (!PadFile_IsExists(dirpath)) {
+        PadFile_MkdirQ(dirpath);
+    }
+
+    FILE *fout = fopen("tests_env/snippet-index/b.txt", "wt");
+    fclose(fout);
+    fout = fopen("tests_env/snippet-index/a.txt", "wt");
+    fclose(fout);
+
+    CapSnptIndex *index = CapSnptIndex_New();
+    assert(!CapSnptIndex_Load(index, indexpath, dirpath));
+    assert(CapSnptIndex_Scan(index, dirpath));
+    assert(CapSnptIndex_Len(index) == 2);
+    assert(!strcmp(CapSnptIndex_GetcNameAt(index, 0), "a.txt"));
+    assert(!strcmp(CapSnptIndex_GetcNameAt(index, 1), "b.txt"));
+    assert(!CapSnptIndex_GetcNameAt(index, 2));
+    assert(CapSnptIndex_Add(index, "a.txt"));
+    assert(CapSnptIndex_Len(index) == 2);
+    assert(CapSnptIndex_Save(index, indexpath));
+
+    // directory was modified just now. the index is stale
+    assert(!CapSnptIndex_Load(index, indexpath, dirpath));
+    assert(CapSnptIndex_Len(index) == 0);
+
+    CapSnptIndex_Del(index);
+    PadFile_Remove("tests_env/snippet-index/a.txt");
+    PadFile_Remove("tests_env/snippet-index/b.txt");
+    PadFile_Remove(dirpath);
+    PadFile_Remove(indexpath);
+}
+
 static const struct testcase
 snippet_tests[] = {
     {"default", test_snippetcmd_default},
     {"add", test_snippetcmd_add},
+    {"index", test_snippetcmd_index},
     {0},
 };
 
@@ -1977,10 +3062,79 @@ test_bakecmd_2(void) {
     CapConfig_Del(config);
 }
 
+static void
+test_bakecmd_recursive(void) {
+    if (!PadFile_IsExists("tests_env/bake/tree")) {
+        PadFile_MkdirQ("tests_env/bake/tree");
+    }
+    if (!PadFile_IsExists("tests_env/bake/tree/sub")) {
+        PadFile_MkdirQ("tests_env/bake/tree/sub");
+    }
+
+    FILE *fout = fopen("tests_env/bake/tree/a.txt", "wt");
+    fputs("{: 1 + 2 :}", fout);
+    fclose(fout);
+    fout = fopen("tests_env/bake/tree/sub/b.txt", "wt");
+    fputs("plain", fout);
+    fclose(fout);
+
+    CapConfig *config = CapConfig_New();
+    char *argv[] = {
+        "bake",
+        "-r",
+        "-j",
+        "2",
+        ":tests_env/bake/tree",
+        NULL,
+    };
+
+    CapBakeCmd *cmd = CapBakeCmd_New(config, 5, argv);
+    assert(CapBakeCmd_Run(cmd) == 0);
+    CapBakeCmd_Del(cmd);
+
+    char *s = PadFile_ReadCopyFromPath("tests_env/bake/tree/a.txt");
+    assert(!strcmp(s, "3"));
+    free(s);
+    s = PadFile_ReadCopyFromPath("tests_env/bake/tree/sub/b.txt");
+    assert(!strcmp(s, "plain"));
+    free(s);
+    assert(PadFile_IsExists("tests_env/bake/tree/" CAP_BAKE_TREE__MANIFEST_NAME));
+
+    // unchanged file is not rewritten
+    struct stat before;
+    assert(stat("tests_env/bake/tree/a.txt", &before) == 0);
+    cmd = CapBakeCmd_New(config, 5, argv);
+    assert(CapBakeCmd_Run(cmd) == 0);
+    CapBakeCmd_Del(cmd);
+    struct stat after;
+    assert(stat("tests_env/bake/tree/a.txt", &after) == 0);
+    assert(before.st_ino == after.st_ino);
+    assert(before.st_mtime == after.st_mtime);
+
+    // changed file is baked again
+    fout = fopen("tests_env/bake/tree/a.txt", "wt");
+    fputs("{: 2 + 2 :}", fout);
+    fclose(fout);
+    cmd = CapBakeCmd_New(config, 5, argv);
+    assert(CapBakeCmd_Run(cmd) == 0);
+    CapBakeCmd_Del(cmd);
+    s = PadFile_ReadCopyFromPath("tests_env/bake/tree/a.txt");
+    assert(!strcmp(s, "4"));
+    free(s);
+
+    PadFile_Remove("tests_env/bake/tree/" CAP_BAKE_TREE__MANIFEST_NAME);
+    PadFile_Remove("tests_env/bake/tree/a.txt");
+    PadFile_Remove("tests_env/bake/tree/sub/b.txt");
+    PadFile_Remove("tests_env/bake/tree/sub");
+    PadFile_Remove("tests_env/bake/tree");
+    CapConfig_Del(config);
+}
+
 static const struct testcase
 bake_tests[] = {
     {"1", test_bakecmd_1},
     {"2", test_bakecmd_2},
+    {"recursive", test_bakecmd_recursive},
     {0},
 };
 
@@ -2064,6 +3218,653 @@ replace_tests[] = {
     {0},
 };
 
+/***************
+* hash command *
+***************/
+
+static void
+test_hashcmd_rebuild(void) {
+    CapConfig *config = CapConfig_New();
+    config->scope = CAP_SCOPE__LOCAL;
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/util"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/util"));
+    assert(solve_path(config->var_hash_path, sizeof config->var_hash_path, "./tests_env/util/hash"));
+
+    FILE *fout = fopen("tests_env/util/.caprc", "wt");
+    fputs("{@\n    PATH = \"bin\"\n@}\n", fout);
+    fclose(fout);
+    if (!PadFile_IsExists("tests_env/util/bin")) {
+        PadFile_MkdirQ("tests_env/util/bin");
+    }
+    fout = fopen("tests_env/util/bin/prog", "wt");
+    fclose(fout);
+
+    int argc = 3;
+    char *argv[] = {
+        "hash",
+        "-r",
+        "-l",
+        NULL,
+    };
+
+    char buf[1024] = {0};
+    setbuf(stdout, buf);
+    CapHashCmd *cmd = CapHashCmd_New(config, argc, argv);
+    assert(CapHashCmd_Run(cmd) == 0);
+    CapHashCmd_Del(cmd);
+    setbuf(stdout, NULL);
+    assert(!strcmp(buf, "prog\tbin/prog\n"));
+
+    CapConfig_Del(config);
+    PadFile_Remove("tests_env/util/bin/prog");
+    PadFile_Remove("tests_env/util/.caprc");
+    PadFile_Remove("tests_env/util/hash");
+}
+
+static const struct testcase
+hash_tests[] = {
+    {"rebuild", test_hashcmd_rebuild},
+    {0},
+};
+
+/***************
+* find command *
+***************/
+
+enum {
+    FINDCMD_TEST_NDIRS = 8,
+};
+
+/**
+ * Run find of aliases by number of jobs and return output
+ */
+static char *
+findcmd_run_aliases(const CapConfig *config, char *jobs) {
+    char *argv[] = {"find", "-a", "-j", jobs, NULL};
+
+    // output is small enough for buffer of pipe
+    int fds[2];
+    assert(pipe(fds) == 0);
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[1]);
+
+    CapFindCmd *cmd = CapFindCmd_New(config, 4, argv);
+    assert(cmd);
+    int result = CapFindCmd_Run(cmd);
+    CapFindCmd_Del(cmd);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    assert(result == 0);
+
+    PadStr *buf = PadStr_New();
+    char tmp[1024];
+    for (ssize_t n; (n = read(fds[0], tmp, sizeof tmp)) > 0; ) {
+        for (ssize_t i = 0; i < n; ++i) {
+            PadStr_PushBack(buf, tmp[i]);
+        }
+    }
+    close(fds[0]);
+
+    char *s = PadCStr_Dup(PadStr_Getc(buf));
+    PadStr_Del(buf);
+    return s;
+}
+
+static void
+test_findcmd_jobs(void) {
+#ifndef CAP_TESTS__WINDOWS
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/find"));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/find"));
+    assert(solve_path(config->alias_cache_dir_path, sizeof config->alias_cache_dir_path, "./tests_env/alias/cache"));
+
+    char rcpaths[FINDCMD_TEST_NDIRS][PAD_FILE__NPATH];
+    for (int i = 0; i < FINDCMD_TEST_NDIRS; ++i) {
+        char dirpath[PAD_FILE__NPATH];
+        snprintf(dirpath, sizeof dirpath, "tests_env/find/d%d", i);
+        if (!PadFile_IsExists(dirpath)) {
+            PadFile_MkdirQ(dirpath);
+        }
+        snprintf(rcpaths[i], sizeof rcpaths[i], "%s/.caprc", dirpath);
+        FILE *fout = fopen(rcpaths[i], "wt");
+        assert(fout);
+        fprintf(fout, "{@ alias.set(\"k%d\", \"v%d\") @}", i, i);
+        fclose(fout);
+    }
+
+    // output of workers is same as sequential
+    char *seq = findcmd_run_aliases(config, "1");
+    char *par = findcmd_run_aliases(config, "4");
+    assert(strstr(seq, "k0") && strstr(seq, "v7"));
+    assert(!strcmp(seq, par));
+    free(seq);
+    free(par);
+
+    for (int i = 0; i < FINDCMD_TEST_NDIRS; ++i) {
+        char rcpath[PAD_FILE__NPATH];
+        char cachepath[PAD_FILE__NPATH];
+        assert(solve_path(rcpath, sizeof rcpath, rcpaths[i]));
+        if (CapAliasCache_MakePath(cachepath, sizeof cachepath, config->alias_cache_dir_path, rcpath)) {
+            PadFile_Remove(cachepath);
+        }
+        PadFile_Remove(rcpaths[i]);
+        *strrchr(rcpaths[i], '/') = '\0';
+        PadFile_Remove(rcpaths[i]);  // directory
+    }
+
+    CapConfig_Del(config);
+#endif
+}
+
+static const struct testcase
+find_tests[] = {
+    {"jobs", test_findcmd_jobs},
+    {0},
+};
+
+/*****************
+* daemon command *
+*****************/
+
+static int
+daemon_test_exec(void *arg, int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        printf("%s%s", argv[i], i < argc-1 ? " " : "\n");
+    }
+    return *(int *) arg;
+}
+
+static bool
+daemon_test_filter(void *arg, int argc, char *argv[]) {
+    (void) arg;
+    return argc < 2 || !PadCStr_Eq(argv[1], "refused");
+}
+
+static void
+test_daemoncmd_forward(void) {
+#ifndef CAP_TESTS__WINDOWS
+    const char *sockpath = "tests_env/daemon.sock";
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        // state of daemon is inherited by children
+        int code = 7;
+        _exit(CapDaemon_Serve(sockpath, daemon_test_exec, daemon_test_filter, &code));
+    }
+
+    // stdout of this process is passed to daemon
+    int fds[2];
+    assert(pipe(fds) == 0);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[1]);
+
+    char *argv[] = {"cap", "hello", "world", NULL};
+    int result = -1;
+    bool forwarded = false;
+    for (int i = 0; i < 100 && !forwarded; ++i) {
+        forwarded = CapDaemon_Forward(&result, sockpath, 3, argv);
+        if (!forwarded) {
+            usleep(10 * 1000);  // wait for listen
+        }
+    }
+    assert(forwarded);
+    assert(result == 7);
+
+    // idle client does not block other clients
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strcpy(addr.sun_path, sockpath);
+    int idle = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(connect(idle, (struct sockaddr *) &addr, sizeof addr) == 0);
+    char *argv2[] = {"cap", "again", NULL};
+    assert(CapDaemon_Forward(&result, sockpath, 2, argv2));
+    assert(result == 7);
+    close(idle);
+
+    // refused request is executed by client
+    char *argv3[] = {"cap", "refused", NULL};
+    result = -1;
+    assert(!CapDaemon_Forward(&result, sockpath, 2, argv3));
+    assert(result == -1);
+
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    char buf[64] = {0};
+    assert(read(fds[0], buf, sizeof buf - 1) > 0);
+    close(fds[0]);
+    assert(!strcmp(buf, "hello world\nagain\n"));
+
+    assert(CapDaemon_Stop(sockpath));
+    int status = 0;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(!CapDaemon_Forward(&result, sockpath, 3, argv));
+#endif
+}
+
+static void
+test_daemoncmd_warm(void) {
+    const char *dirpath = "tests_env/warm";
+    const char *codespath = "tests_env/warm/codes";
+    const char *rcpath = "tests_env/warm/.caprc";
+    if (!PadFile_IsExists(dirpath)) {
+        PadFile_MkdirQ(dirpath);
+    }
+    if (!PadFile_IsExists(codespath)) {
+        PadFile_MkdirQ(codespath);
+    }
+
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/warm"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env/warm"));
+    assert(solve_path(config->var_cd_path, sizeof config->var_cd_path, "./tests_env/warm/cd"));
+    assert(solve_path(config->var_home_path, sizeof config->var_home_path, "./tests_env/warm/home"));
+    assert(solve_path(config->var_editor_path, sizeof config->var_editor_path, "./tests_env/warm/editor"));
+    assert(solve_path(config->var_state_path, sizeof config->var_state_path, "./tests_env/warm/state"));
+    assert(solve_path(config->var_snippets_path, sizeof config->var_snippets_path, "./tests_env/warm/snippets"));
+    assert(solve_path(config->codes_dir_path, sizeof config->codes_dir_path, "./tests_env/warm/codes"));
+    assert(solve_path(config->alias_cache_dir_path, sizeof config->alias_cache_dir_path, "./tests_env/warm/alias_cache"));
+    assert(PadFile_WriteLine(config->cd_path, config->var_cd_path));
+    assert(PadFile_WriteLine(config->home_path, config->var_home_path));
+
+    FILE *fout = fopen(rcpath, "wt");
+    fputs("{@ alias.set(\"ll\", \"ls -l\") @}", fout);
+    fclose(fout);
+    fout = fopen("tests_env/warm/codes/a.txt", "wt");
+    fclose(fout);
+
+    CapWarm *warm = CapWarm_New(config);
+    assert(warm);
+    CapConfig *wconfig = CapWarm_GetConfig(warm);
+    assert(wconfig != config);
+    assert(wconfig->warm == warm);
+
+    // copy of config is not bound to warm state
+    CapConfig *copy = CapConfig_New();
+    assert(CapConfig_CopyValues(copy, wconfig));
+    assert(!copy->warm);
+    CapConfig_Del(copy);
+
+    const CapAliasInfo *alinfo = CapWarm_RefreshAliases(warm, CAP_SCOPE__LOCAL);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "ll"), "ls -l"));
+    alinfo = CapWarm_RefreshAliases(warm, CAP_SCOPE__GLOBAL);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "ll"), "ls -l"));
+
+    // values of variables are read again. changed resource file is read again
+    assert(CapWarm_Refresh(warm));
+    assert(!strcmp(wconfig->cd_path, config->cd_path));
+    fout = fopen(rcpath, "wt");
+    fputs("{@ alias.set(\"ll\", \"ls -la\") @}", fout);
+    fclose(fout);
+    alinfo = CapWarm_RefreshAliases(warm, CAP_SCOPE__LOCAL);
+    assert(!strcmp(CapAliasInfo_GetcValue(alinfo, "ll"), "ls -la"));
+
+    // moved scope has not resource file
+    char otherpath[PAD_FILE__NPATH];
+    assert(solve_path(otherpath, sizeof otherpath, "./tests_env/warm/codes"));
+    assert(PadFile_WriteLine(otherpath, config->var_cd_path));
+    assert(CapWarm_Refresh(warm));
+    alinfo = CapWarm_RefreshAliases(warm, CAP_SCOPE__LOCAL);
+    assert(!CapAliasInfo_GetcValue(alinfo, "ll"));
+
+    CapSnptIndex *index = CapWarm_UpdateSnptIndex(warm);
+    assert(index);
+    assert(CapSnptIndex_Len(index) == 1);
+    assert(!strcmp(CapSnptIndex_GetcNameAt(index, 0), "a.txt"));
+
+    // kits of pool are bound to config of warm state
+    CapKit *kit = CapWarm_NewKit(wconfig);
+    assert(kit);
+    CapWarm_DelKit(wconfig, kit, true);
+    kit = CapWarm_NewKit(config);
+    assert(kit);
+    CapWarm_DelKit(config, kit, true);
+
+    CapWarm_Del(warm);
+    char rcfullpath[PAD_FILE__NPATH];
+    char cachepath[PAD_FILE__NPATH];
+    assert(solve_path(rcfullpath, sizeof rcfullpath, rcpath));
+    if (CapAliasCache_MakePath(cachepath, sizeof cachepath, config->alias_cache_dir_path, rcfullpath)) {
+        PadFile_Remove(cachepath);
+    }
+    PadFile_Remove(config->alias_cache_dir_path);
+    CapConfig_Del(config);
+    PadFile_Remove("tests_env/warm/codes/a.txt");
+    PadFile_Remove(codespath);
+    PadFile_Remove(rcpath);
+    PadFile_Remove("tests_env/warm/cd");
+    PadFile_Remove("tests_env/warm/home");
+    PadFile_Remove("tests_env/warm/snippets");
+    PadFile_Remove(dirpath);
+}
+
+static const struct testcase
+daemon_tests[] = {
+    {"forward", test_daemoncmd_forward},
+    {"warm", test_daemoncmd_warm},
+    {0},
+};
+
+enum {
+    KIT_TEST_THREADS = 8,
+    KIT_TEST_LOOPS = 50,
+};
+
+struct kit_test_thread {
+    const CapConfig *config;
+    int index;
+    int nfails;
+};
+
+static void *
+kit_test_thread_main(void *arg) {
+    struct kit_test_thread *t = arg;
+
+    for (int i = 0; i < KIT_TEST_LOOPS; ++i) {
+        char src[256];
+        snprintf(src, sizeof src,
+            "{@ alias.set(\"t\", \"%d\") @}{: %d :}-{: %d + 1 :}", t->index, t->index, i);
+        char expect[64];
+        snprintf(expect, sizeof expect, "%d-%d", t->index, i + 1);
+
+        CapKit *kit = CapKit_New(t->config);
+        if (!kit || !CapKit_CompileFromStrArgs(kit, NULL, src, 0, NULL)) {
+            t->nfails++;
+            CapKit_Del(kit);
+            continue;
+        }
+
+        const CapAliasInfo *alinfo = CapBltAliasMod_GetAliasInfo(CapKit_GetRefCtx(kit));
+        const char *val = alinfo ? CapAliasInfo_GetcValue(alinfo, "t") : NULL;
+        if (strcmp(CapKit_GetcStdoutBuf(kit), expect) ||
+            !val || atoi(val) != t->index) {
+            t->nfails++;
+        }
+        CapKit_Del(kit);
+    }
+
+    return NULL;
+}
+
+static void
+test_kit_compile_threads(void) {
+    CapConfig *config = CapConfig_New();
+    assert(PadConfig_Init(config->pad_config));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env"));
+
+    pthread_t threads[KIT_TEST_THREADS];
+    struct kit_test_thread args[KIT_TEST_THREADS];
+    for (int i = 0; i < KIT_TEST_THREADS; ++i) {
+        args[i] = (struct kit_test_thread) {
+            .config = config,
+            .index = i,
+        };
+        assert(pthread_create(&threads[i], NULL, kit_test_thread_main, &args[i]) == 0);
+    }
+    for (int i = 0; i < KIT_TEST_THREADS; ++i) {
+        assert(pthread_join(threads[i], NULL) == 0);
+        assert(args[i].nfails == 0);
+    }
+
+    CapConfig_Del(config);
+}
+
+static void
+test_kit_pool(void) {
+    CapConfig *config = CapConfig_New();
+    assert(PadConfig_Init(config->pad_config));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env"));
+
+    CapKitPool *pool = CapKitPool_New(config, 1);
+    assert(pool);
+
+    CapKit *kit = CapKitPool_Get(pool);
+    assert(kit);
+    assert(CapKit_CompileFromStrArgs(kit, NULL, "{@ alias.set(\"a\", \"b\") @}{: 1 :}", 0, NULL));
+    assert(!strcmp(CapKit_GetcStdoutBuf(kit), "1"));
+    CapKitPool_Put(pool, kit, true);
+
+    // reused kit is reset
+    CapKit *kit2 = CapKitPool_Get(pool);
+    assert(kit2 == kit);
+    assert(CapKit_CompileFromStrArgs(kit2, NULL, "{: 2 :}", 0, NULL));
+    assert(!strcmp(CapKit_GetcStdoutBuf(kit2), "2"));
+    const CapAliasInfo *alinfo = CapBltAliasMod_GetAliasInfo(CapKit_GetRefCtx(kit2));
+    assert(!alinfo || !CapAliasInfo_GetcValue(alinfo, "a"));
+
+    CapKitPool_Put(pool, kit2, true);
+
+    // failed kit is deleted and not reused
+    kit = CapKitPool_Get(pool);
+    assert(kit == kit2);
+    assert(!CapKit_CompileFromStrArgs(kit, NULL, "{: undefined_func() :}", 0, NULL));
+    assert(PadErrStack_Len(CapKit_GetcErrStack(kit)));
+    CapKitPool_Put(pool, kit, false);
+    kit = CapKitPool_Get(pool);
+    assert(kit);
+    assert(!PadErrStack_Len(CapKit_GetcErrStack(kit)));
+
+    // pool is full then kit is deleted
+    kit2 = CapKitPool_Get(pool);
+    assert(kit2 && kit2 != kit);
+    CapKitPool_Put(pool, kit, true);
+    CapKitPool_Put(pool, kit2, true);
+
+    CapKitPoolStats stats = CapKitPool_GetStats(pool);
+    assert(stats.nnews == 3);
+    assert(stats.nreuses == 2);
+
+    CapKitPool_Del(pool);
+    CapConfig_Del(config);
+}
+
+static void
+test_kit_blt_mods(void) {
+    assert(CapBltMods_IsUsed("{@ alias.set(\"a\", \"b\") @}", "alias"));
+    assert(CapBltMods_IsUsed("{@ import \"mod\" @}", "alias"));
+    assert(!CapBltMods_IsUsed("{: 1 + 2 :}", "alias"));
+    assert(!CapBltMods_IsUsed("{@ my_alias = 1 @}{: aliases :}", "alias"));
+    assert(!CapBltMods_IsUsed(NULL, "alias"));
+
+    CapConfig *config = CapConfig_New();
+    assert(PadConfig_Init(config->pad_config));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env"));
+
+    // module is installed by second compile of same kit
+    CapKit *kit = CapKit_New(config);
+    assert(CapKit_CompileFromStrArgs(kit, NULL, "{: 1 :}", 0, NULL));
+    assert(!strcmp(CapKit_GetcStdoutBuf(kit), "1"));
+    assert(CapKit_Reset(kit));
+    assert(CapKit_CompileFromStrArgs(kit, NULL, "{@ alias.set(\"a\", \"b\") @}{: 2 :}", 0, NULL));
+    assert(!strcmp(CapKit_GetcStdoutBuf(kit), "2"));
+    const CapAliasInfo *alinfo = CapBltAliasMod_GetAliasInfo(CapKit_GetRefCtx(kit));
+    assert(alinfo && !strcmp(CapAliasInfo_GetcValue(alinfo, "a"), "b"));
+
+    CapKit_Del(kit);
+    CapConfig_Del(config);
+}
+
+static bool
+append_to_str(void *arg, const char *data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        PadStr_PushBack(arg, data[i]);
+    }
+    return true;
+}
+
+static void
+test_kit_sink(void) {
+    // last newline is held until next write
+    PadStr *buf = PadStr_New();
+    CapSink *sink = CapSink_PopLastNewline(CapSink_NewFunc(append_to_str, buf));
+    assert(sink);
+    assert(CapSink_Write(sink, "a\n", 2));
+    assert(!strcmp(PadStr_Getc(buf), "a"));
+    assert(CapSink_Write(sink, "b\n", 2));
+    assert(!strcmp(PadStr_Getc(buf), "a\nb"));
+    assert(CapSink_Close(sink));
+    assert(!strcmp(PadStr_Getc(buf), "a\nb"));
+    CapSink_Del(sink);
+
+    // stdout buffer of kit is written to sink
+    CapConfig *config = CapConfig_New();
+    assert(PadConfig_Init(config->pad_config));
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env"));
+
+    PadStr_Clear(buf);
+    CapKit *kit = CapKit_New(config);
+    assert(CapKit_CompileFromStrArgs(kit, NULL, "abc{: 1 :}\n", 0, NULL));
+    sink = CapSink_NewFunc(append_to_str, buf);
+    assert(CapKit_WriteStdoutBuf(kit, sink));
+    assert(CapSink_Close(sink));
+    assert(!strcmp(PadStr_Getc(buf), "abc1\n"));
+    CapSink_Del(sink);
+
+    // atomic file is not changed until close
+    const char *path = "tests_env/make/sink.txt";
+    PadFile_Remove(path);
+    sink = CapSink_NewAtomicFile(path);
+    assert(sink);
+    assert(CapSink_Write(sink, "abc", 3));
+    assert(!PadFile_IsExists(path));
+    assert(CapSink_Close(sink));
+    CapSink_Del(sink);
+    char *s = PadFile_ReadCopyFromPath(path);
+    assert(s && !strcmp(s, "abc"));
+    free(s);
+
+    // not closed sink keeps file
+    sink = CapSink_NewAtomicFile(path);
+    assert(CapSink_Write(sink, "def", 3));
+    CapSink_Del(sink);
+    s = PadFile_ReadCopyFromPath(path);
+    assert(s && !strcmp(s, "abc"));
+    free(s);
+
+#ifndef CAP_TESTS__WINDOWS
+    // symlink of file system is kept and the target is replaced
+    const char *link = "tests_env/make/sink-link.txt";
+    PadFile_Remove(link);
+    assert(symlink("sink.txt", link) == 0);
+    sink = CapSink_NewAtomicFile(link);
+    assert(CapSink_Write(sink, "ghi", 3));
+    assert(CapSink_Close(sink));
+    CapSink_Del(sink);
+    struct stat st;
+    assert(lstat(link, &st) == 0 && S_ISLNK(st.st_mode));
+    s = PadFile_ReadCopyFromPath(path);
+    assert(s && !strcmp(s, "ghi"));
+    free(s);
+    PadFile_Remove(link);
+#endif
+    PadFile_Remove(path);
+
+    CapKit_Del(kit);
+    CapConfig_Del(config);
+    PadStr_Del(buf);
+}
+
+static const struct testcase
+kit_tests[] = {
+    {"compile_threads", test_kit_compile_threads},
+    {"pool", test_kit_pool},
+    {"blt_mods", test_kit_blt_mods},
+    {"sink", test_kit_sink},
+    {0},
+};
+
+static void *
+app_exec_thread(void *arg) {
+    const CapConfig *config = arg;
+    PadStr *out = PadStr_New();
+    PadStr *err = PadStr_New();
+    CapSink *out_sink = CapSink_NewFunc(append_to_str, out);
+    CapSink *err_sink = CapSink_NewFunc(append_to_str, err);
+    assert(out_sink && err_sink);
+
+    for (int i = 0; i < 10; ++i) {
+        PadStr_Clear(out);
+        char *argv[] = {"cap", "pwd", NULL};
+        assert(CapApp_Exec(config, 2, argv, out_sink, err_sink) == 0);
+        assert(!strcmp(PadStr_Getc(out), "/path/to/dir\n"));
+    }
+    assert(!strcmp(PadStr_Getc(err), ""));
+
+    CapSink_Del(err_sink);
+    CapSink_Del(out_sink);
+    PadStr_Del(err);
+    PadStr_Del(out);
+    return NULL;
+}
+
+static void
+test_app_CapApp_Exec(void) {
+#ifndef CAP_TESTS__WINDOWS
+    CapConfig *config = CapConfig_New();
+    assert(solve_path(config->cd_path, sizeof config->cd_path, "./tests_env/path/to/dir"));
+    assert(solve_path(config->home_path, sizeof config->home_path, "./tests_env"));
+
+    PadStr *out = PadStr_New();
+    PadStr *err = PadStr_New();
+    CapSink *out_sink = CapSink_NewFunc(append_to_str, out);
+    CapSink *err_sink = CapSink_NewFunc(append_to_str, err);
+    assert(out_sink && err_sink);
+
+    char *argv[] = {"cap", "pwd", NULL};
+    assert(CapApp_Exec(config, 2, argv, out_sink, err_sink) == 0);
+    assert(!strcmp(PadStr_Getc(out), "/path/to/dir\n"));
+    assert(!strcmp(PadStr_Getc(err), ""));
+
+    // version and invalid option do not exit process
+    PadStr_Clear(out);
+    char *verargv[] = {"cap", "--version", NULL};
+    assert(CapApp_Exec(config, 2, verargv, out_sink, err_sink) == 0);
+    assert(strlen(PadStr_Getc(out)));
+    char *badargv[] = {"cap", "--unknown-option", NULL};
+    assert(CapApp_Exec(config, 2, badargv, out_sink, err_sink) != 0);
+    assert(strlen(PadStr_Getc(err)));
+
+    // output of exec goes to sink of caller
+    PadStr_Clear(out);
+    char *execargv[] = {"cap", "exec", "printf abc | tr a A", NULL};
+    assert(CapApp_Exec(config, 3, execargv, out_sink, err_sink) == 0);
+    assert(!strcmp(PadStr_Getc(out), "Abc"));
+
+    // threads execute at the same time with own sinks
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) {
+        assert(pthread_create(&threads[i], NULL, app_exec_thread, config) == 0);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    CapSink_Del(err_sink);
+    CapSink_Del(out_sink);
+    PadStr_Del(err);
+    PadStr_Del(out);
+    CapConfig_Del(config);
+#endif
+}
+
+static const struct testcase
+app_tests[] = {
+    {"CapApp_Exec", test_app_CapApp_Exec},
+    {0},
+};
+
 static void
 test_insert_1(void) {
     PadFile_CopyPath("tests_env/insert/file1.txt", "tests_env/insert/file1.txt.org");
@@ -2698,6 +4499,11 @@ test_modules[] = {
     {"link", link_tests},
     {"bake", bake_tests},
     {"replace", replace_tests},
+    {"hash", hash_tests},
+    {"find", find_tests},
+    {"daemon", daemon_tests},
+    {"app", app_tests},
+    {"kit", kit_tests},
     {"insert", insert_tests},
 
     {"util", utiltests},
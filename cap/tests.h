@@ -24,6 +24,7 @@
 #include <stdarg.h>
 #include <errno.h>
 #include <ctype.h>
+#include <pthread.h>
 #include <time.h>
 
 #include <pad/lib/cstring_array.h>
@@ -51,7 +52,10 @@
 #include <cap/core/util.h>
 #include <cap/core/symlink.h>
 #include <cap/core/config.h>
+#include <cap/core/state.h>
+#include <cap/core/bake_manifest.h>
 #include <cap/core/alias_info.h>
+#include <cap/lang/kit_pool.h>
 #include <cap/home/home.h>
 #include <cap/cd/cd.h>
 #include <cap/pwd/pwd.h>
@@ -69,4 +73,8 @@
 #include <cap/link/link.h>
 #include <cap/bake/bake.h>
 #include <cap/replace/replace.h>
+#include <cap/hash/hash.h>
+#include <cap/find/find.h>
+#include <cap/daemon/daemon.h>
+#include <cap/app.h>
 #include <cap/insert/insert.h>
@@ -25,9 +25,7 @@ struct CapTouchCmd {
  */
 static int
 usage(CapTouchCmd *self) {
-    fflush(stdout);
-    fflush(stderr);
-    fprintf(stderr, "Usage:\n"
+    CapOut_ErrPrintf(self->config, "Usage:\n"
         "\n"
         "    cap touch [options]... [file]...\n"
         "\n"
@@ -36,7 +34,6 @@ usage(CapTouchCmd *self) {
         "    -h, --help    show usage\n"
         "\n"
     );
-    fflush(stderr);
     return 0;
 }
 
@@ -58,14 +55,11 @@ parse_opts(CapTouchCmd *self) {
 
     self->opts = (struct Opts){0};
 
-    extern int opterr;
-    extern int optind;
-    opterr = 0; // ignore error messages
-    optind = 0; // init index of parse
+    CapGetopt opt = {0};
 
     for (;;) {
         int optsindex;
-        int cur = getopt_long(self->argc, self->argv, "h", longopts, &optsindex);
+        int cur = CapGetopt_Long(&opt, self->argc, self->argv, "h", longopts, &optsindex);
         if (cur == -1) {
             break;
         }
@@ -75,18 +69,18 @@ parse_opts(CapTouchCmd *self) {
         case 'h': self->opts.is_help = true; break;
         case '?':
         default:
-            PadErr_Die("unknown option");
+            CapOut_Err(self->config, "unknown option");
             return false;
             break;
         }
     }
 
-    if (self->argc < optind) {
-        PadErr_Die("failed to parse option");
+    if (self->argc < opt.optind) {
+        CapOut_Err(self->config, "failed to parse option");
         return false;
     }
 
-    self->optind = optind;
+    self->optind = opt.optind;
     return true;
 }
 
@@ -128,7 +122,7 @@ _touch(CapTouchCmd *self, const char *argpath) {
 
     snprintf(tmppath, sizeof tmppath, "%s/%s", org, argpath);
     if (!CapSymlink_FollowPath(self->config, path, sizeof path, tmppath)) {
-        PadErr_Err("failed to solve path by \"%s\"", argpath);
+        CapOut_Err(self->config, "failed to solve path by \"%s\"", argpath);
         return 1;
     }
 
@@ -137,7 +131,7 @@ _touch(CapTouchCmd *self, const char *argpath) {
     }
 
     if (!PadFile_Trunc(path)) {
-        PadErr_Err("failed to truncate file");
+        CapOut_Err(self->config, "failed to truncate file");
         return 1;
     }
 